@@ -0,0 +1,134 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// End-to-end benchmarks of the audio Task APIs on a synthetic signal, for
+// several number of threads.
+//
+// The test data has no audio model with the required audio metadata, so the
+// models are provided through flags, e.g. the YAMNet model linked from
+// audio_classifier.h:
+//
+//   audio_task_benchmark --audio_classifier_model=/path/to/yamnet.tflite \
+//     --audio_embedder_model=/path/to/yamnet_embedder.tflite
+//
+// The benchmarks of the tasks without a model are skipped with an error.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"  // from @com_google_absl
+#include "absl/flags/parse.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/audio/audio_classifier.h"
+#include "tensorflow_lite_support/cc/task/audio/audio_embedder.h"
+#include "tensorflow_lite_support/cc/task/audio/core/audio_buffer.h"
+#include "tensorflow_lite_support/cc/task/audio/proto/audio_classifier_options.pb.h"
+#include "tensorflow_lite_support/cc/task/audio/proto/audio_embedder_options.pb.h"
+#include "tensorflow_lite_support/cc/task/benchmarks/benchmark_utils.h"
+
+ABSL_FLAG(std::string, audio_classifier_model, "",
+          "Path to an audio classification model with metadata.");
+ABSL_FLAG(std::string, audio_embedder_model, "",
+          "Path to an audio embedding model with metadata.");
+
+namespace tflite {
+namespace task {
+namespace benchmarks {
+namespace {
+
+using ::tflite::support::StatusOr;
+using ::tflite::task::audio::AudioBuffer;
+using ::tflite::task::audio::AudioClassifier;
+using ::tflite::task::audio::AudioClassifierOptions;
+using ::tflite::task::audio::AudioEmbedder;
+using ::tflite::task::audio::AudioEmbedderOptions;
+
+// Creates the task from `options` and benchmarks it on a synthetic signal of
+// the size and format it requires.
+template <typename TaskT, typename OptionsT, typename RunFn>
+void BenchmarkAudioTask(const std::string& model_path, OptionsT& options,
+                        RunFn run, benchmark::State& state) {
+  if (model_path.empty()) {
+    state.SkipWithError("No model provided, see the flags of the binary.");
+    return;
+  }
+  SetModelAndThreads(model_path, state.range(0),
+                     options.mutable_base_options());
+  StatusOr<std::unique_ptr<TaskT>> task = TaskT::CreateFromOptions(options);
+  if (!task.ok()) {
+    state.SkipWithError(std::string(task.status().message()).c_str());
+    return;
+  }
+  StatusOr<AudioBuffer::AudioFormat> format =
+      (*task)->GetRequiredAudioFormat();
+  if (!format.ok()) {
+    state.SkipWithError(std::string(format.status().message()).c_str());
+    return;
+  }
+  const std::vector<float> samples =
+      SyntheticAudio((*task)->GetRequiredInputBufferSize());
+  const AudioBuffer buffer(samples.data(), samples.size(), *format);
+  RunTaskBenchmark(**task, [&] { return run(**task, buffer); }, state);
+  state.SetBytesProcessed(state.iterations() * samples.size() *
+                          sizeof(float));
+}
+
+void BM_AudioClassifier(benchmark::State& state) {
+  AudioClassifierOptions options;
+  options.set_max_results(5);
+  BenchmarkAudioTask<AudioClassifier>(
+      absl::GetFlag(FLAGS_audio_classifier_model), options,
+      [](AudioClassifier& classifier, const AudioBuffer& buffer) {
+        return classifier.Classify(buffer).status();
+      },
+      state);
+}
+BENCHMARK(BM_AudioClassifier)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_AudioEmbedder(benchmark::State& state) {
+  AudioEmbedderOptions options;
+  BenchmarkAudioTask<AudioEmbedder>(
+      absl::GetFlag(FLAGS_audio_embedder_model), options,
+      [](AudioEmbedder& embedder, const AudioBuffer& buffer) {
+        return embedder.Embed(buffer).status();
+      },
+      state);
+}
+BENCHMARK(BM_AudioEmbedder)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace task
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  // Benchmark flags are removed from `argv` before parsing the other flags.
+  benchmark::Initialize(&argc, argv);
+  absl::ParseCommandLine(argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
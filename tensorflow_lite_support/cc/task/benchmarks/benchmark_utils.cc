@@ -0,0 +1,202 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/benchmarks/benchmark_utils.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+#include "tensorflow_lite_support/cc/test/test_utils.h"
+
+namespace tflite {
+namespace task {
+namespace benchmarks {
+
+namespace {
+
+using ::tflite::support::StatusOr;
+using ::tflite::task::vision::FrameBuffer;
+
+constexpr char kTestDataDirectory[] =
+    "/tensorflow_lite_support/cc/test/testdata/";
+
+constexpr const char* kWords[] = {
+    "the",    "a",     "movie",    "was",    "really",   "not",    "good",
+    "bad",    "and",   "of",       "to",     "in",       "it",     "is",
+    "that",   "story", "actors",   "film",   "best",     "worst",  "time",
+    "plot",   "with",  "for",      "scene",  "music",    "great",  "boring",
+    "i",      "this",  "would",    "never",  "again",    "ending", "watched",
+    "camera", "funny", "strongly", "long",   "dialogue", "recommend",
+};
+constexpr int kNumWords = sizeof(kWords) / sizeof(kWords[0]);
+
+// Minimal linear congruential generator, so that the synthetic inputs are
+// identical across platforms and runs.
+class Lcg {
+ public:
+  explicit Lcg(uint32_t seed) : state_(seed) {}
+  uint32_t Next() {
+    state_ = state_ * 1664525u + 1013904223u;
+    return state_ >> 8;
+  }
+
+ private:
+  uint32_t state_;
+};
+
+const char* FormatName(FrameBuffer::Format format) {
+  switch (format) {
+    case FrameBuffer::Format::kRGBA:
+      return "RGBA";
+    case FrameBuffer::Format::kRGB:
+      return "RGB";
+    case FrameBuffer::Format::kNV12:
+      return "NV12";
+    case FrameBuffer::Format::kNV21:
+      return "NV21";
+    case FrameBuffer::Format::kYV12:
+      return "YV12";
+    case FrameBuffer::Format::kYV21:
+      return "YV21";
+    case FrameBuffer::Format::kGRAY:
+      return "GRAY";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+const char* OrientationName(FrameBuffer::Orientation orientation) {
+  switch (orientation) {
+    case FrameBuffer::Orientation::kTopLeft:
+      return "top_left";
+    case FrameBuffer::Orientation::kTopRight:
+      return "top_right";
+    case FrameBuffer::Orientation::kBottomRight:
+      return "bottom_right";
+    case FrameBuffer::Orientation::kBottomLeft:
+      return "bottom_left";
+    case FrameBuffer::Orientation::kLeftTop:
+      return "left_top";
+    case FrameBuffer::Orientation::kRightTop:
+      return "right_top";
+    case FrameBuffer::Orientation::kRightBottom:
+      return "right_bottom";
+    case FrameBuffer::Orientation::kLeftBottom:
+      return "left_bottom";
+  }
+  return "unknown";
+}
+
+}  // namespace
+
+std::string GetTestDataPath(absl::string_view directory,
+                            absl::string_view file_name) {
+  return JoinPath("./" /*test src dir*/, kTestDataDirectory, directory,
+                  file_name);
+}
+
+void SetModelAndThreads(const std::string& model_path, int num_threads,
+                        core::BaseOptions* base_options) {
+  base_options->mutable_model_file()->set_file_name(model_path);
+  base_options->mutable_compute_settings()
+      ->mutable_tflite_settings()
+      ->mutable_cpu_settings()
+      ->set_num_threads(num_threads);
+}
+
+/* static */
+StatusOr<std::unique_ptr<SyntheticImage>> SyntheticImage::Create(
+    FrameBuffer::Dimension dimension, FrameBuffer::Format format,
+    FrameBuffer::Orientation orientation) {
+  std::unique_ptr<SyntheticImage> image(new SyntheticImage());
+  image->pixels_.resize(vision::GetFrameBufferByteSize(dimension, format));
+  Lcg lcg(/*seed=*/42);
+  for (int i = 0; i < image->pixels_.size(); ++i) {
+    // Smooth ramp with some noise, closer to natural images than pure noise.
+    image->pixels_[i] = static_cast<uint8>((i / 3 + (lcg.Next() & 31)) & 0xff);
+  }
+  ASSIGN_OR_RETURN(image->frame_buffer_,
+                   vision::CreateFromRawBuffer(image->pixels_.data(),
+                                               dimension, format, orientation));
+  return image;
+}
+
+vision::BoundingBox SyntheticImage::CenterRoi() const {
+  const FrameBuffer::Dimension dimension = frame_buffer_->dimension();
+  const int side = std::min(dimension.width, dimension.height) / 2;
+  vision::BoundingBox roi;
+  roi.set_origin_x((dimension.width - side) / 2);
+  roi.set_origin_y((dimension.height - side) / 2);
+  roi.set_width(side);
+  roi.set_height(side);
+  return roi;
+}
+
+std::string SyntheticText(int num_words, uint32_t seed) {
+  Lcg lcg(seed);
+  std::string text;
+  for (int i = 0; i < num_words; ++i) {
+    if (i > 0) {
+      absl::StrAppend(&text, i % 12 == 0 ? ". " : " ");
+    }
+    absl::StrAppend(&text, kWords[lcg.Next() % kNumWords]);
+  }
+  absl::StrAppend(&text, ".");
+  return text;
+}
+
+std::vector<float> SyntheticAudio(int num_samples) {
+  // Two tones plus noise, at an assumed 16kHz sample rate.
+  constexpr float kTwoPi = 6.28318530718f;
+  constexpr float kSampleRate = 16000.0f;
+  Lcg lcg(/*seed=*/7);
+  std::vector<float> samples(num_samples);
+  for (int i = 0; i < num_samples; ++i) {
+    const float t = i / kSampleRate;
+    const float noise = (lcg.Next() % 2001) / 1000.0f - 1.0f;
+    samples[i] = 0.5f * std::sin(kTwoPi * 440.0f * t) +
+                 0.3f * std::sin(kTwoPi * 1250.0f * t) + 0.1f * noise;
+  }
+  return samples;
+}
+
+std::string DescribeImageInput(FrameBuffer::Format format,
+                               FrameBuffer::Orientation orientation,
+                               bool use_roi) {
+  return absl::StrCat(FormatName(format), " ", OrientationName(orientation),
+                      use_roi ? " roi" : "");
+}
+
+void ReportTaskStats(const core::TaskStats& stats, benchmark::State& state) {
+  auto report = [&state](const std::string& name,
+                         const core::LatencyStats& latency) {
+    state.counters[absl::StrCat(name, "_ms")] =
+        absl::ToDoubleMilliseconds(latency.mean);
+    state.counters[absl::StrCat(name, "_p99_ms")] =
+        absl::ToDoubleMilliseconds(latency.p99);
+  };
+  report("preprocess", stats.preprocess);
+  report("invoke", stats.invoke);
+  report("postprocess", stats.postprocess);
+  report("total", stats.total);
+}
+
+}  // namespace benchmarks
+}  // namespace task
+}  // namespace tflite
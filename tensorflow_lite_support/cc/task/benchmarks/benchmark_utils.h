@@ -0,0 +1,116 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_BENCHMARKS_BENCHMARK_UTILS_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_BENCHMARKS_BENCHMARK_UTILS_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/core/proto/base_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/core/task_stats.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
+
+namespace tflite {
+namespace task {
+namespace benchmarks {
+
+// Returns the path of `file_name` in the `directory` of the test data, e.g.
+// GetTestDataPath("task/vision", "burger.jpg").
+std::string GetTestDataPath(absl::string_view directory,
+                            absl::string_view file_name);
+
+// Sets the model file and number of CPU threads of `base_options`.
+void SetModelAndThreads(const std::string& model_path, int num_threads,
+                        core::BaseOptions* base_options);
+
+// A synthetic camera frame filled with pseudo-random pixel values, so that the
+// preprocessing does not benefit from uniform data.
+class SyntheticImage {
+ public:
+  static tflite::support::StatusOr<std::unique_ptr<SyntheticImage>> Create(
+      vision::FrameBuffer::Dimension dimension,
+      vision::FrameBuffer::Format format,
+      vision::FrameBuffer::Orientation orientation);
+
+  const vision::FrameBuffer& frame_buffer() const { return *frame_buffer_; }
+
+  // Returns a square region of interest centered in the frame buffer, whose
+  // side is half of the smallest side of the image. It is expressed in the
+  // coordinates of the frame buffer, hence valid for any orientation.
+  vision::BoundingBox CenterRoi() const;
+
+ private:
+  SyntheticImage() = default;
+
+  std::vector<uint8> pixels_;
+  std::unique_ptr<vision::FrameBuffer> frame_buffer_;
+};
+
+// Returns a synthetic English-like text of `num_words` words. The same
+// `seed` always produces the same text.
+std::string SyntheticText(int num_words, uint32_t seed = 0);
+
+// Returns `num_samples` samples of a synthetic audio signal in [-1, 1].
+std::vector<float> SyntheticAudio(int num_samples);
+
+// Returns a short human readable description of an image input, used as
+// benchmark label, e.g. "NV21 right_top roi".
+std::string DescribeImageInput(vision::FrameBuffer::Format format,
+                               vision::FrameBuffer::Orientation orientation,
+                               bool use_roi);
+
+// Adds the mean and 99th percentile latency of each inference stage in
+// `stats` to the counters of `state`, in milliseconds: `preprocess_ms`,
+// `invoke_ms`, `postprocess_ms` and `total_ms` and their `_p99` variants.
+void ReportTaskStats(const core::TaskStats& stats, benchmark::State& state);
+
+// Runs the benchmark loop of `task`, where `run` performs one inference and
+// returns its status. An untimed warm-up inference is run first, so that
+// lazy initializations are excluded from the measurements, and the per-stage
+// latencies recorded by the task statistics are reported as counters.
+template <typename TaskT, typename RunFn>
+void RunTaskBenchmark(TaskT& task, RunFn run, benchmark::State& state) {
+  absl::Status status = run();
+  if (!status.ok()) {
+    state.SkipWithError(std::string(status.message()).c_str());
+    return;
+  }
+  task.ResetStats();
+  task.SetStatsEnabled(true);
+  for (auto _ : state) {
+    status = run();
+    if (!status.ok()) {
+      state.SkipWithError(std::string(status.message()).c_str());
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  ReportTaskStats(task.GetStats(), state);
+}
+
+}  // namespace benchmarks
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_BENCHMARKS_BENCHMARK_UTILS_H_
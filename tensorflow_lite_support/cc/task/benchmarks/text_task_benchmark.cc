@@ -0,0 +1,196 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// End-to-end benchmarks of the text Task APIs on synthetic inputs of several
+// lengths, and for several number of threads.
+//
+// Besides the wall time per call, the mean and 99th percentile latency of the
+// preprocess (tokenization), invoke and postprocess stages are reported as
+// counters. UniversalSentenceEncoderQA runs one inference per response plus
+// one for the query, so its stage latencies are per inference, not per call.
+
+#include <initializer_list>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/benchmarks/benchmark_utils.h"
+#include "tensorflow_lite_support/cc/task/text/bert_nl_classifier.h"
+#include "tensorflow_lite_support/cc/task/text/bert_question_answerer.h"
+#include "tensorflow_lite_support/cc/task/text/nlclassifier/nl_classifier.h"
+#include "tensorflow_lite_support/cc/task/text/proto/bert_nl_classifier_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/text/proto/bert_question_answerer_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/text/proto/nl_classifier_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/text/proto/retrieval_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/text/universal_sentence_encoder_qa.h"
+
+namespace tflite {
+namespace task {
+namespace benchmarks {
+namespace {
+
+using ::tflite::support::StatusOr;
+using ::tflite::task::text::BertNLClassifier;
+using ::tflite::task::text::BertNLClassifierOptions;
+using ::tflite::task::text::BertQuestionAnswerer;
+using ::tflite::task::text::BertQuestionAnswererOptions;
+using ::tflite::task::text::NLClassifierOptions;
+using ::tflite::task::text::RetrievalInput;
+using ::tflite::task::text::RetrievalOptions;
+using ::tflite::task::text::nlclassifier::NLClassifier;
+using ::tflite::task::text::retrieval::UniversalSentenceEncoderQA;
+
+constexpr char kTextDirectory[] = "task/text";
+constexpr char kNLClassifierWithRegexTokenizer[] =
+    "test_model_nl_classifier_with_regex_tokenizer.tflite";
+constexpr char kBertNLClassifier[] = "bert_nl_classifier.tflite";
+constexpr char kMobileBertWithMetadata[] = "mobilebert_with_metadata.tflite";
+constexpr char kUniversalSentenceEncoderQA[] =
+    "universal_sentence_encoder_qa_with_metadata.tflite";
+
+// Indices of the benchmark arguments.
+constexpr int kLengthArg = 0;
+constexpr int kThreadsArg = 1;
+
+// Adds the {length, threads} argument sets: every length in `lengths` on a
+// single thread, then the thread sweep on `sweep_length`.
+void AddTextArguments(benchmark::internal::Benchmark* benchmark,
+                      const char* length_name,
+                      std::initializer_list<int> lengths, int sweep_length) {
+  benchmark->ArgNames({length_name, "threads"});
+  for (int length : lengths) {
+    benchmark->Args({length, 1});
+  }
+  for (int num_threads : {2, 4}) {
+    benchmark->Args({sweep_length, num_threads});
+  }
+}
+
+void WordArguments(benchmark::internal::Benchmark* benchmark) {
+  AddTextArguments(benchmark, "words", {8, 64, 256}, /*sweep_length=*/64);
+}
+
+void ResponseArguments(benchmark::internal::Benchmark* benchmark) {
+  AddTextArguments(benchmark, "responses", {1, 8, 32}, /*sweep_length=*/8);
+}
+
+void BM_NLClassifier(benchmark::State& state) {
+  const std::string text = SyntheticText(state.range(kLengthArg));
+  NLClassifierOptions options;
+  SetModelAndThreads(
+      GetTestDataPath(kTextDirectory, kNLClassifierWithRegexTokenizer),
+      state.range(kThreadsArg), options.mutable_base_options());
+  StatusOr<std::unique_ptr<NLClassifier>> classifier =
+      NLClassifier::CreateFromOptions(options);
+  if (!classifier.ok()) {
+    state.SkipWithError(std::string(classifier.status().message()).c_str());
+    return;
+  }
+  RunTaskBenchmark(
+      **classifier,
+      [&] {
+        benchmark::DoNotOptimize((*classifier)->Classify(text));
+        return absl::OkStatus();
+      },
+      state);
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_NLClassifier)->Apply(WordArguments);
+
+void BM_BertNLClassifier(benchmark::State& state) {
+  const std::string text = SyntheticText(state.range(kLengthArg));
+  BertNLClassifierOptions options;
+  SetModelAndThreads(GetTestDataPath(kTextDirectory, kBertNLClassifier),
+                     state.range(kThreadsArg),
+                     options.mutable_base_options());
+  StatusOr<std::unique_ptr<BertNLClassifier>> classifier =
+      BertNLClassifier::CreateFromOptions(options);
+  if (!classifier.ok()) {
+    state.SkipWithError(std::string(classifier.status().message()).c_str());
+    return;
+  }
+  RunTaskBenchmark(
+      **classifier,
+      [&] {
+        benchmark::DoNotOptimize((*classifier)->Classify(text));
+        return absl::OkStatus();
+      },
+      state);
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_BertNLClassifier)
+    ->Apply(WordArguments)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_BertQuestionAnswerer(benchmark::State& state) {
+  const std::string context = SyntheticText(state.range(kLengthArg));
+  const std::string question =
+      SyntheticText(/*num_words=*/8, /*seed=*/1) + "?";
+  BertQuestionAnswererOptions options;
+  SetModelAndThreads(GetTestDataPath(kTextDirectory, kMobileBertWithMetadata),
+                     state.range(kThreadsArg),
+                     options.mutable_base_options());
+  StatusOr<std::unique_ptr<BertQuestionAnswerer>> answerer =
+      BertQuestionAnswerer::CreateFromOptions(options);
+  if (!answerer.ok()) {
+    state.SkipWithError(std::string(answerer.status().message()).c_str());
+    return;
+  }
+  RunTaskBenchmark(
+      **answerer,
+      [&] {
+        benchmark::DoNotOptimize((*answerer)->Answer(context, question));
+        return absl::OkStatus();
+      },
+      state);
+  state.SetBytesProcessed(state.iterations() *
+                          (context.size() + question.size()));
+}
+BENCHMARK(BM_BertQuestionAnswerer)
+    ->Apply(WordArguments)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_UniversalSentenceEncoderQA(benchmark::State& state) {
+  RetrievalInput input;
+  input.set_query_text(SyntheticText(/*num_words=*/10, /*seed=*/1));
+  for (int i = 0; i < state.range(kLengthArg); ++i) {
+    auto* raw_text = input.add_responses()->mutable_raw_text();
+    raw_text->set_text(SyntheticText(/*num_words=*/16, /*seed=*/i + 2));
+    raw_text->set_context(SyntheticText(/*num_words=*/48, /*seed=*/i + 2));
+  }
+  RetrievalOptions options;
+  SetModelAndThreads(
+      GetTestDataPath(kTextDirectory, kUniversalSentenceEncoderQA),
+      state.range(kThreadsArg), options.mutable_base_options());
+  StatusOr<std::unique_ptr<UniversalSentenceEncoderQA>> retriever =
+      UniversalSentenceEncoderQA::CreateFromOption(options);
+  if (!retriever.ok()) {
+    state.SkipWithError(std::string(retriever.status().message()).c_str());
+    return;
+  }
+  RunTaskBenchmark(
+      **retriever,
+      [&] { return (*retriever)->Retrieve(input).status(); }, state);
+}
+BENCHMARK(BM_UniversalSentenceEncoderQA)
+    ->Apply(ResponseArguments)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace task
+}  // namespace tflite
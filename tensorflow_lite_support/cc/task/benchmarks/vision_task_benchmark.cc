@@ -0,0 +1,219 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// End-to-end benchmarks of the vision Task APIs on synthetic 640x480 camera
+// frames, for several input formats, orientations, regions of interest and
+// number of threads.
+//
+// Besides the wall time per inference, the mean and 99th percentile latency of
+// the preprocess (format conversion, rotation, crop and resize), invoke and
+// postprocess stages are reported as counters.
+
+#include <memory>
+
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/task/benchmarks/benchmark_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/image_classifier.h"
+#include "tensorflow_lite_support/cc/task/vision/image_embedder.h"
+#include "tensorflow_lite_support/cc/task/vision/image_segmenter.h"
+#include "tensorflow_lite_support/cc/task/vision/object_detector.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/image_classifier_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/image_embedder_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/image_segmenter_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/object_detector_options_proto_inc.h"
+
+namespace tflite {
+namespace task {
+namespace benchmarks {
+namespace {
+
+using ::tflite::task::vision::BoundingBox;
+using ::tflite::task::vision::FrameBuffer;
+using ::tflite::task::vision::ImageClassifier;
+using ::tflite::task::vision::ImageClassifierOptions;
+using ::tflite::task::vision::ImageEmbedder;
+using ::tflite::task::vision::ImageEmbedderOptions;
+using ::tflite::task::vision::ImageSegmenter;
+using ::tflite::task::vision::ImageSegmenterOptions;
+using ::tflite::task::vision::ObjectDetector;
+using ::tflite::task::vision::ObjectDetectorOptions;
+
+constexpr char kVisionDirectory[] = "task/vision";
+constexpr char kMobileNetFloatWithMetadata[] = "mobilenet_v2_1.0_224.tflite";
+constexpr char kMobileNetQuantizedWithMetadata[] =
+    "mobilenet_v1_0.25_224_quant.tflite";
+constexpr char kMobileSsdWithMetadata[] =
+    "coco_ssd_mobilenet_v1_1.0_quant_2018_06_29.tflite";
+constexpr char kDeepLabV3[] = "deeplabv3.tflite";
+constexpr char kMobileNetV3Embedder[] =
+    "mobilenet_v3_small_100_224_embedder.tflite";
+
+constexpr FrameBuffer::Dimension kCameraDimension = {640, 480};
+
+// Indices of the benchmark arguments.
+constexpr int kFormatArg = 0;
+constexpr int kOrientationArg = 1;
+constexpr int kRoiArg = 2;
+constexpr int kThreadsArg = 3;
+
+int AsArg(FrameBuffer::Format format) { return static_cast<int>(format); }
+int AsArg(FrameBuffer::Orientation orientation) {
+  return static_cast<int>(orientation);
+}
+
+// Adds the {format, orientation, roi, threads} argument sets: every format and
+// orientation on a single thread, then the thread sweep (and, if `with_roi`,
+// a region of interest) on upright RGB frames.
+void AddImageArguments(benchmark::internal::Benchmark* benchmark,
+                       bool with_roi) {
+  benchmark->ArgNames({"format", "orientation", "roi", "threads"});
+  for (FrameBuffer::Format format :
+       {FrameBuffer::Format::kRGB, FrameBuffer::Format::kNV21,
+        FrameBuffer::Format::kYV12}) {
+    for (FrameBuffer::Orientation orientation :
+         {FrameBuffer::Orientation::kTopLeft,
+          FrameBuffer::Orientation::kRightTop,
+          FrameBuffer::Orientation::kBottomRight}) {
+      benchmark->Args({AsArg(format), AsArg(orientation), 0, 1});
+    }
+  }
+  const int rgb = AsArg(FrameBuffer::Format::kRGB);
+  const int upright = AsArg(FrameBuffer::Orientation::kTopLeft);
+  if (with_roi) {
+    benchmark->Args({rgb, upright, 1, 1});
+  }
+  for (int num_threads : {2, 4}) {
+    benchmark->Args({rgb, upright, 0, num_threads});
+  }
+}
+
+void ImageArguments(benchmark::internal::Benchmark* benchmark) {
+  AddImageArguments(benchmark, /*with_roi=*/false);
+}
+
+void ImageArgumentsWithRoi(benchmark::internal::Benchmark* benchmark) {
+  AddImageArguments(benchmark, /*with_roi=*/true);
+}
+
+// Creates the synthetic frame described by the benchmark arguments, and sets
+// the benchmark label accordingly.
+std::unique_ptr<SyntheticImage> CreateFrame(benchmark::State& state) {
+  const auto format = static_cast<FrameBuffer::Format>(state.range(kFormatArg));
+  const auto orientation =
+      static_cast<FrameBuffer::Orientation>(state.range(kOrientationArg));
+  state.SetLabel(
+      DescribeImageInput(format, orientation, state.range(kRoiArg) != 0));
+  return SyntheticImage::Create(kCameraDimension, format, orientation).value();
+}
+
+void BenchmarkImageClassifier(const char* model, benchmark::State& state) {
+  std::unique_ptr<SyntheticImage> frame = CreateFrame(state);
+  ImageClassifierOptions options;
+  options.set_max_results(5);
+  SetModelAndThreads(GetTestDataPath(kVisionDirectory, model),
+                     state.range(kThreadsArg),
+                     options.mutable_base_options());
+  std::unique_ptr<ImageClassifier> classifier =
+      ImageClassifier::CreateFromOptions(options).value();
+  const bool use_roi = state.range(kRoiArg) != 0;
+  const BoundingBox roi = frame->CenterRoi();
+  RunTaskBenchmark(
+      *classifier,
+      [&] {
+        return use_roi
+                   ? classifier->Classify(frame->frame_buffer(), roi).status()
+                   : classifier->Classify(frame->frame_buffer()).status();
+      },
+      state);
+}
+
+void BM_ImageClassifierFloat(benchmark::State& state) {
+  BenchmarkImageClassifier(kMobileNetFloatWithMetadata, state);
+}
+BENCHMARK(BM_ImageClassifierFloat)
+    ->Apply(ImageArgumentsWithRoi)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_ImageClassifierQuantized(benchmark::State& state) {
+  BenchmarkImageClassifier(kMobileNetQuantizedWithMetadata, state);
+}
+BENCHMARK(BM_ImageClassifierQuantized)
+    ->Apply(ImageArgumentsWithRoi)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_ObjectDetector(benchmark::State& state) {
+  std::unique_ptr<SyntheticImage> frame = CreateFrame(state);
+  ObjectDetectorOptions options;
+  options.set_max_results(10);
+  SetModelAndThreads(GetTestDataPath(kVisionDirectory, kMobileSsdWithMetadata),
+                     state.range(kThreadsArg),
+                     options.mutable_base_options());
+  std::unique_ptr<ObjectDetector> detector =
+      ObjectDetector::CreateFromOptions(options).value();
+  RunTaskBenchmark(
+      *detector,
+      [&] { return detector->Detect(frame->frame_buffer()).status(); }, state);
+}
+BENCHMARK(BM_ObjectDetector)
+    ->Apply(ImageArguments)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_ImageSegmenter(benchmark::State& state) {
+  std::unique_ptr<SyntheticImage> frame = CreateFrame(state);
+  ImageSegmenterOptions options;
+  SetModelAndThreads(GetTestDataPath(kVisionDirectory, kDeepLabV3),
+                     state.range(kThreadsArg),
+                     options.mutable_base_options());
+  std::unique_ptr<ImageSegmenter> segmenter =
+      ImageSegmenter::CreateFromOptions(options).value();
+  RunTaskBenchmark(
+      *segmenter,
+      [&] { return segmenter->Segment(frame->frame_buffer()).status(); },
+      state);
+}
+BENCHMARK(BM_ImageSegmenter)
+    ->Apply(ImageArguments)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_ImageEmbedder(benchmark::State& state) {
+  std::unique_ptr<SyntheticImage> frame = CreateFrame(state);
+  // ImageEmbedderOptions has no `base_options` yet.
+  ImageEmbedderOptions options;
+  options.mutable_model_file_with_metadata()->set_file_name(
+      GetTestDataPath(kVisionDirectory, kMobileNetV3Embedder));
+  options.set_num_threads(state.range(kThreadsArg));
+  options.set_l2_normalize(true);
+  std::unique_ptr<ImageEmbedder> embedder =
+      ImageEmbedder::CreateFromOptions(options).value();
+  const bool use_roi = state.range(kRoiArg) != 0;
+  const BoundingBox roi = frame->CenterRoi();
+  RunTaskBenchmark(
+      *embedder,
+      [&] {
+        return use_roi ? embedder->Embed(frame->frame_buffer(), roi).status()
+                       : embedder->Embed(frame->frame_buffer()).status();
+      },
+      state);
+}
+BENCHMARK(BM_ImageEmbedder)
+    ->Apply(ImageArgumentsWithRoi)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace benchmarks
+}  // namespace task
+}  // namespace tflite
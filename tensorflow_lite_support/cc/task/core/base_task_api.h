@@ -16,15 +16,26 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_BASE_TASK_API_H_
 #define TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_BASE_TASK_API_H_
 
+#include <atomic>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/time/clock.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow_lite_support/cc/common.h"
 #include "tensorflow_lite_support/cc/port/status_macros.h"
 #include "tensorflow_lite_support/cc/port/statusor.h"
 #include "tensorflow_lite_support/cc/port/tflite_wrapper.h"
+#include "tensorflow_lite_support/cc/task/core/cpu_placement.h"
+#include "tensorflow_lite_support/cc/task/core/op_profiler.h"
+#include "tensorflow_lite_support/cc/task/core/raw_output_tensor.h"
+#include "tensorflow_lite_support/cc/task/core/shared_cpu_context.h"
+#include "tensorflow_lite_support/cc/task/core/task_stats.h"
 #include "tensorflow_lite_support/cc/task/core/tflite_engine.h"
 
 namespace tflite {
@@ -42,6 +53,28 @@ class BaseUntypedTaskApi {
     return engine_->metadata_extractor();
   }
 
+  // Enables or disables the collection of inference statistics, which is
+  // disabled by default. When enabled, each inference records the latency of
+  // its preprocessing, interpreter invocation and postprocessing stages, and
+  // the outcome of the invocation. Recording is lock-free and costs a few
+  // clock reads per inference.
+  //
+  // Can be called from any thread, including while inference is running.
+  void SetStatsEnabled(bool enabled) {
+    stats_enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  // Returns the statistics recorded since creation or the last call to
+  // `ResetStats`. Can be called from any thread.
+  TaskStats GetStats() const { return stats_.Snapshot(); }
+
+  // Clears the recorded statistics. Can be called from any thread.
+  void ResetStats() { stats_.Reset(); }
+
+  // Returns the per-operator profiler, or nullptr if profiling was not enabled
+  // through `BaseOptions.profiling_options` at creation time.
+  const OpProfiler* GetOpProfiler() const { return engine_->op_profiler(); }
+
  protected:
   // TODO(b/200258103): It's a short term solution. In the future we will forbid
   // Tasks exposing the underlying TfLiteEngine. Please try not rely on this
@@ -50,8 +83,59 @@ class BaseUntypedTaskApi {
   // Returns a raw pointer to the underlying TfLiteEngine.
   TfLiteEngine* GetTfLiteEngine() { return engine_.get(); }
 
+  // Returns the statistics recorder if statistics are enabled, or nullptr.
+  TaskStatsRecorder* GetStatsRecorder() {
+    return stats_enabled_.load(std::memory_order_relaxed) ? &stats_ : nullptr;
+  }
+
+  // Brackets an inference call, from before preprocessing to after
+  // postprocessing. With a CPU placement, the calling thread is restricted to
+  // the CPU cores of the placement. The shared CPU context, if any, is then
+  // leased, as preprocessing may allocate the tensors again and thus run the
+  // kernels preparation. If statistics are enabled, the latency of the whole
+  // call, including the wait for the lease, is recorded as the total latency
+  // on destruction. Callers must return `status()` if it is not OK.
+  class ScopedInference {
+   public:
+    explicit ScopedInference(BaseUntypedTaskApi* task)
+        : stats_(task->GetStatsRecorder()),
+          start_(stats_ != nullptr ? absl::Now() : absl::Time()),
+          affinity_(task->GetTfLiteEngine()->PinCurrentThread()) {
+      if (affinity_ != nullptr && !affinity_->status().ok()) {
+        status_ = affinity_->status();
+        return;
+      }
+      cpu_context_ = task->GetTfLiteEngine()->AcquireCpuContext();
+    }
+
+    ~ScopedInference() {
+      if (stats_ != nullptr && status_.ok()) {
+        stats_->total().Record(absl::Now() - start_);
+      }
+    }
+
+    ScopedInference(const ScopedInference&) = delete;
+    ScopedInference& operator=(const ScopedInference&) = delete;
+
+    // Whether the calling thread could be pinned.
+    const absl::Status& status() const { return status_; }
+
+    // The statistics recorder if statistics are enabled, or nullptr.
+    TaskStatsRecorder* stats() const { return stats_; }
+
+   private:
+    TaskStatsRecorder* stats_;
+    absl::Time start_;
+    // Declared before the lease, so that it is released after it.
+    std::unique_ptr<ScopedCpuAffinity> affinity_;
+    std::unique_ptr<TfLiteEngine::CpuContextLease> cpu_context_;
+    absl::Status status_;
+  };
+
  private:
   std::unique_ptr<TfLiteEngine> engine_;
+  std::atomic<bool> stats_enabled_{false};
+  TaskStatsRecorder stats_;
 };
 
 template <class OutputType, class... InputTypes>
@@ -94,6 +178,32 @@ class BaseTaskApi : public BaseUntypedTaskApi {
   // the CPU invocation will not be executed.
   void Cancel() { GetTfLiteEngine()->Cancel(); }
 
+  // Runs the preprocessing and the inference of the task on `args`, like the
+  // task-specific inference methods, but skips the postprocessing: returns
+  // views of the output tensors of the model instead (e.g. the raw scores of
+  // a classifier), one per output in the model order. This avoids building
+  // the task results (label strings, score calibration, sorting) for callers
+  // which only need the raw outputs.
+  //
+  // The views point into the interpreter memory and are only valid until the
+  // next inference on this task.
+  tflite::support::StatusOr<absl::Span<const RawOutputTensor>> InferRaw(
+      InputTypes... args) {
+    ScopedInference inference(this);
+    RETURN_IF_ERROR(inference.status());
+    RETURN_IF_ERROR(PreprocessWithStats(args...));
+    RETURN_IF_ERROR(InvokeWithFallback());
+    // The views are rebuilt after each inference, as a fallback to CPU
+    // replaces the interpreter and its tensors.
+    const TfLiteEngine::Interpreter* interpreter =
+        GetTfLiteEngine()->interpreter();
+    raw_outputs_.clear();
+    for (int i = 0; i < TfLiteEngine::OutputCount(interpreter); ++i) {
+      raw_outputs_.emplace_back(TfLiteEngine::GetOutput(interpreter, i));
+    }
+    return absl::MakeConstSpan(raw_outputs_);
+  }
+
  protected:
   // Subclasses need to populate input_tensors from api_inputs.
   virtual absl::Status Preprocess(
@@ -106,6 +216,19 @@ class BaseTaskApi : public BaseUntypedTaskApi {
       const std::vector<const TfLiteTensor*>& output_tensors,
       InputTypes... api_inputs) = 0;
 
+  // Same as `Postprocess`, except that the output is written to `result`,
+  // whose previous contents are replaced. Subclasses can override this method
+  // to reuse the memory already held by `result` (e.g. the cleared elements
+  // of the repeated fields and the string capacity of a protobuf message, or
+  // its arena). The default implementation moves the output of `Postprocess`
+  // into `result`. On error, the contents of `result` are unspecified.
+  virtual absl::Status PostprocessInto(
+      const std::vector<const TfLiteTensor*>& output_tensors,
+      InputTypes... api_inputs, OutputType* result) {
+    ASSIGN_OR_RETURN(*result, Postprocess(output_tensors, api_inputs...));
+    return absl::OkStatus();
+  }
+
   // Returns (the addresses of) the model's inputs.
   std::vector<TfLiteTensor*> GetInputTensors() {
     return GetTfLiteEngine()->GetInputs();
@@ -121,10 +244,26 @@ class BaseTaskApi : public BaseUntypedTaskApi {
   tflite::support::StatusOr<OutputType> Infer(InputTypes... args) {
     tflite::task::core::TfLiteEngine::InterpreterWrapper* interpreter_wrapper =
         GetTfLiteEngine()->interpreter_wrapper();
+    ScopedInference inference(this);
+    RETURN_IF_ERROR(inference.status());
+    TaskStatsRecorder* stats = inference.stats();
     // Note: AllocateTensors() is already performed by the interpreter wrapper
     // at InitInterpreter time (see TfLiteEngine).
-    RETURN_IF_ERROR(Preprocess(GetInputTensors(), args...));
+    RETURN_IF_ERROR(PreprocessWithStats(args...));
+    const absl::Time invoke_start =
+        stats != nullptr ? absl::Now() : absl::Time();
+    OpProfiler* profiler = GetTfLiteEngine()->op_profiler();
+    if (profiler != nullptr) {
+      profiler->BeginInvocation(GetTfLiteEngine()->interpreter());
+    }
     absl::Status status = interpreter_wrapper->InvokeWithoutFallback();
+    if (profiler != nullptr) {
+      profiler->EndInvocation();
+    }
+    if (stats != nullptr) {
+      stats->invoke().Record(absl::Now() - invoke_start);
+      stats->RecordInvocation(status, /*fell_back=*/false);
+    }
     if (!status.ok()) {
       return status.GetPayload(tflite::support::kTfLiteSupportPayload)
                      .has_value()
@@ -132,26 +271,123 @@ class BaseTaskApi : public BaseUntypedTaskApi {
                  : tflite::support::CreateStatusWithPayload(status.code(),
                                                             status.message());
     }
-    return Postprocess(GetOutputTensors(), args...);
+    return PostprocessWithStats(args...);
   }
 
   // Performs inference using tflite::support::TfLiteInterpreterWrapper
   // InvokeWithFallback() to benefit from automatic fallback from delegation to
   // CPU where applicable.
   tflite::support::StatusOr<OutputType> InferWithFallback(InputTypes... args) {
-    tflite::task::core::TfLiteEngine::InterpreterWrapper* interpreter_wrapper =
-        GetTfLiteEngine()->interpreter_wrapper();
+    ScopedInference inference(this);
+    RETURN_IF_ERROR(inference.status());
     // Note: AllocateTensors() is already performed by the interpreter wrapper
     // at InitInterpreter time (see TfLiteEngine).
-    RETURN_IF_ERROR(Preprocess(GetInputTensors(), args...));
+    RETURN_IF_ERROR(PreprocessWithStats(args...));
+    RETURN_IF_ERROR(InvokeWithFallback());
+    return PostprocessWithStats(args...);
+  }
+
+  // Same as `InferWithFallback`, except that the output is written to
+  // `result` through `PostprocessInto`, so that callers running many
+  // inferences can reuse the same output object. On error, the contents of
+  // `result` are unspecified: it may have been partially written, and must be
+  // overwritten by a later successful call before being read.
+  absl::Status InferWithFallbackInto(InputTypes... args, OutputType* result) {
+    ScopedInference inference(this);
+    RETURN_IF_ERROR(inference.status());
+    RETURN_IF_ERROR(PreprocessWithStats(args...));
+    RETURN_IF_ERROR(InvokeWithFallback());
+    return PostprocessIntoWithStats(args..., result);
+  }
+
+  // Calls `Preprocess` on the input tensors, recording its latency and the
+  // size of the input tensors if statistics are enabled.
+  absl::Status PreprocessWithStats(InputTypes... args) {
+    TaskStatsRecorder* stats = GetStatsRecorder();
+    if (stats == nullptr) {
+      return Preprocess(GetInputTensors(), args...);
+    }
+    const absl::Time start = absl::Now();
+    const std::vector<TfLiteTensor*> input_tensors = GetInputTensors();
+    absl::Status status = Preprocess(input_tensors, args...);
+    stats->preprocess().Record(absl::Now() - start);
+    if (status.ok()) {
+      int64_t bytes = 0;
+      for (const TfLiteTensor* input_tensor : input_tensors) {
+        bytes += input_tensor->bytes;
+      }
+      stats->RecordInputBytes(bytes);
+    }
+    return status;
+  }
+
+  // Calls `Postprocess` on the output tensors, recording its latency if
+  // statistics are enabled.
+  tflite::support::StatusOr<OutputType> PostprocessWithStats(
+      InputTypes... args) {
+    TaskStatsRecorder* stats = GetStatsRecorder();
+    if (stats == nullptr) {
+      return Postprocess(GetOutputTensors(), args...);
+    }
+    const absl::Time start = absl::Now();
+    tflite::support::StatusOr<OutputType> result =
+        Postprocess(GetOutputTensors(), args...);
+    stats->postprocess().Record(absl::Now() - start);
+    return result;
+  }
+
+  // Calls `PostprocessInto` on the output tensors, recording its latency if
+  // statistics are enabled.
+  absl::Status PostprocessIntoWithStats(InputTypes... args,
+                                        OutputType* result) {
+    TaskStatsRecorder* stats = GetStatsRecorder();
+    if (stats == nullptr) {
+      return PostprocessInto(GetOutputTensors(), args..., result);
+    }
+    const absl::Time start = absl::Now();
+    absl::Status status = PostprocessInto(GetOutputTensors(), args..., result);
+    stats->postprocess().Record(absl::Now() - start);
+    return status;
+  }
+
+  // Invokes the interpreter on input tensors that have already been populated,
+  // using tflite::support::TfLiteInterpreterWrapper InvokeWithFallback().
+  absl::Status InvokeWithFallback() {
+    tflite::task::core::TfLiteEngine::InterpreterWrapper* interpreter_wrapper =
+        GetTfLiteEngine()->interpreter_wrapper();
+    OpProfiler* profiler = GetTfLiteEngine()->op_profiler();
+    // Pinning again is cheap when called from InferWithFallback, and needed
+    // when subclasses call this method directly.
+    std::unique_ptr<ScopedCpuAffinity> affinity =
+        GetTfLiteEngine()->PinCurrentThread();
+    if (affinity != nullptr) {
+      RETURN_IF_ERROR(affinity->status());
+    }
+    // Only leases the shared CPU context, if any, when not called from an
+    // inference method which already holds a lease.
+    std::unique_ptr<TfLiteEngine::CpuContextLease> cpu_context =
+        GetTfLiteEngine()->AcquireCpuContext();
     auto set_inputs_nop =
-        [](tflite::task::core::TfLiteEngine::Interpreter* interpreter)
+        [profiler](tflite::task::core::TfLiteEngine::Interpreter* interpreter)
         -> absl::Status {
-      // NOP since inputs are populated at Preprocess() time.
+      // NOP since inputs are populated before invoking. The profiler, if any,
+      // is attached to the interpreter the wrapper is about to invoke.
+      if (profiler != nullptr) {
+        profiler->BeginInvocation(interpreter);
+      }
       return absl::OkStatus();
     };
+    TaskStatsRecorder* stats = GetStatsRecorder();
+    const absl::Time start = stats != nullptr ? absl::Now() : absl::Time();
     absl::Status status =
         interpreter_wrapper->InvokeWithFallback(set_inputs_nop);
+    if (profiler != nullptr) {
+      profiler->EndInvocation();
+    }
+    if (stats != nullptr) {
+      stats->invoke().Record(absl::Now() - start);
+      stats->RecordInvocation(status, interpreter_wrapper->HasDelegateError());
+    }
     if (!status.ok()) {
       return status.GetPayload(tflite::support::kTfLiteSupportPayload)
                      .has_value()
@@ -159,8 +395,13 @@ class BaseTaskApi : public BaseUntypedTaskApi {
                  : tflite::support::CreateStatusWithPayload(status.code(),
                                                             status.message());
     }
-    return Postprocess(GetOutputTensors(), args...);
+    return absl::OkStatus();
   }
+
+ private:
+  // The views returned by the last call to `InferRaw`, kept to avoid
+  // reallocating them.
+  std::vector<RawOutputTensor> raw_outputs_;
 };
 
 }  // namespace core
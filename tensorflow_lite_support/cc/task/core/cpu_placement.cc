@@ -0,0 +1,302 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/cpu_placement.h"
+
+#include <dirent.h>
+#include <errno.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>  // NOLINT(build/c++11)
+#include <tuple>
+#include <utility>
+
+#include "absl/strings/ascii.h"  // from @com_google_absl
+#include "absl/strings/match.h"  // from @com_google_absl
+#include "absl/strings/numbers.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "absl/strings/str_join.h"  // from @com_google_absl
+#include "absl/strings/str_split.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/task/core/model_verification_cache.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+
+namespace {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::StatusOr;
+using ::tflite::support::TfLiteSupportStatus;
+
+// Upper bound of the CPU indices, matching CPU_SETSIZE on Linux.
+constexpr int kMaxCpus = 1024;
+
+absl::Status CreateInvalidCpuListError(absl::string_view cpu_list) {
+  return CreateStatusWithPayload(
+      StatusCode::kInvalidArgument,
+      absl::StrFormat("Invalid CPU list: \"%s\"", cpu_list),
+      TfLiteSupportStatus::kInvalidArgumentError);
+}
+
+}  // namespace
+
+constexpr char CpuTopology::kSysfsNodeDirectory[];
+
+StatusOr<std::vector<int>> ParseCpuList(absl::string_view cpu_list) {
+  std::vector<int> cpus;
+  for (absl::string_view range :
+       absl::StrSplit(absl::StripAsciiWhitespace(cpu_list), ',',
+                      absl::SkipWhitespace())) {
+    std::vector<absl::string_view> bounds = absl::StrSplit(range, '-');
+    int first;
+    int last;
+    if (bounds.size() > 2 ||
+        !absl::SimpleAtoi(absl::StripAsciiWhitespace(bounds[0]), &first) ||
+        !absl::SimpleAtoi(absl::StripAsciiWhitespace(bounds.back()), &last) ||
+        first < 0 || last < first || last >= kMaxCpus) {
+      return CreateInvalidCpuListError(cpu_list);
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+}
+
+/* static */
+StatusOr<CpuTopology> CpuTopology::Read(const std::string& node_directory) {
+  DIR* directory = opendir(node_directory.c_str());
+  if (directory == nullptr) {
+    if (errno != ENOENT) {
+      return CreateStatusWithPayload(
+          StatusCode::kUnknown,
+          absl::StrFormat("Unable to read NUMA nodes from %s, errno=%d",
+                          node_directory, errno),
+          TfLiteSupportStatus::kFileReadError);
+    }
+    std::vector<int> cpus(
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+    for (size_t cpu = 0; cpu < cpus.size(); ++cpu) {
+      cpus[cpu] = cpu;
+    }
+    return CpuTopology({{0, std::move(cpus)}});
+  }
+  std::map<int, std::vector<int>> node_cpus;
+  absl::Status status;
+  while (struct dirent* entry = readdir(directory)) {
+    absl::string_view name(entry->d_name);
+    int node;
+    if (!absl::ConsumePrefix(&name, "node") || !absl::SimpleAtoi(name, &node)) {
+      continue;
+    }
+    const std::string cpu_list_path =
+        absl::StrFormat("%s/%s/cpulist", node_directory, entry->d_name);
+    std::ifstream cpu_list_file(cpu_list_path);
+    if (!cpu_list_file) {
+      status = CreateStatusWithPayload(
+          StatusCode::kUnknown,
+          absl::StrFormat("Unable to read %s", cpu_list_path),
+          TfLiteSupportStatus::kFileReadError);
+      break;
+    }
+    std::stringstream cpu_list;
+    cpu_list << cpu_list_file.rdbuf();
+    StatusOr<std::vector<int>> cpus = ParseCpuList(cpu_list.str());
+    if (!cpus.ok()) {
+      status = cpus.status();
+      break;
+    }
+    node_cpus[node] = std::move(cpus).value();
+  }
+  closedir(directory);
+  RETURN_IF_ERROR(status);
+  if (node_cpus.empty()) {
+    return CreateStatusWithPayload(
+        StatusCode::kNotFound,
+        absl::StrFormat("No NUMA node found in %s", node_directory),
+        TfLiteSupportStatus::kFileNotFoundError);
+  }
+  return CpuTopology(std::move(node_cpus));
+}
+
+const std::vector<int>* CpuTopology::CpusOfNode(int node) const {
+  auto it = node_cpus_.find(node);
+  return it == node_cpus_.end() ? nullptr : &it->second;
+}
+
+int CpuTopology::NodeOfCpus(const std::vector<int>& cpus) const {
+  int result = -1;
+  for (int cpu : cpus) {
+    int cpu_node = -1;
+    for (const auto& node : node_cpus_) {
+      if (std::binary_search(node.second.begin(), node.second.end(), cpu)) {
+        cpu_node = node.first;
+        break;
+      }
+    }
+    if (cpu_node < 0 || (result >= 0 && cpu_node != result)) {
+      return -1;
+    }
+    result = cpu_node;
+  }
+  return result;
+}
+
+/* static */
+StatusOr<CpuPlacement> CpuPlacement::Create(const std::vector<int>& cpus,
+                                            int numa_node,
+                                            bool replicate_model,
+                                            const CpuTopology& topology) {
+  std::vector<int> resolved_cpus;
+  if (!cpus.empty()) {
+    for (int cpu : cpus) {
+      if (cpu < 0 || cpu >= kMaxCpus) {
+        return CreateStatusWithPayload(
+            StatusCode::kInvalidArgument,
+            absl::StrFormat("Invalid CPU index: %d", cpu),
+            TfLiteSupportStatus::kInvalidArgumentError);
+      }
+    }
+    resolved_cpus = cpus;
+    std::sort(resolved_cpus.begin(), resolved_cpus.end());
+    resolved_cpus.erase(
+        std::unique(resolved_cpus.begin(), resolved_cpus.end()),
+        resolved_cpus.end());
+  } else if (numa_node >= 0) {
+    const std::vector<int>* node_cpus = topology.CpusOfNode(numa_node);
+    if (node_cpus == nullptr || node_cpus->empty()) {
+      return CreateStatusWithPayload(
+          StatusCode::kInvalidArgument,
+          absl::StrFormat("NUMA node %d doesn't exist or has no CPU core.",
+                          numa_node),
+          TfLiteSupportStatus::kInvalidArgumentError);
+    }
+    resolved_cpus = *node_cpus;
+  } else {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "Expected either a list of CPU cores or a NUMA node.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+
+  const int resolved_node = topology.NodeOfCpus(resolved_cpus);
+  if (replicate_model && resolved_node < 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "The model can only be replicated for CPU cores of a single NUMA "
+        "node.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  return CpuPlacement(std::move(resolved_cpus), resolved_node,
+                      replicate_model);
+}
+
+ScopedCpuAffinity::ScopedCpuAffinity(const std::vector<int>& cpus) {
+#ifdef __linux__
+  cpu_set_t previous_mask;
+  CPU_ZERO(&previous_mask);
+  if (sched_getaffinity(/*pid=*/0, sizeof(previous_mask), &previous_mask) !=
+      0) {
+    status_ = CreateStatusWithPayload(
+        StatusCode::kInternal,
+        absl::StrFormat("Unable to get the CPU affinity, errno=%d", errno));
+    return;
+  }
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &mask);
+    }
+  }
+  if (sched_setaffinity(/*pid=*/0, sizeof(mask), &mask) != 0) {
+    // EINVAL means that none of the CPU cores is available to the process.
+    const int affinity_errno = errno;
+    status_ = CreateStatusWithPayload(
+        affinity_errno == EINVAL ? StatusCode::kInvalidArgument
+                                 : StatusCode::kInternal,
+        absl::StrFormat("Unable to restrict the thread to the CPU cores "
+                        "%s, errno=%d",
+                        absl::StrJoin(cpus, ","), affinity_errno),
+        TfLiteSupportStatus::kInvalidArgumentError);
+    return;
+  }
+  const char* previous_mask_data =
+      reinterpret_cast<const char*>(&previous_mask);
+  previous_mask_.assign(previous_mask_data,
+                        previous_mask_data + sizeof(previous_mask));
+#else
+  status_ = CreateStatusWithPayload(
+      StatusCode::kUnimplemented,
+      "CPU affinity is only supported on Linux.",
+      TfLiteSupportStatus::kInvalidArgumentError);
+#endif
+}
+
+ScopedCpuAffinity::~ScopedCpuAffinity() {
+#ifdef __linux__
+  if (!previous_mask_.empty()) {
+    sched_setaffinity(
+        /*pid=*/0, previous_mask_.size(),
+        reinterpret_cast<const cpu_set_t*>(previous_mask_.data()));
+  }
+#endif
+}
+
+std::shared_ptr<const std::string> GetModelReplica(absl::string_view model,
+                                                   int numa_node) {
+  static absl::Mutex* mutex = new absl::Mutex();
+  // Keyed by the hash and size of the model and the node. Never destroyed, as
+  // tasks may be destroyed at exit time.
+  static auto* replicas =
+      new std::map<std::tuple<uint64_t, size_t, int>,
+                   std::weak_ptr<const std::string>>();
+  const std::tuple<uint64_t, size_t, int> key(
+      ModelVerificationCache::XxHash64(model), model.size(), numa_node);
+  absl::MutexLock lock(mutex);
+  std::shared_ptr<const std::string> replica = (*replicas)[key].lock();
+  if (replica != nullptr && *replica != model) {
+    // A different model with the same hash: the caller gets its own copy,
+    // and the replica already recorded stays shared.
+    return std::make_shared<const std::string>(model);
+  }
+  if (replica == nullptr) {
+    // The copy is written, hence allocated, by the calling thread.
+    replica = std::make_shared<const std::string>(model);
+    (*replicas)[key] = replica;
+  }
+  // Forget the replicas no longer used by any engine.
+  for (auto it = replicas->begin(); it != replicas->end();) {
+    it = it->second.expired() ? replicas->erase(it) : std::next(it);
+  }
+  return replica;
+}
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,134 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_CPU_PLACEMENT_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_CPU_PLACEMENT_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/statusor.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+
+// Parses a Linux CPU list such as "0-3,8,10-11" (see cpuset(7)) into the
+// sorted list of CPU indices.
+tflite::support::StatusOr<std::vector<int>> ParseCpuList(
+    absl::string_view cpu_list);
+
+// The NUMA nodes of the machine and their CPU cores.
+class CpuTopology {
+ public:
+  // Directory where Linux describes the NUMA nodes.
+  static constexpr char kSysfsNodeDirectory[] = "/sys/devices/system/node";
+
+  // Creates a topology from the CPU cores of each node, indexed by node id.
+  explicit CpuTopology(std::map<int, std::vector<int>> node_cpus)
+      : node_cpus_(std::move(node_cpus)) {}
+
+  // Reads the topology from the `node<N>/cpulist` files of `node_directory`,
+  // which can be pointed to a fake sysfs tree for tests. If the directory
+  // doesn't exist (e.g. on non-NUMA kernels), returns a single node 0 with
+  // all the CPU cores.
+  static tflite::support::StatusOr<CpuTopology> Read(
+      const std::string& node_directory = kSysfsNodeDirectory);
+
+  const std::map<int, std::vector<int>>& node_cpus() const {
+    return node_cpus_;
+  }
+
+  // Returns the CPU cores of `node`, or nullptr if there is no such node.
+  const std::vector<int>* CpusOfNode(int node) const;
+
+  // Returns the node all of `cpus` belong to, or -1 if they span several
+  // nodes or if any of them is unknown.
+  int NodeOfCpus(const std::vector<int>& cpus) const;
+
+ private:
+  std::map<int, std::vector<int>> node_cpus_;
+};
+
+// Where the threads and the memory of an interpreter are placed, resolved
+// against the topology of the machine.
+class CpuPlacement {
+ public:
+  // Resolves the placement on the explicit list of `cpus` if not empty, or on
+  // the CPU cores of `numa_node` otherwise. `replicate_model` requests a copy
+  // of the model local to the NUMA node, which requires the CPU cores to
+  // belong to a single node.
+  static tflite::support::StatusOr<CpuPlacement> Create(
+      const std::vector<int>& cpus, int numa_node, bool replicate_model,
+      const CpuTopology& topology);
+
+  // The CPU cores the interpreter threads run on.
+  const std::vector<int>& cpus() const { return cpus_; }
+  // The NUMA node of `cpus()`, or -1 if they span several nodes.
+  int numa_node() const { return numa_node_; }
+  bool replicate_model() const { return replicate_model_; }
+
+ private:
+  CpuPlacement(std::vector<int> cpus, int numa_node, bool replicate_model)
+      : cpus_(std::move(cpus)),
+        numa_node_(numa_node),
+        replicate_model_(replicate_model) {}
+
+  std::vector<int> cpus_;
+  int numa_node_;
+  bool replicate_model_;
+};
+
+// Restricts the calling thread to a set of CPU cores for the lifetime of this
+// object, then restores its previous affinity. Threads created in the
+// meantime (e.g. the worker threads of an interpreter) inherit the
+// restriction for their whole lifetime, and memory first written to in the
+// meantime is allocated on the NUMA node of the cores by the default Linux
+// policy. Only supported on Linux: `status()` is an UnimplementedError on
+// other platforms.
+class ScopedCpuAffinity {
+ public:
+  explicit ScopedCpuAffinity(const std::vector<int>& cpus);
+  ~ScopedCpuAffinity();
+
+  ScopedCpuAffinity(const ScopedCpuAffinity&) = delete;
+  ScopedCpuAffinity& operator=(const ScopedCpuAffinity&) = delete;
+
+  // Whether the restriction could be applied.
+  const absl::Status& status() const { return status_; }
+
+ private:
+  absl::Status status_;
+  // The previous affinity mask, as a cpu_set_t.
+  std::vector<char> previous_mask_;
+};
+
+// Returns a copy of `model` local to `numa_node`, shared with all the callers
+// asking for the same model on the same node as long as one of them holds
+// it. Must be called from a thread restricted to the CPU cores of the node
+// (see ScopedCpuAffinity), so that the copy is allocated there.
+std::shared_ptr<const std::string> GetModelReplica(absl::string_view model,
+                                                   int numa_node);
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_CPU_PLACEMENT_H_
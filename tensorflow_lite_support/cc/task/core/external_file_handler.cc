@@ -159,14 +159,66 @@ absl::Status ExternalFileHandler::MapExternalFile() {
   buffer_aligned_offset_ = GetPageSizeAlignedOffset(buffer_offset_);
   buffer_aligned_size_ = buffer_size_ + buffer_offset_ - buffer_aligned_offset_;
   // Map into memory.
-  buffer_ = mmap(/*addr=*/nullptr, buffer_aligned_size_, PROT_READ, MAP_SHARED,
-                 fd, buffer_aligned_offset_);
+  const MemoryMappingOptions& mapping_options =
+      external_file_.memory_mapping_options();
+  MemoryMappingOptions::PrefetchMode prefetch_mode =
+      mapping_options.prefetch_mode();
+  int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+  if (prefetch_mode == MemoryMappingOptions::POPULATE) {
+    flags |= MAP_POPULATE;
+  }
+#else
+  if (prefetch_mode == MemoryMappingOptions::POPULATE) {
+    prefetch_mode = MemoryMappingOptions::ADVISE_WILLNEED;
+  }
+#endif
+  buffer_ = mmap(/*addr=*/nullptr, buffer_aligned_size_, PROT_READ, flags, fd,
+                 buffer_aligned_offset_);
   if (buffer_ == MAP_FAILED) {
     return CreateStatusWithPayload(
         StatusCode::kUnknown,
         absl::StrFormat("Unable to map file to memory buffer, errno=%d", errno),
         TfLiteSupportStatus::kFileMmapError);
   }
+  return ApplyMemoryMappingOptions(mapping_options, prefetch_mode);
+}
+
+absl::Status ExternalFileHandler::ApplyMemoryMappingOptions(
+    const MemoryMappingOptions& mapping_options,
+    MemoryMappingOptions::PrefetchMode prefetch_mode) {
+  // madvise(2) hints are best effort: failures are ignored, as the mapping is
+  // usable anyway.
+#ifdef MADV_HUGEPAGE
+  if (mapping_options.transparent_huge_pages()) {
+    madvise(buffer_, buffer_aligned_size_, MADV_HUGEPAGE);
+  }
+#endif
+  if (prefetch_mode == MemoryMappingOptions::ADVISE_WILLNEED) {
+    madvise(buffer_, buffer_aligned_size_, MADV_WILLNEED);
+  }
+  // The pages are implicitly unlocked by munmap(2) in the destructor.
+  if (mapping_options.lock_in_memory() &&
+      mlock(buffer_, buffer_aligned_size_) != 0) {
+    const int mlock_errno = errno;
+    const std::string error_message = absl::StrFormat(
+        "Unable to lock %d bytes of mapped file in memory, errno=%d",
+        buffer_aligned_size_, mlock_errno);
+    switch (mlock_errno) {
+      case EAGAIN:
+      case ENOMEM:
+        return CreateStatusWithPayload(StatusCode::kResourceExhausted,
+                                       error_message,
+                                       TfLiteSupportStatus::kFileMmapError);
+      case EPERM:
+        return CreateStatusWithPayload(StatusCode::kPermissionDenied,
+                                       error_message,
+                                       TfLiteSupportStatus::kFileMmapError);
+      default:
+        return CreateStatusWithPayload(StatusCode::kUnknown, error_message,
+                                       TfLiteSupportStatus::kFileMmapError);
+    }
+  }
   return absl::OkStatus();
 }
 
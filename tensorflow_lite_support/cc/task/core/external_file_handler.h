@@ -62,6 +62,13 @@ class ExternalFileHandler {
   // contents are already loaded in memory.
   absl::Status MapExternalFile();
 
+  // Applies the prefetch, huge page and locking settings of the ExternalFile
+  // to the mapped memory buffer. `prefetch_mode` may differ from the one of
+  // `mapping_options` on platforms without MAP_POPULATE.
+  absl::Status ApplyMemoryMappingOptions(
+      const MemoryMappingOptions& mapping_options,
+      MemoryMappingOptions::PrefetchMode prefetch_mode);
+
   // Reference to the input ExternalFile.
   const ExternalFile& external_file_;
 
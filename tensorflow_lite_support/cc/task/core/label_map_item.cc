@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow_lite_support/cc/task/core/label_map_item.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "absl/strings/str_format.h"  // from @com_google_absl
 #include "absl/strings/str_split.h"  // from @com_google_absl
 #include "tensorflow_lite_support/cc/common.h"
@@ -75,51 +78,153 @@ StatusOr<std::vector<LabelMapItem>> BuildLabelMapFromFiles(
 
 absl::Status LabelHierarchy::InitializeFromLabelMap(
     std::vector<LabelMapItem> label_map_items) {
-  parents_map_.clear();
+  ids_.clear();
+  names_.clear();
+  auto get_or_add_id = [this](const std::string& name) {
+    auto it = ids_.try_emplace(name, names_.size());
+    if (it.second) names_.push_back(name);
+    return it.first->second;
+  };
+  for (const LabelMapItem& label : label_map_items) {
+    get_or_add_id(label.name);
+  }
+  // Direct (child, parent) relations, deduplicated.
+  std::vector<std::pair<int, int>> relations;
   for (const LabelMapItem& label : label_map_items) {
+    const int parent_id = ids_.at(label.name);
     for (const std::string& child_name : label.child_name) {
-      parents_map_[child_name].insert(label.name);
+      relations.emplace_back(get_or_add_id(child_name), parent_id);
     }
   }
-  if (parents_map_.empty()) {
+  if (relations.empty()) {
+    names_.clear();
+    ids_.clear();
     return CreateStatusWithPayload(StatusCode::kInvalidArgument,
                                    "Input labelmap is not hierarchical: there "
                                    "is no parent-child relationship.",
                                    TfLiteSupportStatus::kInvalidArgumentError);
   }
+  std::sort(relations.begin(), relations.end());
+  relations.erase(std::unique(relations.begin(), relations.end()),
+                  relations.end());
+
+  const int num_labels = names_.size();
+  parent_offsets_.assign(num_labels + 1, 0);
+  parent_ids_.clear();
+  parent_ids_.reserve(relations.size());
+  for (const auto& relation : relations) {
+    ++parent_offsets_[relation.first + 1];
+    parent_ids_.push_back(relation.second);
+  }
+  is_forest_ = true;
+  for (int i = 0; i < num_labels; ++i) {
+    is_forest_ &= parent_offsets_[i + 1] <= 1;
+    parent_offsets_[i + 1] += parent_offsets_[i];
+  }
+
+  enter_.clear();
+  exit_.clear();
+  ancestor_bits_.clear();
+  if (is_forest_) {
+    // Iterative depth-first traversal from the roots. Labels not reached are
+    // part of a cycle, in which case the hierarchy is not a forest.
+    std::vector<std::vector<int>> children(num_labels);
+    for (const auto& relation : relations) {
+      children[relation.second].push_back(relation.first);
+    }
+    enter_.assign(num_labels, -1);
+    exit_.assign(num_labels, -1);
+    int order = 0;
+    std::vector<std::pair<int, int>> stack;
+    for (int root = 0; root < num_labels; ++root) {
+      if (parent_offsets_[root + 1] != parent_offsets_[root]) continue;
+      enter_[root] = order++;
+      stack.emplace_back(root, 0);
+      while (!stack.empty()) {
+        auto& top = stack.back();
+        if (top.second < children[top.first].size()) {
+          const int child = children[top.first][top.second++];
+          enter_[child] = order++;
+          stack.emplace_back(child, 0);
+        } else {
+          exit_[top.first] = order;
+          stack.pop_back();
+        }
+      }
+    }
+    is_forest_ = order == num_labels;
+  }
+  if (!is_forest_) {
+    enter_.clear();
+    exit_.clear();
+    // Breadth-first traversal of the ancestors of each label.
+    const int num_words = NumWordsPerRow();
+    ancestor_bits_.assign(static_cast<size_t>(num_labels) * num_words, 0);
+    std::vector<int> queue;
+    for (int label = 0; label < num_labels; ++label) {
+      uint64_t* row = ancestor_bits_.data() + label * num_words;
+      queue.assign(parent_ids_.begin() + parent_offsets_[label],
+                   parent_ids_.begin() + parent_offsets_[label + 1]);
+      while (!queue.empty()) {
+        const int ancestor = queue.back();
+        queue.pop_back();
+        const uint64_t mask = uint64_t{1} << (ancestor % 64);
+        if (row[ancestor / 64] & mask) continue;
+        row[ancestor / 64] |= mask;
+        queue.insert(queue.end(),
+                     parent_ids_.begin() + parent_offsets_[ancestor],
+                     parent_ids_.begin() + parent_offsets_[ancestor + 1]);
+      }
+    }
+  }
   return absl::OkStatus();
 }
 
 bool LabelHierarchy::HaveAncestorDescendantRelationship(
-    const std::string& ancestor_name,
-    const std::string& descendant_name) const {
-  absl::flat_hash_set<std::string> ancestors;
-  GetAncestors(descendant_name, &ancestors);
-  return ancestors.contains(ancestor_name);
+    absl::string_view ancestor_name, absl::string_view descendant_name) const {
+  return IsAncestor(GetLabelId(ancestor_name), GetLabelId(descendant_name));
 }
 
-absl::flat_hash_set<std::string> LabelHierarchy::GetParents(
-    const std::string& name) const {
-  absl::flat_hash_set<std::string> parents;
-  auto it = parents_map_.find(name);
-  if (it != parents_map_.end()) {
-    for (const std::string& parent_name : it->second) {
-      parents.insert(parent_name);
-    }
+int LabelHierarchy::GetLabelId(absl::string_view name) const {
+  auto it = ids_.find(name);
+  return it == ids_.end() ? -1 : it->second;
+}
+
+absl::Span<const int> LabelHierarchy::GetParentIds(int label_id) const {
+  if (label_id < 0 || label_id >= names_.size()) return {};
+  return absl::Span<const int>(
+      parent_ids_.data() + parent_offsets_[label_id],
+      parent_offsets_[label_id + 1] - parent_offsets_[label_id]);
+}
+
+bool LabelHierarchy::IsAncestor(int ancestor_id, int descendant_id) const {
+  const int num_labels = names_.size();
+  if (ancestor_id < 0 || ancestor_id >= num_labels || descendant_id < 0 ||
+      descendant_id >= num_labels) {
+    return false;
+  }
+  if (is_forest_) {
+    return enter_[ancestor_id] < enter_[descendant_id] &&
+           exit_[descendant_id] <= exit_[ancestor_id];
   }
-  return parents;
+  const uint64_t word =
+      ancestor_bits_[static_cast<size_t>(descendant_id) * NumWordsPerRow() +
+                     ancestor_id / 64];
+  return (word >> (ancestor_id % 64)) & 1;
 }
 
-void LabelHierarchy::GetAncestors(
-    const std::string& name,
-    absl::flat_hash_set<std::string>* ancestors) const {
-  const absl::flat_hash_set<std::string> parents = GetParents(name);
-  for (const std::string& parent_name : parents) {
-    auto it = ancestors->insert(parent_name);
-    if (it.second) {
-      GetAncestors(parent_name, ancestors);
+int LabelHierarchy::CollapseToAncestor(
+    int label_id, absl::Span<const int> candidate_ids) const {
+  int best = -1;
+  for (int candidate : candidate_ids) {
+    if (candidate == label_id) return label_id;
+    // A candidate is closer than `best` if it descends from it.
+    if (IsAncestor(candidate, label_id) &&
+        (best < 0 || IsAncestor(best, candidate))) {
+      best = candidate;
     }
   }
+  return best;
 }
 
 }  // namespace core
@@ -0,0 +1,297 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/model_verification_cache.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/strings/escaping.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "tensorflow/lite/version.h"
+#include "tensorflow_lite_support/cc/common.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+namespace {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::StatusOr;
+using ::tflite::support::TfLiteSupportStatus;
+
+// Bump when the meaning of an entry changes.
+constexpr int kCacheFormatVersion = 2;
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t RotateLeft(uint64_t value, int bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+// xxHash is defined on little-endian words.
+inline uint64_t Load64(const char* p) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(p);
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; --i) {
+    value = (value << 8) | bytes[i];
+  }
+  return value;
+}
+
+inline uint32_t Load32(const char* p) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(p);
+  return static_cast<uint32_t>(bytes[0]) |
+         (static_cast<uint32_t>(bytes[1]) << 8) |
+         (static_cast<uint32_t>(bytes[2]) << 16) |
+         (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+inline uint64_t Round(uint64_t accumulator, uint64_t input) {
+  accumulator += input * kPrime2;
+  return RotateLeft(accumulator, 31) * kPrime1;
+}
+
+inline uint64_t MergeRound(uint64_t accumulator, uint64_t value) {
+  accumulator ^= Round(0, value);
+  return accumulator * kPrime1 + kPrime4;
+}
+
+// SHA-256 round constants, from FIPS 180-4.
+constexpr uint32_t kSha256RoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+inline uint32_t RotateRight32(uint32_t value, int bits) {
+  return (value >> bits) | (value << (32 - bits));
+}
+
+// SHA-256 is defined on big-endian words.
+inline uint32_t LoadBigEndian32(const unsigned char* bytes) {
+  return (static_cast<uint32_t>(bytes[0]) << 24) |
+         (static_cast<uint32_t>(bytes[1]) << 16) |
+         (static_cast<uint32_t>(bytes[2]) << 8) |
+         static_cast<uint32_t>(bytes[3]);
+}
+
+// Updates the SHA-256 `state` with a 64-byte block.
+void Sha256Block(const unsigned char* block, uint32_t state[8]) {
+  uint32_t w[64];
+  for (int i = 0; i < 16; ++i) {
+    w[i] = LoadBigEndian32(block + 4 * i);
+  }
+  for (int i = 16; i < 64; ++i) {
+    const uint32_t s0 = RotateRight32(w[i - 15], 7) ^
+                        RotateRight32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    const uint32_t s1 = RotateRight32(w[i - 2], 17) ^
+                        RotateRight32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+  uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+  for (int i = 0; i < 64; ++i) {
+    const uint32_t s1 =
+        RotateRight32(e, 6) ^ RotateRight32(e, 11) ^ RotateRight32(e, 25);
+    const uint32_t choice = (e & f) ^ (~e & g);
+    const uint32_t t1 = h + s1 + choice + kSha256RoundConstants[i] + w[i];
+    const uint32_t s0 =
+        RotateRight32(a, 2) ^ RotateRight32(a, 13) ^ RotateRight32(a, 22);
+    const uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+    const uint32_t t2 = s0 + majority;
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+}  // namespace
+
+/* static */
+StatusOr<std::unique_ptr<ModelVerificationCache>>
+ModelVerificationCache::Create(const std::string& cache_dir) {
+  struct stat info;
+  if (cache_dir.empty() || stat(cache_dir.c_str(), &info) != 0 ||
+      !S_ISDIR(info.st_mode)) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Verification cache directory not found: %s",
+                        cache_dir),
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  return absl::WrapUnique(new ModelVerificationCache(cache_dir));
+}
+
+/* static */
+uint64_t ModelVerificationCache::XxHash64(absl::string_view data,
+                                          uint64_t seed) {
+  const char* p = data.data();
+  const char* const end = p + data.size();
+  uint64_t hash;
+  if (data.size() >= 32) {
+    uint64_t v1 = seed + kPrime1 + kPrime2;
+    uint64_t v2 = seed + kPrime2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - kPrime1;
+    for (; end - p >= 32; p += 32) {
+      v1 = Round(v1, Load64(p));
+      v2 = Round(v2, Load64(p + 8));
+      v3 = Round(v3, Load64(p + 16));
+      v4 = Round(v4, Load64(p + 24));
+    }
+    hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) +
+           RotateLeft(v4, 18);
+    hash = MergeRound(hash, v1);
+    hash = MergeRound(hash, v2);
+    hash = MergeRound(hash, v3);
+    hash = MergeRound(hash, v4);
+  } else {
+    hash = seed + kPrime5;
+  }
+  hash += data.size();
+
+  for (; end - p >= 8; p += 8) {
+    hash ^= Round(0, Load64(p));
+    hash = RotateLeft(hash, 27) * kPrime1 + kPrime4;
+  }
+  if (end - p >= 4) {
+    hash ^= Load32(p) * kPrime1;
+    hash = RotateLeft(hash, 23) * kPrime2 + kPrime3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    hash ^= static_cast<unsigned char>(*p) * kPrime5;
+    hash = RotateLeft(hash, 11) * kPrime1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= kPrime2;
+  hash ^= hash >> 29;
+  hash *= kPrime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+/* static */
+std::string ModelVerificationCache::Sha256(absl::string_view data) {
+  uint32_t state[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                       0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(data.data());
+  size_t remaining = data.size();
+  for (; remaining >= 64; p += 64, remaining -= 64) {
+    Sha256Block(p, state);
+  }
+  // Pads the last bytes with a 1 bit, zeros and the message length in bits,
+  // over one or two blocks.
+  unsigned char tail[128] = {};
+  std::memcpy(tail, p, remaining);
+  tail[remaining] = 0x80;
+  const size_t tail_size = remaining < 56 ? 64 : 128;
+  const uint64_t bit_count = static_cast<uint64_t>(data.size()) * 8;
+  for (int i = 0; i < 8; ++i) {
+    tail[tail_size - 1 - i] = static_cast<unsigned char>(bit_count >> (8 * i));
+  }
+  for (size_t offset = 0; offset < tail_size; offset += 64) {
+    Sha256Block(tail + offset, state);
+  }
+
+  std::string digest(32, '\0');
+  for (int i = 0; i < 8; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      digest[4 * i + j] = static_cast<char>(state[i] >> (24 - 8 * j));
+    }
+  }
+  return digest;
+}
+
+/* static */
+std::string ModelVerificationCache::ComputeKey(absl::string_view model_buffer) {
+  return absl::StrCat(absl::BytesToHexString(Sha256(model_buffer)), "-",
+                      absl::Hex(model_buffer.size()));
+}
+
+std::string ModelVerificationCache::EntryPath(absl::string_view key) const {
+  return absl::StrCat(cache_dir_, "/", key, ".tflite-", TFLITE_VERSION_STRING,
+                      ".v", kCacheFormatVersion, ".verified");
+}
+
+bool ModelVerificationCache::Contains(absl::string_view key) const {
+  struct stat info;
+  return stat(EntryPath(key).c_str(), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+absl::Status ModelVerificationCache::Insert(absl::string_view key) {
+  const std::string path = EntryPath(key);
+  // Create the entry under a unique name and rename it, so that the entry
+  // appears atomically even if several processes insert it at once.
+  const std::string temporary_path = absl::StrCat(path, ".tmp", getpid());
+  {
+    std::ofstream entry(temporary_path, std::ios::out | std::ios::trunc);
+    if (!entry) {
+      return CreateStatusWithPayload(
+          StatusCode::kUnavailable,
+          absl::StrFormat("Unable to create verification cache entry %s: %s",
+                          temporary_path, std::strerror(errno)),
+          TfLiteSupportStatus::kError);
+    }
+  }
+  if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+    const int rename_errno = errno;
+    std::remove(temporary_path.c_str());
+    return CreateStatusWithPayload(
+        StatusCode::kUnavailable,
+        absl::StrFormat("Unable to create verification cache entry %s: %s",
+                        path, std::strerror(rename_errno)),
+        TfLiteSupportStatus::kError);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
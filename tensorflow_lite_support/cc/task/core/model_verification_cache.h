@@ -0,0 +1,85 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_MODEL_VERIFICATION_CACHE_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_MODEL_VERIFICATION_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/statusor.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+
+// Persistent record of the model FlatBuffers that passed verification, so
+// that a restarted process can skip verifying an unchanged model again.
+//
+// Models are identified by the SHA-256 of their contents and their size, so
+// that a different model cannot be crafted to match the key of a verified one.
+// Each verified model is recorded as an empty file in the cache directory,
+// whose name also encodes the TF Lite version, since the verifier may change
+// between versions.
+//
+// Computing the key hashes the whole model, so the cache pays off for models
+// whose verification is more expensive than a SHA-256 pass, e.g. large graphs
+// with many tensors and operators.
+//
+// Warning: anyone able to write to the cache directory can make unverified
+// models be loaded. Only use a directory private to the current user.
+class ModelVerificationCache {
+ public:
+  // Creates a cache storing its entries in `cache_dir`, which must be an
+  // existing directory.
+  static tflite::support::StatusOr<std::unique_ptr<ModelVerificationCache>>
+  Create(const std::string& cache_dir);
+
+  // Returns the cache key of the provided model FlatBuffer.
+  static std::string ComputeKey(absl::string_view model_buffer);
+
+  // Returns the 32-byte SHA-256 digest of `data`.
+  static std::string Sha256(absl::string_view data);
+
+  // Returns the xxHash64 of `data` with the provided seed. This is not a
+  // cryptographic hash, and is only suitable for in-memory lookups that
+  // compare the contents on a match.
+  static uint64_t XxHash64(absl::string_view data, uint64_t seed = 0);
+
+  // Returns whether the model with this key has been recorded as verified.
+  bool Contains(absl::string_view key) const;
+
+  // Records the model with this key as verified. Concurrent insertions of the
+  // same key, e.g. from several processes, are safe.
+  absl::Status Insert(absl::string_view key);
+
+ private:
+  explicit ModelVerificationCache(const std::string& cache_dir)
+      : cache_dir_(cache_dir) {}
+
+  // Returns the path of the file recording the model with this key.
+  std::string EntryPath(absl::string_view key) const;
+
+  const std::string cache_dir_;
+};
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_MODEL_VERIFICATION_CACHE_H_
@@ -0,0 +1,216 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/op_profiler.h"
+
+#include <algorithm>
+
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "absl/strings/str_join.h"  // from @com_google_absl
+
+namespace tflite {
+namespace task {
+namespace core {
+
+namespace {
+
+using ::tflite::profiling::ProfileEvent;
+using EventType = ::tflite::Profiler::EventType;
+
+bool IsOperatorEvent(const ProfileEvent& event) {
+  return event.event_type == EventType::OPERATOR_INVOKE_EVENT ||
+         event.event_type == EventType::DELEGATE_OPERATOR_INVOKE_EVENT;
+}
+
+std::vector<OpStats> SortByTotal(std::vector<OpStats> stats) {
+  std::sort(stats.begin(), stats.end(), [](const OpStats& a, const OpStats& b) {
+    return a.total > b.total;
+  });
+  return stats;
+}
+
+// Escapes `value` for use in a JSON string.
+std::string JsonEscape(const std::string& value) {
+  std::string escaped;
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      escaped.push_back('\\');
+      escaped.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      absl::StrAppendFormat(&escaped, "\\u%04x", c);
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+
+}  // namespace
+
+OpProfiler::OpProfiler(const Options& options)
+    : options_(options),
+      profiler_(std::max(1, options.max_events_per_invocation)) {}
+
+void OpProfiler::BeginInvocation(tflite_shims::Interpreter* interpreter) {
+  // Setting the profiler is cheap, and the interpreter may have been rebuilt
+  // since the last invocation.
+  interpreter->SetProfiler(&profiler_);
+  profiler_.Reset();
+  profiler_.StartProfiling();
+}
+
+void OpProfiler::EndInvocation() {
+  profiler_.StopProfiling();
+  std::vector<const ProfileEvent*> events = profiler_.GetProfileEvents();
+  std::vector<TraceEvent> trace_events;
+  trace_events.reserve(events.size());
+  for (const ProfileEvent* event : events) {
+    if (!IsOperatorEvent(*event) ||
+        event->end_timestamp_us < event->begin_timestamp_us) {
+      continue;
+    }
+    trace_events.push_back(
+        {event->tag, static_cast<int>(event->extra_event_metadata),
+         static_cast<int>(event->event_metadata), event->begin_timestamp_us,
+         event->end_timestamp_us - event->begin_timestamp_us});
+  }
+
+  absl::MutexLock lock(&mutex_);
+  ++invocations_;
+  for (const TraceEvent& event : trace_events) {
+    const absl::Duration duration =
+        absl::Microseconds(static_cast<int64_t>(event.duration_us));
+    OpStats& type_stats = op_type_stats_[event.op_type];
+    if (type_stats.count == 0) type_stats.op_type = event.op_type;
+    Accumulate(duration, &type_stats);
+    OpStats& node_stats =
+        node_stats_[std::make_pair(event.subgraph_index, event.node_index)];
+    if (node_stats.count == 0) {
+      node_stats.op_type = event.op_type;
+      node_stats.subgraph_index = event.subgraph_index;
+      node_stats.node_index = event.node_index;
+    }
+    Accumulate(duration, &node_stats);
+  }
+  if (options_.max_trace_invocations > 0) {
+    if (trace_.size() == options_.max_trace_invocations) {
+      trace_.pop_front();
+    }
+    trace_.push_back(std::move(trace_events));
+  }
+}
+
+/* static */
+void OpProfiler::Accumulate(absl::Duration duration, OpStats* stats) {
+  ++stats->count;
+  stats->total += duration;
+  stats->min = std::min(stats->min, duration);
+  stats->max = std::max(stats->max, duration);
+}
+
+int64_t OpProfiler::GetInvocationCount() const {
+  absl::MutexLock lock(&mutex_);
+  return invocations_;
+}
+
+std::vector<OpStats> OpProfiler::GetOpTypeStats() const {
+  std::vector<OpStats> stats;
+  absl::MutexLock lock(&mutex_);
+  stats.reserve(op_type_stats_.size());
+  for (const auto& entry : op_type_stats_) {
+    stats.push_back(entry.second);
+  }
+  return SortByTotal(std::move(stats));
+}
+
+std::vector<OpStats> OpProfiler::GetNodeStats() const {
+  std::vector<OpStats> stats;
+  absl::MutexLock lock(&mutex_);
+  stats.reserve(node_stats_.size());
+  for (const auto& entry : node_stats_) {
+    stats.push_back(entry.second);
+  }
+  return SortByTotal(std::move(stats));
+}
+
+std::string OpProfiler::GetSummary(int max_nodes) const {
+  const int64_t invocations = GetInvocationCount();
+  const std::vector<OpStats> op_types = GetOpTypeStats();
+  const std::vector<OpStats> nodes = GetNodeStats();
+  absl::Duration total = absl::ZeroDuration();
+  for (const OpStats& stats : op_types) {
+    total += stats.total;
+  }
+  const double total_us = std::max(absl::ToDoubleMicroseconds(total), 1e-9);
+
+  std::string summary = absl::StrFormat(
+      "Operator profile over %d invocation(s), %.3f ms per invocation.\n\n",
+      invocations,
+      invocations > 0 ? absl::ToDoubleMilliseconds(total) / invocations : 0.0);
+  absl::StrAppendFormat(&summary, "%-32s %10s %12s %12s %8s\n", "[op type]",
+                        "[count]", "[avg us]", "[total ms]", "[%]");
+  for (const OpStats& stats : op_types) {
+    absl::StrAppendFormat(&summary, "%-32s %10d %12.1f %12.3f %7.2f%%\n",
+                          stats.op_type, stats.count,
+                          absl::ToDoubleMicroseconds(stats.Mean()),
+                          absl::ToDoubleMilliseconds(stats.total),
+                          100.0 * absl::ToDoubleMicroseconds(stats.total) /
+                              total_us);
+  }
+  absl::StrAppendFormat(&summary, "\n%-32s %10s %12s %12s %8s\n",
+                        "[node (subgraph:index)]", "[count]", "[avg us]",
+                        "[max us]", "[%]");
+  for (int i = 0; i < nodes.size() && i < max_nodes; ++i) {
+    const OpStats& stats = nodes[i];
+    absl::StrAppendFormat(
+        &summary, "%-32s %10d %12.1f %12.1f %7.2f%%\n",
+        absl::StrFormat("%s (%d:%d)", stats.op_type, stats.subgraph_index,
+                        stats.node_index),
+        stats.count, absl::ToDoubleMicroseconds(stats.Mean()),
+        absl::ToDoubleMicroseconds(stats.max),
+        100.0 * absl::ToDoubleMicroseconds(stats.total) / total_us);
+  }
+  return summary;
+}
+
+std::string OpProfiler::GetChromeTrace() const {
+  std::vector<std::string> json_events;
+  absl::MutexLock lock(&mutex_);
+  for (int invocation = 0; invocation < trace_.size(); ++invocation) {
+    for (const TraceEvent& event : trace_[invocation]) {
+      json_events.push_back(absl::StrFormat(
+          "{\"name\":\"%s\",\"cat\":\"op\",\"ph\":\"X\",\"ts\":%d,"
+          "\"dur\":%d,\"pid\":0,\"tid\":0,\"args\":{\"subgraph_index\":%d,"
+          "\"node_index\":%d,\"invocation\":%d}}",
+          JsonEscape(event.op_type), event.begin_us, event.duration_us,
+          event.subgraph_index, event.node_index, invocation));
+    }
+  }
+  return absl::StrCat("{\"traceEvents\":[", absl::StrJoin(json_events, ","),
+                      "],\"displayTimeUnit\":\"ms\"}");
+}
+
+void OpProfiler::Reset() {
+  absl::MutexLock lock(&mutex_);
+  invocations_ = 0;
+  op_type_stats_.clear();
+  node_stats_.clear();
+  trace_.clear();
+}
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,134 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_OP_PROFILER_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_OP_PROFILER_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"  // from @com_google_absl
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "tensorflow/lite/core/shims/cc/interpreter.h"
+#include "tensorflow/lite/profiling/buffered_profiler.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+
+// Aggregated timings of an operator type, or of a single node of the graph.
+struct OpStats {
+  // Operator type, e.g. "CONV_2D", or custom op name.
+  std::string op_type;
+  // Subgraph and node index, or -1 for per-operator-type stats.
+  int subgraph_index = -1;
+  int node_index = -1;
+  // Number of executions, summed over all invocations.
+  int64_t count = 0;
+  absl::Duration total = absl::ZeroDuration();
+  absl::Duration min = absl::InfiniteDuration();
+  absl::Duration max = absl::ZeroDuration();
+
+  absl::Duration Mean() const {
+    return count > 0 ? total / count : absl::ZeroDuration();
+  }
+};
+
+// Per-operator profiler of the interpreter invocations of a TfLiteEngine,
+// see `TfLiteEngine::EnableOpProfiling`. A TFLite BufferedProfiler is attached
+// to the interpreter and its events are harvested after each invocation, so
+// that timings are aggregated across any number of invocations while the
+// event buffer stays bounded. The raw events of the last invocations are also
+// kept for export as a Chrome trace.
+//
+// `BeginInvocation` and `EndInvocation` must be called by the thread running
+// the invocations. The other methods are thread-safe.
+class OpProfiler {
+ public:
+  struct Options {
+    // Maximum number of events recorded per invocation. Events past this
+    // limit are dropped, so it should be at least the number of nodes of the
+    // model.
+    int max_events_per_invocation = 1024;
+    // Number of most recent invocations whose events are kept for
+    // `GetChromeTrace`.
+    int max_trace_invocations = 16;
+  };
+
+  explicit OpProfiler(const Options& options);
+
+  OpProfiler(const OpProfiler&) = delete;
+  OpProfiler& operator=(const OpProfiler&) = delete;
+
+  // Attaches the profiler to `interpreter`, which may change across
+  // invocations (e.g. after a delegate fallback), and starts profiling.
+  void BeginInvocation(tflite_shims::Interpreter* interpreter);
+
+  // Stops profiling and aggregates the events of the invocation.
+  void EndInvocation();
+
+  // Returns the number of profiled invocations.
+  int64_t GetInvocationCount() const;
+
+  // Returns the stats of each operator type, by decreasing total time.
+  std::vector<OpStats> GetOpTypeStats() const;
+
+  // Returns the stats of each node, by decreasing total time.
+  std::vector<OpStats> GetNodeStats() const;
+
+  // Returns human readable tables of the per-operator-type and per-node
+  // stats. At most `max_nodes` nodes are listed.
+  std::string GetSummary(int max_nodes = 20) const;
+
+  // Returns the events of the last invocations in the Chrome trace event
+  // format, which can be loaded in chrome://tracing or Perfetto.
+  std::string GetChromeTrace() const;
+
+  // Clears the aggregated stats and the kept events.
+  void Reset();
+
+ private:
+  struct TraceEvent {
+    std::string op_type;
+    int subgraph_index;
+    int node_index;
+    uint64_t begin_us;
+    uint64_t duration_us;
+  };
+
+  static void Accumulate(absl::Duration duration, OpStats* stats);
+
+  const Options options_;
+  tflite::profiling::BufferedProfiler profiler_;
+
+  mutable absl::Mutex mutex_;
+  int64_t invocations_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::flat_hash_map<std::string, OpStats> op_type_stats_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::pair<int, int>, OpStats> node_stats_
+      ABSL_GUARDED_BY(mutex_);
+  std::deque<std::vector<TraceEvent>> trace_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_OP_PROFILER_H_
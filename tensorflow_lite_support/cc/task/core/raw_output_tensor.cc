@@ -0,0 +1,84 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/raw_output_tensor.h"
+
+#include <algorithm>
+
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+
+namespace {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::StatusOr;
+using ::tflite::support::TfLiteSupportStatus;
+
+template <typename T>
+StatusOr<int> ArgMaxOf(const RawOutputTensor& tensor) {
+  ASSIGN_OR_RETURN(absl::Span<const T> values, tensor.data<T>());
+  if (values.empty()) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Tensor %s is empty.", tensor.name()),
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  return std::max_element(values.begin(), values.end()) - values.begin();
+}
+
+}  // namespace
+
+absl::Span<const int> RawOutputTensor::dims() const {
+  if (tensor_->dims == nullptr) {
+    return {};
+  }
+  return absl::MakeConstSpan(tensor_->dims->data, tensor_->dims->size);
+}
+
+int RawOutputTensor::num_elements() const {
+  int num_elements = 1;
+  for (int dim : dims()) {
+    num_elements *= dim;
+  }
+  return num_elements;
+}
+
+StatusOr<int> RawOutputTensor::ArgMax() const {
+  switch (tensor_->type) {
+    case kTfLiteFloat32:
+      return ArgMaxOf<float>(*this);
+    case kTfLiteUInt8:
+      // The scale of quantized tensors is positive, so the quantized values
+      // are in the same order as the dequantized ones.
+      return ArgMaxOf<uint8_t>(*this);
+    case kTfLiteInt8:
+      return ArgMaxOf<int8_t>(*this);
+    default:
+      return CreateStatusWithPayload(
+          StatusCode::kInvalidArgument,
+          absl::StrFormat("Unsupported type %d of tensor %s, expected "
+                          "kTfLiteFloat32, kTfLiteUInt8 or kTfLiteInt8.",
+                          tensor_->type, tensor_->name),
+          TfLiteSupportStatus::kInvalidArgumentError);
+  }
+}
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,91 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_RAW_OUTPUT_TENSOR_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_RAW_OUTPUT_TENSOR_H_
+
+#include <cstdint>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/type_to_tflitetype.h"
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+
+// A read-only view of an output tensor of the model, pointing into the
+// interpreter memory without any copy. It is only valid until the next
+// inference on the task, or until the task is destroyed.
+class RawOutputTensor {
+ public:
+  explicit RawOutputTensor(const TfLiteTensor* tensor) : tensor_(tensor) {}
+
+  // The name of the tensor in the model.
+  const char* name() const { return tensor_->name; }
+
+  TfLiteType type() const { return tensor_->type; }
+
+  // The dimensions of the tensor, e.g. `{1, 1001}` for a classifier with 1001
+  // classes.
+  absl::Span<const int> dims() const;
+
+  // The number of elements of the tensor, i.e. the product of its dimensions.
+  int num_elements() const;
+
+  // Whether the tensor is 8-bit quantized (kTfLiteUInt8 or kTfLiteInt8), in
+  // which case a quantized value `q` stands for `scale() * (q -
+  // zero_point())`.
+  bool is_quantized() const {
+    return tensor_->type == kTfLiteUInt8 || tensor_->type == kTfLiteInt8;
+  }
+  float scale() const { return tensor_->params.scale; }
+  int32_t zero_point() const { return tensor_->params.zero_point; }
+
+  // Returns the elements of the tensor. `T` must match `type()`, e.g. `float`
+  // for kTfLiteFloat32 or `uint8_t` for kTfLiteUInt8.
+  template <typename T>
+  tflite::support::StatusOr<absl::Span<const T>> data() const {
+    if (tensor_->type != typeToTfLiteType<T>()) {
+      return tflite::support::CreateStatusWithPayload(
+          absl::StatusCode::kInvalidArgument,
+          absl::StrFormat("Type mismatch for tensor %s: requested %d, got %d.",
+                          tensor_->name, typeToTfLiteType<T>(),
+                          tensor_->type),
+          tflite::support::TfLiteSupportStatus::kInvalidArgumentError);
+    }
+    return absl::MakeConstSpan(reinterpret_cast<const T*>(tensor_->data.raw),
+                               tensor_->bytes / sizeof(T));
+  }
+
+  // Returns the index of the largest element of a kTfLiteFloat32,
+  // kTfLiteUInt8 or kTfLiteInt8 tensor, e.g. the top-1 class of a
+  // classification output, without dequantizing it. The first index wins in
+  // case of ties.
+  tflite::support::StatusOr<int> ArgMax() const;
+
+ private:
+  const TfLiteTensor* tensor_;
+};
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_RAW_OUTPUT_TENSOR_H_
@@ -0,0 +1,139 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/shared_cpu_context.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+
+namespace {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::StatusOr;
+using ::tflite::support::TfLiteSupportStatus;
+
+int ResolveThreadBudget(int thread_budget) {
+  if (thread_budget != 0) {
+    return thread_budget;
+  }
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+}  // namespace
+
+SharedCpuContext::Lease::~Lease() { owner_->Release(context_, num_threads_); }
+
+/* static */
+StatusOr<std::shared_ptr<SharedCpuContext>> SharedCpuContext::Create(
+    const Options& options) {
+  if (options.thread_budget < 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Expected a non-negative thread budget, got %d.",
+                        options.thread_budget),
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  // Use absl::WrapUnique() to call private constructor:
+  // https://abseil.io/tips/126.
+  return std::shared_ptr<SharedCpuContext>(absl::WrapUnique(
+      new SharedCpuContext(ResolveThreadBudget(options.thread_budget))));
+}
+
+/* static */
+StatusOr<std::shared_ptr<SharedCpuContext>> SharedCpuContext::GetDefault(
+    int thread_budget) {
+  static absl::Mutex* mutex = new absl::Mutex();
+  static std::shared_ptr<SharedCpuContext>* default_context = nullptr;
+  absl::MutexLock lock(mutex);
+  if (default_context == nullptr) {
+    Options options;
+    options.thread_budget = thread_budget;
+    ASSIGN_OR_RETURN(std::shared_ptr<SharedCpuContext> context,
+                     Create(options));
+    // Never destroyed, as tasks may be destroyed at exit time.
+    default_context = new std::shared_ptr<SharedCpuContext>(context);
+  }
+  if (thread_budget != 0 &&
+      (*default_context)->thread_budget() != thread_budget) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("The process-wide shared CPU context already has a "
+                        "thread budget of %d, got %d.",
+                        (*default_context)->thread_budget(), thread_budget),
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  return *default_context;
+}
+
+SharedCpuContext::SharedCpuContext(int thread_budget)
+    : thread_budget_(thread_budget), available_threads_(thread_budget) {}
+
+std::unique_ptr<SharedCpuContext::Lease> SharedCpuContext::Acquire(
+    int num_threads) {
+  num_threads = num_threads == -1
+                    ? thread_budget_
+                    : std::min(std::max(num_threads, 1), thread_budget_);
+  tflite::ExternalCpuBackendContext* context;
+  {
+    absl::MutexLock lock(&mutex_);
+    while (available_threads_ < num_threads) {
+      threads_released_.Wait(&mutex_);
+    }
+    available_threads_ -= num_threads;
+    if (free_contexts_.empty()) {
+      auto new_context = absl::make_unique<tflite::ExternalCpuBackendContext>();
+      // Created eagerly, so that the interpreters never race to create it
+      // lazily.
+      new_context->set_internal_backend_context(
+          absl::make_unique<tflite::CpuBackendContext>());
+      free_contexts_.push_back(new_context.get());
+      contexts_.push_back(std::move(new_context));
+    }
+    context = free_contexts_.back();
+    free_contexts_.pop_back();
+  }
+  static_cast<tflite::CpuBackendContext*>(context->internal_backend_context())
+      ->SetMaxNumThreads(num_threads);
+  return absl::WrapUnique(new Lease(this, context, num_threads));
+}
+
+int SharedCpuContext::available_threads() const {
+  absl::MutexLock lock(&mutex_);
+  return available_threads_;
+}
+
+void SharedCpuContext::Release(tflite::ExternalCpuBackendContext* context,
+                               int num_threads) {
+  absl::MutexLock lock(&mutex_);
+  available_threads_ += num_threads;
+  free_contexts_.push_back(context);
+  threads_released_.SignalAll();
+}
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
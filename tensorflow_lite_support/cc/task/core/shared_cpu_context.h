@@ -0,0 +1,130 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_SHARED_CPU_CONTEXT_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_SHARED_CPU_CONTEXT_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+
+// CPU execution context shared by the interpreters of several TfLiteEngine
+// instances, so that running many tasks in the same process doesn't
+// oversubscribe the CPU cores.
+//
+// By default, each interpreter has its own pool of `num_threads` threads:
+// e.g. 20 tasks with 4 threads each on a 16-core machine run up to 80 threads
+// at once, and the latency becomes erratic. With a SharedCpuContext, the
+// interpreters lease a CPU backend context for the duration of each
+// invocation, and the number of threads used by the ongoing invocations never
+// exceeds the thread budget: invocations wait for threads to be available
+// instead of contending for the cores.
+//
+// Only the builtin CPU kernels draw their threads from the shared context.
+// Delegates (e.g. XNNPACK) keep their own threads, and should be configured
+// with a single thread when used with a SharedCpuContext.
+//
+// This class is thread-safe.
+class SharedCpuContext {
+ public:
+  struct Options {
+    // Maximum number of threads used by all the ongoing invocations. If 0,
+    // the number of CPU cores is used.
+    int thread_budget = 0;
+  };
+
+  // A CPU backend context leased for an invocation of `num_threads()`
+  // threads. The threads are given back to the budget when the lease is
+  // destroyed.
+  class Lease {
+   public:
+    ~Lease();
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+
+    // The context to install on the interpreter with
+    // `SetExternalContext(kTfLiteCpuBackendContext, ...)`.
+    TfLiteExternalContext* context() const { return context_; }
+    int num_threads() const { return num_threads_; }
+
+   private:
+    friend class SharedCpuContext;
+    Lease(SharedCpuContext* owner, tflite::ExternalCpuBackendContext* context,
+          int num_threads)
+        : owner_(owner), context_(context), num_threads_(num_threads) {}
+
+    SharedCpuContext* owner_;
+    tflite::ExternalCpuBackendContext* context_;
+    int num_threads_;
+  };
+
+  static tflite::support::StatusOr<std::shared_ptr<SharedCpuContext>> Create(
+      const Options& options);
+
+  // Returns the process-wide context, created with a budget of `thread_budget`
+  // threads (or the number of CPU cores if 0) on the first call. Fails if
+  // the existing context has a different budget.
+  static tflite::support::StatusOr<std::shared_ptr<SharedCpuContext>>
+  GetDefault(int thread_budget);
+
+  SharedCpuContext(const SharedCpuContext&) = delete;
+  SharedCpuContext& operator=(const SharedCpuContext&) = delete;
+
+  // Blocks until `num_threads` threads of the budget are available, and
+  // leases a CPU backend context limited to that many threads. A
+  // `num_threads` of -1, which lets TF Lite pick the number of threads,
+  // leases the whole budget; other values are clamped to
+  // [1, thread_budget()]. The lease must not outlive this object.
+  std::unique_ptr<Lease> Acquire(int num_threads);
+
+  int thread_budget() const { return thread_budget_; }
+
+  // Number of threads of the budget not currently leased.
+  int available_threads() const;
+
+ private:
+  explicit SharedCpuContext(int thread_budget);
+
+  void Release(tflite::ExternalCpuBackendContext* context, int num_threads);
+
+  const int thread_budget_;
+
+  mutable absl::Mutex mutex_;
+  // Signaled when a lease is released.
+  absl::CondVar threads_released_;
+  int available_threads_ ABSL_GUARDED_BY(mutex_);
+  // All the contexts created so far, and the ones not currently leased. A
+  // context is only created when all the existing ones are leased, so there
+  // are at most `thread_budget_` of them.
+  std::vector<std::unique_ptr<tflite::ExternalCpuBackendContext>> contexts_
+      ABSL_GUARDED_BY(mutex_);
+  std::vector<tflite::ExternalCpuBackendContext*> free_contexts_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_SHARED_CPU_CONTEXT_H_
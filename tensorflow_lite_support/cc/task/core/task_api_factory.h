@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_TASK_API_FACTORY_H_
 
 #include <memory>
+#include <vector>
 
 #include "absl/base/macros.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
@@ -26,8 +27,11 @@ limitations under the License.
 #include "tensorflow_lite_support/cc/port/status_macros.h"
 #include "tensorflow_lite_support/cc/port/statusor.h"
 #include "tensorflow_lite_support/cc/task/core/base_task_api.h"
+#include "tensorflow_lite_support/cc/task/core/cpu_placement.h"
+#include "tensorflow_lite_support/cc/task/core/op_profiler.h"
 #include "tensorflow_lite_support/cc/task/core/proto/base_options_proto_inc.h"
 #include "tensorflow_lite_support/cc/task/core/proto/external_file_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/core/shared_cpu_context.h"
 #include "tensorflow_lite_support/cc/task/core/tflite_engine.h"
 
 namespace tflite {
@@ -117,7 +121,9 @@ class TaskAPIFactory {
 
   // Creates a Task API from the provided BaseOptions. A non-default
   // OpResolver can be specified in order to support custom Ops or specify a
-  // subset of built-in Ops.
+  // subset of built-in Ops. The warm-up inferences configured in
+  // `warmup_options`, if any, are run before the task is returned, on the
+  // CPU cores of `cpu_placement_options` if set.
   template <typename T, EnableIfBaseUntypedTaskApiSubclass<T> = nullptr>
   static tflite::support::StatusOr<std::unique_ptr<T>> CreateFromBaseOptions(
       const BaseOptions* base_options,
@@ -142,10 +148,44 @@ class TaskAPIFactory {
     }
 
     auto engine = absl::make_unique<TfLiteEngine>(std::move(resolver));
+    if (base_options->has_verification_cache_dir()) {
+      RETURN_IF_ERROR(engine->EnableVerificationCache(
+          base_options->verification_cache_dir()));
+    }
+    if (base_options->profiling_options().enable_op_profiling()) {
+      OpProfiler::Options profiler_options;
+      profiler_options.max_events_per_invocation =
+          base_options->profiling_options().max_events_per_invocation();
+      profiler_options.max_trace_invocations =
+          base_options->profiling_options().max_trace_invocations();
+      RETURN_IF_ERROR(engine->EnableOpProfiling(profiler_options));
+    }
+    if (base_options->has_shared_cpu_context_options()) {
+      ASSIGN_OR_RETURN(
+          std::shared_ptr<SharedCpuContext> cpu_context,
+          SharedCpuContext::GetDefault(
+              base_options->shared_cpu_context_options().thread_budget()));
+      RETURN_IF_ERROR(engine->SetSharedCpuContext(std::move(cpu_context)));
+    }
+    if (base_options->has_cpu_placement_options()) {
+      const CpuPlacementOptions& placement_options =
+          base_options->cpu_placement_options();
+      ASSIGN_OR_RETURN(CpuTopology topology, CpuTopology::Read());
+      ASSIGN_OR_RETURN(
+          CpuPlacement placement,
+          CpuPlacement::Create(
+              std::vector<int>(placement_options.cpus().begin(),
+                               placement_options.cpus().end()),
+              placement_options.numa_node(),
+              placement_options.replicate_model_on_node(), topology));
+      RETURN_IF_ERROR(engine->SetCpuPlacement(std::move(placement)));
+    }
     RETURN_IF_ERROR(engine->BuildModelFromExternalFileProto(
         &base_options->model_file(), base_options->compute_settings()));
-    return CreateFromTfLiteEngine<T>(std::move(engine),
-                                     base_options->compute_settings());
+    RETURN_IF_ERROR(engine->InitInterpreter(base_options->compute_settings()));
+    RETURN_IF_ERROR(
+        engine->Warmup(base_options->warmup_options().num_warmup_runs()));
+    return absl::make_unique<T>(std::move(engine));
   }
 
  private:
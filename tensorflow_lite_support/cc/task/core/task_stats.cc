@@ -0,0 +1,172 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/task_stats.h"
+
+#include <algorithm>
+
+#include "absl/numeric/bits.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+
+namespace tflite {
+namespace task {
+namespace core {
+
+namespace {
+
+constexpr std::memory_order kRelaxed = std::memory_order_relaxed;
+
+std::string FormatLatencyStats(const char* name, const LatencyStats& stats) {
+  return absl::StrFormat(
+      "%-12s count=%d mean=%s p50=%s p90=%s p99=%s max=%s\n", name,
+      stats.count, absl::FormatDuration(stats.mean),
+      absl::FormatDuration(stats.p50), absl::FormatDuration(stats.p90),
+      absl::FormatDuration(stats.p99), absl::FormatDuration(stats.max));
+}
+
+}  // namespace
+
+std::string TaskStats::DebugString() const {
+  return absl::StrCat(
+      FormatLatencyStats("preprocess", preprocess),
+      FormatLatencyStats("invoke", invoke),
+      FormatLatencyStats("postprocess", postprocess),
+      FormatLatencyStats("total", total),
+      absl::StrFormat("invocations=%d failed=%d cancelled=%d fallback=%d "
+                      "input_bytes=%d\n",
+                      invocations, failed_invocations, cancelled_invocations,
+                      fallback_invocations, input_bytes));
+}
+
+/* static */
+int LatencyHistogram::BucketIndex(int64_t micros) {
+  constexpr int kSubBuckets = 1 << kSubBucketBits;
+  if (micros < kSubBuckets) {
+    return std::max<int64_t>(micros, 0);
+  }
+  // Position of the leading bit, and the next `kSubBucketBits` bits.
+  const int log2 = 63 - absl::countl_zero(static_cast<uint64_t>(micros));
+  const int sub_bucket =
+      (micros >> (log2 - kSubBucketBits)) & (kSubBuckets - 1);
+  return std::min(kNumBuckets - 1,
+                  ((log2 - kSubBucketBits + 1) << kSubBucketBits) + sub_bucket);
+}
+
+/* static */
+int64_t LatencyHistogram::BucketUpperBound(int index) {
+  constexpr int kSubBuckets = 1 << kSubBucketBits;
+  if (index < kSubBuckets) {
+    return index + 1;
+  }
+  const int shift = (index >> kSubBucketBits) - 1;
+  const int sub_bucket = index & (kSubBuckets - 1);
+  return static_cast<int64_t>(kSubBuckets + sub_bucket + 1) << shift;
+}
+
+void LatencyHistogram::Record(absl::Duration latency) {
+  const int64_t nanos = absl::ToInt64Nanoseconds(latency);
+  buckets_[BucketIndex(nanos / 1000)].fetch_add(1, kRelaxed);
+  count_.fetch_add(1, kRelaxed);
+  total_nanos_.fetch_add(nanos, kRelaxed);
+  int64_t max = max_nanos_.load(kRelaxed);
+  while (nanos > max && !max_nanos_.compare_exchange_weak(max, nanos)) {
+  }
+}
+
+LatencyStats LatencyHistogram::Snapshot() const {
+  LatencyStats stats;
+  int64_t counts[kNumBuckets];
+  int64_t count = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    counts[i] = buckets_[i].load(kRelaxed);
+    count += counts[i];
+  }
+  if (count == 0) {
+    return stats;
+  }
+  stats.count = count;
+  stats.max = absl::Nanoseconds(max_nanos_.load(kRelaxed));
+  stats.mean = absl::Nanoseconds(total_nanos_.load(kRelaxed) /
+                                 std::max<int64_t>(count_.load(kRelaxed), 1));
+  auto percentile = [&](double fraction) {
+    const int64_t rank = std::max<int64_t>(1, fraction * count + 0.5);
+    int64_t seen = 0;
+    for (int i = 0; i < kNumBuckets; ++i) {
+      seen += counts[i];
+      if (seen >= rank) {
+        return std::min(stats.max, absl::Microseconds(BucketUpperBound(i)));
+      }
+    }
+    return stats.max;
+  };
+  stats.p50 = percentile(0.5);
+  stats.p90 = percentile(0.9);
+  stats.p99 = percentile(0.99);
+  return stats;
+}
+
+void LatencyHistogram::Reset() {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, kRelaxed);
+  }
+  count_.store(0, kRelaxed);
+  total_nanos_.store(0, kRelaxed);
+  max_nanos_.store(0, kRelaxed);
+}
+
+void TaskStatsRecorder::RecordInvocation(const absl::Status& status,
+                                         bool fell_back) {
+  invocations_.fetch_add(1, kRelaxed);
+  if (!status.ok()) {
+    failed_invocations_.fetch_add(1, kRelaxed);
+  }
+  if (status.code() == absl::StatusCode::kCancelled) {
+    cancelled_invocations_.fetch_add(1, kRelaxed);
+  }
+  if (fell_back) {
+    fallback_invocations_.fetch_add(1, kRelaxed);
+  }
+}
+
+TaskStats TaskStatsRecorder::Snapshot() const {
+  TaskStats stats;
+  stats.preprocess = preprocess_.Snapshot();
+  stats.invoke = invoke_.Snapshot();
+  stats.postprocess = postprocess_.Snapshot();
+  stats.total = total_.Snapshot();
+  stats.invocations = invocations_.load(kRelaxed);
+  stats.failed_invocations = failed_invocations_.load(kRelaxed);
+  stats.cancelled_invocations = cancelled_invocations_.load(kRelaxed);
+  stats.fallback_invocations = fallback_invocations_.load(kRelaxed);
+  stats.input_bytes = input_bytes_.load(kRelaxed);
+  return stats;
+}
+
+void TaskStatsRecorder::Reset() {
+  preprocess_.Reset();
+  invoke_.Reset();
+  postprocess_.Reset();
+  total_.Reset();
+  invocations_.store(0, kRelaxed);
+  failed_invocations_.store(0, kRelaxed);
+  cancelled_invocations_.store(0, kRelaxed);
+  fallback_invocations_.store(0, kRelaxed);
+  input_bytes_.store(0, kRelaxed);
+}
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
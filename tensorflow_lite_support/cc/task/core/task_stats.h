@@ -0,0 +1,136 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_TASK_STATS_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_TASK_STATS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+
+namespace tflite {
+namespace task {
+namespace core {
+
+// Latency distribution of a stage of inference.
+struct LatencyStats {
+  int64_t count = 0;
+  absl::Duration mean = absl::ZeroDuration();
+  // Percentiles are estimated from a log-scale histogram with 4 buckets per
+  // power of two of microseconds, i.e. within 25%.
+  absl::Duration p50 = absl::ZeroDuration();
+  absl::Duration p90 = absl::ZeroDuration();
+  absl::Duration p99 = absl::ZeroDuration();
+  absl::Duration max = absl::ZeroDuration();
+};
+
+// Snapshot of the statistics of a task, see `BaseTaskApi::GetStats`.
+struct TaskStats {
+  // Population of the input tensors from the API inputs.
+  LatencyStats preprocess;
+  // Interpreter invocation, including the CPU fallback if any.
+  LatencyStats invoke;
+  // Construction of the API result from the output tensors.
+  LatencyStats postprocess;
+  // Whole inference calls, from preprocessing to postprocessing.
+  LatencyStats total;
+  // Number of interpreter invocations.
+  int64_t invocations = 0;
+  // Number of invocations which failed, including the cancelled ones.
+  int64_t failed_invocations = 0;
+  // Number of invocations which were cancelled with `Cancel()`.
+  int64_t cancelled_invocations = 0;
+  // Number of invocations which ran on CPU because the delegate failed, at
+  // this invocation or a previous one.
+  int64_t fallback_invocations = 0;
+  // Total size of the input tensors populated by preprocessing.
+  int64_t input_bytes = 0;
+
+  // Returns a human readable multi-line summary.
+  std::string DebugString() const;
+};
+
+// A lock-free latency histogram: `Record` can be called concurrently with
+// `Snapshot` and `Reset`, from any thread. A snapshot taken concurrently with
+// `Record` calls may be off by the samples in flight.
+class LatencyHistogram {
+ public:
+  LatencyHistogram() { Reset(); }
+
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  void Record(absl::Duration latency);
+  LatencyStats Snapshot() const;
+  void Reset();
+
+ private:
+  // 4 buckets per power of two, up to 2^40 microseconds.
+  static constexpr int kSubBucketBits = 2;
+  static constexpr int kNumBuckets = 40 << kSubBucketBits;
+
+  static int BucketIndex(int64_t micros);
+  // Returns the exclusive upper bound of the bucket, in microseconds.
+  static int64_t BucketUpperBound(int index);
+
+  std::atomic<int64_t> buckets_[kNumBuckets];
+  std::atomic<int64_t> count_;
+  std::atomic<int64_t> total_nanos_;
+  std::atomic<int64_t> max_nanos_;
+};
+
+// Accumulates the statistics of a task. Thread-safe.
+class TaskStatsRecorder {
+ public:
+  TaskStatsRecorder() = default;
+
+  TaskStatsRecorder(const TaskStatsRecorder&) = delete;
+  TaskStatsRecorder& operator=(const TaskStatsRecorder&) = delete;
+
+  LatencyHistogram& preprocess() { return preprocess_; }
+  LatencyHistogram& invoke() { return invoke_; }
+  LatencyHistogram& postprocess() { return postprocess_; }
+  LatencyHistogram& total() { return total_; }
+
+  // Records the outcome of an interpreter invocation. `fell_back` is whether
+  // it ran on CPU because of a delegate error.
+  void RecordInvocation(const absl::Status& status, bool fell_back);
+  void RecordInputBytes(int64_t bytes) {
+    input_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  TaskStats Snapshot() const;
+  void Reset();
+
+ private:
+  LatencyHistogram preprocess_;
+  LatencyHistogram invoke_;
+  LatencyHistogram postprocess_;
+  LatencyHistogram total_;
+  std::atomic<int64_t> invocations_{0};
+  std::atomic<int64_t> failed_invocations_{0};
+  std::atomic<int64_t> cancelled_invocations_{0};
+  std::atomic<int64_t> fallback_invocations_{0};
+  std::atomic<int64_t> input_bytes_{0};
+};
+
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_CORE_TASK_STATS_H_
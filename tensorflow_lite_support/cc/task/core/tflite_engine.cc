@@ -17,18 +17,25 @@ limitations under the License.
 
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <random>
 
 #include "absl/strings/match.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/core/shims/cc/kernels/register.h"
 #include "tensorflow/lite/core/shims/cc/tools/verifier.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/schema/schema_generated.h"
 #include "tensorflow/lite/stderr_reporter.h"
+#include "tensorflow/lite/string_util.h"
 #include "tensorflow_lite_support/cc/common.h"
 #include "tensorflow_lite_support/cc/port/configuration_proto_inc.h"
 #include "tensorflow_lite_support/cc/port/status_macros.h"
 #include "tensorflow_lite_support/cc/task/core/external_file_handler.h"
+#include "tensorflow_lite_support/cc/task/core/model_verification_cache.h"
 
 namespace tflite {
 namespace task {
@@ -55,6 +62,65 @@ using ::tflite::support::CreateStatusWithPayload;
 using ::tflite::support::InterpreterCreationResources;
 using ::tflite::support::TfLiteSupportStatus;
 
+namespace {
+
+// Fills `tensor` with synthetic values for the warm-up inferences: uniformly
+// distributed values in [0, 1) for float tensors, uniformly distributed bytes
+// for 8-bit tensors, a short string per element for string tensors and zeros
+// otherwise, which are e.g. valid token ids.
+void PopulateWarmupTensor(TfLiteTensor* tensor, std::mt19937* rng) {
+  if (tensor->type == kTfLiteString) {
+    int num_elements = 1;
+    for (int i = 0; i < tensor->dims->size; ++i) {
+      num_elements *= tensor->dims->data[i];
+    }
+    static constexpr char kWarmupText[] = "warm up";
+    tflite::DynamicBuffer buffer;
+    for (int i = 0; i < std::max(num_elements, 1); ++i) {
+      buffer.AddString(kWarmupText, sizeof(kWarmupText) - 1);
+    }
+    buffer.WriteToTensorAsVector(tensor);
+    return;
+  }
+  if (tensor->data.raw == nullptr) {
+    return;
+  }
+  switch (tensor->type) {
+    case kTfLiteFloat32: {
+      std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+      float* data = tensor->data.f;
+      for (size_t i = 0; i < tensor->bytes / sizeof(float); ++i) {
+        data[i] = distribution(*rng);
+      }
+      break;
+    }
+    case kTfLiteUInt8:
+    case kTfLiteInt8:
+      for (size_t i = 0; i < tensor->bytes; ++i) {
+        tensor->data.uint8[i] = static_cast<uint8_t>((*rng)() & 0xff);
+      }
+      break;
+    default:
+      memset(tensor->data.raw, 0, tensor->bytes);
+  }
+}
+
+// Writes to the tensors allocated in the arena of `interpreter`, so that the
+// arena pages are allocated by the calling thread, i.e. on its NUMA node under
+// the default Linux policy, rather than by whichever thread first runs the
+// model.
+void FirstTouchArena(TfLiteEngine::Interpreter* interpreter) {
+  for (int index = 0; index < interpreter->tensors_size(); ++index) {
+    TfLiteTensor* tensor = interpreter->tensor(index);
+    if (tensor->allocation_type == kTfLiteArenaRw &&
+        tensor->data.raw != nullptr) {
+      memset(tensor->data.raw, 0, tensor->bytes);
+    }
+  }
+}
+
+}  // namespace
+
 bool TfLiteEngine::Verifier::Verify(const char* data, int length,
                                     tflite::ErrorReporter* reporter) {
   return tflite_shims::Verify(data, length, reporter);
@@ -85,18 +151,83 @@ std::vector<const TfLiteTensor*> TfLiteEngine::GetOutputs() {
   return tensors;
 }
 
-void TfLiteEngine::VerifyAndBuildModelFromBuffer(
-    const char* buffer_data, size_t buffer_size,
-    TfLiteVerifier* extra_verifier) {
-  model_ = tflite_shims::FlatBufferModel::VerifyAndBuildFromBuffer(
-      buffer_data, buffer_size, extra_verifier, &error_reporter_);
+absl::Status TfLiteEngine::EnableVerificationCache(
+    const std::string& cache_dir) {
+  ASSIGN_OR_RETURN(verification_cache_,
+                   ModelVerificationCache::Create(cache_dir));
+  return absl::OkStatus();
+}
+
+absl::Status TfLiteEngine::EnableOpProfiling(
+    const OpProfiler::Options& options) {
+  if (options.max_events_per_invocation <= 0 ||
+      options.max_trace_invocations < 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "Expected `max_events_per_invocation` > 0 and "
+        "`max_trace_invocations` >= 0.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  op_profiler_ = absl::make_unique<OpProfiler>(options);
+  return absl::OkStatus();
+}
+
+absl::Status TfLiteEngine::VerifyModel(const char* buffer_data,
+                                       size_t buffer_size) {
+  std::string cache_key;
+  if (verification_cache_ != nullptr) {
+    cache_key = ModelVerificationCache::ComputeKey(
+        absl::string_view(buffer_data, buffer_size));
+    if (verification_cache_->Contains(cache_key)) {
+      return absl::OkStatus();
+    }
+  }
+
+  // tflite::Verify includes the base FlatBuffer verification, so this is the
+  // only pass over the buffer on success.
+  if (!verifier_.Verify(buffer_data, buffer_size, &error_reporter_)) {
+    // Only re-run the base FlatBuffer verification on failure, to tell
+    // malformed FlatBuffers apart from invalid models.
+    flatbuffers::Verifier base_verifier(
+        reinterpret_cast<const uint8_t*>(buffer_data), buffer_size);
+    if (!tflite::VerifyModelBuffer(base_verifier)) {
+      return CreateStatusWithPayload(
+          StatusCode::kInvalidArgument,
+          "The model is not a valid Flatbuffer buffer",
+          TfLiteSupportStatus::kInvalidFlatBufferError);
+    }
+    return CreateStatusWithPayload(
+        StatusCode::kUnknown,
+        absl::StrCat(
+            "Could not build model from the provided pre-loaded flatbuffer: ",
+            error_reporter_.message()));
+  }
+
+  if (verification_cache_ != nullptr) {
+    // The cache is an optimization only: failing to record the model, e.g.
+    // because the directory is read-only, must not fail the initialization.
+    verification_cache_->Insert(cache_key).IgnoreError();
+  }
+  return absl::OkStatus();
 }
 
 absl::Status TfLiteEngine::InitializeFromModelFileHandler(
     const tflite::proto::ComputeSettings& compute_settings) {
   const char* buffer_data = model_file_handler_->GetFileContent().data();
   size_t buffer_size = model_file_handler_->GetFileContent().size();
-  VerifyAndBuildModelFromBuffer(buffer_data, buffer_size, &verifier_);
+  if (cpu_placement_ != nullptr && cpu_placement_->replicate_model()) {
+    // The replica is copied, hence allocated, on the node of the placement.
+    std::unique_ptr<ScopedCpuAffinity> affinity = PinCurrentThread();
+    RETURN_IF_ERROR(affinity->status());
+    model_replica_ =
+        GetModelReplica(model_file_handler_->GetFileContent(),
+                        cpu_placement_->numa_node());
+    buffer_data = model_replica_->data();
+    buffer_size = model_replica_->size();
+  }
+  RETURN_IF_ERROR(VerifyModel(buffer_data, buffer_size));
+  model_ = tflite_shims::FlatBufferModel::BuildFromBuffer(
+      buffer_data, buffer_size, &error_reporter_);
   if (model_ == nullptr) {
     static constexpr char kInvalidFlatbufferMessage[] =
         "The model is not a valid Flatbuffer";
@@ -124,9 +255,11 @@ absl::Status TfLiteEngine::InitializeFromModelFileHandler(
     }
   }
 
+  // The buffer has been verified above, so the extractor doesn't need to
+  // verify it again.
   ASSIGN_OR_RETURN(
       model_metadata_extractor_,
-      tflite::metadata::ModelMetadataExtractor::CreateFromModelBuffer(
+      tflite::metadata::ModelMetadataExtractor::CreateFromVerifiedModelBuffer(
           buffer_data, buffer_size));
 
   return absl::OkStatus();
@@ -208,6 +341,89 @@ absl::Status TfLiteEngine::BuildModelFromExternalFileProto(
   return InitializeFromModelFileHandler(compute_settings);
 }
 
+absl::Status TfLiteEngine::SetSharedCpuContext(
+    std::shared_ptr<SharedCpuContext> context) {
+  if (interpreter() != nullptr) {
+    return CreateStatusWithPayload(
+        StatusCode::kFailedPrecondition,
+        "The shared CPU context must be set before calling InitInterpreter.");
+  }
+  if (cpu_placement_ != nullptr) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "A shared CPU context can't be combined with a CPU placement.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  shared_cpu_context_ = std::move(context);
+  if (idle_cpu_context_ == nullptr) {
+    idle_cpu_context_ = absl::make_unique<tflite::ExternalCpuBackendContext>();
+    auto backend_context = absl::make_unique<tflite::CpuBackendContext>();
+    backend_context->SetMaxNumThreads(1);
+    idle_cpu_context_->set_internal_backend_context(std::move(backend_context));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status TfLiteEngine::SetCpuPlacement(CpuPlacement placement) {
+  if (model_ != nullptr) {
+    return CreateStatusWithPayload(
+        StatusCode::kFailedPrecondition,
+        "The CPU placement must be set before building the model.");
+  }
+  if (shared_cpu_context_ != nullptr) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "A CPU placement can't be combined with a shared CPU context.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  cpu_placement_ = absl::make_unique<CpuPlacement>(std::move(placement));
+  return absl::OkStatus();
+}
+
+std::unique_ptr<ScopedCpuAffinity> TfLiteEngine::PinCurrentThread() {
+  if (cpu_placement_ == nullptr) {
+    return nullptr;
+  }
+  return absl::make_unique<ScopedCpuAffinity>(cpu_placement_->cpus());
+}
+
+absl::Status TfLiteEngine::AllocateTensors() {
+  if (interpreter()->AllocateTensors() != kTfLiteOk) {
+    return CreateStatusWithPayload(StatusCode::kInternal,
+                                   "Failed to allocate the tensors.");
+  }
+  if (cpu_placement_ != nullptr) {
+    FirstTouchArena(interpreter());
+  }
+  return absl::OkStatus();
+}
+
+TfLiteEngine::CpuContextLease::~CpuContextLease() {
+  engine_->leased_cpu_context_ = nullptr;
+  if (engine_->interpreter() != nullptr) {
+    engine_->interpreter()->SetExternalContext(
+        kTfLiteCpuBackendContext, engine_->idle_cpu_context_.get());
+  }
+  // `lease_` returns the context to the shared pool once uninstalled.
+}
+
+std::unique_ptr<TfLiteEngine::CpuContextLease>
+TfLiteEngine::AcquireCpuContext() {
+  if (shared_cpu_context_ == nullptr || leased_cpu_context_ != nullptr) {
+    return nullptr;
+  }
+  // Use absl::WrapUnique() to call private constructor:
+  // https://abseil.io/tips/126.
+  std::unique_ptr<CpuContextLease> lease = absl::WrapUnique(
+      new CpuContextLease(this, shared_cpu_context_->Acquire(num_threads_)));
+  leased_cpu_context_ = lease->context();
+  if (interpreter() != nullptr) {
+    interpreter()->SetExternalContext(kTfLiteCpuBackendContext,
+                                      leased_cpu_context_);
+  }
+  return lease;
+}
+
 absl::Status TfLiteEngine::InitInterpreter(int num_threads) {
   tflite::proto::ComputeSettings compute_settings;
   compute_settings.mutable_tflite_settings()
@@ -238,9 +454,22 @@ absl::Status TfLiteEngine::InitInterpreter(
         "TF Lite FlatBufferModel is null. Please make sure to call one of the "
         "BuildModelFrom methods before calling InitInterpreter.");
   }
+  num_threads_ =
+      compute_settings.tflite_settings().cpu_settings().num_threads();
+  // The worker threads created by the interpreter and its delegates inherit
+  // the CPU cores of the placement from the calling thread.
+  std::unique_ptr<ScopedCpuAffinity> affinity = PinCurrentThread();
+  if (affinity != nullptr) {
+    RETURN_IF_ERROR(affinity->status());
+  }
+  // With a shared CPU context, the interpreter gets the leased backend
+  // context right after being built, so that it never uses a private thread
+  // pool, and the kernels are prepared under the lease.
+  std::unique_ptr<CpuContextLease> cpu_context = AcquireCpuContext();
   auto initializer =
-      [this](const InterpreterCreationResources& resources,
-             std::unique_ptr<Interpreter, InterpreterDeleter>* interpreter_out)
+      [this](
+          const InterpreterCreationResources& resources,
+          std::unique_ptr<Interpreter, InterpreterDeleter>* interpreter_out)
       -> absl::Status {
     tflite_shims::InterpreterBuilder interpreter_builder(*model_, *resolver_);
     resources.ApplyTo(&interpreter_builder);
@@ -254,6 +483,15 @@ absl::Status TfLiteEngine::InitInterpreter(
       return CreateStatusWithPayload(StatusCode::kInternal,
                                      "TF Lite interpreter is null.");
     }
+    // The initializer is kept by the interpreter wrapper, and may run again
+    // outside of InitInterpreter: it installs whichever context is current.
+    if (shared_cpu_context_ != nullptr) {
+      (*interpreter_out)
+          ->SetExternalContext(kTfLiteCpuBackendContext,
+                               leased_cpu_context_ != nullptr
+                                   ? leased_cpu_context_
+                                   : idle_cpu_context_.get());
+    }
     return absl::OkStatus();
   };
 
@@ -274,10 +512,52 @@ absl::Status TfLiteEngine::InitInterpreter(
                     .has_value()) {
       return CreateStatusWithPayload(status.code(), status.message());
     }
+    return status;
+  }
+  if (affinity != nullptr) {
+    FirstTouchArena(interpreter());
   }
   return status;
 }
 
+absl::Status TfLiteEngine::Warmup(int num_runs) {
+  if (num_runs < 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrCat("Expected a non-negative number of warm-up runs, got ",
+                     num_runs, "."),
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  if (num_runs == 0) {
+    return absl::OkStatus();
+  }
+  if (interpreter() == nullptr) {
+    return CreateStatusWithPayload(
+        StatusCode::kInternal,
+        "TF Lite interpreter is null. Please make sure to call InitInterpreter "
+        "before calling Warmup.");
+  }
+  // A fixed seed keeps the warm-up reproducible.
+  std::mt19937 rng(/*seed=*/42);
+  for (TfLiteTensor* input : GetInputs()) {
+    PopulateWarmupTensor(input, &rng);
+  }
+  std::unique_ptr<ScopedCpuAffinity> affinity = PinCurrentThread();
+  if (affinity != nullptr) {
+    RETURN_IF_ERROR(affinity->status());
+  }
+  for (int run = 0; run < num_runs; ++run) {
+    std::unique_ptr<CpuContextLease> cpu_context = AcquireCpuContext();
+    absl::Status status = interpreter_.InvokeWithoutFallback();
+    if (!status.ok()) {
+      return CreateStatusWithPayload(
+          status.code(),
+          absl::StrCat("Warm-up inference failed: ", status.message()));
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace core
 }  // namespace task
 }  // namespace tflite
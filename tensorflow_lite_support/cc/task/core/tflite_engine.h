@@ -19,6 +19,8 @@ limitations under the License.
 #include <sys/mman.h>
 
 #include <memory>
+#include <string>
+#include <utility>
 
 #include "absl/memory/memory.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
@@ -28,11 +30,16 @@ limitations under the License.
 #include "tensorflow/lite/core/shims/cc/interpreter.h"
 #include "tensorflow/lite/core/shims/cc/kernels/register.h"
 #include "tensorflow/lite/core/shims/cc/model.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow_lite_support/cc/port/configuration_proto_inc.h"
 #include "tensorflow_lite_support/cc/port/tflite_wrapper.h"
+#include "tensorflow_lite_support/cc/task/core/cpu_placement.h"
 #include "tensorflow_lite_support/cc/task/core/error_reporter.h"
 #include "tensorflow_lite_support/cc/task/core/external_file_handler.h"
+#include "tensorflow_lite_support/cc/task/core/model_verification_cache.h"
+#include "tensorflow_lite_support/cc/task/core/op_profiler.h"
 #include "tensorflow_lite_support/cc/task/core/proto/external_file_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/core/shared_cpu_context.h"
 #include "tensorflow_lite_support/metadata/cc/metadata_extractor.h"
 
 namespace tflite {
@@ -92,6 +99,9 @@ class TfLiteEngine {
   const tflite::metadata::ModelMetadataExtractor* metadata_extractor() const {
     return model_metadata_extractor_.get();
   }
+  // Returns the operator profiler, or nullptr if profiling is not enabled.
+  OpProfiler* op_profiler() { return op_profiler_.get(); }
+  const OpProfiler* op_profiler() const { return op_profiler_.get(); }
 
   // Builds the TF Lite FlatBufferModel (model_) from the raw FlatBuffer data
   // whose ownership remains with the caller, and which must outlive the current
@@ -126,6 +136,76 @@ class TfLiteEngine {
   absl::Status BuildModelFromExternalFileProto(
       std::unique_ptr<ExternalFile> external_file);
 
+  // Enables the persistent verification cache stored in `cache_dir`, which
+  // must be an existing directory, for the models built afterwards. Models
+  // found in the cache are not verified again. See ModelVerificationCache.
+  absl::Status EnableVerificationCache(const std::string& cache_dir);
+
+  // Enables the per-operator profiling of the interpreter invocations, see
+  // OpProfiler. Invocations are only profiled if the caller brackets them with
+  // `OpProfiler::BeginInvocation` and `OpProfiler::EndInvocation`, as
+  // BaseTaskApi does.
+  absl::Status EnableOpProfiling(const OpProfiler::Options& options);
+
+  // A lease of the shared CPU context installed on the interpreter of the
+  // engine. When destroyed, the interpreter gets back a context private to
+  // the engine, so that it never references a context leased to another
+  // engine, and the leased context returns to the shared pool.
+  class CpuContextLease {
+   public:
+    ~CpuContextLease();
+    CpuContextLease(const CpuContextLease&) = delete;
+    CpuContextLease& operator=(const CpuContextLease&) = delete;
+
+    TfLiteExternalContext* context() const { return lease_->context(); }
+
+   private:
+    friend class TfLiteEngine;
+    CpuContextLease(TfLiteEngine* engine,
+                    std::unique_ptr<SharedCpuContext::Lease> lease)
+        : engine_(engine), lease_(std::move(lease)) {}
+
+    TfLiteEngine* engine_;
+    std::unique_ptr<SharedCpuContext::Lease> lease_;
+  };
+
+  // Makes the interpreter draw its CPU threads from `context`, shared with
+  // other engines, instead of having its own thread pool. Must be called
+  // before InitInterpreter. Everything that may run the kernels of the
+  // interpreter (invocations, but also the tensor allocations after an input
+  // resize) must then be bracketed by a lease from AcquireCpuContext, as
+  // BaseTaskApi does.
+  absl::Status SetSharedCpuContext(std::shared_ptr<SharedCpuContext> context);
+
+  // Leases `num_threads` threads (as set by InitInterpreter) from the shared
+  // CPU context, waiting for them to be available if needed, and installs the
+  // leased context on the interpreter until the lease is destroyed. Returns
+  // nullptr if no shared CPU context is set, or if the engine already holds a
+  // lease (e.g. when an invocation is nested in a leased inference), in
+  // which case that lease remains in effect.
+  std::unique_ptr<CpuContextLease> AcquireCpuContext();
+
+  // Places the threads and the memory of the interpreter according to
+  // `placement`: the model is built (from a replica local to the NUMA node if
+  // requested), the interpreter initialized and its tensor arena first
+  // written to while the calling thread is restricted to the CPU cores of the
+  // placement, so that the interpreter worker threads inherit the restriction
+  // and the memory is allocated on the matching node. Must be called before
+  // building the model, and is exclusive with SetSharedCpuContext, whose
+  // threads are not owned by the engine. Each invocation must then be
+  // bracketed by PinCurrentThread, as BaseTaskApi does.
+  absl::Status SetCpuPlacement(CpuPlacement placement);
+
+  // Restricts the calling thread to the CPU cores of the placement until the
+  // returned object is destroyed. Returns nullptr if no placement is set.
+  std::unique_ptr<ScopedCpuAffinity> PinCurrentThread();
+
+  // Allocates the tensors of the interpreter again, e.g. after an input
+  // resize. With a CPU placement, the new arena is then first written to by
+  // the calling thread, which must be bracketed by PinCurrentThread so that
+  // the arena pages are allocated on the NUMA node of the placement.
+  absl::Status AllocateTensors();
+
   // Initializes interpreter with encapsulated model.
   // Note: setting num_threads to -1 has for effect to let TFLite runtime set
   // the value.
@@ -142,6 +222,15 @@ class TfLiteEngine {
   absl::Status InitInterpreter(
       const tflite::proto::ComputeSettings& compute_settings, int num_threads);
 
+  // Runs `num_runs` inferences on synthetic inputs, so that the one-time costs
+  // of the first inferences (page faults on the model, lazy initializations in
+  // the kernels, cold caches) are paid upfront. Must be called after
+  // InitInterpreter, and before the task sets its own inputs as they are
+  // overwritten. Numeric inputs are filled with a deterministic pseudo-random
+  // pattern, string inputs with a single short string. The invocations are
+  // not profiled, even if operator profiling is enabled.
+  absl::Status Warmup(int num_runs);
+
   // Cancels the on-going `Invoke()` call if any and if possible. This method
   // can be called from a different thread than the one where `Invoke()` is
   // running.
@@ -161,13 +250,10 @@ class TfLiteEngine {
                 tflite::ErrorReporter* reporter) override;
   };
 
-  // Verifies that the supplied buffer refers to a valid flatbuffer model,
-  // and that it uses only operators that are supported by the OpResolver
-  // that was passed to the TfLiteEngine constructor, and then builds
-  // the model from the buffer and stores it in 'model_'.
-  void VerifyAndBuildModelFromBuffer(const char* buffer_data,
-                                     size_t buffer_size,
-                                     TfLiteVerifier* extra_verifier = nullptr);
+  // Verifies that the supplied buffer refers to a valid flatbuffer model with
+  // a single pass of tflite::Verify, unless the verification cache (if any)
+  // already records it as verified.
+  absl::Status VerifyModel(const char* buffer_data, size_t buffer_size);
 
   // Gets the buffer from the file handler; verifies and builds the model
   // from the buffer; if successful, sets 'model_metadata_extractor_' to be
@@ -184,9 +270,34 @@ class TfLiteEngine {
   std::unique_ptr<ExternalFile> external_file_;
   std::unique_ptr<ExternalFileHandler> model_file_handler_;
 
+  // Optional placement of the interpreter threads and memory.
+  std::unique_ptr<CpuPlacement> cpu_placement_;
+
+  // Copy of the model local to the NUMA node of the placement, if requested.
+  // Declared before the model, which references it until destroyed.
+  std::shared_ptr<const std::string> model_replica_;
+
   // TF Lite model and interpreter for actual inference.
   std::unique_ptr<Model, ModelDeleter> model_;
 
+  // Optional CPU context shared with other engines. Declared before the
+  // interpreter, which may reference its backend contexts until destroyed.
+  std::shared_ptr<SharedCpuContext> shared_cpu_context_;
+
+  // With a shared CPU context, the single-threaded context installed on the
+  // interpreter outside of leases: the interpreter gives up its own context
+  // when another one is installed, and must never keep a context which
+  // returned to the shared pool, as e.g. its destructor clears the caches of
+  // the installed context. Declared before the interpreter for the same
+  // reason as above.
+  std::unique_ptr<tflite::ExternalCpuBackendContext> idle_cpu_context_;
+
+  // The context of the lease currently held by the engine, if any.
+  TfLiteExternalContext* leased_cpu_context_ = nullptr;
+
+  // Number of threads of the interpreter, as set by InitInterpreter.
+  int num_threads_ = -1;
+
   // Interpreter wrapper built from the model.
   InterpreterWrapper interpreter_;
 
@@ -200,6 +311,12 @@ class TfLiteEngine {
 
   // Extra verifier for FlatBuffer input data.
   Verifier verifier_;
+
+  // Optional persistent cache of the verified models.
+  std::unique_ptr<ModelVerificationCache> verification_cache_;
+
+  // Optional per-operator profiler, null unless profiling is enabled.
+  std::unique_ptr<OpProfiler> op_profiler_;
 };
 
 }  // namespace core
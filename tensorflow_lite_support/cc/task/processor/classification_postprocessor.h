@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <initializer_list>
 
+#include "absl/container/flat_hash_set.h"  // from @com_google_absl
 #include "tensorflow_lite_support/cc/port/status_macros.h"
 #include "tensorflow_lite_support/cc/port/statusor.h"
 #include "tensorflow_lite_support/cc/task/core/classification_head.h"
@@ -0,0 +1,546 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/processor/detection_postprocessor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/numbers.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "absl/strings/str_split.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/task/core/classification_head.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
+
+namespace tflite {
+namespace task {
+namespace processor {
+
+namespace {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::TfLiteSupportStatus;
+using ::tflite::task::core::BuildClassificationHead;
+using ::tflite::task::core::ClassificationHead;
+
+// Candidates of a single NMS pass, stored as a structure of arrays.
+struct Candidates {
+  std::vector<float> ymin;
+  std::vector<float> xmin;
+  std::vector<float> ymax;
+  std::vector<float> xmax;
+  std::vector<float> area;
+  std::vector<float> score;
+  std::vector<int> box_index;
+  std::vector<int> class_index;
+
+  int size() const { return score.size(); }
+
+  void Add(const float* box, float box_score, int box_idx, int class_idx) {
+    ymin.push_back(box[0]);
+    xmin.push_back(box[1]);
+    ymax.push_back(box[2]);
+    xmax.push_back(box[3]);
+    area.push_back(std::max(box[2] - box[0], 0.0f) *
+                   std::max(box[3] - box[1], 0.0f));
+    score.push_back(box_score);
+    box_index.push_back(box_idx);
+    class_index.push_back(class_idx);
+  }
+};
+
+// Computes the IoU of candidate `i` with all candidates into `iou`. The loop
+// has no branches so that it can be auto-vectorized.
+void ComputeIou(const Candidates& c, int i, float* iou) {
+  const int n = c.size();
+  const float ymin = c.ymin[i];
+  const float xmin = c.xmin[i];
+  const float ymax = c.ymax[i];
+  const float xmax = c.xmax[i];
+  const float area = c.area[i];
+  const float* ymins = c.ymin.data();
+  const float* xmins = c.xmin.data();
+  const float* ymaxs = c.ymax.data();
+  const float* xmaxs = c.xmax.data();
+  const float* areas = c.area.data();
+  for (int j = 0; j < n; ++j) {
+    const float h =
+        std::max(std::min(ymax, ymaxs[j]) - std::max(ymin, ymins[j]), 0.0f);
+    const float w =
+        std::max(std::min(xmax, xmaxs[j]) - std::max(xmin, xmins[j]), 0.0f);
+    const float intersection = h * w;
+    const float union_area = area + areas[j] - intersection;
+    iou[j] = union_area > 0.0f ? intersection / union_area : 0.0f;
+  }
+}
+
+// Keeps the `max_candidates` (box, class) pairs with the highest scores,
+// sorted by decreasing score.
+void SelectTopK(int max_candidates, std::vector<std::pair<float, int>>* pairs) {
+  auto by_score = [](const std::pair<float, int>& a,
+                     const std::pair<float, int>& b) {
+    return a.first > b.first;
+  };
+  if (max_candidates >= 0 &&
+      pairs->size() > static_cast<size_t>(max_candidates)) {
+    std::nth_element(pairs->begin(), pairs->begin() + max_candidates,
+                     pairs->end(), by_score);
+    pairs->resize(max_candidates);
+  }
+  std::sort(pairs->begin(), pairs->end(), by_score);
+}
+
+// Runs NMS over `candidates`, which are sorted by decreasing score, and
+// appends the selected ones to `results`.
+void RunNms(const NmsParameters& params, Candidates* candidates,
+            std::vector<DetectionCandidate>* results) {
+  const int n = candidates->size();
+  const int max_detections = params.max_detections < 0
+                                 ? n
+                                 : std::min(n, params.max_detections);
+  std::vector<float> iou(n);
+  if (params.soft_nms_sigma <= 0) {
+    // Hard NMS: candidates are visited by decreasing score, and suppress the
+    // lower-scored ones overlapping them.
+    std::vector<char> alive(n, 1);
+    int selected = 0;
+    for (int i = 0; i < n && selected < max_detections; ++i) {
+      if (!alive[i]) continue;
+      results->push_back({candidates->box_index[i], candidates->class_index[i],
+                          candidates->score[i]});
+      ++selected;
+      ComputeIou(*candidates, i, iou.data());
+      for (int j = i + 1; j < n; ++j) {
+        alive[j] &= iou[j] <= params.iou_threshold;
+      }
+    }
+    return;
+  }
+  // Soft-NMS: the highest remaining candidate is selected, and the scores of
+  // the others are decayed by exp(-iou^2 / sigma).
+  std::vector<char> alive(n, 1);
+  float* scores = candidates->score.data();
+  const float scale = -1.0f / params.soft_nms_sigma;
+  for (int selected = 0; selected < max_detections; ++selected) {
+    int best = -1;
+    for (int j = 0; j < n; ++j) {
+      if (alive[j] && (best < 0 || scores[j] > scores[best])) best = j;
+    }
+    if (best < 0 || scores[best] < params.score_threshold) break;
+    alive[best] = 0;
+    results->push_back({candidates->box_index[best],
+                        candidates->class_index[best], scores[best]});
+    ComputeIou(*candidates, best, iou.data());
+    for (int j = 0; j < n; ++j) {
+      scores[j] *= std::exp(scale * iou[j] * iou[j]);
+    }
+  }
+}
+
+float Sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+
+// Returns a pointer to the dequantized content of `tensor`, using `buffer` as
+// storage if needed.
+tflite::support::StatusOr<const float*> DequantizeTensor(
+    const TfLiteTensor* tensor, std::vector<float>* buffer) {
+  // Quantized tensors have 1-byte elements.
+  const int size = tensor->bytes;
+  switch (tensor->type) {
+    case kTfLiteFloat32:
+      return reinterpret_cast<const float*>(tensor->data.raw);
+    case kTfLiteUInt8: {
+      buffer->resize(size);
+      const float scale = tensor->params.scale;
+      const int zero_point = tensor->params.zero_point;
+      for (int i = 0; i < size; ++i) {
+        (*buffer)[i] = scale * (tensor->data.uint8[i] - zero_point);
+      }
+      return buffer->data();
+    }
+    case kTfLiteInt8: {
+      buffer->resize(size);
+      const float scale = tensor->params.scale;
+      const int zero_point = tensor->params.zero_point;
+      for (int i = 0; i < size; ++i) {
+        (*buffer)[i] = scale * (tensor->data.int8[i] - zero_point);
+      }
+      return buffer->data();
+    }
+    default:
+      return CreateStatusWithPayload(
+          StatusCode::kInvalidArgument,
+          absl::StrFormat("Type mismatch for output tensor %s. Requested one "
+                          "of these types: kTfLiteFloat32/kTfLiteUInt8/"
+                          "kTfLiteInt8, got %s.",
+                          tensor->name, TfLiteTypeGetName(tensor->type)),
+          TfLiteSupportStatus::kInvalidOutputTensorTypeError);
+  }
+}
+
+// Checks that `tensor` has shape [1 x N x `last_dim`] or [N x `last_dim`] and
+// returns N. `last_dim` <= 0 accepts any last dimension.
+tflite::support::StatusOr<int> GetNumRows(const TfLiteTensor* tensor,
+                                          int tensor_index, int last_dim) {
+  const int num_dimensions = tensor->dims->size;
+  if ((num_dimensions != 2 && num_dimensions != 3) ||
+      (num_dimensions == 3 && tensor->dims->data[0] != 1) ||
+      (last_dim > 0 && tensor->dims->data[num_dimensions - 1] != last_dim)) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Unexpected dimensions for output index %d: expected "
+                        "[1 x N x %s] or [N x %s].",
+                        tensor_index,
+                        last_dim > 0 ? absl::StrCat(last_dim) : "M",
+                        last_dim > 0 ? absl::StrCat(last_dim) : "M"),
+        TfLiteSupportStatus::kInvalidOutputTensorDimensionsError);
+  }
+  return tensor->dims->data[num_dimensions - 2];
+}
+
+}  // namespace
+
+std::vector<DetectionCandidate> NonMaxSuppression(
+    const float* boxes, const float* scores, int num_boxes, int num_classes,
+    const NmsParameters& params) {
+  std::vector<DetectionCandidate> results;
+  std::vector<std::pair<float, int>> pairs;
+  Candidates candidates;
+  if (params.class_agnostic) {
+    // Each box only competes with its best class.
+    for (int b = 0; b < num_boxes; ++b) {
+      const float* box_scores = scores + b * num_classes;
+      int best = params.first_class;
+      for (int c = params.first_class + 1; c < num_classes; ++c) {
+        if (box_scores[c] > box_scores[best]) best = c;
+      }
+      if (best < num_classes && box_scores[best] >= params.score_threshold) {
+        pairs.emplace_back(box_scores[best], b * num_classes + best);
+      }
+    }
+    SelectTopK(params.max_candidates, &pairs);
+    for (const auto& pair : pairs) {
+      const int b = pair.second / num_classes;
+      candidates.Add(boxes + 4 * b, pair.first, b, pair.second % num_classes);
+    }
+    RunNms(params, &candidates, &results);
+  } else {
+    for (int c = params.first_class; c < num_classes; ++c) {
+      pairs.clear();
+      for (int b = 0; b < num_boxes; ++b) {
+        const float score = scores[b * num_classes + c];
+        if (score >= params.score_threshold) pairs.emplace_back(score, b);
+      }
+      SelectTopK(params.max_candidates, &pairs);
+      candidates = Candidates();
+      for (const auto& pair : pairs) {
+        candidates.Add(boxes + 4 * pair.second, pair.first, pair.second, c);
+      }
+      RunNms(params, &candidates, &results);
+    }
+  }
+  std::stable_sort(
+      results.begin(), results.end(),
+      [](const DetectionCandidate& a, const DetectionCandidate& b) {
+        return a.score > b.score;
+      });
+  if (params.max_detections >= 0 &&
+      results.size() > static_cast<size_t>(params.max_detections)) {
+    results.resize(params.max_detections);
+  }
+  return results;
+}
+
+/* static */
+tflite::support::StatusOr<std::unique_ptr<DetectionPostprocessor>>
+DetectionPostprocessor::Create(core::TfLiteEngine* engine,
+                               const std::initializer_list<int> output_indices,
+                               std::unique_ptr<DetectionOptions> options) {
+  ASSIGN_OR_RETURN(auto processor,
+                   Processor::Create<DetectionPostprocessor>(
+                       /* num_expected_tensors = */ 2, engine, output_indices,
+                       /* requires_metadata = */ false));
+
+  RETURN_IF_ERROR(processor->Init(std::move(options)));
+  return processor;
+}
+
+absl::Status DetectionPostprocessor::Init(
+    std::unique_ptr<DetectionOptions> options) {
+  options_ = std::move(options);
+  if (options_->max_results() == 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "Invalid `max_results` option: value must be != 0",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  if (options_->iou_threshold() < 0 || options_->iou_threshold() > 1) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "Invalid `iou_threshold` option: value must be in [0, 1]",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+
+  ASSIGN_OR_RETURN(num_boxes_,
+                   GetNumRows(GetTensor(0), tensor_indices_.at(0), 4));
+  ASSIGN_OR_RETURN(int num_score_rows,
+                   GetNumRows(GetTensor(1), tensor_indices_.at(1), 0));
+  if (num_score_rows != num_boxes_) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Got %d boxes for output index %d but %d rows of "
+                        "scores for output index %d.",
+                        num_boxes_, tensor_indices_.at(0), num_score_rows,
+                        tensor_indices_.at(1)),
+        TfLiteSupportStatus::kInvalidOutputTensorDimensionsError);
+  }
+  const TfLiteTensor* scores = GetTensor(1);
+  num_classes_ = scores->dims->data[scores->dims->size - 1];
+  const int first_class = options_->has_background_class() ? 1 : 0;
+  if (num_classes_ <= first_class) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Expected at least %d classes for output index %d, "
+                        "got %d.",
+                        first_class + 1, tensor_indices_.at(1), num_classes_),
+        TfLiteSupportStatus::kInvalidOutputTensorDimensionsError);
+  }
+
+  if (!options_->normalized_coordinates()) {
+    const TfLiteTensor* input = engine_->GetInput(engine_->interpreter(), 0);
+    if (input->dims->size != 4) {
+      return CreateStatusWithPayload(
+          StatusCode::kInvalidArgument,
+          "Pixel box coordinates require a [1 x H x W x C] input tensor.",
+          TfLiteSupportStatus::kInvalidInputTensorDimensionsError);
+    }
+    input_height_ = input->dims->data[1];
+    input_width_ = input->dims->data[2];
+  }
+
+  RETURN_IF_ERROR(InitAnchors());
+  RETURN_IF_ERROR(InitLabelsAndThreshold());
+
+  nms_parameters_.iou_threshold = options_->iou_threshold();
+  nms_parameters_.max_detections = options_->max_results();
+  // Any value <= 0 keeps all the candidates.
+  nms_parameters_.max_candidates =
+      options_->max_candidates() > 0 ? options_->max_candidates() : -1;
+  nms_parameters_.class_agnostic = options_->class_agnostic();
+  nms_parameters_.soft_nms_sigma = options_->soft_nms_sigma();
+  nms_parameters_.first_class = first_class;
+  if (options_->has_score_threshold()) {
+    nms_parameters_.score_threshold = options_->score_threshold();
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DetectionPostprocessor::InitAnchors() {
+  if (options_->box_format() != DetectionOptions::ANCHOR_ENCODED) {
+    return absl::OkStatus();
+  }
+  if (options_->anchors_size() > 0) {
+    anchors_.reserve(4 * options_->anchors_size());
+    for (const auto& anchor : options_->anchors()) {
+      anchors_.insert(anchors_.end(), {anchor.ycenter(), anchor.xcenter(),
+                                       anchor.height(), anchor.width()});
+    }
+  } else {
+    // The metadata schema has no anchor type: anchors are read from an
+    // associated file of the model.
+    ASSIGN_OR_RETURN(absl::string_view contents,
+                     GetMetadataExtractor()->GetAssociatedFile(
+                         options_->anchors_file_name()));
+    for (absl::string_view line : absl::StrSplit(contents, '\n')) {
+      std::vector<absl::string_view> values =
+          absl::StrSplit(line, absl::ByAnyChar(" ,\t\r"), absl::SkipEmpty());
+      if (values.empty()) continue;
+      float anchor[4];
+      if (values.size() != 4 || !absl::SimpleAtof(values[0], &anchor[0]) ||
+          !absl::SimpleAtof(values[1], &anchor[1]) ||
+          !absl::SimpleAtof(values[2], &anchor[2]) ||
+          !absl::SimpleAtof(values[3], &anchor[3])) {
+        return CreateStatusWithPayload(
+            StatusCode::kInvalidArgument,
+            absl::StrFormat("Invalid line in anchors file %s: '%s'.",
+                            options_->anchors_file_name(), line),
+            TfLiteSupportStatus::kMetadataInconsistencyError);
+      }
+      anchors_.insert(anchors_.end(), anchor, anchor + 4);
+    }
+  }
+  if (anchors_.size() != 4 * static_cast<size_t>(num_boxes_)) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Got %d anchors, expected %d according to output "
+                        "index %d.",
+                        anchors_.size() / 4, num_boxes_, tensor_indices_.at(0)),
+        TfLiteSupportStatus::kMetadataInconsistencyError);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DetectionPostprocessor::InitLabelsAndThreshold() {
+  const tflite::TensorMetadata* metadata = GetTensorMetadata(1);
+  if (metadata == nullptr) {
+    return absl::OkStatus();
+  }
+  ASSIGN_OR_RETURN(ClassificationHead head,
+                   BuildClassificationHead(*GetMetadataExtractor(), *metadata,
+                                           options_->display_names_locale()));
+  nms_parameters_.score_threshold = head.score_threshold;
+  const int first_class = options_->has_background_class() ? 1 : 0;
+  if (head.label_map_items.empty()) {
+    return absl::OkStatus();
+  }
+  const int num_labels = head.label_map_items.size();
+  if (num_labels == num_classes_) {
+    label_map_items_ = std::move(head.label_map_items);
+  } else if (num_labels == num_classes_ - first_class) {
+    // The label map does not list the background class.
+    label_map_items_.resize(first_class);
+    label_map_items_.insert(label_map_items_.end(),
+                            head.label_map_items.begin(),
+                            head.label_map_items.end());
+  } else {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        absl::StrFormat("Got %d class(es) for output index %d, expected %d "
+                        "according to the label map.",
+                        num_classes_, tensor_indices_.at(1), num_labels),
+        TfLiteSupportStatus::kMetadataInconsistencyError);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DetectionPostprocessor::DecodeBoxes() {
+  std::vector<float> dequantized;
+  ASSIGN_OR_RETURN(const float* raw,
+                   DequantizeTensor(GetTensor(0), &dequantized));
+  boxes_.resize(4 * num_boxes_);
+  const float y_norm = 1.0f / input_height_;
+  const float x_norm = 1.0f / input_width_;
+  for (int i = 0; i < num_boxes_; ++i) {
+    const float* in = raw + 4 * i;
+    float* out = boxes_.data() + 4 * i;
+    switch (options_->box_format()) {
+      case DetectionOptions::CORNERS:
+        out[0] = in[0] * y_norm;
+        out[1] = in[1] * x_norm;
+        out[2] = in[2] * y_norm;
+        out[3] = in[3] * x_norm;
+        break;
+      case DetectionOptions::CENTER_SIZE: {
+        const float xc = in[0] * x_norm;
+        const float yc = in[1] * y_norm;
+        const float w = in[2] * x_norm;
+        const float h = in[3] * y_norm;
+        out[0] = yc - h / 2;
+        out[1] = xc - w / 2;
+        out[2] = yc + h / 2;
+        out[3] = xc + w / 2;
+        break;
+      }
+      case DetectionOptions::ANCHOR_ENCODED: {
+        // Same decoding as the TFLite_Detection_PostProcess op.
+        const float* anchor = anchors_.data() + 4 * i;
+        const float yc = in[0] / options_->y_scale() * anchor[2] + anchor[0];
+        const float xc = in[1] / options_->x_scale() * anchor[3] + anchor[1];
+        const float h = std::exp(in[2] / options_->h_scale()) * anchor[2];
+        const float w = std::exp(in[3] / options_->w_scale()) * anchor[3];
+        out[0] = yc - h / 2;
+        out[1] = xc - w / 2;
+        out[2] = yc + h / 2;
+        out[3] = xc + w / 2;
+        break;
+      }
+      default:
+        return CreateStatusWithPayload(
+            StatusCode::kInvalidArgument,
+            absl::StrFormat("Unsupported box format: %d.",
+                            options_->box_format()),
+            TfLiteSupportStatus::kInvalidArgumentError);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DetectionPostprocessor::DecodeScores() {
+  ASSIGN_OR_RETURN(const float* raw, DequantizeTensor(GetTensor(1), &scores_));
+  const int size = num_boxes_ * num_classes_;
+  if (raw != scores_.data()) {
+    scores_.assign(raw, raw + size);
+  }
+  if (options_->score_activation() == DetectionOptions::SIGMOID) {
+    for (int i = 0; i < size; ++i) {
+      scores_[i] = Sigmoid(scores_[i]);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DetectionPostprocessor::Postprocess(
+    int image_width, int image_height, vision::DetectionResult* detections) {
+  detections->clear_detections();
+  RETURN_IF_ERROR(DecodeBoxes());
+  RETURN_IF_ERROR(DecodeScores());
+
+  const std::vector<DetectionCandidate> candidates =
+      NonMaxSuppression(boxes_.data(), scores_.data(), num_boxes_,
+                        num_classes_, nms_parameters_);
+
+  const int first_class = nms_parameters_.first_class;
+  for (const DetectionCandidate& candidate : candidates) {
+    const float* box = boxes_.data() + 4 * candidate.box_index;
+    const int x0 = std::max(
+        0, static_cast<int>(std::lround(box[1] * image_width)));
+    const int y0 = std::max(
+        0, static_cast<int>(std::lround(box[0] * image_height)));
+    const int x1 = std::min(
+        image_width, static_cast<int>(std::lround(box[3] * image_width)));
+    const int y1 = std::min(
+        image_height, static_cast<int>(std::lround(box[2] * image_height)));
+    if (x1 <= x0 || y1 <= y0) continue;
+
+    vision::Detection* detection = detections->add_detections();
+    vision::BoundingBox* bounding_box = detection->mutable_bounding_box();
+    bounding_box->set_origin_x(x0);
+    bounding_box->set_origin_y(y0);
+    bounding_box->set_width(x1 - x0);
+    bounding_box->set_height(y1 - y0);
+    vision::Class* detection_class = detection->add_classes();
+    detection_class->set_index(candidate.class_index - first_class);
+    detection_class->set_score(candidate.score);
+    if (!label_map_items_.empty()) {
+      const core::LabelMapItem& item =
+          label_map_items_[candidate.class_index];
+      detection_class->set_class_name(item.name);
+      detection_class->set_display_name(item.display_name);
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace processor
+}  // namespace task
+}  // namespace tflite
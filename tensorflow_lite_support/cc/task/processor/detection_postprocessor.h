@@ -0,0 +1,138 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_PROCESSOR_DETECTION_POSTPROCESSOR_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_PROCESSOR_DETECTION_POSTPROCESSOR_H_
+
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/core/label_map_item.h"
+#include "tensorflow_lite_support/cc/task/processor/processor.h"
+#include "tensorflow_lite_support/cc/task/processor/proto/detection_options.pb.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/detections_proto_inc.h"
+
+namespace tflite {
+namespace task {
+namespace processor {
+
+// Parameters of `NonMaxSuppression`.
+struct NmsParameters {
+  // Candidates with a lower score are discarded.
+  float score_threshold = 0.0f;
+  // Minimum IoU with a selected box for a box to be suppressed (hard NMS).
+  float iou_threshold = 0.5f;
+  // Maximum number of returned detections, or -1 for no limit.
+  int max_detections = -1;
+  // Number of highest scoring candidates kept before NMS, per class unless
+  // `class_agnostic` is set, or -1 for no limit.
+  int max_candidates = -1;
+  // Whether NMS runs once over the best class of each box, or independently
+  // for each class.
+  bool class_agnostic = false;
+  // If > 0, Gaussian soft-NMS is used with this sigma instead of hard NMS.
+  float soft_nms_sigma = 0.0f;
+  // Classes before this one (e.g. a background class) are ignored.
+  int first_class = 0;
+};
+
+// A detection selected by `NonMaxSuppression`.
+struct DetectionCandidate {
+  int box_index;
+  int class_index;
+  // The score, possibly decayed by soft-NMS.
+  float score;
+};
+
+// Selects the detections among `num_boxes` boxes given as [ymin, xmin, ymax,
+// xmax] corners in `boxes`, with `num_classes` scores each in `scores`.
+// Returns the selected detections sorted by decreasing score.
+//
+// Candidates are first filtered by score and top-k, then stored in a
+// structure of arrays so that the IoU of a selected box with all the
+// remaining candidates is computed by a single vectorizable loop.
+std::vector<DetectionCandidate> NonMaxSuppression(const float* boxes,
+                                                  const float* scores,
+                                                  int num_boxes,
+                                                  int num_classes,
+                                                  const NmsParameters& params);
+
+// This Postprocessor expects two output tensors with:
+//   (kTfLiteFloat32/kTfLiteUInt8/kTfLiteInt8)
+//    - boxes: `[1 x num_boxes x 4]` (or `[num_boxes x 4]`), in the layout
+//      given by `DetectionOptions.box_format`.
+//    - scores: `[1 x num_boxes x num_classes]` (or `[num_boxes x
+//      num_classes]`), optionally with TENSOR_AXIS_LABELS associated files
+//      used to fill the class names, and a ScoreThresholdingOptions process
+//      unit providing the default score threshold.
+//
+// This makes it possible to run models exported without the
+// TFLite_Detection_PostProcess custom op, e.g. with raw anchor-based or
+// YOLO-style heads.
+class DetectionPostprocessor : public Postprocessor {
+ public:
+  // `output_indices` are the indices of the boxes and scores tensors, in that
+  // order.
+  static tflite::support::StatusOr<std::unique_ptr<DetectionPostprocessor>>
+  Create(core::TfLiteEngine* engine,
+         const std::initializer_list<int> output_indices,
+         std::unique_ptr<DetectionOptions> options);
+
+  // Decodes the output tensors, runs non-max suppression and fills
+  // `detections` with the results sorted by decreasing score. Boxes are
+  // expressed in the pixels of an image of `image_width` x `image_height`,
+  // typically the upright input image, and clamped to it.
+  absl::Status Postprocess(int image_width, int image_height,
+                           vision::DetectionResult* detections);
+
+ private:
+  using Postprocessor::Postprocessor;
+
+  absl::Status Init(std::unique_ptr<DetectionOptions> options);
+  // Loads the anchors from the options or the box tensor metadata.
+  absl::Status InitAnchors();
+  // Loads the label map and default score threshold from the score tensor
+  // metadata, if any.
+  absl::Status InitLabelsAndThreshold();
+
+  // Decodes the box tensor into `boxes_`, as normalized corners.
+  absl::Status DecodeBoxes();
+  // Dequantizes and activates the score tensor into `scores_`.
+  absl::Status DecodeScores();
+
+  std::unique_ptr<DetectionOptions> options_;
+  NmsParameters nms_parameters_;
+  int num_boxes_ = 0;
+  int num_classes_ = 0;
+  // Size of the model input, used to normalize pixel coordinates.
+  int input_width_ = 1;
+  int input_height_ = 1;
+  // Anchors as [ycenter, xcenter, height, width], for ANCHOR_ENCODED boxes.
+  std::vector<float> anchors_;
+  // Label map of the score tensor, indexed by class index, if any.
+  std::vector<core::LabelMapItem> label_map_items_;
+  // Scratch buffers reused across calls.
+  std::vector<float> boxes_;
+  std::vector<float> scores_;
+};
+
+}  // namespace processor
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_PROCESSOR_DETECTION_POSTPROCESSOR_H_
@@ -40,8 +40,10 @@ class EmbeddingPostprocessor : public Postprocessor {
          const std::initializer_list<int> output_indices,
          std::unique_ptr<EmbeddingOptions> options);
 
+  // Fills `embedding` from the output tensor. `batch_index` selects the batch
+  // slot to read from when the model was run on a batch of inputs.
   template <typename T>
-  absl::Status Postprocess(T* embedding);
+  absl::Status Postprocess(T* embedding, int batch_index = 0);
 
   // Utility function to compute cosine similarity [1] between two feature
   // vectors. May return an InvalidArgumentError if e.g. the feature vectors are
@@ -77,13 +79,15 @@ class EmbeddingPostprocessor : public Postprocessor {
 };
 
 template <typename T>
-absl::Status EmbeddingPostprocessor::Postprocess(T* embedding) {
+absl::Status EmbeddingPostprocessor::Postprocess(T* embedding,
+                                                 int batch_index) {
   embedding->set_output_index(tensor_indices_.at(0));
   auto* feature_vector = embedding->mutable_feature_vector();
   if (GetTensor()->type == kTfLiteUInt8) {
     const uint8* output_data =
         engine_->interpreter()->typed_output_tensor<uint8>(
-            tensor_indices_.at(0));
+            tensor_indices_.at(0)) +
+        batch_index * embedding_dimension_;
     // Get the zero_point and scale parameters from the tensor metadata.
     const int output_tensor_index =
         engine_->interpreter()->outputs()[tensor_indices_.at(0)];
@@ -98,7 +102,8 @@ absl::Status EmbeddingPostprocessor::Postprocess(T* embedding) {
     // Float
     const float* output_data =
         engine_->interpreter()->typed_output_tensor<float>(
-            tensor_indices_.at(0));
+            tensor_indices_.at(0)) +
+        batch_index * embedding_dimension_;
     for (int j = 0; j < embedding_dimension_; ++j) {
       feature_vector->add_value_float(output_data[j]);
     }
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow_lite_support/cc/task/processor/image_preprocessor.h"
 
+#include <cstring>
+
+#include "absl/strings/str_format.h"  // from @com_google_absl
 #include "tensorflow_lite_support/cc/port/status_macros.h"
 #include "tensorflow_lite_support/cc/task/core/task_utils.h"
 #include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
@@ -87,7 +90,9 @@ absl::Status ImagePreprocessor::Init(
 
   // Some fixed-shape models do not have dims_signature.
   if (dims_signature != nullptr && dims_signature->size > 2) {
-    // Only the HxW dimensions support mutability.
+    // The batch dimension is only resized by `PreprocessBatch`, the HxW
+    // dimensions follow the size of the image.
+    is_batch_mutable_ = dims_signature->data[0] == -1;
     is_height_mutable_ = dims_signature->data[1] == -1;
     is_width_mutable_ = dims_signature->data[2] == -1;
   }
@@ -110,8 +115,7 @@ absl::Status ImagePreprocessor::Preprocess(const FrameBuffer& frame_buffer,
   const uint8* input_data;
   size_t input_data_byte_size;
 
-  // Optional buffers in case image preprocessing is needed.
-  std::unique_ptr<FrameBuffer> preprocessed_frame_buffer;
+  // Optional buffer in case image preprocessing is needed.
   std::vector<uint8> preprocessed_data;
 
   if (IsImagePreprocessingNeeded(frame_buffer, roi)) {
@@ -123,22 +127,12 @@ absl::Status ImagePreprocessor::Preprocess(const FrameBuffer& frame_buffer,
     input_specs_.image_height =
         is_height_mutable_ ? roi.height() : input_specs_.image_height;
 
-    FrameBuffer::Dimension to_buffer_dimension = {input_specs_.image_width,
-                                                  input_specs_.image_height};
-    input_data_byte_size =
-        GetBufferByteSize(to_buffer_dimension, FrameBuffer::Format::kRGB);
+    input_data_byte_size = GetPreprocessedByteSize();
     preprocessed_data.resize(input_data_byte_size / sizeof(uint8), 0);
     input_data = preprocessed_data.data();
 
-    FrameBuffer::Plane preprocessed_plane = {
-        /*buffer=*/preprocessed_data.data(),
-        /*stride=*/{input_specs_.image_width * kRgbPixelBytes, kRgbPixelBytes}};
-    preprocessed_frame_buffer = FrameBuffer::Create(
-        {preprocessed_plane}, to_buffer_dimension, FrameBuffer::Format::kRGB,
-        FrameBuffer::Orientation::kTopLeft);
-
-    RETURN_IF_ERROR(frame_buffer_utils_->Preprocess(
-        frame_buffer, roi, preprocessed_frame_buffer.get()));
+    RETURN_IF_ERROR(
+        CropResizeAndConvert(frame_buffer, roi, preprocessed_data.data()));
   } else {
     // Input frame buffer already targets model requirements: skip image
     // preprocessing. For RGB, the data is always stored in a single plane.
@@ -148,28 +142,200 @@ absl::Status ImagePreprocessor::Preprocess(const FrameBuffer& frame_buffer,
   }
 
   // If dynamic, it will re-dim the entire graph as per the input.
+  RETURN_IF_ERROR(ResizeInputTensorIfNeeded(/*batch_size=*/1));
+  // Then normalize pixel data (if needed) and populate the input tensor.
+  return PopulateBatchSlot(input_data, input_data_byte_size,
+                           /*batch_index=*/0);
+}
+
+absl::Status ImagePreprocessor::PreprocessBatch(
+    const FrameBuffer& frame_buffer, absl::Span<const BoundingBox> rois) {
+  if (rois.empty()) {
+    return tflite::support::CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "At least one region of interest must be provided.",
+        tflite::support::TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  if (rois.size() == 1) {
+    return Preprocess(frame_buffer, rois[0]);
+  }
+  if (!is_batch_mutable_) {
+    return tflite::support::CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "Batched preprocessing requires an input tensor with a dynamic batch "
+        "dimension.",
+        tflite::support::TfLiteSupportStatus::kInvalidArgumentError);
+  }
   if (is_height_mutable_ || is_width_mutable_) {
-    engine_->interpreter()->ResizeInputTensorStrict(
-        0, {GetTensor()->dims->data[0], input_specs_.image_height,
-            input_specs_.image_width, GetTensor()->dims->data[3]});
+    return tflite::support::CreateStatusWithPayload(
+        absl::StatusCode::kUnimplemented,
+        "Batched preprocessing is not supported for input tensors with a "
+        "dynamic height or width.");
+  }
 
-    engine_->interpreter()->AllocateTensors();
+  RETURN_IF_ERROR(ResizeInputTensorIfNeeded(rois.size()));
+  const size_t preprocessed_byte_size = GetPreprocessedByteSize();
+  // Quantized models take the RGB pixels as-is, so each region is cropped and
+  // resized straight into its batch slot. Float models go through a scratch
+  // buffer which is reused across regions, then get normalized.
+  const bool write_in_place = input_specs_.tensor_type == kTfLiteUInt8 &&
+                              GetTensor()->bytes / rois.size() ==
+                                  preprocessed_byte_size;
+  std::vector<uint8> preprocessed_data;
+  if (!write_in_place) {
+    preprocessed_data.resize(preprocessed_byte_size / sizeof(uint8), 0);
   }
-  // Then normalize pixel data (if needed) and populate the input tensor.
+  const int num_rois = rois.size();
+  for (int i = 0; i < num_rois; ++i) {
+    if (!IsImagePreprocessingNeeded(frame_buffer, rois[i])) {
+      RETURN_IF_ERROR(PopulateBatchSlot(
+          frame_buffer.plane(0).buffer,
+          frame_buffer.plane(0).stride.row_stride_bytes *
+              frame_buffer.dimension().height,
+          i));
+    } else if (write_in_place) {
+      RETURN_IF_ERROR(CropResizeAndConvert(
+          frame_buffer, rois[i],
+          GetTensor()->data.uint8 + i * preprocessed_byte_size));
+    } else {
+      RETURN_IF_ERROR(CropResizeAndConvert(frame_buffer, rois[i],
+                                           preprocessed_data.data()));
+      RETURN_IF_ERROR(PopulateBatchSlot(preprocessed_data.data(),
+                                        preprocessed_byte_size, i));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ImagePreprocessor::Stage(const FrameBuffer& frame_buffer,
+                                      const BoundingBox& roi,
+                                      StagedImage* staged_image) {
+  // `input_specs_` image dimensions are only written by `PreprocessStaged` for
+  // mutable dimensions, which are not read here.
+  staged_image->width =
+      is_width_mutable_ ? roi.width() : input_specs_.image_width;
+  staged_image->height =
+      is_height_mutable_ ? roi.height() : input_specs_.image_height;
+  const size_t byte_size = vision::GetBufferByteSize(
+      {staged_image->width, staged_image->height}, FrameBuffer::Format::kRGB);
+  staged_image->pixels.resize(byte_size / sizeof(uint8));
+
+  if (frame_buffer.format() == FrameBuffer::Format::kRGB &&
+      frame_buffer.orientation() == FrameBuffer::Orientation::kTopLeft &&
+      roi.origin_x() == 0 && roi.origin_y() == 0 &&
+      roi.width() == frame_buffer.dimension().width &&
+      roi.height() == frame_buffer.dimension().height &&
+      roi.width() == staged_image->width &&
+      roi.height() == staged_image->height &&
+      frame_buffer.plane(0).stride.row_stride_bytes *
+              frame_buffer.dimension().height ==
+          byte_size) {
+    // The frame buffer already has the expected layout: a copy is enough.
+    std::memcpy(staged_image->pixels.data(), frame_buffer.plane(0).buffer,
+                byte_size);
+    return absl::OkStatus();
+  }
+  FrameBuffer::Plane staged_plane = {
+      /*buffer=*/staged_image->pixels.data(),
+      /*stride=*/{staged_image->width * kRgbPixelBytes, kRgbPixelBytes}};
+  std::unique_ptr<FrameBuffer> staged_frame_buffer = FrameBuffer::Create(
+      {staged_plane}, {staged_image->width, staged_image->height},
+      FrameBuffer::Format::kRGB, FrameBuffer::Orientation::kTopLeft);
+  return frame_buffer_utils_->Preprocess(frame_buffer, roi,
+                                         staged_frame_buffer.get());
+}
+
+absl::Status ImagePreprocessor::PreprocessStaged(
+    const StagedImage& staged_image) {
+  if (is_width_mutable_) {
+    input_specs_.image_width = staged_image.width;
+  }
+  if (is_height_mutable_) {
+    input_specs_.image_height = staged_image.height;
+  }
+  if (staged_image.width != input_specs_.image_width ||
+      staged_image.height != input_specs_.image_height) {
+    return tflite::support::CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        absl::StrFormat("Staged image is %d x %d, expected %d x %d.",
+                        staged_image.width, staged_image.height,
+                        input_specs_.image_width, input_specs_.image_height),
+        tflite::support::TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  RETURN_IF_ERROR(ResizeInputTensorIfNeeded(/*batch_size=*/1));
+  return PopulateBatchSlot(staged_image.pixels.data(),
+                           staged_image.pixels.size() * sizeof(uint8),
+                           /*batch_index=*/0);
+}
+
+size_t ImagePreprocessor::GetPreprocessedByteSize() const {
+  return vision::GetBufferByteSize(
+      {input_specs_.image_width, input_specs_.image_height},
+      FrameBuffer::Format::kRGB);
+}
+
+absl::Status ImagePreprocessor::CropResizeAndConvert(
+    const FrameBuffer& frame_buffer, const BoundingBox& roi, uint8* output) {
+  FrameBuffer::Dimension to_buffer_dimension = {input_specs_.image_width,
+                                                input_specs_.image_height};
+  FrameBuffer::Plane preprocessed_plane = {
+      /*buffer=*/output,
+      /*stride=*/{input_specs_.image_width * kRgbPixelBytes, kRgbPixelBytes}};
+  std::unique_ptr<FrameBuffer> preprocessed_frame_buffer = FrameBuffer::Create(
+      {preprocessed_plane}, to_buffer_dimension, FrameBuffer::Format::kRGB,
+      FrameBuffer::Orientation::kTopLeft);
+  return frame_buffer_utils_->Preprocess(frame_buffer, roi,
+                                         preprocessed_frame_buffer.get());
+}
+
+absl::Status ImagePreprocessor::ResizeInputTensorIfNeeded(int batch_size) {
+  const TfLiteIntArray* dims = GetTensor()->dims;
+  if (dims->data[0] == batch_size &&
+      dims->data[1] == input_specs_.image_height &&
+      dims->data[2] == input_specs_.image_width) {
+    return absl::OkStatus();
+  }
+  auto* interpreter = engine_->interpreter();
+  if (interpreter->ResizeInputTensorStrict(
+          interpreter->inputs()[tensor_indices_.at(0)],
+          {batch_size, input_specs_.image_height, input_specs_.image_width,
+           dims->data[3]}) != kTfLiteOk) {
+    return tflite::support::CreateStatusWithPayload(
+        absl::StatusCode::kInternal,
+        absl::StrFormat("Failed to resize the input tensor to %d x %d x %d x "
+                        "%d.",
+                        batch_size, input_specs_.image_height,
+                        input_specs_.image_width, dims->data[3]));
+  }
+  // With a CPU placement, the reallocated arena is first touched on the node
+  // of the placement.
+  return engine_->AllocateTensors();
+}
+
+absl::Status ImagePreprocessor::PopulateBatchSlot(const uint8* input_data,
+                                                  size_t input_data_byte_size,
+                                                  int batch_index) {
+  TfLiteTensor* tensor = GetTensor();
+  const int batch_size = tensor->dims->data[0];
+  const size_t slot_byte_size = tensor->bytes / batch_size;
   switch (input_specs_.tensor_type) {
     case kTfLiteUInt8:
-      if (GetTensor()->bytes != input_data_byte_size) {
+      if (slot_byte_size != input_data_byte_size) {
         return tflite::support::CreateStatusWithPayload(
             absl::StatusCode::kInternal,
             "Size mismatch or unsupported padding bytes between pixel data "
             "and input tensor.");
       }
       // No normalization required: directly populate data.
-      RETURN_IF_ERROR(tflite::task::core::PopulateTensor(
-          input_data, input_data_byte_size / sizeof(uint8), GetTensor()));
+      if (batch_size == 1) {
+        return tflite::task::core::PopulateTensor(
+            input_data, input_data_byte_size / sizeof(uint8), tensor);
+      }
+      std::memcpy(tensor->data.uint8 + batch_index * slot_byte_size,
+                  input_data, input_data_byte_size);
       break;
     case kTfLiteFloat32: {
-      if (GetTensor()->bytes / sizeof(float) !=
+      if (slot_byte_size / sizeof(float) !=
           input_data_byte_size / sizeof(uint8)) {
         return tflite::support::CreateStatusWithPayload(
             absl::StatusCode::kInternal,
@@ -179,7 +345,8 @@ absl::Status ImagePreprocessor::Preprocess(const FrameBuffer& frame_buffer,
       // Normalize and populate.
       ASSIGN_OR_RETURN(
           float* normalized_input_data,
-          tflite::task::core::AssertAndReturnTypedTensor<float>(GetTensor()));
+          tflite::task::core::AssertAndReturnTypedTensor<float>(tensor));
+      normalized_input_data += batch_index * (slot_byte_size / sizeof(float));
       const tflite::task::vision::NormalizationOptions& normalization_options =
           input_specs_.normalization_options.value();
       for (int i = 0; i < normalization_options.num_values; i++) {
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_PROCESSOR_IMAGE_PREPROCESSOR_H_
 #define TENSORFLOW_LITE_SUPPORT_CC_TASK_PROCESSOR_IMAGE_PREPROCESSOR_H_
 
+#include <vector>
+
+#include "absl/types/span.h"  // from @com_google_absl
 #include "tensorflow_lite_support/cc/port/status_macros.h"
 #include "tensorflow_lite_support/cc/task/processor/processor.h"
 #include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
@@ -31,7 +34,8 @@ namespace processor {
 // Requirement for the input tensor:
 //   (kTfLiteUInt8/kTfLiteFloat32)
 //    - image input of size `[batch x height x width x channels]`.
-//    - batch inference is not supported (`batch` is required to be 1).
+//    - `batch` is required to be 1, unless it is dynamic in which case
+//      several regions of interest can be batched with `PreprocessBatch`.
 //    - only RGB inputs are supported (`channels` is required to be 3).
 //    - if type is kTfLiteFloat32, NormalizationOptions are required to be
 //      attached to the metadata for input normalization.
@@ -71,6 +75,44 @@ class ImagePreprocessor : public Preprocessor {
   absl::Status Preprocess(const vision::FrameBuffer& frame_buffer,
                           const vision::BoundingBox& roi);
 
+  // Same as above, for several regions of interest of the same frame buffer.
+  // The input tensor is resized to a batch of `rois.size()` and the i-th
+  // region is cropped, resized and converted into the i-th batch slot.
+  //
+  // Requires the batch dimension of the input tensor to be dynamic (i.e. -1 in
+  // its shape signature) when more than one region is provided, see
+  // `IsBatchSizeMutable`. Models with a dynamic image size are not supported.
+  // Subsequent calls to `Preprocess` reset the batch size to 1.
+  absl::Status PreprocessBatch(const vision::FrameBuffer& frame_buffer,
+                               absl::Span<const vision::BoundingBox> rois);
+
+  // An RGB image with the dimensions expected by the input tensor, prepared
+  // by `Stage` and consumed by `PreprocessStaged`.
+  struct StagedImage {
+    std::vector<uint8> pixels;
+    int width = 0;
+    int height = 0;
+  };
+
+  // Crops, resizes, converts and rotates the region of interest of
+  // `frame_buffer` into `staged_image`, like `Preprocess` does, but without
+  // touching the input tensor or the interpreter. The pixels vector is reused
+  // if it is large enough.
+  //
+  // This allows preparing the next image while the interpreter runs on the
+  // current one: `Stage` may be called concurrently with `PreprocessStaged`
+  // and inference, but not with itself or the other preprocessing methods.
+  absl::Status Stage(const vision::FrameBuffer& frame_buffer,
+                     const vision::BoundingBox& roi,
+                     StagedImage* staged_image);
+
+  // Normalizes (if needed) a staged image and populates the input tensor,
+  // resizing it first if the model has a dynamic image size.
+  absl::Status PreprocessStaged(const StagedImage& staged_image);
+
+  // Returns true if the model accepts batches of several images.
+  bool IsBatchSizeMutable() const { return is_batch_mutable_; }
+
   // Returns the spec of model. Passing in an image with this spec will speed up
   // the inference as it bypasses image cropping and resizing.
   const vision::ImageTensorSpecs& GetInputSpecs() const { return input_specs_; }
@@ -85,6 +127,25 @@ class ImagePreprocessor : public Preprocessor {
   absl::Status Init(
       const vision::FrameBufferUtils::ProcessEngine& process_engine);
 
+  // Returns the size in bytes of an RGB image with the dimensions of the
+  // input tensor.
+  size_t GetPreprocessedByteSize() const;
+
+  // Crops, resizes and converts the region of interest of `frame_buffer` to an
+  // RGB image with the dimensions of the input tensor, written to `output`.
+  absl::Status CropResizeAndConvert(const vision::FrameBuffer& frame_buffer,
+                                    const vision::BoundingBox& roi,
+                                    uint8* output);
+
+  // Resizes the input tensor and reallocates the graph if its current shape
+  // does not match `batch_size` and the input image specs.
+  absl::Status ResizeInputTensorIfNeeded(int batch_size);
+
+  // Normalizes (if needed) the RGB pixels in `input_data` and writes them to
+  // the `batch_index`-th slot of the input tensor.
+  absl::Status PopulateBatchSlot(const uint8* input_data,
+                                 size_t input_data_byte_size, int batch_index);
+
   // Parameters related to the input tensor which represents an image.
   vision::ImageTensorSpecs input_specs_;
 
@@ -92,6 +153,7 @@ class ImagePreprocessor : public Preprocessor {
   std::unique_ptr<vision::FrameBufferUtils> frame_buffer_utils_;
 
   // Is true if the model expects dynamic image shape, false otherwise.
+  bool is_batch_mutable_ = false;
   bool is_height_mutable_ = false;
   bool is_width_mutable_ = false;
 };
@@ -16,24 +16,36 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_CORE_BASE_VISION_TASK_API_H_
 #define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_CORE_BASE_VISION_TASK_API_H_
 
+#include <algorithm>
 #include <array>
+#include <cstdlib>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
 #include "absl/time/clock.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow_lite_support/cc/common.h"
 #include "tensorflow_lite_support/cc/port/integral_types.h"
 #include "tensorflow_lite_support/cc/port/status_macros.h"
 #include "tensorflow_lite_support/cc/task/core/base_task_api.h"
+#include "tensorflow_lite_support/cc/task/core/raw_output_tensor.h"
+#include "tensorflow_lite_support/cc/task/core/task_stats.h"
 #include "tensorflow_lite_support/cc/task/core/task_utils.h"
 #include "tensorflow_lite_support/cc/task/core/tflite_engine.h"
 #include "tensorflow_lite_support/cc/task/processor/image_preprocessor.h"
 #include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
 #include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
 #include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
 #include "tensorflow_lite_support/cc/task/vision/utils/image_tensor_specs.h"
 #include "tensorflow_lite_support/metadata/metadata_schema_generated.h"
@@ -52,10 +64,101 @@ class BaseVisionTaskApi
       : tflite::task::core::BaseTaskApi<OutputType, const FrameBuffer&,
                                         const BoundingBox&>(std::move(engine)) {
   }
+  // Subclasses using `InferAsync` must call `StopAsyncInference` in their own
+  // destructor, as the inference thread calls their `Postprocess` method.
+  ~BaseVisionTaskApi() override { StopAsyncInference(); }
   // BaseVisionTaskApi is neither copyable nor movable.
   BaseVisionTaskApi(const BaseVisionTaskApi&) = delete;
   BaseVisionTaskApi& operator=(const BaseVisionTaskApi&) = delete;
 
+  using tflite::task::core::BaseTaskApi<OutputType, const FrameBuffer&,
+                                        const BoundingBox&>::InferRaw;
+
+  // Same as `InferRaw(frame_buffer, roi)`, with a region of interest covering
+  // the whole frame buffer.
+  tflite::support::StatusOr<absl::Span<const core::RawOutputTensor>> InferRaw(
+      const FrameBuffer& frame_buffer) {
+    BoundingBox roi;
+    roi.set_width(frame_buffer.dimension().width);
+    roi.set_height(frame_buffer.dimension().height);
+    return this->InferRaw(frame_buffer, roi);
+  }
+
+  // Options for the video mode, where the result of the previous inference is
+  // reused as long as the incoming frames are almost identical to the frame it
+  // was computed on, e.g. for mostly static cameras.
+  //
+  // Frames are compared through a downsampled luma thumbnail, read directly
+  // from the Y plane of YUV frame buffers.
+  struct VideoModeOptions {
+    // The video mode is opt-in: by default, inference runs on every frame.
+    bool enabled = false;
+    // Mean absolute difference between luma thumbnails, in [0, 255], under
+    // which the previous result is reused.
+    float change_threshold = 2.0f;
+    // Maximum number of consecutive frames for which the previous result is
+    // reused, after which inference runs regardless of the change. 0 disables
+    // skipping.
+    int max_skipped_frames = 15;
+    // Width and height of the luma thumbnails.
+    int thumbnail_size = 32;
+  };
+
+  // Frame counters of the video mode.
+  struct VideoModeStats {
+    // Frames on which inference ran.
+    int64 executed_frames = 0;
+    // Frames for which the previous result was reused.
+    int64 skipped_frames = 0;
+  };
+
+  // Sets the video mode options, and resets the reference frame and the
+  // counters.
+  void SetVideoModeOptions(const VideoModeOptions& video_mode_options) {
+    video_mode_options_ = video_mode_options;
+    video_mode_stats_ = VideoModeStats();
+    has_video_reference_ = false;
+  }
+
+  // Returns the video mode counters since the last `SetVideoModeOptions`.
+  VideoModeStats GetVideoModeStats() const { return video_mode_stats_; }
+
+  // Receives the result of an asynchronous inference.
+  using AsyncCallback =
+      std::function<void(tflite::support::StatusOr<OutputType> result)>;
+
+  // Options for asynchronous inference.
+  struct AsyncOptions {
+    // Maximum number of frames accepted but not yet delivered to their
+    // callback, including the frame being inferred.
+    int max_in_flight_frames = 2;
+    // What to do with a new frame when `max_in_flight_frames` are in flight:
+    // drop it (the asynchronous method returns an `kUnavailable` status and
+    // the callback is never called) or block until a frame completes.
+    bool drop_frames_when_full = true;
+  };
+
+  // Sets the options used for asynchronous inference. Must be called before
+  // any asynchronous inference is performed.
+  void SetAsyncOptions(const AsyncOptions& async_options) {
+    absl::MutexLock lock(&async_mutex_);
+    async_options_ = async_options;
+  }
+
+  // Blocks until the callbacks of all the frames accepted for asynchronous
+  // inference have returned.
+  void WaitForAsyncInferences() {
+    absl::MutexLock lock(&async_mutex_);
+    async_mutex_.Await(absl::Condition(this, &BaseVisionTaskApi::AsyncIdle));
+  }
+
+  // Returns the number of frames dropped since creation because too many
+  // frames were in flight.
+  int64 GetDroppedFrameCount() const {
+    absl::MutexLock lock(&async_mutex_);
+    return dropped_frames_;
+  }
+
   // Sets the ProcessEngine used for image pre-processing. Must be called before
   // any inference is performed. Can be called between inferences to override
   // the current process engine.
@@ -117,13 +220,351 @@ class BaseVisionTaskApi
     return preprocessor_->Preprocess(frame_buffer, roi);
   }
 
+  // Same as `InferWithFallback`, except that in video mode the previous result
+  // is returned without running inference if `frame_buffer` barely changed,
+  // see `VideoModeOptions`.
+  tflite::support::StatusOr<OutputType> InferVideoFrame(
+      const FrameBuffer& frame_buffer, const BoundingBox& roi) {
+    if (!video_mode_options_.enabled) {
+      return this->InferWithFallback(frame_buffer, roi);
+    }
+    ASSIGN_OR_RETURN(bool skip, SkipVideoFrame(frame_buffer, roi));
+    if (skip) {
+      return video_reference_result_;
+    }
+    ASSIGN_OR_RETURN(OutputType result,
+                     this->InferWithFallback(frame_buffer, roi));
+    SetVideoReference(frame_buffer, roi, result);
+    return result;
+  }
+
+  // Same as `InferVideoFrame`, except that the output is written to `result`
+  // through `PostprocessInto`, reusing the memory it already holds. On error,
+  // the contents of `result` are unspecified.
+  absl::Status InferVideoFrameInto(const FrameBuffer& frame_buffer,
+                                   const BoundingBox& roi, OutputType* result) {
+    if (!video_mode_options_.enabled) {
+      return this->InferWithFallbackInto(frame_buffer, roi, result);
+    }
+    ASSIGN_OR_RETURN(bool skip, SkipVideoFrame(frame_buffer, roi));
+    if (skip) {
+      *result = video_reference_result_;
+      return absl::OkStatus();
+    }
+    RETURN_IF_ERROR(this->InferWithFallbackInto(frame_buffer, roi, result));
+    SetVideoReference(frame_buffer, roi, *result);
+    return absl::OkStatus();
+  }
+
+  // Performs inference on several regions of interest of the same frame
+  // buffer and returns one result per region, in the same order.
+  //
+  // If the model input has a dynamic batch dimension, all the regions are
+  // preprocessed into consecutive batch slots of the input tensor and a single
+  // inference is run. Otherwise, the regions go through `InferWithFallback`
+  // one at a time. Subclasses overriding `Preprocess` must not rely on the
+  // batched path, since it populates the input tensor directly.
+  tflite::support::StatusOr<std::vector<OutputType>> InferRois(
+      const FrameBuffer& frame_buffer, absl::Span<const BoundingBox> rois) {
+    std::vector<OutputType> results;
+    results.reserve(rois.size());
+    if (rois.size() <= 1 || preprocessor_ == nullptr ||
+        !preprocessor_->IsBatchSizeMutable()) {
+      for (const BoundingBox& roi : rois) {
+        ASSIGN_OR_RETURN(OutputType result,
+                         this->InferWithFallback(frame_buffer, roi));
+        results.push_back(std::move(result));
+      }
+      return results;
+    }
+
+    // Resizing the batch allocates the tensors, with the thread pinned and
+    // under the shared CPU context lease if any.
+    core::BaseUntypedTaskApi::ScopedInference inference(this);
+    RETURN_IF_ERROR(inference.status());
+    // The whole batch is recorded as one inference in the statistics, with
+    // the same stages as `InferWithFallback`.
+    core::TaskStatsRecorder* stats = inference.stats();
+    const absl::Time preprocess_start =
+        stats != nullptr ? absl::Now() : absl::Time();
+    absl::Status status = preprocessor_->PreprocessBatch(frame_buffer, rois);
+    if (stats != nullptr) {
+      stats->preprocess().Record(absl::Now() - preprocess_start);
+      if (status.ok()) {
+        int64_t bytes = 0;
+        for (const TfLiteTensor* input_tensor : this->GetInputTensors()) {
+          bytes += input_tensor->bytes;
+        }
+        stats->RecordInputBytes(bytes);
+      }
+    }
+    RETURN_IF_ERROR(status);
+    RETURN_IF_ERROR(this->InvokeWithFallback());
+    const absl::Time postprocess_start =
+        stats != nullptr ? absl::Now() : absl::Time();
+    const std::vector<const TfLiteTensor*> output_tensors =
+        this->GetOutputTensors();
+    const int num_rois = rois.size();
+    for (const TfLiteTensor* output_tensor : output_tensors) {
+      if (output_tensor->dims->size == 0 ||
+          output_tensor->dims->data[0] != num_rois) {
+        return tflite::support::CreateStatusWithPayload(
+            absl::StatusCode::kInternal,
+            absl::StrFormat("Expected output tensor %s to have a batch size "
+                            "of %d.",
+                            output_tensor->name, num_rois));
+      }
+    }
+    for (int i = 0; i < num_rois; ++i) {
+      ASSIGN_OR_RETURN(OutputType result,
+                       PostprocessBatchSlot(output_tensors, i, frame_buffer,
+                                            rois[i]));
+      results.push_back(std::move(result));
+    }
+    if (stats != nullptr) {
+      stats->postprocess().Record(absl::Now() - postprocess_start);
+    }
+    return results;
+  }
+
+  // Post-processes the outputs of the `batch_index`-th region of a batched
+  // inference. The default implementation calls `Postprocess` on shallow
+  // copies of the output tensors whose data points to that batch slot (their
+  // `dims` still describe the whole batch). Subclasses which do not read the
+  // output data through `output_tensors` must override this method.
+  virtual tflite::support::StatusOr<OutputType> PostprocessBatchSlot(
+      const std::vector<const TfLiteTensor*>& output_tensors, int batch_index,
+      const FrameBuffer& frame_buffer, const BoundingBox& roi) {
+    std::vector<TfLiteTensor> slices;
+    slices.reserve(output_tensors.size());
+    std::vector<const TfLiteTensor*> slice_pointers;
+    slice_pointers.reserve(output_tensors.size());
+    for (const TfLiteTensor* output_tensor : output_tensors) {
+      slices.push_back(*output_tensor);
+      TfLiteTensor& slice = slices.back();
+      slice.bytes = output_tensor->bytes / output_tensor->dims->data[0];
+      slice.data.raw = output_tensor->data.raw + batch_index * slice.bytes;
+      slice_pointers.push_back(&slice);
+    }
+    return this->Postprocess(slice_pointers, frame_buffer, roi);
+  }
+
+  // Performs inference on the region of interest of `frame_buffer` on a
+  // background thread and calls `callback` with the result, on that thread.
+  //
+  // The frame is cropped, resized and converted on the caller thread into a
+  // staging buffer, so that `frame_buffer` can be released as soon as this
+  // method returns, and so that preparing a frame overlaps with inference on
+  // the previous one. Callbacks are called in the order frames were accepted.
+  //
+  // `Postprocess` then receives a frame buffer with the dimension, format and
+  // orientation of `frame_buffer` but without any pixel data. Calls must not
+  // be concurrent with each other nor with synchronous inference, which must
+  // not be performed either while frames are in flight, see
+  // `WaitForAsyncInferences`.
+  absl::Status InferAsync(const FrameBuffer& frame_buffer,
+                          const BoundingBox& roi, AsyncCallback callback) {
+    if (preprocessor_ == nullptr) {
+      return tflite::support::CreateStatusWithPayload(
+          absl::StatusCode::kInternal,
+          "Uninitialized preprocessor: CheckAndSetInputs must be called "
+          "at initialization time.");
+    }
+    AsyncFrame frame;
+    {
+      absl::MutexLock lock(&async_mutex_);
+      if (async_stopped_) {
+        return tflite::support::CreateStatusWithPayload(
+            absl::StatusCode::kFailedPrecondition,
+            "Asynchronous inference has been stopped.");
+      }
+      if (!AsyncSlotAvailable()) {
+        if (async_options_.drop_frames_when_full) {
+          ++dropped_frames_;
+          return tflite::support::CreateStatusWithPayload(
+              absl::StatusCode::kUnavailable,
+              absl::StrFormat("Frame dropped: %d frames are already in "
+                              "flight.",
+                              async_in_flight_));
+        }
+        async_mutex_.Await(
+            absl::Condition(this, &BaseVisionTaskApi::AsyncSlotAvailable));
+      }
+      ++async_in_flight_;
+      if (!free_staged_images_.empty()) {
+        frame.staged_image = std::move(free_staged_images_.back());
+        free_staged_images_.pop_back();
+      }
+      if (!async_thread_.joinable()) {
+        async_thread_ = std::thread([this] { RunAsyncInferences(); });
+      }
+    }
+
+    // Staging runs outside of the lock so that it overlaps with inference.
+    absl::Status status =
+        preprocessor_->Stage(frame_buffer, roi, &frame.staged_image);
+    if (!status.ok()) {
+      absl::MutexLock lock(&async_mutex_);
+      // The staging buffer may have been resized, keep it for the next frame.
+      free_staged_images_.push_back(std::move(frame.staged_image));
+      --async_in_flight_;
+      return status;
+    }
+    frame.frame_buffer = FrameBuffer::Create(
+        std::vector<FrameBuffer::Plane>(), frame_buffer.dimension(),
+        frame_buffer.format(), frame_buffer.orientation(),
+        frame_buffer.timestamp());
+    frame.roi = roi;
+    frame.callback = std::move(callback);
+    absl::MutexLock lock(&async_mutex_);
+    async_queue_.push_back(std::move(frame));
+    return absl::OkStatus();
+  }
+
+  // Waits for the frames in flight and stops the inference thread. Further
+  // calls to `InferAsync` fail.
+  void StopAsyncInference() {
+    {
+      absl::MutexLock lock(&async_mutex_);
+      if (async_stopped_) return;
+      async_stopped_ = true;
+    }
+    if (async_thread_.joinable()) {
+      async_thread_.join();
+    }
+  }
+
   // Returns the spec for the input image.
   const vision::ImageTensorSpecs& GetInputSpecs() const {
     return preprocessor_->GetInputSpecs();
   }
 
  private:
+  // A frame accepted for asynchronous inference.
+  struct AsyncFrame {
+    processor::ImagePreprocessor::StagedImage staged_image;
+    // The source frame buffer metadata, without pixel data.
+    std::unique_ptr<FrameBuffer> frame_buffer;
+    BoundingBox roi;
+    AsyncCallback callback;
+  };
+
+  bool AsyncSlotAvailable() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(async_mutex_) {
+    return async_in_flight_ < std::max(1, async_options_.max_in_flight_frames);
+  }
+
+  bool AsyncIdle() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(async_mutex_) {
+    return async_in_flight_ == 0;
+  }
+
+  bool AsyncFrameReadyOrStopped() const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(async_mutex_) {
+    return !async_queue_.empty() || (async_stopped_ && async_in_flight_ == 0);
+  }
+
+  // Computes the thumbnail of `frame_buffer` and returns whether it barely
+  // changed from the video reference, in which case the frame is counted as
+  // skipped.
+  tflite::support::StatusOr<bool> SkipVideoFrame(
+      const FrameBuffer& frame_buffer, const BoundingBox& roi) {
+    const int thumbnail_size = std::max(1, video_mode_options_.thumbnail_size);
+    RETURN_IF_ERROR(ComputeLumaThumbnail(frame_buffer, thumbnail_size,
+                                         thumbnail_size, &luma_thumbnail_));
+    if (has_video_reference_ &&
+        skipped_video_frames_ < video_mode_options_.max_skipped_frames &&
+        frame_buffer.dimension() == video_reference_dimension_ &&
+        frame_buffer.orientation() == video_reference_orientation_ &&
+        roi.origin_x() == video_reference_roi_.origin_x() &&
+        roi.origin_y() == video_reference_roi_.origin_y() &&
+        roi.width() == video_reference_roi_.width() &&
+        roi.height() == video_reference_roi_.height() &&
+        luma_thumbnail_.size() == video_reference_thumbnail_.size()) {
+      const int num_pixels = luma_thumbnail_.size();
+      int64 total_difference = 0;
+      for (int i = 0; i < num_pixels; ++i) {
+        total_difference += std::abs(static_cast<int>(luma_thumbnail_[i]) -
+                                     video_reference_thumbnail_[i]);
+      }
+      if (total_difference <
+          video_mode_options_.change_threshold * num_pixels) {
+        ++skipped_video_frames_;
+        ++video_mode_stats_.skipped_frames;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Makes the frame whose thumbnail was last computed by `SkipVideoFrame`,
+  // and its `result`, the video reference.
+  void SetVideoReference(const FrameBuffer& frame_buffer,
+                         const BoundingBox& roi, const OutputType& result) {
+    ++video_mode_stats_.executed_frames;
+    // The reference is the last inferred frame, not the last seen one, so
+    // that a slow drift eventually triggers an inference.
+    video_reference_thumbnail_.swap(luma_thumbnail_);
+    video_reference_dimension_ = frame_buffer.dimension();
+    video_reference_orientation_ = frame_buffer.orientation();
+    video_reference_roi_ = roi;
+    video_reference_result_ = result;
+    has_video_reference_ = true;
+    skipped_video_frames_ = 0;
+  }
+
+  tflite::support::StatusOr<OutputType> InferStaged(const AsyncFrame& frame) {
+    core::BaseUntypedTaskApi::ScopedInference inference(this);
+    RETURN_IF_ERROR(inference.status());
+    RETURN_IF_ERROR(preprocessor_->PreprocessStaged(frame.staged_image));
+    RETURN_IF_ERROR(this->InvokeWithFallback());
+    return this->PostprocessWithStats(*frame.frame_buffer, frame.roi);
+  }
+
+  // Body of the inference thread. Frames are inferred one at a time, in
+  // order, and their staging buffers are recycled.
+  void RunAsyncInferences() {
+    while (true) {
+      AsyncFrame frame;
+      {
+        absl::MutexLock lock(&async_mutex_);
+        async_mutex_.Await(absl::Condition(
+            this, &BaseVisionTaskApi::AsyncFrameReadyOrStopped));
+        if (async_queue_.empty()) return;
+        frame = std::move(async_queue_.front());
+        async_queue_.pop_front();
+      }
+      frame.callback(InferStaged(frame));
+      absl::MutexLock lock(&async_mutex_);
+      free_staged_images_.push_back(std::move(frame.staged_image));
+      --async_in_flight_;
+    }
+  }
+
   std::unique_ptr<processor::ImagePreprocessor> preprocessor_ = nullptr;
+
+  VideoModeOptions video_mode_options_;
+  VideoModeStats video_mode_stats_;
+  // The frame on which inference last ran in video mode, and its result.
+  bool has_video_reference_ = false;
+  std::vector<uint8> video_reference_thumbnail_;
+  FrameBuffer::Dimension video_reference_dimension_;
+  FrameBuffer::Orientation video_reference_orientation_;
+  BoundingBox video_reference_roi_;
+  OutputType video_reference_result_;
+  int skipped_video_frames_ = 0;
+  // Scratch buffer for the thumbnail of the current frame.
+  std::vector<uint8> luma_thumbnail_;
+
+  mutable absl::Mutex async_mutex_;
+  AsyncOptions async_options_ ABSL_GUARDED_BY(async_mutex_);
+  std::thread async_thread_;
+  // Frames staged and waiting for inference.
+  std::deque<AsyncFrame> async_queue_ ABSL_GUARDED_BY(async_mutex_);
+  // Staging buffers of completed frames, reused by the next frames.
+  std::vector<processor::ImagePreprocessor::StagedImage> free_staged_images_
+      ABSL_GUARDED_BY(async_mutex_);
+  int async_in_flight_ ABSL_GUARDED_BY(async_mutex_) = 0;
+  int64 dropped_frames_ ABSL_GUARDED_BY(async_mutex_) = 0;
+  bool async_stopped_ ABSL_GUARDED_BY(async_mutex_) = false;
 };
 
 }  // namespace vision
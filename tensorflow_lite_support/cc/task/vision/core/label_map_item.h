@@ -15,13 +15,15 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_CORE_LABEL_MAP_ITEM_H_
 #define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_CORE_LABEL_MAP_ITEM_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"  // from @com_google_absl
-#include "absl/container/flat_hash_set.h"  // from @com_google_absl
+#include "absl/container/inlined_vector.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "tensorflow_lite_support/cc/port/statusor.h"
 
 namespace tflite {
@@ -58,6 +60,15 @@ tflite::support::StatusOr<std::vector<LabelMapItem>> BuildLabelMapFromFiles(
 // hierarchy, e.g. if both "fruit" and "banana" have been inferred by a given
 // classifier model prune "fruit" from the final results as "banana" is a more
 // fine-grained descendant.
+//
+// The hierarchy is compiled at initialization time into integer label ids, so
+// that ancestor queries are constant-time and do not allocate:
+// - if every label has at most one parent (i.e. the hierarchy is a forest),
+//   each label is assigned the interval of its subtree in a depth-first
+//   traversal, and a label is an ancestor of another if its interval strictly
+//   contains the other one,
+// - otherwise, the transitive closure of the parent relation is stored as one
+//   bitset of ancestors per label, i.e. num_labels^2 bits.
 class LabelHierarchy {
  public:
   LabelHierarchy() = default;
@@ -72,22 +83,90 @@ class LabelHierarchy {
   // hierarchy of labels. Invalid names, i.e. names which do not exist in the
   // label map used at initialization time, are ignored.
   bool HaveAncestorDescendantRelationship(
-      const std::string& ancestor_name,
-      const std::string& descendant_name) const;
+      absl::string_view ancestor_name, absl::string_view descendant_name) const;
+
+  // Returns the id of the label `name`, or -1 if it does not exist in the
+  // label map used at initialization time. Ids are in [0, GetNumLabels()[.
+  int GetLabelId(absl::string_view name) const;
+
+  // Returns the number of labels in the hierarchy, i.e. labels either listed
+  // in the label map or referenced as a child.
+  int GetNumLabels() const { return names_.size(); }
+
+  // Returns the name of the label with id `label_id`.
+  const std::string& GetLabelName(int label_id) const {
+    return names_[label_id];
+  }
+
+  // Returns the ids of the direct parents of `label_id`.
+  absl::Span<const int> GetParentIds(int label_id) const;
+
+  // Returns true if `descendant_id` is a descendant of `ancestor_id`. Ids out
+  // of range are ignored.
+  bool IsAncestor(int ancestor_id, int descendant_id) const;
+
+  // Returns the closest ancestor of `label_id` among `candidate_ids`, or
+  // `label_id` itself if it belongs to `candidate_ids`, or -1 if there is
+  // none. E.g. this collapses fine-grained labels to a coarser set of labels.
+  // Ties are resolved in favor of the first candidate.
+  int CollapseToAncestor(int label_id, absl::Span<const int> candidate_ids)
+      const;
+
+  // Removes from each head of `result` the classes which are an ancestor of
+  // another class of the same head, keeping the order of the remaining
+  // classes. Classes whose name is not in the hierarchy are kept.
+  //
+  // `ClassificationResultT` is any ClassificationResult proto, with repeated
+  // `classifications` holding repeated `classes` with a `class_name`.
+  template <typename ClassificationResultT>
+  void PruneAncestors(ClassificationResultT* result) const;
 
  private:
-  // Retrieve and return all parent names, if any, for the input label name.
-  absl::flat_hash_set<std::string> GetParents(const std::string& name) const;
-
-  // Retrieve all ancestor names, if any, for the input label name.
-  void GetAncestors(const std::string& name,
-                    absl::flat_hash_set<std::string>* ancestors) const;
-
-  // Label name (key) to parent names (value) direct mapping.
-  absl::flat_hash_map<std::string, absl::flat_hash_set<std::string>>
-      parents_map_;
+  // Number of 64-bit words per row of `ancestor_bits_`.
+  int NumWordsPerRow() const { return (names_.size() + 63) / 64; }
+
+  // Label name (key) to label id (value) mapping.
+  absl::flat_hash_map<std::string, int> ids_;
+  // Label names, indexed by id.
+  std::vector<std::string> names_;
+  // Direct parents of the label with id `i`, stored in
+  // `parent_ids_[parent_offsets_[i]:parent_offsets_[i + 1]]`.
+  std::vector<int> parent_offsets_;
+  std::vector<int> parent_ids_;
+  // Whether the hierarchy is a forest, encoded by `enter_` and `exit_`.
+  bool is_forest_ = false;
+  // Pre-order index of each label, and pre-order index past the end of its
+  // subtree, for forests.
+  std::vector<int> enter_;
+  std::vector<int> exit_;
+  // Row-major ancestor bitsets, for general hierarchies: bit `a` of row `d`
+  // is set iff `a` is an ancestor of `d`.
+  std::vector<uint64_t> ancestor_bits_;
 };
 
+template <typename ClassificationResultT>
+void LabelHierarchy::PruneAncestors(ClassificationResultT* result) const {
+  for (auto& classifications : *result->mutable_classifications()) {
+    auto* classes = classifications.mutable_classes();
+    absl::InlinedVector<int, 16> label_ids;
+    label_ids.reserve(classes->size());
+    for (const auto& label : *classes) {
+      label_ids.push_back(GetLabelId(label.class_name()));
+    }
+    int kept = 0;
+    for (int i = 0; i < label_ids.size(); ++i) {
+      bool is_ancestor = false;
+      for (int j = 0; j < label_ids.size() && !is_ancestor; ++j) {
+        is_ancestor = IsAncestor(label_ids[i], label_ids[j]);
+      }
+      if (is_ancestor) continue;
+      if (kept != i) classes->SwapElements(kept, i);
+      ++kept;
+    }
+    classes->DeleteSubrange(kept, classes->size() - kept);
+  }
+}
+
 }  // namespace vision
 }  // namespace task
 }  // namespace tflite
@@ -0,0 +1,375 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/detection_cascade.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <utility>
+
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/time/clock.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+namespace {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::StatusOr;
+using ::tflite::support::TfLiteSupportStatus;
+
+// Number of bytes required for 8-bit per pixel RGB color space.
+constexpr int kRgbPixelBytes = 3;
+
+// Copies the pixels of an RGB frame buffer to a tightly packed buffer.
+void CopyRgbPixels(const FrameBuffer& frame_buffer, uint8* output) {
+  const FrameBuffer::Plane& plane = frame_buffer.plane(0);
+  const int row_bytes = frame_buffer.dimension().width * kRgbPixelBytes;
+  for (int y = 0; y < frame_buffer.dimension().height; ++y) {
+    std::memcpy(output + y * row_bytes,
+                plane.buffer + y * plane.stride.row_stride_bytes, row_bytes);
+  }
+}
+
+// Clamps `box` to the frame, keeping at least one pixel so that it can be
+// cropped.
+BoundingBox ClampToFrame(const BoundingBox& box,
+                         FrameBuffer::Dimension dimension) {
+  const int x0 = std::min(std::max(box.origin_x(), 0), dimension.width - 1);
+  const int y0 = std::min(std::max(box.origin_y(), 0), dimension.height - 1);
+  const int x1 = std::min(box.origin_x() + box.width(), dimension.width);
+  const int y1 = std::min(box.origin_y() + box.height(), dimension.height);
+  BoundingBox result;
+  result.set_origin_x(x0);
+  result.set_origin_y(y0);
+  result.set_width(std::max(x1 - x0, 1));
+  result.set_height(std::max(y1 - y0, 1));
+  return result;
+}
+
+}  // namespace
+
+// A frame going through the cascade, along with the RGB images derived from
+// it.
+struct DetectionCascade::Frame {
+  // The full resolution RGB image. Points to the source frame when it is used
+  // in place.
+  const FrameBuffer* rgb = nullptr;
+  std::vector<uint8> rgb_data;
+  std::unique_ptr<FrameBuffer> owned_rgb;
+  // Successive halvings of `rgb`, the last of which is used for detection.
+  std::vector<std::vector<uint8>> pyramid_data;
+  std::vector<std::unique_ptr<FrameBuffer>> pyramid;
+  const FrameBuffer* detection = nullptr;
+
+  absl::Time start_time;
+  Result result;
+  absl::Status status;
+  Callback callback;
+};
+
+// A bounded blocking FIFO queue, used to hand frames over between stages.
+template <typename T>
+class DetectionCascade::Queue {
+ public:
+  explicit Queue(int capacity) : capacity_(capacity) {}
+
+  // Blocks while the queue is full.
+  void Push(T item) {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(this, &Queue::HasRoom));
+    items_.push_back(std::move(item));
+  }
+
+  // Blocks until an item is available and pops it. Returns false once the
+  // queue is closed and empty.
+  bool Pop(T* item) {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(this, &Queue::HasItemOrIsClosed));
+    if (items_.empty()) {
+      return false;
+    }
+    *item = std::move(items_.front());
+    items_.pop_front();
+    return true;
+  }
+
+  void Close() {
+    absl::MutexLock lock(&mutex_);
+    closed_ = true;
+  }
+
+ private:
+  bool HasRoom() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return static_cast<int>(items_.size()) < capacity_;
+  }
+  bool HasItemOrIsClosed() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !items_.empty() || closed_;
+  }
+
+  const int capacity_;
+  absl::Mutex mutex_;
+  std::deque<T> items_ ABSL_GUARDED_BY(mutex_);
+  bool closed_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+/* static */
+StatusOr<std::unique_ptr<DetectionCascade>> DetectionCascade::Create(
+    std::unique_ptr<ObjectDetector> detector,
+    std::unique_ptr<ImageClassifier> classifier, const Options& options) {
+  if (detector == nullptr || classifier == nullptr) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "Both an ObjectDetector and an ImageClassifier must be provided.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  if (options.detection_min_dimension < 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "Invalid `detection_min_dimension`: must be >= 0.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  if (options.max_queued_frames < 1) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "Invalid `max_queued_frames`: must be >= 1.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  return absl::WrapUnique(new DetectionCascade(
+      std::move(detector), std::move(classifier), options));
+}
+
+DetectionCascade::DetectionCascade(std::unique_ptr<ObjectDetector> detector,
+                                   std::unique_ptr<ImageClassifier> classifier,
+                                   const Options& options)
+    : detector_(std::move(detector)),
+      classifier_(std::move(classifier)),
+      options_(options),
+      frame_buffer_utils_(FrameBufferUtils::Create(options.process_engine)) {}
+
+DetectionCascade::~DetectionCascade() {
+  if (detection_thread_.joinable()) {
+    // The detection stage closes the classification queue once drained.
+    detection_queue_->Close();
+    detection_thread_.join();
+    classification_thread_.join();
+  }
+}
+
+StatusOr<DetectionCascade::Result> DetectionCascade::Process(
+    const FrameBuffer& frame_buffer) {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (in_flight_ > 0) {
+      return CreateStatusWithPayload(
+          StatusCode::kFailedPrecondition,
+          "Frames submitted to the pipeline are still in flight: Flush must "
+          "be called before Process.");
+    }
+  }
+  Frame frame;
+  RETURN_IF_ERROR(Preprocess(frame_buffer, /*copy=*/false, &frame));
+  RETURN_IF_ERROR(Detect(&frame));
+  RETURN_IF_ERROR(Classify(&frame));
+  return std::move(frame.result);
+}
+
+absl::Status DetectionCascade::Submit(const FrameBuffer& frame_buffer,
+                                      Callback callback) {
+  if (callback == nullptr) {
+    return CreateStatusWithPayload(StatusCode::kInvalidArgument,
+                                   "A callback must be provided.",
+                                   TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  StartPipeline();
+  auto frame = absl::make_unique<Frame>();
+  RETURN_IF_ERROR(Preprocess(frame_buffer, /*copy=*/true, frame.get()));
+  frame->callback = std::move(callback);
+  {
+    absl::MutexLock lock(&mutex_);
+    ++in_flight_;
+  }
+  detection_queue_->Push(std::move(frame));
+  return absl::OkStatus();
+}
+
+void DetectionCascade::Flush() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(this, &DetectionCascade::NoFrameInFlight));
+}
+
+DetectionCascade::Latencies DetectionCascade::GetLatencies() const {
+  absl::MutexLock lock(&mutex_);
+  return latencies_;
+}
+
+void DetectionCascade::ResetLatencies() {
+  absl::MutexLock lock(&mutex_);
+  latencies_ = Latencies();
+}
+
+absl::Status DetectionCascade::Preprocess(const FrameBuffer& frame_buffer,
+                                          bool copy, Frame* frame) {
+  frame->start_time = absl::Now();
+  const FrameBuffer::Dimension dimension = frame_buffer.dimension();
+  if (frame_buffer.format() == FrameBuffer::Format::kRGB && !copy) {
+    frame->rgb = &frame_buffer;
+  } else {
+    frame->rgb_data.resize(
+        GetBufferByteSize(dimension, FrameBuffer::Format::kRGB));
+    frame->owned_rgb = CreateFromRgbRawBuffer(
+        frame->rgb_data.data(), dimension, frame_buffer.orientation(),
+        frame_buffer.timestamp());
+    if (frame_buffer.format() == FrameBuffer::Format::kRGB) {
+      CopyRgbPixels(frame_buffer, frame->rgb_data.data());
+    } else {
+      RETURN_IF_ERROR(
+          frame_buffer_utils_->Convert(frame_buffer, frame->owned_rgb.get()));
+    }
+    frame->rgb = frame->owned_rgb.get();
+  }
+
+  // Halving repeatedly rather than resizing once keeps bilinear downscaling
+  // from skipping source pixels.
+  const FrameBuffer* level = frame->rgb;
+  const int min_dimension = options_.detection_min_dimension;
+  while (min_dimension > 0 && level->dimension().width / 2 >= min_dimension &&
+         level->dimension().height / 2 >= min_dimension) {
+    const FrameBuffer::Dimension half = {level->dimension().width / 2,
+                                         level->dimension().height / 2};
+    frame->pyramid_data.emplace_back(
+        GetBufferByteSize(half, FrameBuffer::Format::kRGB));
+    frame->pyramid.push_back(CreateFromRgbRawBuffer(
+        frame->pyramid_data.back().data(), half, frame_buffer.orientation(),
+        frame_buffer.timestamp()));
+    RETURN_IF_ERROR(
+        frame_buffer_utils_->Resize(*level, frame->pyramid.back().get()));
+    level = frame->pyramid.back().get();
+  }
+  frame->detection = level;
+
+  RecordLatency(&Latencies::preprocessing, absl::Now() - frame->start_time);
+  return absl::OkStatus();
+}
+
+absl::Status DetectionCascade::Detect(Frame* frame) {
+  const absl::Time start = absl::Now();
+  ASSIGN_OR_RETURN(frame->result.detections,
+                   detector_->Detect(*frame->detection));
+  if (frame->detection != frame->rgb) {
+    // Map the boxes back to the full resolution frame.
+    const float scale_x =
+        static_cast<float>(frame->rgb->dimension().width) /
+        frame->detection->dimension().width;
+    const float scale_y =
+        static_cast<float>(frame->rgb->dimension().height) /
+        frame->detection->dimension().height;
+    for (Detection& detection :
+         *frame->result.detections.mutable_detections()) {
+      BoundingBox* box = detection.mutable_bounding_box();
+      box->set_origin_x(std::lround(box->origin_x() * scale_x));
+      box->set_origin_y(std::lround(box->origin_y() * scale_y));
+      box->set_width(std::lround(box->width() * scale_x));
+      box->set_height(std::lround(box->height() * scale_y));
+    }
+  }
+  RecordLatency(&Latencies::detection, absl::Now() - start);
+  return absl::OkStatus();
+}
+
+absl::Status DetectionCascade::Classify(Frame* frame) {
+  const absl::Time start = absl::Now();
+  const DetectionResult& detections = frame->result.detections;
+  int num_classified = detections.detections_size();
+  if (options_.max_classified_detections >= 0) {
+    num_classified =
+        std::min(num_classified, options_.max_classified_detections);
+  }
+  std::vector<BoundingBox> rois;
+  rois.reserve(num_classified);
+  for (int i = 0; i < num_classified; ++i) {
+    rois.push_back(ClampToFrame(detections.detections(i).bounding_box(),
+                                frame->rgb->dimension()));
+  }
+  if (!rois.empty()) {
+    ASSIGN_OR_RETURN(frame->result.classifications,
+                     classifier_->ClassifyRois(*frame->rgb, rois));
+  }
+  const absl::Time end = absl::Now();
+  RecordLatency(&Latencies::classification, end - start);
+  RecordLatency(&Latencies::end_to_end, end - frame->start_time);
+  return absl::OkStatus();
+}
+
+void DetectionCascade::StartPipeline() {
+  if (detection_thread_.joinable()) {
+    return;
+  }
+  detection_queue_ = absl::make_unique<Queue<std::unique_ptr<Frame>>>(
+      options_.max_queued_frames);
+  classification_queue_ = absl::make_unique<Queue<std::unique_ptr<Frame>>>(
+      options_.max_queued_frames);
+  detection_thread_ = std::thread([this] { RunDetectionStage(); });
+  classification_thread_ = std::thread([this] { RunClassificationStage(); });
+}
+
+void DetectionCascade::RunDetectionStage() {
+  std::unique_ptr<Frame> frame;
+  while (detection_queue_->Pop(&frame)) {
+    frame->status = Detect(frame.get());
+    classification_queue_->Push(std::move(frame));
+  }
+  classification_queue_->Close();
+}
+
+void DetectionCascade::RunClassificationStage() {
+  std::unique_ptr<Frame> frame;
+  while (classification_queue_->Pop(&frame)) {
+    if (frame->status.ok()) {
+      frame->status = Classify(frame.get());
+    }
+    if (frame->status.ok()) {
+      frame->callback(std::move(frame->result));
+    } else {
+      frame->callback(frame->status);
+    }
+    frame.reset();
+    absl::MutexLock lock(&mutex_);
+    --in_flight_;
+  }
+}
+
+void DetectionCascade::RecordLatency(StageLatency Latencies::*stage,
+                                     absl::Duration latency) {
+  absl::MutexLock lock(&mutex_);
+  StageLatency& stats = latencies_.*stage;
+  ++stats.count;
+  stats.total += latency;
+  stats.max = std::max(stats.max, latency);
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
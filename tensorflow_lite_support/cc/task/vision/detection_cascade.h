@@ -0,0 +1,178 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_DETECTION_CASCADE_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_DETECTION_CASCADE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/image_classifier.h"
+#include "tensorflow_lite_support/cc/task/vision/object_detector.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/classifications_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/detections_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// Runs an ObjectDetector on a frame, then an ImageClassifier on each of the
+// detected objects.
+//
+// The source frame is converted to RGB only once per frame. The detector runs
+// on that RGB image, optionally downscaled, and the classifier crops the
+// detections out of the full resolution RGB image. This avoids converting the
+// source frame (e.g. from YUV) again for every stage and every detection.
+//
+// Frames can either be processed synchronously with `Process`, or submitted to
+// a pipeline with `Submit`, in which case detection and classification run on
+// two dedicated threads so that consecutive frames overlap.
+//
+// This class is thread-compatible: `Process`, `Submit` and `Flush` must not be
+// called concurrently.
+class DetectionCascade {
+ public:
+  struct Options {
+    // If > 0, the detector runs on the RGB image downscaled by successive
+    // halvings, as long as both its width and height stay at least this large.
+    // Detection results are always expressed in the source frame coordinates.
+    int detection_min_dimension = 0;
+    // Maximum number of detections (in decreasing score order) to classify,
+    // or -1 to classify all of them.
+    int max_classified_detections = -1;
+    // Maximum number of frames waiting for each pipeline stage. `Submit`
+    // blocks while the detection stage queue is full.
+    int max_queued_frames = 1;
+    // The engine used for frame conversion and downscaling.
+    FrameBufferUtils::ProcessEngine process_engine =
+        FrameBufferUtils::ProcessEngine::kLibyuv;
+  };
+
+  struct Result {
+    // The detections, in the source frame coordinates.
+    DetectionResult detections;
+    // The classification of the i-th classified detection. Detections beyond
+    // `max_classified_detections` are not classified.
+    std::vector<ClassificationResult> classifications;
+  };
+
+  // Latency statistics of a stage of the cascade.
+  struct StageLatency {
+    int64_t count = 0;
+    absl::Duration total = absl::ZeroDuration();
+    absl::Duration max = absl::ZeroDuration();
+
+    absl::Duration Mean() const {
+      return count > 0 ? total / count : absl::ZeroDuration();
+    }
+  };
+
+  struct Latencies {
+    // Conversion of the source frame to RGB and downscaling.
+    StageLatency preprocessing;
+    StageLatency detection;
+    StageLatency classification;
+    // From the beginning of preprocessing to the end of classification,
+    // including the time spent waiting between stages.
+    StageLatency end_to_end;
+  };
+
+  using Callback =
+      std::function<void(tflite::support::StatusOr<Result> result)>;
+
+  // Creates a cascade taking ownership of the two tasks.
+  static tflite::support::StatusOr<std::unique_ptr<DetectionCascade>> Create(
+      std::unique_ptr<ObjectDetector> detector,
+      std::unique_ptr<ImageClassifier> classifier, const Options& options);
+
+  // Waits for all submitted frames and stops the pipeline threads.
+  ~DetectionCascade();
+
+  DetectionCascade(const DetectionCascade&) = delete;
+  DetectionCascade& operator=(const DetectionCascade&) = delete;
+
+  // Processes `frame_buffer` on the caller thread. Fails if frames submitted
+  // with `Submit` are still in flight.
+  tflite::support::StatusOr<Result> Process(const FrameBuffer& frame_buffer);
+
+  // Converts `frame_buffer` to RGB on the caller thread, then queues it for
+  // detection and classification on the pipeline threads. `frame_buffer` can
+  // be released as soon as this method returns. `callback` is called on the
+  // classification thread, in submission order.
+  absl::Status Submit(const FrameBuffer& frame_buffer, Callback callback);
+
+  // Blocks until the callbacks of all submitted frames have returned.
+  void Flush();
+
+  // Returns the latency statistics accumulated since creation or the last
+  // call to `ResetLatencies`.
+  Latencies GetLatencies() const;
+  void ResetLatencies();
+
+ private:
+  struct Frame;
+  template <typename T>
+  class Queue;
+
+  DetectionCascade(std::unique_ptr<ObjectDetector> detector,
+                   std::unique_ptr<ImageClassifier> classifier,
+                   const Options& options);
+
+  // Converts `frame_buffer` to RGB and builds the downscaled image used for
+  // detection. If `copy` is false and `frame_buffer` is already RGB, it is
+  // used without being copied.
+  absl::Status Preprocess(const FrameBuffer& frame_buffer, bool copy,
+                          Frame* frame);
+  absl::Status Detect(Frame* frame);
+  absl::Status Classify(Frame* frame);
+
+  void RunDetectionStage();
+  void RunClassificationStage();
+  void StartPipeline();
+
+  void RecordLatency(StageLatency Latencies::*stage, absl::Duration latency);
+  bool NoFrameInFlight() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return in_flight_ == 0;
+  }
+
+  std::unique_ptr<ObjectDetector> detector_;
+  std::unique_ptr<ImageClassifier> classifier_;
+  const Options options_;
+  std::unique_ptr<FrameBufferUtils> frame_buffer_utils_;
+
+  std::unique_ptr<Queue<std::unique_ptr<Frame>>> detection_queue_;
+  std::unique_ptr<Queue<std::unique_ptr<Frame>>> classification_queue_;
+  std::thread detection_thread_;
+  std::thread classification_thread_;
+
+  mutable absl::Mutex mutex_;
+  int in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+  Latencies latencies_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_DETECTION_CASCADE_H_
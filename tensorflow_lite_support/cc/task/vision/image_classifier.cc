@@ -48,6 +48,11 @@ using ::tflite::task::core::TfLiteEngine;
 
 }  // namespace
 
+ImageClassifier::~ImageClassifier() {
+  // The asynchronous inference thread calls `Postprocess`.
+  StopAsyncInference();
+}
+
 /* static */
 StatusOr<std::unique_ptr<ImageClassifier>> ImageClassifier::CreateFromOptions(
     const ImageClassifierOptions& options,
@@ -384,9 +389,51 @@ StatusOr<ClassificationResult> ImageClassifier::Classify(
   return InferWithFallback(frame_buffer, roi);
 }
 
+absl::Status ImageClassifier::Classify(const FrameBuffer& frame_buffer,
+                                       ClassificationResult* result) {
+  BoundingBox roi;
+  roi.set_width(frame_buffer.dimension().width);
+  roi.set_height(frame_buffer.dimension().height);
+  return Classify(frame_buffer, roi, result);
+}
+
+absl::Status ImageClassifier::Classify(const FrameBuffer& frame_buffer,
+                                       const BoundingBox& roi,
+                                       ClassificationResult* result) {
+  return InferWithFallbackInto(frame_buffer, roi, result);
+}
+
+StatusOr<std::vector<ClassificationResult>> ImageClassifier::ClassifyRois(
+    const FrameBuffer& frame_buffer, absl::Span<const BoundingBox> rois) {
+  return InferRois(frame_buffer, rois);
+}
+
+absl::Status ImageClassifier::ClassifyAsync(const FrameBuffer& frame_buffer,
+                                            AsyncCallback callback) {
+  BoundingBox roi;
+  roi.set_width(frame_buffer.dimension().width);
+  roi.set_height(frame_buffer.dimension().height);
+  return ClassifyAsync(frame_buffer, roi, std::move(callback));
+}
+
+absl::Status ImageClassifier::ClassifyAsync(const FrameBuffer& frame_buffer,
+                                            const BoundingBox& roi,
+                                            AsyncCallback callback) {
+  return InferAsync(frame_buffer, roi, std::move(callback));
+}
+
 StatusOr<ClassificationResult> ImageClassifier::Postprocess(
     const std::vector<const TfLiteTensor*>& output_tensors,
-    const FrameBuffer& /*frame_buffer*/, const BoundingBox& /*roi*/) {
+    const FrameBuffer& frame_buffer, const BoundingBox& roi) {
+  ClassificationResult result;
+  RETURN_IF_ERROR(PostprocessInto(output_tensors, frame_buffer, roi, &result));
+  return result;
+}
+
+absl::Status ImageClassifier::PostprocessInto(
+    const std::vector<const TfLiteTensor*>& output_tensors,
+    const FrameBuffer& /*frame_buffer*/, const BoundingBox& /*roi*/,
+    ClassificationResult* result) {
   if (output_tensors.size() != num_outputs_) {
     return CreateStatusWithPayload(
         StatusCode::kInternal,
@@ -394,37 +441,38 @@ StatusOr<ClassificationResult> ImageClassifier::Postprocess(
                         output_tensors.size()));
   }
 
-  ClassificationResult result;
-  std::vector<std::pair<int, float>> score_pairs;
+  // Clearing keeps the previous classes (and their strings) allocated, so
+  // that they are reused by `add_classes` below.
+  result->Clear();
 
   for (int i = 0; i < num_outputs_; ++i) {
-    auto* classifications = result.add_classifications();
+    auto* classifications = result->add_classifications();
     classifications->set_head_index(i);
 
     const auto& head = classification_heads_[i];
-    score_pairs.clear();
-    score_pairs.reserve(head.label_map_items.size());
+    score_pairs_.clear();
+    score_pairs_.reserve(head.label_map_items.size());
 
     const TfLiteTensor* output_tensor = output_tensors[i];
     if (has_uint8_outputs_) {
       ASSIGN_OR_RETURN(const uint8* output_data,
                        AssertAndReturnTypedTensor<uint8>(output_tensor));
       for (int j = 0; j < head.label_map_items.size(); ++j) {
-        score_pairs.emplace_back(j, output_tensor->params.scale *
-                                        (static_cast<int>(output_data[j]) -
-                                         output_tensor->params.zero_point));
+        score_pairs_.emplace_back(j, output_tensor->params.scale *
+                                         (static_cast<int>(output_data[j]) -
+                                          output_tensor->params.zero_point));
       }
     } else {
       ASSIGN_OR_RETURN(const float* output_data,
                        AssertAndReturnTypedTensor<float>(output_tensor));
       for (int j = 0; j < head.label_map_items.size(); ++j) {
-        score_pairs.emplace_back(j, output_data[j]);
+        score_pairs_.emplace_back(j, output_data[j]);
       }
     }
 
     // Optional score calibration.
     if (score_calibrations_[i] != nullptr) {
-      for (auto& score_pair : score_pairs) {
+      for (auto& score_pair : score_pairs_) {
         const std::string& class_name =
             head.label_map_items[score_pair.first].name;
 
@@ -456,35 +504,35 @@ StatusOr<ClassificationResult> ImageClassifier::Postprocess(
     if (class_name_set_.values.empty()) {
       // Partially sort in descending order (higher score is better).
       absl::c_partial_sort(
-          score_pairs, score_pairs.begin() + num_results,
+          score_pairs_, score_pairs_.begin() + num_results,
           [](const std::pair<int, float>& a, const std::pair<int, float>& b) {
             return a.second > b.second;
           });
 
       for (int j = 0; j < num_results; ++j) {
-        float score = score_pairs[j].second;
+        float score = score_pairs_[j].second;
         if (score < score_threshold) {
           break;
         }
         auto* cl = classifications->add_classes();
-        cl->set_index(score_pairs[j].first);
+        cl->set_index(score_pairs_[j].first);
         cl->set_score(score);
       }
     } else {
       // Sort in descending order (higher score is better).
-      absl::c_sort(score_pairs, [](const std::pair<int, float>& a,
-                                   const std::pair<int, float>& b) {
+      absl::c_sort(score_pairs_, [](const std::pair<int, float>& a,
+                                    const std::pair<int, float>& b) {
         return a.second > b.second;
       });
 
       for (int j = 0; j < head.label_map_items.size(); ++j) {
-        float score = score_pairs[j].second;
+        float score = score_pairs_[j].second;
         if (score < score_threshold ||
             classifications->classes_size() >= num_results) {
           break;
         }
 
-        const int class_index = score_pairs[j].first;
+        const int class_index = score_pairs_[j].first;
         const std::string& class_name = head.label_map_items[class_index].name;
 
         bool class_name_found = class_name_set_.values.contains(class_name);
@@ -501,9 +549,7 @@ StatusOr<ClassificationResult> ImageClassifier::Postprocess(
     }
   }
 
-  RETURN_IF_ERROR(FillResultsFromLabelMaps(&result));
-
-  return result;
+  return FillResultsFromLabelMaps(result);
 }
 
 absl::Status ImageClassifier::FillResultsFromLabelMaps(
@@ -17,10 +17,12 @@ limitations under the License.
 #define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_IMAGE_CLASSIFIER_H_
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/core/shims/cc/kernels/register.h"
@@ -47,7 +49,8 @@ namespace vision {
 // Input tensor:
 //   (kTfLiteUInt8/kTfLiteFloat32)
 //    - image input of size `[batch x height x width x channels]`.
-//    - batch inference is not supported (`batch` is required to be 1).
+//    - `batch` is required to be 1, or dynamic (-1 in the shape signature) in
+//      which case `ClassifyRois` runs a single batched inference.
 //    - only RGB inputs are supported (`channels` is required to be 3).
 //    - if type is kTfLiteFloat32, NormalizationOptions are required to be
 //      attached to the metadata for input normalization.
@@ -73,6 +76,7 @@ namespace vision {
 class ImageClassifier : public BaseVisionTaskApi<ClassificationResult> {
  public:
   using BaseVisionTaskApi::BaseVisionTaskApi;
+  ~ImageClassifier() override;
 
   // Creates an ImageClassifier from the provided options. A non-default
   // OpResolver can be specified in order to support custom Ops or specify a
@@ -111,6 +115,47 @@ class ImageClassifier : public BaseVisionTaskApi<ClassificationResult> {
   tflite::support::StatusOr<ClassificationResult> Classify(
       const FrameBuffer& frame_buffer, const BoundingBox& roi);
 
+  // Same as the above methods, except that the result is written to `result`,
+  // whose previous contents are replaced. Reusing the same `result` across
+  // calls reuses the memory allocated for its classes and label strings. If
+  // `result` is allocated on a `google::protobuf::Arena`, so is every message
+  // added to it. On error, the contents of `result` are unspecified.
+  absl::Status Classify(const FrameBuffer& frame_buffer,
+                        ClassificationResult* result);
+  absl::Status Classify(const FrameBuffer& frame_buffer, const BoundingBox& roi,
+                        ClassificationResult* result);
+
+  // Same as above, for several regions of interest of the same frame buffer
+  // (e.g. the detections of an ObjectDetector). Returns one result per region,
+  // in the same order.
+  //
+  // If the model input has a dynamic batch dimension, all the regions are
+  // cropped and resized into a single batch and classified with one inference.
+  // Otherwise, this is equivalent to calling `Classify` on each region.
+  tflite::support::StatusOr<std::vector<ClassificationResult>> ClassifyRois(
+      const FrameBuffer& frame_buffer, absl::Span<const BoundingBox> rois);
+
+  // Same as `Classify`, except that classification runs on a background
+  // thread and `callback` is called with the result on that thread. Callbacks
+  // are called in the order frames were accepted. `frame_buffer` is converted
+  // to the model input before this method returns and can be released
+  // afterwards.
+  //
+  // At most `AsyncOptions::max_in_flight_frames` frames are in flight: beyond
+  // that, the frame is either dropped (with an `kUnavailable` status and no
+  // callback) or this method blocks, see `SetAsyncOptions`.
+  //
+  // This method is not thread-safe: calls must not be concurrent with each
+  // other, nor with the synchronous methods. Synchronous methods must not be
+  // called either until `WaitForAsyncInferences` returns.
+  absl::Status ClassifyAsync(const FrameBuffer& frame_buffer,
+                             AsyncCallback callback);
+
+  // Same as above, except that the classification is performed based on the
+  // input region of interest.
+  absl::Status ClassifyAsync(const FrameBuffer& frame_buffer,
+                             const BoundingBox& roi, AsyncCallback callback);
+
  protected:
   // The options used to build this ImageClassifier.
   std::unique_ptr<ImageClassifierOptions> options_;
@@ -125,6 +170,12 @@ class ImageClassifier : public BaseVisionTaskApi<ClassificationResult> {
       const std::vector<const TfLiteTensor*>& output_tensors,
       const FrameBuffer& frame_buffer, const BoundingBox& roi) override;
 
+  // Same as above, writing the classification results to `result`.
+  absl::Status PostprocessInto(
+      const std::vector<const TfLiteTensor*>& output_tensors,
+      const FrameBuffer& frame_buffer, const BoundingBox& roi,
+      ClassificationResult* result) override;
+
   // Performs sanity checks on the provided ImageClassifierOptions.
   static absl::Status SanityCheckOptions(const ImageClassifierOptions& options);
 
@@ -174,6 +225,10 @@ class ImageClassifier : public BaseVisionTaskApi<ClassificationResult> {
   // List of score calibration parameters, if any. Built from TFLite Model
   // Metadata.
   std::vector<std::unique_ptr<ScoreCalibration>> score_calibrations_;
+
+  // Scratch buffer for the (index, score) pairs of a classification head,
+  // kept across calls to avoid reallocating it.
+  std::vector<std::pair<int, float>> score_pairs_;
 };
 
 }  // namespace vision
@@ -122,6 +122,12 @@ tflite::support::StatusOr<EmbeddingResult> ImageEmbedder::Embed(
   return InferWithFallback(frame_buffer, roi);
 }
 
+tflite::support::StatusOr<std::vector<EmbeddingResult>>
+ImageEmbedder::EmbedRois(const FrameBuffer& frame_buffer,
+                         absl::Span<const BoundingBox> rois) {
+  return InferRois(frame_buffer, rois);
+}
+
 tflite::support::StatusOr<EmbeddingResult> ImageEmbedder::Postprocess(
     const std::vector<const TfLiteTensor*>& output_tensors,
     const FrameBuffer& /*frame_buffer*/, const BoundingBox& /*roi*/) {
@@ -134,6 +140,19 @@ tflite::support::StatusOr<EmbeddingResult> ImageEmbedder::Postprocess(
   return result;
 }
 
+tflite::support::StatusOr<EmbeddingResult> ImageEmbedder::PostprocessBatchSlot(
+    const std::vector<const TfLiteTensor*>& /*output_tensors*/,
+    int batch_index, const FrameBuffer& /*frame_buffer*/,
+    const BoundingBox& /*roi*/) {
+  EmbeddingResult result;
+  for (int i = 0; i < postprocessors_.size(); ++i) {
+    RETURN_IF_ERROR(postprocessors_.at(i)->Postprocess(result.add_embeddings(),
+                                                       batch_index));
+  }
+
+  return result;
+}
+
 Embedding ImageEmbedder::GetEmbeddingByIndex(const EmbeddingResult& result,
                                              int output_index) {
   if (output_index < 0 || output_index >= postprocessors_.size()) {
@@ -19,6 +19,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/status/status.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/core/shims/cc/kernels/register.h"
 #include "tensorflow_lite_support/cc/port/integral_types.h"
@@ -92,6 +93,12 @@ class ImageEmbedder
   tflite::support::StatusOr<EmbeddingResult> Embed(
       const FrameBuffer& frame_buffer, const BoundingBox& roi);
 
+  // Same as above, for several regions of interest of the same frame buffer.
+  // Returns one result per region, in the same order. If the model input has a
+  // dynamic batch dimension, all the regions are embedded with one inference.
+  tflite::support::StatusOr<std::vector<EmbeddingResult>> EmbedRois(
+      const FrameBuffer& frame_buffer, absl::Span<const BoundingBox> rois);
+
   // Returns the Embedding output by the output_index'th layer. In (the most
   // common) case where a single embedding is produced, you can just call
   // GetEmbeddingByIndex(result, 0).
@@ -124,6 +131,11 @@ class ImageEmbedder
       const std::vector<const TfLiteTensor*>& output_tensors,
       const FrameBuffer& frame_buffer, const BoundingBox& roi) override;
 
+  // Post-processing of one region of a batched inference.
+  tflite::support::StatusOr<EmbeddingResult> PostprocessBatchSlot(
+      const std::vector<const TfLiteTensor*>& output_tensors, int batch_index,
+      const FrameBuffer& frame_buffer, const BoundingBox& roi) override;
+
   // Performs pre-initialization actions.
   virtual absl::Status PreInit();
   // Performs post-initialization actions.
@@ -327,12 +327,29 @@ StatusOr<SegmentationResult> ImageSegmenter::Segment(
   BoundingBox roi;
   roi.set_width(frame_buffer.dimension().width);
   roi.set_height(frame_buffer.dimension().height);
-  return InferWithFallback(frame_buffer, roi);
+  return InferVideoFrame(frame_buffer, roi);
+}
+
+absl::Status ImageSegmenter::Segment(const FrameBuffer& frame_buffer,
+                                     SegmentationResult* result) {
+  BoundingBox roi;
+  roi.set_width(frame_buffer.dimension().width);
+  roi.set_height(frame_buffer.dimension().height);
+  return InferVideoFrameInto(frame_buffer, roi, result);
 }
 
 StatusOr<SegmentationResult> ImageSegmenter::Postprocess(
     const std::vector<const TfLiteTensor*>& output_tensors,
-    const FrameBuffer& frame_buffer, const BoundingBox& /*roi*/) {
+    const FrameBuffer& frame_buffer, const BoundingBox& roi) {
+  SegmentationResult result;
+  RETURN_IF_ERROR(PostprocessInto(output_tensors, frame_buffer, roi, &result));
+  return result;
+}
+
+absl::Status ImageSegmenter::PostprocessInto(
+    const std::vector<const TfLiteTensor*>& output_tensors,
+    const FrameBuffer& frame_buffer, const BoundingBox& /*roi*/,
+    SegmentationResult* result) {
   if (output_tensors.size() != 1) {
     return CreateStatusWithPayload(
         StatusCode::kInternal,
@@ -341,10 +358,13 @@ StatusOr<SegmentationResult> ImageSegmenter::Postprocess(
   }
   const TfLiteTensor* output_tensor = output_tensors[0];
 
-  SegmentationResult result;
-  Segmentation* segmentation = result.add_segmentation();
-  *segmentation->mutable_colored_labels() = {colored_labels_.begin(),
-                                             colored_labels_.end()};
+  // Clearing keeps the previous masks and colored labels allocated, so that
+  // they are reused below.
+  result->Clear();
+  Segmentation* segmentation = result->add_segmentation();
+  for (const Segmentation::ColoredLabel& colored_label : colored_labels_) {
+    *segmentation->add_colored_labels() = colored_label;
+  }
 
   // The output tensor has orientation `frame_buffer.orientation()`, as it has
   // been produced from the pre-processed frame.
@@ -406,7 +426,8 @@ StatusOr<SegmentationResult> ImageSegmenter::Postprocess(
              ImageSegmenterOptions::CONFIDENCE_MASK) {
     auto* confidence_masks = segmentation->mutable_confidence_masks();
     for (int d = 0; d < output_depth_; ++d) {
-      confidence_masks->add_confidence_mask();
+      confidence_masks->add_confidence_mask()->mutable_value()->Reserve(
+          mask_dimension.width * mask_dimension.height);
     }
     for (int mask_y = 0; mask_y < segmentation->height(); ++mask_y) {
       for (int mask_x = 0; mask_x < segmentation->width(); ++mask_x) {
@@ -428,7 +449,7 @@ StatusOr<SegmentationResult> ImageSegmenter::Postprocess(
     }
   }
 
-  return result;
+  return absl::OkStatus();
 }
 
 StatusOr<float> ImageSegmenter::GetOutputConfidence(
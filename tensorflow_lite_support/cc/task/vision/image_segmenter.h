@@ -111,9 +111,20 @@ class ImageSegmenter : public BaseVisionTaskApi<SegmentationResult> {
   // masks need to be:
   // * re-scaled to 640 x 480,
   // * then rotated 90° clockwise.
+  //
+  // In video mode (see `SetVideoModeOptions`), the previous result is returned
+  // without running inference if the frame barely changed.
   tflite::support::StatusOr<SegmentationResult> Segment(
       const FrameBuffer& frame_buffer);
 
+  // Same as above, except that the result is written to `result`, whose
+  // previous contents are replaced. Reusing the same `result` across calls
+  // reuses the memory allocated for its masks and colored labels. If `result`
+  // is allocated on a `google::protobuf::Arena`, so is every message added to
+  // it. On error, the contents of `result` are unspecified.
+  absl::Status Segment(const FrameBuffer& frame_buffer,
+                       SegmentationResult* result);
+
  protected:
   // Post-processing to transform the raw model outputs into segmentation
   // results.
@@ -121,6 +132,12 @@ class ImageSegmenter : public BaseVisionTaskApi<SegmentationResult> {
       const std::vector<const TfLiteTensor*>& output_tensors,
       const FrameBuffer& frame_buffer, const BoundingBox& roi) override;
 
+  // Same as above, writing the segmentation results to `result`.
+  absl::Status PostprocessInto(
+      const std::vector<const TfLiteTensor*>& output_tensors,
+      const FrameBuffer& frame_buffer, const BoundingBox& roi,
+      SegmentationResult* result) override;
+
   // Performs sanity checks on the provided ImageSegmenterOptions.
   static absl::Status SanityCheckOptions(const ImageSegmenterOptions& options);
 
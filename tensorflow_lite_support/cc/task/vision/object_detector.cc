@@ -308,6 +308,11 @@ absl::Status ObjectDetector::SanityCheckOptions(
   return absl::OkStatus();
 }
 
+ObjectDetector::~ObjectDetector() {
+  // The asynchronous inference thread calls `Postprocess`.
+  StopAsyncInference();
+}
+
 /* static */
 StatusOr<std::unique_ptr<ObjectDetector>> ObjectDetector::CreateFromOptions(
     const ObjectDetectorOptions& options,
@@ -594,12 +599,37 @@ StatusOr<DetectionResult> ObjectDetector::Detect(
   BoundingBox roi;
   roi.set_width(frame_buffer.dimension().width);
   roi.set_height(frame_buffer.dimension().height);
-  return InferWithFallback(frame_buffer, roi);
+  return InferVideoFrame(frame_buffer, roi);
+}
+
+absl::Status ObjectDetector::Detect(const FrameBuffer& frame_buffer,
+                                    DetectionResult* result) {
+  BoundingBox roi;
+  roi.set_width(frame_buffer.dimension().width);
+  roi.set_height(frame_buffer.dimension().height);
+  return InferVideoFrameInto(frame_buffer, roi, result);
+}
+
+absl::Status ObjectDetector::DetectAsync(const FrameBuffer& frame_buffer,
+                                         AsyncCallback callback) {
+  BoundingBox roi;
+  roi.set_width(frame_buffer.dimension().width);
+  roi.set_height(frame_buffer.dimension().height);
+  return InferAsync(frame_buffer, roi, std::move(callback));
 }
 
 StatusOr<DetectionResult> ObjectDetector::Postprocess(
     const std::vector<const TfLiteTensor*>& output_tensors,
-    const FrameBuffer& frame_buffer, const BoundingBox& /*roi*/) {
+    const FrameBuffer& frame_buffer, const BoundingBox& roi) {
+  DetectionResult result;
+  RETURN_IF_ERROR(PostprocessInto(output_tensors, frame_buffer, roi, &result));
+  return result;
+}
+
+absl::Status ObjectDetector::PostprocessInto(
+    const std::vector<const TfLiteTensor*>& output_tensors,
+    const FrameBuffer& frame_buffer, const BoundingBox& /*roi*/,
+    DetectionResult* result) {
   // Most of the checks here should never happen, as outputs have been validated
   // at construction time. Checking nonetheless and returning internal errors if
   // something bad happens.
@@ -632,7 +662,9 @@ StatusOr<DetectionResult> ObjectDetector::Postprocess(
   ASSIGN_OR_RETURN(
       const float* scores,
       AssertAndReturnTypedTensor<float>(output_tensors[output_indices_[2]]));
-  DetectionResult results;
+  // Clearing keeps the previous detections (and their strings) allocated, so
+  // that they are reused by `add_detections` below.
+  result->Clear();
   for (int i = 0; i < num_results; ++i) {
     const int class_index = static_cast<int>(classes[i]);
     if (!IsClassIndexAllowed(class_index)) {
@@ -649,7 +681,7 @@ StatusOr<DetectionResult> ObjectDetector::Postprocess(
       continue;
     }
 
-    Detection* detection = results.add_detections();
+    Detection* detection = result->add_detections();
     // Denormalize the bounding box cooordinates in the upright frame
     // coordinates system, then rotate back from frame_buffer.orientation() to
     // the unrotated frame of reference coordinates system (i.e. with
@@ -665,16 +697,16 @@ StatusOr<DetectionResult> ObjectDetector::Postprocess(
     Class* detection_class = detection->add_classes();
     detection_class->set_index(class_index);
     detection_class->set_score(score);
-    if (results.detections_size() == max_results) {
+    if (result->detections_size() == max_results) {
       break;
     }
   }
 
   if (!label_map_.empty()) {
-    RETURN_IF_ERROR(FillResultsFromLabelMap(&results));
+    RETURN_IF_ERROR(FillResultsFromLabelMap(result));
   }
 
-  return results;
+  return absl::OkStatus();
 }
 
 bool ObjectDetector::IsClassIndexAllowed(int class_index) {
@@ -703,11 +735,11 @@ absl::Status ObjectDetector::FillResultsFromLabelMap(DetectionResult* result) {
                 index, label_map_.size()),
             TfLiteSupportStatus::kMetadataInconsistencyError);
       }
-      std::string name = label_map_[index].name;
+      const std::string& name = label_map_[index].name;
       if (!name.empty()) {
         detection_class->set_class_name(name);
       }
-      std::string display_name = label_map_[index].display_name;
+      const std::string& display_name = label_map_[index].display_name;
       if (!display_name.empty()) {
         detection_class->set_display_name(display_name);
       }
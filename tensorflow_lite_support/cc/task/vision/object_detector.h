@@ -78,6 +78,7 @@ namespace vision {
 class ObjectDetector : public BaseVisionTaskApi<DetectionResult> {
  public:
   using BaseVisionTaskApi::BaseVisionTaskApi;
+  ~ObjectDetector() override;
 
   // Creates an ObjectDetector from the provided options. A non-default
   // OpResolver can be specified in order to support custom Ops or specify a
@@ -116,15 +117,46 @@ class ObjectDetector : public BaseVisionTaskApi<DetectionResult> {
   // `kLeftBottom` (i.e. the image will be rotated 90° clockwise during
   // preprocessing to make it "upright"), then the same 90° clockwise rotation
   // needs to be applied to the bounding box for display.
+  //
+  // In video mode (see `SetVideoModeOptions`), the previous result is returned
+  // without running inference if the frame barely changed.
   tflite::support::StatusOr<DetectionResult> Detect(
       const FrameBuffer& frame_buffer);
 
+  // Same as above, except that the result is written to `result`, whose
+  // previous contents are replaced. Reusing the same `result` across calls
+  // reuses the memory allocated for its detections and label strings. If
+  // `result` is allocated on a `google::protobuf::Arena`, so is every message
+  // added to it. On error, the contents of `result` are unspecified.
+  absl::Status Detect(const FrameBuffer& frame_buffer, DetectionResult* result);
+
+  // Same as above, except that detection runs on a background thread and
+  // `callback` is called with the result on that thread. Callbacks are called
+  // in the order frames were accepted. `frame_buffer` is converted to the
+  // model input before this method returns and can be released afterwards.
+  //
+  // At most `AsyncOptions::max_in_flight_frames` frames are in flight: beyond
+  // that, the frame is either dropped (with an `kUnavailable` status and no
+  // callback) or this method blocks, see `SetAsyncOptions`.
+  //
+  // This method is not thread-safe: calls must not be concurrent with each
+  // other, nor with `Detect`. `Detect` must not be called either until
+  // `WaitForAsyncInferences` returns.
+  absl::Status DetectAsync(const FrameBuffer& frame_buffer,
+                           AsyncCallback callback);
+
  protected:
   // Post-processing to transform the raw model outputs into detection results.
   tflite::support::StatusOr<DetectionResult> Postprocess(
       const std::vector<const TfLiteTensor*>& output_tensors,
       const FrameBuffer& frame_buffer, const BoundingBox& roi) override;
 
+  // Same as above, writing the detection results to `result`.
+  absl::Status PostprocessInto(
+      const std::vector<const TfLiteTensor*>& output_tensors,
+      const FrameBuffer& frame_buffer, const BoundingBox& roi,
+      DetectionResult* result) override;
+
   // Performs sanity checks on the provided ObjectDetectorOptions.
   static absl::Status SanityCheckOptions(const ObjectDetectorOptions& options);
 
@@ -0,0 +1,249 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/object_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <utility>
+
+#include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+namespace {
+
+// Noise parameters of the Kalman filters, following the reference SORT
+// implementation: variances of the initial state, of the process noise and of
+// the measurement noise, for the center coordinates, the area and the aspect
+// ratio of the boxes.
+constexpr float kInitialPositionVariance = 10.0f;
+constexpr float kInitialVelocityVariance = 1e4f;
+constexpr float kCenterPositionNoise = 1.0f;
+constexpr float kCenterVelocityNoise = 1e-2f;
+constexpr float kAreaPositionNoise = 1.0f;
+constexpr float kAreaVelocityNoise = 1e-4f;
+constexpr float kAspectRatioNoise = 1.0f;
+constexpr float kCenterMeasurementNoise = 1.0f;
+constexpr float kAreaMeasurementNoise = 10.0f;
+constexpr float kAspectRatioMeasurementNoise = 10.0f;
+
+float IntersectionOverUnion(float ax0, float ay0, float ax1, float ay1,
+                            float bx0, float by0, float bx1, float by1) {
+  const float intersection_width = std::min(ax1, bx1) - std::max(ax0, bx0);
+  const float intersection_height = std::min(ay1, by1) - std::max(ay0, by0);
+  if (intersection_width <= 0 || intersection_height <= 0) {
+    return 0.0f;
+  }
+  const float intersection = intersection_width * intersection_height;
+  const float union_area =
+      (ax1 - ax0) * (ay1 - ay0) + (bx1 - bx0) * (by1 - by0) - intersection;
+  return union_area > 0 ? intersection / union_area : 0.0f;
+}
+
+}  // namespace
+
+void ObjectTracker::AxisFilter::Init(float position, float position_variance,
+                                     float velocity_variance) {
+  x[0] = position;
+  x[1] = 0.0f;
+  p[0][0] = position_variance;
+  p[0][1] = 0.0f;
+  p[1][0] = 0.0f;
+  p[1][1] = velocity_variance;
+}
+
+void ObjectTracker::AxisFilter::Predict(float position_noise,
+                                        float velocity_noise) {
+  // x = F x and P = F P F' + Q, with F = [[1, 1], [0, 1]].
+  x[0] += x[1];
+  p[0][0] += p[0][1] + p[1][0] + p[1][1] + position_noise;
+  p[0][1] += p[1][1];
+  p[1][0] += p[1][1];
+  p[1][1] += velocity_noise;
+}
+
+void ObjectTracker::AxisFilter::Update(float measurement,
+                                       float measurement_noise) {
+  // Only the position is measured, i.e. H = [1, 0].
+  const float innovation = measurement - x[0];
+  const float innovation_variance = p[0][0] + measurement_noise;
+  const float gain0 = p[0][0] / innovation_variance;
+  const float gain1 = p[1][0] / innovation_variance;
+  x[0] += gain0 * innovation;
+  x[1] += gain1 * innovation;
+  // P = (I - K H) P.
+  const float p00 = p[0][0];
+  const float p01 = p[0][1];
+  p[0][0] -= gain0 * p00;
+  p[0][1] -= gain0 * p01;
+  p[1][0] -= gain1 * p00;
+  p[1][1] -= gain1 * p01;
+}
+
+void ObjectTracker::Track::Init(int64 track_id, const Detection& source) {
+  const BoundingBox& box = source.bounding_box();
+  id = track_id;
+  center_x.Init(box.origin_x() + box.width() / 2.0f, kInitialPositionVariance,
+                kInitialVelocityVariance);
+  center_y.Init(box.origin_y() + box.height() / 2.0f,
+                kInitialPositionVariance, kInitialVelocityVariance);
+  area.Init(static_cast<float>(box.width()) * box.height(),
+            kInitialPositionVariance, kInitialVelocityVariance);
+  aspect_ratio = box.height() > 0
+                     ? static_cast<float>(box.width()) / box.height()
+                     : 1.0f;
+  aspect_ratio_variance = kInitialPositionVariance;
+  detections = 1;
+  frames_since_detection = 0;
+  detection = source;
+}
+
+void ObjectTracker::Track::Predict() {
+  // The area must stay positive.
+  if (area.x[0] + area.x[1] <= 0) {
+    area.x[1] = 0.0f;
+  }
+  center_x.Predict(kCenterPositionNoise, kCenterVelocityNoise);
+  center_y.Predict(kCenterPositionNoise, kCenterVelocityNoise);
+  area.Predict(kAreaPositionNoise, kAreaVelocityNoise);
+  aspect_ratio_variance += kAspectRatioNoise;
+  ++frames_since_detection;
+}
+
+void ObjectTracker::Track::Update(const Detection& source) {
+  const BoundingBox& box = source.bounding_box();
+  center_x.Update(box.origin_x() + box.width() / 2.0f,
+                  kCenterMeasurementNoise);
+  center_y.Update(box.origin_y() + box.height() / 2.0f,
+                  kCenterMeasurementNoise);
+  area.Update(static_cast<float>(box.width()) * box.height(),
+              kAreaMeasurementNoise);
+  if (box.height() > 0) {
+    const float gain = aspect_ratio_variance /
+                       (aspect_ratio_variance + kAspectRatioMeasurementNoise);
+    aspect_ratio +=
+        gain * (static_cast<float>(box.width()) / box.height() - aspect_ratio);
+    aspect_ratio_variance -= gain * aspect_ratio_variance;
+  }
+  ++detections;
+  frames_since_detection = 0;
+  detection = source;
+}
+
+void ObjectTracker::Track::GetBox(float* x0, float* y0, float* x1,
+                                  float* y1) const {
+  const float width = std::sqrt(std::max(area.x[0], 0.0f) * aspect_ratio);
+  const float height = width > 0 ? area.x[0] / width : 0.0f;
+  *x0 = center_x.x[0] - width / 2;
+  *y0 = center_y.x[0] - height / 2;
+  *x1 = *x0 + width;
+  *y1 = *y0 + height;
+}
+
+ObjectTracker::ObjectTracker(const Options& options) : options_(options) {}
+
+void ObjectTracker::PredictTracks() {
+  tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(),
+                               [this](const Track& track) {
+                                 return track.frames_since_detection >=
+                                        options_.max_frames_without_detection;
+                               }),
+                tracks_.end());
+  for (Track& track : tracks_) {
+    track.Predict();
+  }
+}
+
+TrackingResult ObjectTracker::Update(const DetectionResult& detections) {
+  PredictTracks();
+
+  // Greedy association by decreasing IoU. Unlike the Hungarian algorithm used
+  // by the reference SORT implementation it is not globally optimal, but the
+  // two only differ when boxes overlap ambiguously.
+  std::vector<std::tuple<float, int, int>> candidates;
+  for (int t = 0; t < tracks_.size(); ++t) {
+    float tx0, ty0, tx1, ty1;
+    tracks_[t].GetBox(&tx0, &ty0, &tx1, &ty1);
+    for (int d = 0; d < detections.detections_size(); ++d) {
+      const BoundingBox& box = detections.detections(d).bounding_box();
+      const float iou = IntersectionOverUnion(
+          tx0, ty0, tx1, ty1, box.origin_x(), box.origin_y(),
+          box.origin_x() + box.width(), box.origin_y() + box.height());
+      if (iou >= options_.iou_threshold) {
+        candidates.emplace_back(iou, t, d);
+      }
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const std::tuple<float, int, int>& a,
+               const std::tuple<float, int, int>& b) {
+              return std::get<0>(a) > std::get<0>(b);
+            });
+  std::vector<bool> track_matched(tracks_.size(), false);
+  std::vector<bool> detection_matched(detections.detections_size(), false);
+  for (const auto& candidate : candidates) {
+    const int t = std::get<1>(candidate);
+    const int d = std::get<2>(candidate);
+    if (track_matched[t] || detection_matched[d]) continue;
+    track_matched[t] = true;
+    detection_matched[d] = true;
+    tracks_[t].Update(detections.detections(d));
+  }
+
+  for (int d = 0; d < detections.detections_size(); ++d) {
+    if (detection_matched[d]) continue;
+    tracks_.emplace_back();
+    tracks_.back().Init(next_track_id_++, detections.detections(d));
+  }
+  return BuildResult();
+}
+
+TrackingResult ObjectTracker::Predict() {
+  PredictTracks();
+  return BuildResult();
+}
+
+void ObjectTracker::Reset() { tracks_.clear(); }
+
+TrackingResult ObjectTracker::BuildResult() const {
+  TrackingResult result;
+  for (const Track& track : tracks_) {
+    if (track.detections < options_.min_detections ||
+        track.frames_since_detection >= options_.max_frames_without_detection) {
+      continue;
+    }
+    TrackedObject object;
+    object.track_id = track.id;
+    object.frames_since_detection = track.frames_since_detection;
+    object.detection = track.detection;
+    float x0, y0, x1, y1;
+    track.GetBox(&x0, &y0, &x1, &y1);
+    BoundingBox* box = object.detection.mutable_bounding_box();
+    box->set_origin_x(std::lround(x0));
+    box->set_origin_y(std::lround(y0));
+    box->set_width(std::max(1L, std::lround(x1 - x0)));
+    box->set_height(std::max(1L, std::lround(y1 - y0)));
+    result.objects.push_back(std::move(object));
+  }
+  return result;
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,128 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_OBJECT_TRACKER_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_OBJECT_TRACKER_H_
+
+#include <vector>
+
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/detections_proto_inc.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// An object followed across frames.
+struct TrackedObject {
+  // Identifier of the track, unique within an ObjectTracker.
+  int64 track_id = 0;
+  // The last detection associated with the track, with its bounding box
+  // replaced by the current estimate of the tracker.
+  Detection detection;
+  // Number of frames since the track was last associated with a detection,
+  // i.e. 0 if it was detected on the current frame.
+  int frames_since_detection = 0;
+};
+
+struct TrackingResult {
+  std::vector<TrackedObject> objects;
+};
+
+// A SORT-style multi-object tracker: each object is tracked by a constant
+// velocity Kalman filter on its box center, area and aspect ratio, and
+// detections are associated with the tracks by IoU.
+//
+// The tracker only consumes detection results and does not look at the
+// frames, so that `Predict` is cheap enough to run on the frames between two
+// detections (see TrackedObjectDetector). Tracks are class-agnostic.
+//
+// This class is thread-compatible.
+class ObjectTracker {
+ public:
+  struct Options {
+    // Minimum IoU between a detection and the predicted box of a track for
+    // them to be associated.
+    float iou_threshold = 0.3f;
+    // Number of consecutive frames without detection after which a track is
+    // deleted.
+    int max_frames_without_detection = 5;
+    // Number of detections required before a track is reported.
+    int min_detections = 1;
+  };
+
+  explicit ObjectTracker(const Options& options);
+  ObjectTracker() : ObjectTracker(Options()) {}
+
+  // Advances all tracks by one frame, associates them with `detections` and
+  // returns the reported tracks, in creation order. New tracks are created
+  // for the detections which were not associated.
+  TrackingResult Update(const DetectionResult& detections);
+
+  // Advances all tracks by one frame on which no detection was run and
+  // returns the reported tracks with their predicted boxes.
+  TrackingResult Predict();
+
+  // Deletes all tracks. Track ids keep increasing.
+  void Reset();
+
+ private:
+  // Kalman filter of a single coordinate with a constant velocity model.
+  struct AxisFilter {
+    // Position and velocity.
+    float x[2];
+    // Covariance matrix, row-major.
+    float p[2][2];
+
+    void Init(float position, float position_variance,
+              float velocity_variance);
+    void Predict(float position_noise, float velocity_noise);
+    void Update(float measurement, float measurement_noise);
+  };
+
+  struct Track {
+    int64 id;
+    // Center x, center y and area of the box.
+    AxisFilter center_x;
+    AxisFilter center_y;
+    AxisFilter area;
+    // The aspect ratio (width / height) is assumed constant.
+    float aspect_ratio;
+    float aspect_ratio_variance;
+    int detections;
+    int frames_since_detection;
+    Detection detection;
+
+    void Init(int64 id, const Detection& detection);
+    void Predict();
+    void Update(const Detection& detection);
+    // Returns the current estimate of the box, as floats.
+    void GetBox(float* x0, float* y0, float* x1, float* y1) const;
+  };
+
+  // Advances all tracks and deletes the stale ones.
+  void PredictTracks();
+  TrackingResult BuildResult() const;
+
+  const Options options_;
+  std::vector<Track> tracks_;
+  int64 next_track_id_ = 0;
+};
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_OBJECT_TRACKER_H_
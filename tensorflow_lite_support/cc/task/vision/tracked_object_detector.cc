@@ -0,0 +1,93 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/tracked_object_detector.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+namespace {
+
+using ::absl::StatusCode;
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::StatusOr;
+using ::tflite::support::TfLiteSupportStatus;
+
+}  // namespace
+
+/* static */
+StatusOr<std::unique_ptr<TrackedObjectDetector>> TrackedObjectDetector::Create(
+    std::unique_ptr<ObjectDetector> detector, const Options& options) {
+  if (detector == nullptr) {
+    return CreateStatusWithPayload(StatusCode::kInvalidArgument,
+                                   "Expected a non-null object detector.",
+                                   TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  if (options.detection_interval < 1) {
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "Invalid `detection_interval`: must be at least 1.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  if (options.tracker_options.max_frames_without_detection <
+      options.detection_interval) {
+    // Otherwise tracks would be deleted before the next detection.
+    return CreateStatusWithPayload(
+        StatusCode::kInvalidArgument,
+        "Invalid `max_frames_without_detection`: must be at least "
+        "`detection_interval`.",
+        TfLiteSupportStatus::kInvalidArgumentError);
+  }
+  return absl::WrapUnique(
+      new TrackedObjectDetector(std::move(detector), options));
+}
+
+TrackedObjectDetector::TrackedObjectDetector(
+    std::unique_ptr<ObjectDetector> detector, const Options& options)
+    : detector_(std::move(detector)),
+      options_(options),
+      tracker_(options.tracker_options) {}
+
+StatusOr<TrackingResult> TrackedObjectDetector::Track(
+    const FrameBuffer& frame_buffer) {
+  ++frame_count_;
+  if (frames_since_detection_ >= 0 &&
+      frames_since_detection_ + 1 < options_.detection_interval) {
+    ++frames_since_detection_;
+    return tracker_.Predict();
+  }
+  ASSIGN_OR_RETURN(DetectionResult detections,
+                   detector_->Detect(frame_buffer));
+  frames_since_detection_ = 0;
+  ++detected_frame_count_;
+  return tracker_.Update(detections);
+}
+
+void TrackedObjectDetector::Reset() {
+  tracker_.Reset();
+  frames_since_detection_ = -1;
+}
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,82 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_TRACKED_OBJECT_DETECTOR_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_TRACKED_OBJECT_DETECTOR_H_
+
+#include <memory>
+
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/object_detector.h"
+#include "tensorflow_lite_support/cc/task/vision/object_tracker.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+
+// Runs an ObjectDetector every `detection_interval` frames of a video and
+// tracks the detected objects with an ObjectTracker, which propagates their
+// boxes on the frames in between. This trades box accuracy on fast moving
+// objects for a throughput close to `detection_interval` times the one of
+// running the detector on every frame.
+//
+// This class is thread-compatible.
+class TrackedObjectDetector {
+ public:
+  struct Options {
+    // Detection runs on one frame out of `detection_interval`, starting with
+    // the first one. 1 runs detection on every frame. Must not be larger than
+    // `tracker_options.max_frames_without_detection`.
+    int detection_interval = 3;
+    ObjectTracker::Options tracker_options;
+  };
+
+  // Creates a TrackedObjectDetector taking ownership of `detector`.
+  static tflite::support::StatusOr<std::unique_ptr<TrackedObjectDetector>>
+  Create(std::unique_ptr<ObjectDetector> detector, const Options& options);
+
+  // Processes the next frame of the video and returns the tracked objects.
+  // The frame is only read if detection runs on it.
+  tflite::support::StatusOr<TrackingResult> Track(
+      const FrameBuffer& frame_buffer);
+
+  // Forgets the tracked objects, e.g. on a scene cut. Detection runs on the
+  // next frame.
+  void Reset();
+
+  // Returns the number of frames processed, and on which detection ran.
+  int64 GetFrameCount() const { return frame_count_; }
+  int64 GetDetectedFrameCount() const { return detected_frame_count_; }
+
+ private:
+  TrackedObjectDetector(std::unique_ptr<ObjectDetector> detector,
+                        const Options& options);
+
+  std::unique_ptr<ObjectDetector> detector_;
+  const Options options_;
+  ObjectTracker tracker_;
+  // Number of frames since detection last ran, or -1 to force detection.
+  int frames_since_detection_ = -1;
+  int64 frame_count_ = 0;
+  int64 detected_frame_count_ = 0;
+};
+
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_TRACKED_OBJECT_DETECTOR_H_
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -152,6 +153,72 @@ FrameBuffer::Dimension GetCropDimension(int x0, int x1, int y0, int y1) {
   return {x1 - x0 + 1, y1 - y0 + 1};
 }
 
+absl::Status ComputeLumaThumbnail(const FrameBuffer& buffer, int width,
+                                  int height, std::vector<uint8>* thumbnail) {
+  if (width <= 0 || height <= 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid thumbnail dimension: {%d, %d}.", width, height));
+  }
+  const uint8* data;
+  int row_stride;
+  int pixel_stride;
+  bool is_rgb = false;
+  switch (buffer.format()) {
+    case FrameBuffer::Format::kNV12:
+    case FrameBuffer::Format::kNV21:
+    case FrameBuffer::Format::kYV12:
+    case FrameBuffer::Format::kYV21: {
+      ASSIGN_OR_RETURN(FrameBuffer::YuvData yuv_data,
+                       FrameBuffer::GetYuvDataFromFrameBuffer(buffer));
+      data = yuv_data.y_buffer;
+      row_stride = yuv_data.y_row_stride;
+      pixel_stride = 1;
+      break;
+    }
+    case FrameBuffer::Format::kGRAY:
+    case FrameBuffer::Format::kRGB:
+    case FrameBuffer::Format::kRGBA:
+      data = buffer.plane(0).buffer;
+      row_stride = buffer.plane(0).stride.row_stride_bytes;
+      pixel_stride = buffer.plane(0).stride.pixel_stride_bytes;
+      is_rgb = buffer.format() != FrameBuffer::Format::kGRAY;
+      break;
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Unsupported buffer format: %i.", buffer.format()));
+  }
+
+  // At most kSamplesPerAxis x kSamplesPerAxis pixels are read per cell.
+  constexpr int kSamplesPerAxis = 4;
+  const int buffer_width = buffer.dimension().width;
+  const int buffer_height = buffer.dimension().height;
+  thumbnail->resize(width * height);
+  for (int cell_y = 0; cell_y < height; ++cell_y) {
+    const int y0 = cell_y * buffer_height / height;
+    const int y1 = std::max(y0 + 1, (cell_y + 1) * buffer_height / height);
+    const int y_step = std::max(1, (y1 - y0) / kSamplesPerAxis);
+    for (int cell_x = 0; cell_x < width; ++cell_x) {
+      const int x0 = cell_x * buffer_width / width;
+      const int x1 = std::max(x0 + 1, (cell_x + 1) * buffer_width / width);
+      const int x_step = std::max(1, (x1 - x0) / kSamplesPerAxis);
+      int sum = 0;
+      int count = 0;
+      for (int y = y0; y < y1 && y < buffer_height; y += y_step) {
+        const uint8* row = data + y * row_stride;
+        for (int x = x0; x < x1 && x < buffer_width; x += x_step) {
+          const uint8* pixel = row + x * pixel_stride;
+          // BT.601 luma with 8-bit fixed point weights.
+          sum += is_rgb ? (77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2]) >> 8
+                        : pixel[0];
+          ++count;
+        }
+      }
+      (*thumbnail)[cell_y * width + cell_x] = count > 0 ? sum / count : 0;
+    }
+  }
+  return absl::OkStatus();
+}
+
 // Validation Methods
 // -----------------------------------------------------------------
 
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_SUPPORT_CC_TASK_VISION_UTILS_FRAME_BUFFER_COMMON_UTILS_H_
 
 #include <memory>
+#include <vector>
 
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/time/clock.h"  // from @com_google_absl
@@ -63,6 +64,16 @@ tflite::support::StatusOr<FrameBuffer::Dimension> GetUvPlaneDimension(
 // Returns crop dimension based on crop start and end points.
 FrameBuffer::Dimension GetCropDimension(int x0, int x1, int y0, int y1);
 
+// Computes a `width` x `height` thumbnail of the luma of `buffer` into
+// `thumbnail`, each value being the average of a sparse sample of the pixels
+// of the corresponding cell. This is meant as a cheap signature for frame
+// change detection, not as a proper downscaling.
+//
+// YUV frame buffers are read directly from their Y plane, RGB and RGBA pixels
+// are converted with the BT.601 weights. The orientation is ignored.
+absl::Status ComputeLumaThumbnail(const FrameBuffer& buffer, int width,
+                                  int height, std::vector<uint8>* thumbnail);
+
 // Validation Methods
 // -----------------------------------------------------------------
 
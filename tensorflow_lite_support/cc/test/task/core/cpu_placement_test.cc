@@ -0,0 +1,232 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/cpu_placement.h"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+#include <sys/stat.h>
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/status_matchers.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Writes a fake sysfs node directory with the provided CPU lists per node.
+std::string WriteFakeNodeDirectory(
+    const std::string& name, const std::map<int, std::string>& cpu_lists) {
+  const std::string root = absl::StrCat(::testing::TempDir(), "/", name);
+  mkdir(root.c_str(), 0700);
+  for (const auto& node : cpu_lists) {
+    const std::string node_directory =
+        absl::StrCat(root, "/node", node.first);
+    mkdir(node_directory.c_str(), 0700);
+    std::ofstream(absl::StrCat(node_directory, "/cpulist"))
+        << node.second << "\n";
+  }
+  // Other entries of the real directory are ignored.
+  mkdir(absl::StrCat(root, "/power").c_str(), 0700);
+  return root;
+}
+
+// Two sockets of 4 cores with hyper-threading.
+CpuTopology DualSocketTopology() {
+  return CpuTopology({{0, {0, 1, 2, 3, 8, 9, 10, 11}},
+                      {1, {4, 5, 6, 7, 12, 13, 14, 15}}});
+}
+
+TEST(ParseCpuListTest, ParsesRangesAndSingleCpus) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::vector<int> cpus,
+                               ParseCpuList("8-9,0-2,5\n"));
+  EXPECT_THAT(cpus, ElementsAre(0, 1, 2, 5, 8, 9));
+}
+
+TEST(ParseCpuListTest, ParsesEmptyList) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::vector<int> cpus, ParseCpuList("\n"));
+  EXPECT_THAT(cpus, IsEmpty());
+}
+
+TEST(ParseCpuListTest, FailsWithInvalidList) {
+  for (const char* cpu_list : {"a", "3-1", "1-2-3", "-1", "0-4096"}) {
+    EXPECT_EQ(ParseCpuList(cpu_list).status().code(),
+              absl::StatusCode::kInvalidArgument)
+        << cpu_list;
+  }
+}
+
+TEST(CpuTopologyTest, ReadsFakeTopology) {
+  const std::string directory = WriteFakeNodeDirectory(
+      "dual_socket", {{0, "0-3,8-11"}, {1, "4-7,12-15"}, {2, ""}});
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(CpuTopology topology,
+                               CpuTopology::Read(directory));
+
+  EXPECT_EQ(topology.node_cpus().size(), 3);
+  EXPECT_THAT(*topology.CpusOfNode(1),
+              ElementsAre(4, 5, 6, 7, 12, 13, 14, 15));
+  // A memory-only node.
+  EXPECT_THAT(*topology.CpusOfNode(2), IsEmpty());
+  EXPECT_EQ(topology.CpusOfNode(3), nullptr);
+}
+
+TEST(CpuTopologyTest, FallsBackToSingleNodeWithoutNumaSupport) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      CpuTopology topology,
+      CpuTopology::Read(absl::StrCat(::testing::TempDir(), "/no_numa")));
+
+  ASSERT_EQ(topology.node_cpus().size(), 1);
+  ASSERT_NE(topology.CpusOfNode(0), nullptr);
+  EXPECT_FALSE(topology.CpusOfNode(0)->empty());
+}
+
+TEST(CpuTopologyTest, ReadsHostTopology) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(CpuTopology topology, CpuTopology::Read());
+
+  EXPECT_FALSE(topology.node_cpus().empty());
+}
+
+TEST(CpuTopologyTest, FindsNodeOfCpus) {
+  const CpuTopology topology = DualSocketTopology();
+
+  EXPECT_EQ(topology.NodeOfCpus({4, 12}), 1);
+  EXPECT_EQ(topology.NodeOfCpus({0, 1, 8}), 0);
+  EXPECT_EQ(topology.NodeOfCpus({3, 4}), -1);
+  EXPECT_EQ(topology.NodeOfCpus({42}), -1);
+}
+
+TEST(CpuPlacementTest, ResolvesNumaNode) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      CpuPlacement placement,
+      CpuPlacement::Create(/*cpus=*/{}, /*numa_node=*/1,
+                           /*replicate_model=*/true, DualSocketTopology()));
+
+  EXPECT_THAT(placement.cpus(), ElementsAre(4, 5, 6, 7, 12, 13, 14, 15));
+  EXPECT_EQ(placement.numa_node(), 1);
+  EXPECT_TRUE(placement.replicate_model());
+}
+
+TEST(CpuPlacementTest, ExplicitCpusTakePrecedence) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      CpuPlacement placement,
+      CpuPlacement::Create(/*cpus=*/{9, 1, 1}, /*numa_node=*/1,
+                           /*replicate_model=*/false, DualSocketTopology()));
+
+  EXPECT_THAT(placement.cpus(), ElementsAre(1, 9));
+  EXPECT_EQ(placement.numa_node(), 0);
+}
+
+TEST(CpuPlacementTest, AllowsCpusSpanningNodesWithoutReplication) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      CpuPlacement placement,
+      CpuPlacement::Create(/*cpus=*/{0, 4}, /*numa_node=*/-1,
+                           /*replicate_model=*/false, DualSocketTopology()));
+
+  EXPECT_EQ(placement.numa_node(), -1);
+}
+
+TEST(CpuPlacementTest, FailsToReplicateAcrossNodes) {
+  EXPECT_EQ(CpuPlacement::Create(/*cpus=*/{0, 4}, /*numa_node=*/-1,
+                                 /*replicate_model=*/true,
+                                 DualSocketTopology())
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(CpuPlacementTest, FailsWithUnknownNode) {
+  EXPECT_EQ(CpuPlacement::Create(/*cpus=*/{}, /*numa_node=*/2,
+                                 /*replicate_model=*/false,
+                                 DualSocketTopology())
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(CpuPlacementTest, FailsWithoutCpusNorNode) {
+  EXPECT_EQ(CpuPlacement::Create(/*cpus=*/{}, /*numa_node=*/-1,
+                                 /*replicate_model=*/false,
+                                 DualSocketTopology())
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+#ifdef __linux__
+TEST(ScopedCpuAffinityTest, RestrictsAndRestoresAffinity) {
+  cpu_set_t initial_mask;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(initial_mask), &initial_mask), 0);
+  int allowed_cpu = 0;
+  while (!CPU_ISSET(allowed_cpu, &initial_mask)) {
+    ++allowed_cpu;
+  }
+
+  {
+    ScopedCpuAffinity affinity({allowed_cpu});
+    SUPPORT_ASSERT_OK(affinity.status());
+    cpu_set_t mask;
+    ASSERT_EQ(sched_getaffinity(0, sizeof(mask), &mask), 0);
+    EXPECT_EQ(CPU_COUNT(&mask), 1);
+    EXPECT_TRUE(CPU_ISSET(allowed_cpu, &mask));
+  }
+
+  cpu_set_t final_mask;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(final_mask), &final_mask), 0);
+  EXPECT_TRUE(CPU_EQUAL(&initial_mask, &final_mask));
+}
+
+TEST(ScopedCpuAffinityTest, FailsWithUnavailableCpus) {
+  ScopedCpuAffinity affinity({1023});
+
+  EXPECT_EQ(affinity.status().code(), absl::StatusCode::kInvalidArgument);
+}
+#endif  // __linux__
+
+TEST(GetModelReplicaTest, SharesReplicasPerNode) {
+  const std::string model = "some model contents";
+
+  std::shared_ptr<const std::string> first = GetModelReplica(model, 0);
+  std::shared_ptr<const std::string> same_node = GetModelReplica(model, 0);
+  std::shared_ptr<const std::string> other_node = GetModelReplica(model, 1);
+  std::shared_ptr<const std::string> other_model =
+      GetModelReplica("some other model", 0);
+
+  EXPECT_EQ(*first, model);
+  EXPECT_EQ(first, same_node);
+  EXPECT_NE(first->data(), model.data());
+  EXPECT_EQ(*other_node, model);
+  EXPECT_NE(other_node, first);
+  EXPECT_NE(other_model, first);
+}
+
+}  // namespace
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
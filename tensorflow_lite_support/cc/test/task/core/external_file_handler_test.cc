@@ -0,0 +1,133 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/external_file_handler.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/status_matchers.h"
+#include "tensorflow_lite_support/cc/task/core/proto/external_file_proto_inc.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+namespace {
+
+constexpr char kFileContent[] = "some file content to be mapped in memory";
+
+std::string WriteTestFile(const std::string& name) {
+  std::string path = absl::StrCat(::testing::TempDir(), "/", name);
+  std::ofstream file(path, std::ios::binary);
+  file << kFileContent;
+  return path;
+}
+
+TEST(ExternalFileHandlerTest, MapsFileWithDefaultOptions) {
+  ExternalFile external_file;
+  external_file.set_file_name(WriteTestFile("default_options"));
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ExternalFileHandler> handler,
+      ExternalFileHandler::CreateFromExternalFile(&external_file));
+
+  EXPECT_EQ(handler->GetFileContent(), kFileContent);
+}
+
+TEST(ExternalFileHandlerTest, MapsFileWithWillNeedPrefetch) {
+  ExternalFile external_file;
+  external_file.set_file_name(WriteTestFile("willneed_prefetch"));
+  external_file.mutable_memory_mapping_options()->set_prefetch_mode(
+      MemoryMappingOptions::ADVISE_WILLNEED);
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ExternalFileHandler> handler,
+      ExternalFileHandler::CreateFromExternalFile(&external_file));
+
+  EXPECT_EQ(handler->GetFileContent(), kFileContent);
+}
+
+TEST(ExternalFileHandlerTest, MapsFileWithPopulatePrefetchAndHugePages) {
+  ExternalFile external_file;
+  external_file.set_file_name(WriteTestFile("populate_prefetch"));
+  external_file.mutable_memory_mapping_options()->set_prefetch_mode(
+      MemoryMappingOptions::POPULATE);
+  external_file.mutable_memory_mapping_options()->set_transparent_huge_pages(
+      true);
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ExternalFileHandler> handler,
+      ExternalFileHandler::CreateFromExternalFile(&external_file));
+
+  EXPECT_EQ(handler->GetFileContent(), kFileContent);
+}
+
+TEST(ExternalFileHandlerTest, MapsFileDescriptorWithOffsetAndLock) {
+  const std::string path = WriteTestFile("locked_with_offset");
+  int fd = open(path.c_str(), O_RDONLY);
+  ASSERT_GE(fd, 0);
+  ExternalFile external_file;
+  external_file.mutable_file_descriptor_meta()->set_fd(fd);
+  external_file.mutable_file_descriptor_meta()->set_offset(5);
+  external_file.mutable_file_descriptor_meta()->set_length(4);
+  external_file.mutable_memory_mapping_options()->set_prefetch_mode(
+      MemoryMappingOptions::POPULATE);
+  external_file.mutable_memory_mapping_options()->set_lock_in_memory(true);
+
+  {
+    // A single page fits in the default locked memory limit.
+    SUPPORT_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<ExternalFileHandler> handler,
+        ExternalFileHandler::CreateFromExternalFile(&external_file));
+    EXPECT_EQ(handler->GetFileContent(), "file");
+  }
+  close(fd);
+}
+
+TEST(ExternalFileHandlerTest, IgnoresMappingOptionsForFileContent) {
+  ExternalFile external_file;
+  external_file.set_file_content(kFileContent);
+  external_file.mutable_memory_mapping_options()->set_lock_in_memory(true);
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ExternalFileHandler> handler,
+      ExternalFileHandler::CreateFromExternalFile(&external_file));
+
+  EXPECT_EQ(handler->GetFileContent(), kFileContent);
+}
+
+TEST(ExternalFileHandlerTest, FailsWithMissingFile) {
+  ExternalFile external_file;
+  external_file.set_file_name(
+      absl::StrCat(::testing::TempDir(), "/does_not_exist"));
+
+  EXPECT_EQ(ExternalFileHandler::CreateFromExternalFile(&external_file)
+                .status()
+                .code(),
+            absl::StatusCode::kNotFound);
+}
+
+}  // namespace
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,156 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/label_map_item.h"
+
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/task/processor/proto/classifications.pb.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// food -> fruit -> {banana, apple}, food -> vegetable.
+std::vector<LabelMapItem> TreeLabelMap() {
+  return {
+      {.name = "food", .child_name = {"fruit", "vegetable"}},
+      {.name = "fruit", .child_name = {"banana", "apple"}},
+      {.name = "banana"},
+      {.name = "apple"},
+      {.name = "vegetable"},
+      {.name = "dog"},
+  };
+}
+
+// Same as above, but "tomato" is both a fruit and a vegetable.
+std::vector<LabelMapItem> DagLabelMap() {
+  std::vector<LabelMapItem> label_map = TreeLabelMap();
+  label_map[1].child_name.push_back("tomato");
+  label_map[4].child_name.push_back("tomato");
+  return label_map;
+}
+
+TEST(LabelHierarchyTest, InitializeFailsWithoutRelationships) {
+  LabelHierarchy hierarchy;
+
+  absl::Status status =
+      hierarchy.InitializeFromLabelMap({{.name = "a"}, {.name = "b"}});
+
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_FALSE(hierarchy.HaveAncestorDescendantRelationship("a", "b"));
+}
+
+class LabelHierarchyTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(hierarchy_
+                    .InitializeFromLabelMap(GetParam() ? DagLabelMap()
+                                                       : TreeLabelMap())
+                    .ok());
+  }
+
+  int Id(const std::string& name) const { return hierarchy_.GetLabelId(name); }
+
+  LabelHierarchy hierarchy_;
+};
+
+TEST_P(LabelHierarchyTest, HaveAncestorDescendantRelationshipSucceeds) {
+  EXPECT_TRUE(hierarchy_.HaveAncestorDescendantRelationship("food", "fruit"));
+  EXPECT_TRUE(hierarchy_.HaveAncestorDescendantRelationship("food", "banana"));
+  EXPECT_TRUE(hierarchy_.HaveAncestorDescendantRelationship("fruit", "apple"));
+  EXPECT_FALSE(hierarchy_.HaveAncestorDescendantRelationship("fruit", "food"));
+  EXPECT_FALSE(
+      hierarchy_.HaveAncestorDescendantRelationship("fruit", "vegetable"));
+  EXPECT_FALSE(hierarchy_.HaveAncestorDescendantRelationship("food", "food"));
+  EXPECT_FALSE(hierarchy_.HaveAncestorDescendantRelationship("food", "dog"));
+  EXPECT_FALSE(
+      hierarchy_.HaveAncestorDescendantRelationship("food", "unknown"));
+  EXPECT_FALSE(
+      hierarchy_.HaveAncestorDescendantRelationship("unknown", "food"));
+}
+
+TEST_P(LabelHierarchyTest, GetParentIdsSucceeds) {
+  EXPECT_THAT(hierarchy_.GetParentIds(Id("banana")), ElementsAre(Id("fruit")));
+  EXPECT_THAT(hierarchy_.GetParentIds(Id("food")), IsEmpty());
+  EXPECT_THAT(hierarchy_.GetParentIds(-1), IsEmpty());
+  EXPECT_EQ(hierarchy_.GetLabelName(Id("apple")), "apple");
+}
+
+TEST_P(LabelHierarchyTest, CollapseToAncestorSucceeds) {
+  const std::vector<int> coarse = {Id("food"), Id("fruit"), Id("dog")};
+
+  EXPECT_EQ(hierarchy_.CollapseToAncestor(Id("banana"), coarse), Id("fruit"));
+  EXPECT_EQ(hierarchy_.CollapseToAncestor(Id("vegetable"), coarse),
+            Id("food"));
+  EXPECT_EQ(hierarchy_.CollapseToAncestor(Id("dog"), coarse), Id("dog"));
+  EXPECT_EQ(hierarchy_.CollapseToAncestor(Id("food"), {Id("fruit")}), -1);
+}
+
+TEST_P(LabelHierarchyTest, PruneAncestorsSucceeds) {
+  processor::ClassificationResult result;
+  processor::Classifications* head = result.add_classifications();
+  for (const char* name : {"food", "banana", "unknown", "fruit", "dog"}) {
+    head->add_classes()->set_class_name(name);
+  }
+  result.add_classifications()->add_classes()->set_class_name("food");
+
+  hierarchy_.PruneAncestors(&result);
+
+  std::vector<std::string> names;
+  for (const auto& label : result.classifications(0).classes()) {
+    names.push_back(label.class_name());
+  }
+  EXPECT_THAT(names, ElementsAre("banana", "unknown", "dog"));
+  EXPECT_EQ(result.classifications(1).classes_size(), 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(TreeAndDag, LabelHierarchyTest,
+                         ::testing::Bool());
+
+TEST(LabelHierarchyDagTest, HandlesMultipleParents) {
+  LabelHierarchy hierarchy;
+  ASSERT_TRUE(hierarchy.InitializeFromLabelMap(DagLabelMap()).ok());
+
+  EXPECT_TRUE(hierarchy.HaveAncestorDescendantRelationship("fruit", "tomato"));
+  EXPECT_TRUE(
+      hierarchy.HaveAncestorDescendantRelationship("vegetable", "tomato"));
+  EXPECT_TRUE(hierarchy.HaveAncestorDescendantRelationship("food", "tomato"));
+  EXPECT_THAT(hierarchy.GetParentIds(hierarchy.GetLabelId("tomato")),
+              ::testing::SizeIs(2));
+}
+
+TEST(LabelHierarchyDagTest, HandlesCycles) {
+  LabelHierarchy hierarchy;
+  ASSERT_TRUE(hierarchy
+                  .InitializeFromLabelMap({{.name = "a", .child_name = {"b"}},
+                                           {.name = "b", .child_name = {"a"}}})
+                  .ok());
+
+  EXPECT_TRUE(hierarchy.HaveAncestorDescendantRelationship("a", "b"));
+  EXPECT_TRUE(hierarchy.HaveAncestorDescendantRelationship("b", "a"));
+}
+
+}  // namespace
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
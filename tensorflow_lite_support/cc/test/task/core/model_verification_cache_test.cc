@@ -0,0 +1,105 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/model_verification_cache.h"
+
+#include <sys/stat.h>
+
+#include <string>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/escaping.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/status_matchers.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+namespace {
+
+std::string MakeCacheDir(const std::string& name) {
+  std::string path = absl::StrCat(::testing::TempDir(), "/", name);
+  mkdir(path.c_str(), 0700);
+  return path;
+}
+
+TEST(ModelVerificationCacheTest, XxHash64MatchesReferenceValues) {
+  EXPECT_EQ(ModelVerificationCache::XxHash64(""), 0xEF46DB3751D8E999ULL);
+  EXPECT_EQ(ModelVerificationCache::XxHash64("abc"), 0x44BC2CF5AD770999ULL);
+  EXPECT_EQ(ModelVerificationCache::XxHash64(
+                "Nobody inspects the spammish repetition"),
+            0xFBCEA83C8A378BF1ULL);
+}
+
+TEST(ModelVerificationCacheTest, Sha256MatchesReferenceValues) {
+  EXPECT_EQ(absl::BytesToHexString(ModelVerificationCache::Sha256("")),
+            "e3b0c44298fc1c149afbf4c8996fb924"
+            "27ae41e4649b934ca495991b7852b855");
+  EXPECT_EQ(absl::BytesToHexString(ModelVerificationCache::Sha256("abc")),
+            "ba7816bf8f01cfea414140de5dae2223"
+            "b00361a396177a9cb410ff61f20015ad");
+  // Two blocks of padding.
+  EXPECT_EQ(absl::BytesToHexString(ModelVerificationCache::Sha256(
+                "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")),
+            "248d6a61d20638b8e5c026930c3e6039"
+            "a33ce45964ff2167f6ecedd419db06c1");
+  // Several blocks.
+  EXPECT_EQ(absl::BytesToHexString(
+                ModelVerificationCache::Sha256(std::string(1000, 'a'))),
+            "41edece42d63e8d9bf515a9ba6932e1c"
+            "20cbc9f5a5d134645adb5db1b9737ea3");
+}
+
+TEST(ModelVerificationCacheTest, KeyDependsOnContents) {
+  EXPECT_EQ(ModelVerificationCache::ComputeKey("model"),
+            ModelVerificationCache::ComputeKey("model"));
+  EXPECT_NE(ModelVerificationCache::ComputeKey("model"),
+            ModelVerificationCache::ComputeKey("modem"));
+}
+
+TEST(ModelVerificationCacheTest, FailsWithMissingDirectory) {
+  EXPECT_EQ(ModelVerificationCache::Create(
+                absl::StrCat(::testing::TempDir(), "/does/not/exist"))
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(ModelVerificationCacheTest, RecordsVerifiedModelsAcrossInstances) {
+  const std::string cache_dir = MakeCacheDir("verification_cache");
+  const std::string key = ModelVerificationCache::ComputeKey("some model");
+  const std::string other_key =
+      ModelVerificationCache::ComputeKey("some other model");
+  {
+    SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ModelVerificationCache> cache,
+                                 ModelVerificationCache::Create(cache_dir));
+    EXPECT_FALSE(cache->Contains(key));
+    SUPPORT_ASSERT_OK(cache->Insert(key));
+    EXPECT_TRUE(cache->Contains(key));
+    EXPECT_FALSE(cache->Contains(other_key));
+  }
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ModelVerificationCache> cache,
+                               ModelVerificationCache::Create(cache_dir));
+  EXPECT_TRUE(cache->Contains(key));
+  EXPECT_FALSE(cache->Contains(other_key));
+}
+
+}  // namespace
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,121 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/raw_output_tensor.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/status_matchers.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Owns a TfLiteTensor pointing to `values`, with the provided dimensions.
+class FakeTensor {
+ public:
+  template <typename T>
+  FakeTensor(TfLiteType type, std::vector<T>* values,
+             const std::vector<int>& dims) {
+    tensor_.type = type;
+    tensor_.name = "fake";
+    tensor_.data.raw = reinterpret_cast<char*>(values->data());
+    tensor_.bytes = values->size() * sizeof(T);
+    tensor_.dims = TfLiteIntArrayCreate(dims.size());
+    for (size_t i = 0; i < dims.size(); ++i) {
+      tensor_.dims->data[i] = dims[i];
+    }
+  }
+  ~FakeTensor() { TfLiteIntArrayFree(tensor_.dims); }
+
+  FakeTensor(const FakeTensor&) = delete;
+  FakeTensor& operator=(const FakeTensor&) = delete;
+
+  TfLiteTensor* get() { return &tensor_; }
+
+ private:
+  TfLiteTensor tensor_ = {};
+};
+
+TEST(RawOutputTensorTest, ViewsFloatTensor) {
+  std::vector<float> values = {0.1, 0.7, 0.2};
+  FakeTensor tensor(kTfLiteFloat32, &values, {1, 3});
+  RawOutputTensor view(tensor.get());
+
+  EXPECT_EQ(view.type(), kTfLiteFloat32);
+  EXPECT_THAT(view.dims(), ElementsAre(1, 3));
+  EXPECT_EQ(view.num_elements(), 3);
+  EXPECT_FALSE(view.is_quantized());
+  SUPPORT_ASSERT_OK_AND_ASSIGN(absl::Span<const float> data,
+                               view.data<float>());
+  // The view points to the tensor data.
+  EXPECT_EQ(data.data(), values.data());
+  EXPECT_EQ(data.size(), 3);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(int arg_max, view.ArgMax());
+  EXPECT_EQ(arg_max, 1);
+}
+
+TEST(RawOutputTensorTest, ViewsQuantizedTensor) {
+  std::vector<uint8_t> values = {3, 250, 250, 7};
+  FakeTensor tensor(kTfLiteUInt8, &values, {1, 1, 1, 4});
+  tensor.get()->params.scale = 0.5;
+  tensor.get()->params.zero_point = 2;
+  RawOutputTensor view(tensor.get());
+
+  EXPECT_TRUE(view.is_quantized());
+  EXPECT_FLOAT_EQ(view.scale(), 0.5);
+  EXPECT_EQ(view.zero_point(), 2);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> data,
+                               view.data<uint8_t>());
+  EXPECT_THAT(data, ElementsAre(3, 250, 250, 7));
+  // Ties are resolved in favor of the first index.
+  SUPPORT_ASSERT_OK_AND_ASSIGN(int arg_max, view.ArgMax());
+  EXPECT_EQ(arg_max, 1);
+}
+
+TEST(RawOutputTensorTest, FailsWithTypeMismatch) {
+  std::vector<uint8_t> values = {1, 2};
+  FakeTensor tensor(kTfLiteUInt8, &values, {2});
+  RawOutputTensor view(tensor.get());
+
+  EXPECT_EQ(view.data<float>().status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(RawOutputTensorTest, ArgMaxFailsWithUnsupportedOrEmptyTensor) {
+  std::vector<int32_t> int_values = {1, 2};
+  FakeTensor int_tensor(kTfLiteInt32, &int_values, {2});
+  std::vector<float> no_values;
+  FakeTensor empty_tensor(kTfLiteFloat32, &no_values, {0});
+
+  EXPECT_EQ(RawOutputTensor(int_tensor.get()).ArgMax().status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(RawOutputTensor(empty_tensor.get()).ArgMax().status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
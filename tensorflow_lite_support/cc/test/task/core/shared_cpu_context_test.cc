@@ -0,0 +1,157 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/shared_cpu_context.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/synchronization/notification.h"  // from @com_google_absl
+#include "absl/time/clock.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/status_matchers.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+namespace {
+
+std::shared_ptr<SharedCpuContext> CreateContext(int thread_budget) {
+  SharedCpuContext::Options options;
+  options.thread_budget = thread_budget;
+  return SharedCpuContext::Create(options).value();
+}
+
+TEST(SharedCpuContextTest, FailsWithNegativeBudget) {
+  SharedCpuContext::Options options;
+  options.thread_budget = -1;
+
+  EXPECT_EQ(SharedCpuContext::Create(options).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(SharedCpuContextTest, DefaultsToNumberOfCores) {
+  EXPECT_GE(CreateContext(0)->thread_budget(), 1);
+}
+
+TEST(SharedCpuContextTest, LeasesThreadsFromBudget) {
+  std::shared_ptr<SharedCpuContext> context = CreateContext(8);
+
+  std::unique_ptr<SharedCpuContext::Lease> first = context->Acquire(3);
+  std::unique_ptr<SharedCpuContext::Lease> second = context->Acquire(4);
+
+  EXPECT_EQ(first->num_threads(), 3);
+  EXPECT_EQ(second->num_threads(), 4);
+  // Concurrent leases never share a backend context.
+  EXPECT_NE(first->context(), second->context());
+  EXPECT_EQ(first->context()->type, kTfLiteCpuBackendContext);
+  EXPECT_EQ(context->available_threads(), 1);
+
+  first.reset();
+  EXPECT_EQ(context->available_threads(), 4);
+  second.reset();
+  EXPECT_EQ(context->available_threads(), 8);
+}
+
+TEST(SharedCpuContextTest, ClampsRequestedThreads) {
+  std::shared_ptr<SharedCpuContext> context = CreateContext(2);
+
+  EXPECT_EQ(context->Acquire(0)->num_threads(), 1);
+  EXPECT_EQ(context->Acquire(16)->num_threads(), 2);
+}
+
+TEST(SharedCpuContextTest, ResolvesDefaultThreadsToBudget) {
+  std::shared_ptr<SharedCpuContext> context = CreateContext(3);
+
+  EXPECT_EQ(context->Acquire(-1)->num_threads(), 3);
+}
+
+TEST(SharedCpuContextTest, ReusesReleasedBackendContexts) {
+  std::shared_ptr<SharedCpuContext> context = CreateContext(4);
+
+  TfLiteExternalContext* backend_context = context->Acquire(2)->context();
+
+  EXPECT_EQ(context->Acquire(4)->context(), backend_context);
+}
+
+TEST(SharedCpuContextTest, WaitsForThreadsToBeReleased) {
+  std::shared_ptr<SharedCpuContext> context = CreateContext(4);
+  std::unique_ptr<SharedCpuContext::Lease> lease = context->Acquire(3);
+  absl::Notification acquired;
+
+  std::thread waiter([&] {
+    std::unique_ptr<SharedCpuContext::Lease> other = context->Acquire(2);
+    acquired.Notify();
+  });
+  EXPECT_FALSE(acquired.WaitForNotificationWithTimeout(absl::Milliseconds(50)));
+  lease.reset();
+  acquired.WaitForNotification();
+  waiter.join();
+
+  EXPECT_EQ(context->available_threads(), 4);
+}
+
+TEST(SharedCpuContextTest, NeverExceedsBudgetUnderContention) {
+  constexpr int kBudget = 4;
+  std::shared_ptr<SharedCpuContext> context = CreateContext(kBudget);
+  std::atomic<int> leased_threads(0);
+  std::atomic<int> max_leased_threads(0);
+
+  std::vector<std::thread> clients;
+  for (int i = 0; i < 8; ++i) {
+    clients.emplace_back([&, i] {
+      for (int run = 0; run < 50; ++run) {
+        std::unique_ptr<SharedCpuContext::Lease> lease =
+            context->Acquire(1 + (i + run) % 3);
+        int leased = leased_threads += lease->num_threads();
+        int max_leased = max_leased_threads;
+        while (leased > max_leased &&
+               !max_leased_threads.compare_exchange_weak(max_leased, leased)) {
+        }
+        leased_threads -= lease->num_threads();
+      }
+    });
+  }
+  for (std::thread& client : clients) {
+    client.join();
+  }
+
+  EXPECT_LE(max_leased_threads, kBudget);
+  EXPECT_EQ(context->available_threads(), kBudget);
+}
+
+TEST(SharedCpuContextTest, DefaultContextIsProcessWide) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::shared_ptr<SharedCpuContext> context,
+                               SharedCpuContext::GetDefault(6));
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::shared_ptr<SharedCpuContext> same_context,
+                               SharedCpuContext::GetDefault(6));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::shared_ptr<SharedCpuContext> any_budget,
+                               SharedCpuContext::GetDefault(0));
+  EXPECT_EQ(same_context, context);
+  EXPECT_EQ(any_budget, context);
+  EXPECT_EQ(SharedCpuContext::GetDefault(3).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
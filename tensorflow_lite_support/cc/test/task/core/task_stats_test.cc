@@ -0,0 +1,124 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/core/task_stats.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+
+namespace tflite {
+namespace task {
+namespace core {
+namespace {
+
+using ::testing::AllOf;
+using ::testing::Ge;
+using ::testing::Le;
+
+TEST(LatencyHistogramTest, SnapshotIsEmptyByDefault) {
+  LatencyHistogram histogram;
+
+  LatencyStats stats = histogram.Snapshot();
+
+  EXPECT_EQ(stats.count, 0);
+  EXPECT_EQ(stats.p99, absl::ZeroDuration());
+}
+
+TEST(LatencyHistogramTest, EstimatesPercentilesWithin25Percent) {
+  LatencyHistogram histogram;
+  // 1ms to 100ms uniformly.
+  for (int i = 1; i <= 100; ++i) {
+    histogram.Record(absl::Milliseconds(i));
+  }
+
+  LatencyStats stats = histogram.Snapshot();
+
+  EXPECT_EQ(stats.count, 100);
+  EXPECT_EQ(stats.max, absl::Milliseconds(100));
+  EXPECT_EQ(stats.mean, absl::Microseconds(50500));
+  EXPECT_THAT(stats.p50, AllOf(Ge(absl::Milliseconds(50)),
+                               Le(absl::Milliseconds(50) * 1.25)));
+  EXPECT_THAT(stats.p90, AllOf(Ge(absl::Milliseconds(90)),
+                               Le(absl::Milliseconds(90) * 1.25)));
+  EXPECT_THAT(stats.p99, AllOf(Ge(absl::Milliseconds(99)),
+                               Le(absl::Milliseconds(100))));
+}
+
+TEST(LatencyHistogramTest, HandlesExtremeValues) {
+  LatencyHistogram histogram;
+  histogram.Record(absl::ZeroDuration());
+  histogram.Record(absl::Hours(1000));
+
+  LatencyStats stats = histogram.Snapshot();
+
+  EXPECT_EQ(stats.count, 2);
+  EXPECT_EQ(stats.max, absl::Hours(1000));
+  EXPECT_LE(stats.p50, absl::Microseconds(1));
+}
+
+TEST(LatencyHistogramTest, RecordsConcurrently) {
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&histogram] {
+      for (int i = 0; i < 1000; ++i) {
+        histogram.Record(absl::Microseconds(i));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(histogram.Snapshot().count, 4000);
+  EXPECT_EQ(histogram.Snapshot().max, absl::Microseconds(999));
+}
+
+TEST(TaskStatsRecorderTest, CountsInvocationsAndResets) {
+  TaskStatsRecorder recorder;
+  recorder.RecordInvocation(absl::OkStatus(), /*fell_back=*/false);
+  recorder.RecordInvocation(absl::CancelledError(), /*fell_back=*/false);
+  recorder.RecordInvocation(absl::OkStatus(), /*fell_back=*/true);
+  recorder.RecordInputBytes(150528);
+  recorder.invoke().Record(absl::Milliseconds(3));
+
+  TaskStats stats = recorder.Snapshot();
+
+  EXPECT_EQ(stats.invocations, 3);
+  EXPECT_EQ(stats.failed_invocations, 1);
+  EXPECT_EQ(stats.cancelled_invocations, 1);
+  EXPECT_EQ(stats.fallback_invocations, 1);
+  EXPECT_EQ(stats.input_bytes, 150528);
+  EXPECT_EQ(stats.invoke.count, 1);
+  EXPECT_EQ(stats.preprocess.count, 0);
+  EXPECT_THAT(stats.DebugString(), testing::HasSubstr("invocations=3"));
+
+  recorder.Reset();
+
+  stats = recorder.Snapshot();
+  EXPECT_EQ(stats.invocations, 0);
+  EXPECT_EQ(stats.input_bytes, 0);
+  EXPECT_EQ(stats.invoke.count, 0);
+}
+
+}  // namespace
+}  // namespace core
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,206 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Compares DetectionPostprocessor::Postprocess, i.e. the anchor decoding and
+// non-max suppression, with the TFLite_Detection_PostProcess op, on the
+// output sizes of an SSD MobileNet trained on COCO (1917 anchors, 90 classes
+// plus background).
+
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/task/core/task_utils.h"
+#include "tensorflow_lite_support/cc/task/core/tflite_engine.h"
+#include "tensorflow_lite_support/cc/task/processor/detection_postprocessor.h"
+#include "tensorflow_lite_support/cc/test/task/processor/detection_test_utils.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+TfLiteRegistration* Register_DETECTION_POSTPROCESS();
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
+
+namespace tflite {
+namespace task {
+namespace processor {
+namespace {
+
+constexpr int kNumAnchors = 1917;
+// Including the background class.
+constexpr int kNumClasses = 91;
+constexpr int kMaxDetections = 10;
+constexpr float kScoreThreshold = 0.3f;
+constexpr float kIouThreshold = 0.6f;
+constexpr float kYScale = 10.0f;
+constexpr float kXScale = 10.0f;
+constexpr float kHScale = 5.0f;
+constexpr float kWScale = 5.0f;
+
+// Random raw SSD outputs, with most scores below the threshold as on real
+// images.
+struct RawOutputs {
+  RawOutputs() {
+    std::mt19937 rng(/*seed=*/42);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> encoding(0.0f, 1.0f);
+    for (int i = 0; i < kNumAnchors; ++i) {
+      const float size = 0.1f + 0.4f * unit(rng);
+      anchors.insert(anchors.end(), {unit(rng), unit(rng), size, size});
+      for (int j = 0; j < 4; ++j) {
+        box_encodings.push_back(encoding(rng));
+      }
+      for (int c = 0; c < kNumClasses; ++c) {
+        const float u = unit(rng);
+        scores.push_back(u * u * u * u);
+      }
+    }
+  }
+
+  std::vector<float> anchors;
+  std::vector<float> box_encodings;
+  std::vector<float> scores;
+};
+
+const RawOutputs& GetRawOutputs() {
+  static const RawOutputs* outputs = new RawOutputs();
+  return *outputs;
+}
+
+class DetectionPostProcessOpModel : public SingleOpModel {
+ public:
+  explicit DetectionPostProcessOpModel(bool use_regular_nms) {
+    const int box_encodings = AddInput(TensorType_FLOAT32);
+    const int class_predictions = AddInput(TensorType_FLOAT32);
+    const int anchors = AddInput(TensorType_FLOAT32);
+    AddOutput(TensorType_FLOAT32);
+    AddOutput(TensorType_FLOAT32);
+    AddOutput(TensorType_FLOAT32);
+    AddOutput(TensorType_FLOAT32);
+
+    flexbuffers::Builder fbb;
+    size_t start_map = fbb.StartMap();
+    fbb.Int("max_detections", kMaxDetections);
+    fbb.Int("max_classes_per_detection", 1);
+    fbb.Int("detections_per_class", kMaxDetections);
+    fbb.Bool("use_regular_nms", use_regular_nms);
+    fbb.Float("nms_score_threshold", kScoreThreshold);
+    fbb.Float("nms_iou_threshold", kIouThreshold);
+    fbb.Int("num_classes", kNumClasses - 1);
+    fbb.Float("y_scale", kYScale);
+    fbb.Float("x_scale", kXScale);
+    fbb.Float("h_scale", kHScale);
+    fbb.Float("w_scale", kWScale);
+    fbb.EndMap(start_map);
+    fbb.Finish();
+    SetCustomOp("TFLite_Detection_PostProcess", fbb.GetBuffer(),
+                tflite::ops::custom::Register_DETECTION_POSTPROCESS);
+
+    BuildInterpreter({{1, kNumAnchors, 4},
+                      {1, kNumAnchors, kNumClasses},
+                      {kNumAnchors, 4}});
+    const RawOutputs& outputs = GetRawOutputs();
+    PopulateTensor(box_encodings, outputs.box_encodings);
+    PopulateTensor(class_predictions, outputs.scores);
+    PopulateTensor(anchors, outputs.anchors);
+  }
+};
+
+void BM_DetectionPostProcessOp(benchmark::State& state) {
+  DetectionPostProcessOpModel model(/*use_regular_nms=*/state.range(0));
+  for (auto _ : state) {
+    model.Invoke();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumAnchors);
+}
+// 0: fast (class-agnostic) NMS, 1: regular (per-class) NMS.
+BENCHMARK(BM_DetectionPostProcessOp)->Arg(0)->Arg(1);
+
+void BM_DetectionPostprocessor(benchmark::State& state) {
+  const RawOutputs& outputs = GetRawOutputs();
+  const std::string model = BuildDetectionModel(
+      {1, kNumAnchors, 4}, {1, kNumAnchors, kNumClasses});
+  core::TfLiteEngine engine;
+  absl::Status status =
+      engine.BuildModelFromFlatBuffer(model.data(), model.size());
+  if (status.ok()) status = engine.InitInterpreter();
+  if (!status.ok()) {
+    state.SkipWithError(std::string(status.message()).c_str());
+    return;
+  }
+
+  auto options = absl::make_unique<DetectionOptions>();
+  options->set_box_format(DetectionOptions::ANCHOR_ENCODED);
+  options->set_y_scale(kYScale);
+  options->set_x_scale(kXScale);
+  options->set_h_scale(kHScale);
+  options->set_w_scale(kWScale);
+  for (int i = 0; i < kNumAnchors; ++i) {
+    DetectionOptions::Anchor* anchor = options->add_anchors();
+    anchor->set_ycenter(outputs.anchors[4 * i]);
+    anchor->set_xcenter(outputs.anchors[4 * i + 1]);
+    anchor->set_height(outputs.anchors[4 * i + 2]);
+    anchor->set_width(outputs.anchors[4 * i + 3]);
+  }
+  options->set_has_background_class(true);
+  options->set_score_threshold(kScoreThreshold);
+  options->set_iou_threshold(kIouThreshold);
+  options->set_max_results(kMaxDetections);
+  options->set_max_candidates(state.range(1));
+  options->set_class_agnostic(!state.range(0));
+  auto postprocessor =
+      DetectionPostprocessor::Create(&engine, {0, 1}, std::move(options));
+  if (!postprocessor.ok()) {
+    state.SkipWithError(std::string(postprocessor.status().message()).c_str());
+    return;
+  }
+  // The box and score tensors are not overwritten by postprocessing, so they
+  // only need to be populated once.
+  status = core::PopulateTensor(
+      outputs.box_encodings,
+      core::TfLiteEngine::GetOutput(engine.interpreter(), 0));
+  if (status.ok()) {
+    status = core::PopulateTensor(
+        outputs.scores, core::TfLiteEngine::GetOutput(engine.interpreter(), 1));
+  }
+  if (!status.ok()) {
+    state.SkipWithError(std::string(status.message()).c_str());
+    return;
+  }
+
+  vision::DetectionResult result;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize((*postprocessor)->Postprocess(
+        /*image_width=*/640, /*image_height=*/480, &result));
+  }
+  state.SetItemsProcessed(state.iterations() * kNumAnchors);
+}
+// First argument as above, second argument is the top-k pre-NMS limit, where
+// -1 keeps all the candidates.
+BENCHMARK(BM_DetectionPostprocessor)->ArgsProduct({{0, 1}, {-1, 100}});
+
+}  // namespace
+}  // namespace processor
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,611 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/processor/detection_postprocessor.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/cord.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/core/shims/cc/shims_test_util.h"
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/status_matchers.h"
+#include "tensorflow_lite_support/cc/task/core/task_utils.h"
+#include "tensorflow_lite_support/cc/task/core/tflite_engine.h"
+#include "tensorflow_lite_support/cc/task/processor/proto/detection_options.pb.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/detections_proto_inc.h"
+#include "tensorflow_lite_support/cc/test/message_matchers.h"
+#include "tensorflow_lite_support/cc/test/task/processor/detection_test_utils.h"
+#include "tensorflow_lite_support/cc/test/test_utils.h"
+#include "tensorflow_lite_support/metadata/cc/metadata_populator.h"
+#include "tensorflow_lite_support/metadata/metadata_schema_generated.h"
+
+namespace tflite {
+namespace task {
+namespace processor {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Lt;
+using ::testing::Optional;
+using ::tflite::metadata::ModelMetadataPopulator;
+using ::tflite::support::EqualsProto;
+using ::tflite::support::kTfLiteSupportPayload;
+using ::tflite::support::StatusOr;
+using ::tflite::support::TfLiteSupportStatus;
+using ::tflite::task::ParseTextProtoOrDie;
+using ::tflite::task::core::PopulateTensor;
+using ::tflite::task::core::TfLiteEngine;
+using ::tflite::task::vision::BoundingBox;
+using ::tflite::task::vision::Detection;
+using ::tflite::task::vision::DetectionResult;
+
+// Boxes 0 and 1 overlap heavily (IoU = 0.81), box 2 overlaps box 0 a little
+// (IoU ~= 0.14) and box 3 is disjoint from all others.
+constexpr float kBoxes[] = {0.0f, 0.0f, 1.0f, 1.0f,  //
+                            0.0f, 0.0f, 0.9f, 0.9f,  //
+                            0.5f, 0.5f, 1.5f, 1.5f,  //
+                            2.0f, 2.0f, 3.0f, 3.0f};
+// Scores of a background class and two object classes for each box.
+constexpr float kScores[] = {0.0f, 0.9f, 0.1f,  //
+                             0.0f, 0.8f, 0.2f,  //
+                             0.0f, 0.7f, 0.3f,  //
+                             0.0f, 0.1f, 0.6f};
+constexpr int kNumBoxes = 4;
+constexpr int kNumClasses = 3;
+
+MATCHER_P3(IsCandidate, box_index, class_index, score, "") {
+  return arg.box_index == box_index && arg.class_index == class_index &&
+         std::abs(arg.score - score) < 1e-3f;
+}
+
+NmsParameters DefaultParameters() {
+  NmsParameters params;
+  params.first_class = 1;
+  params.score_threshold = 0.15f;
+  params.iou_threshold = 0.5f;
+  return params;
+}
+
+TEST(NonMaxSuppressionTest, SucceedsPerClass) {
+  std::vector<DetectionCandidate> results = NonMaxSuppression(
+      kBoxes, kScores, kNumBoxes, kNumClasses, DefaultParameters());
+
+  EXPECT_THAT(results,
+              ElementsAre(IsCandidate(0, 1, 0.9f), IsCandidate(2, 1, 0.7f),
+                          IsCandidate(3, 2, 0.6f), IsCandidate(2, 2, 0.3f),
+                          IsCandidate(1, 2, 0.2f)));
+}
+
+TEST(NonMaxSuppressionTest, SucceedsClassAgnostic) {
+  NmsParameters params = DefaultParameters();
+  params.class_agnostic = true;
+
+  std::vector<DetectionCandidate> results =
+      NonMaxSuppression(kBoxes, kScores, kNumBoxes, kNumClasses, params);
+
+  EXPECT_THAT(results,
+              ElementsAre(IsCandidate(0, 1, 0.9f), IsCandidate(2, 1, 0.7f),
+                          IsCandidate(3, 2, 0.6f)));
+}
+
+TEST(NonMaxSuppressionTest, SucceedsWithMaxDetectionsAndCandidates) {
+  NmsParameters params = DefaultParameters();
+  params.max_detections = 2;
+  params.max_candidates = 1;
+
+  std::vector<DetectionCandidate> results =
+      NonMaxSuppression(kBoxes, kScores, kNumBoxes, kNumClasses, params);
+
+  // Only the best candidate of each class is kept before NMS.
+  EXPECT_THAT(results,
+              ElementsAre(IsCandidate(0, 1, 0.9f), IsCandidate(3, 2, 0.6f)));
+}
+
+TEST(NonMaxSuppressionTest, SucceedsWithSoftNms) {
+  NmsParameters params = DefaultParameters();
+  params.soft_nms_sigma = 0.5f;
+
+  std::vector<DetectionCandidate> results =
+      NonMaxSuppression(kBoxes, kScores, kNumBoxes, kNumClasses, params);
+
+  // Overlapping boxes are kept with decayed scores instead of being removed.
+  ASSERT_EQ(results.size(), 6);
+  EXPECT_THAT(results[0], IsCandidate(0, 1, 0.9f));
+  EXPECT_EQ(results[1].box_index, 2);
+  EXPECT_THAT(results[1].score, Lt(0.7f));
+  EXPECT_THAT(results[5].score, Lt(0.2f));
+  for (int i = 1; i < results.size(); ++i) {
+    EXPECT_GE(results[i - 1].score, results[i].score);
+  }
+}
+
+TEST(NonMaxSuppressionTest, SucceedsWithNoCandidates) {
+  NmsParameters params = DefaultParameters();
+  params.score_threshold = 0.95f;
+
+  EXPECT_TRUE(
+      NonMaxSuppression(kBoxes, kScores, kNumBoxes, kNumClasses, params)
+          .empty());
+}
+
+// Metadata of the box and score tensors of the models built by
+// BuildDetectionModel.
+struct DetectionMetadata {
+  // Contents of the "anchors.txt" file associated with the box tensor, if
+  // not empty.
+  std::string anchors_file;
+  // Contents of the "labels.txt" file associated with the score tensor, if
+  // not empty.
+  std::string labels_file;
+  // Score threshold of the score tensor, if > 0.
+  float score_threshold = 0.0f;
+};
+
+std::string CreateMetadataBuffer(const DetectionMetadata& detection_metadata) {
+  auto boxes = absl::make_unique<tflite::TensorMetadataT>();
+  boxes->name = "boxes";
+  if (!detection_metadata.anchors_file.empty()) {
+    auto anchors_file = absl::make_unique<tflite::AssociatedFileT>();
+    anchors_file->name = "anchors.txt";
+    anchors_file->type = tflite::AssociatedFileType_UNKNOWN;
+    boxes->associated_files.push_back(std::move(anchors_file));
+  }
+  auto scores = absl::make_unique<tflite::TensorMetadataT>();
+  scores->name = "scores";
+  if (!detection_metadata.labels_file.empty()) {
+    auto labels_file = absl::make_unique<tflite::AssociatedFileT>();
+    labels_file->name = "labels.txt";
+    labels_file->type = tflite::AssociatedFileType_TENSOR_AXIS_LABELS;
+    scores->associated_files.push_back(std::move(labels_file));
+  }
+  if (detection_metadata.score_threshold > 0) {
+    tflite::ScoreThresholdingOptionsT thresholding_options;
+    thresholding_options.global_score_threshold =
+        detection_metadata.score_threshold;
+    auto process_unit = absl::make_unique<tflite::ProcessUnitT>();
+    process_unit->options.Set(std::move(thresholding_options));
+    scores->process_units.push_back(std::move(process_unit));
+  }
+  auto subgraph = absl::make_unique<tflite::SubGraphMetadataT>();
+  subgraph->output_tensor_metadata.push_back(std::move(boxes));
+  subgraph->output_tensor_metadata.push_back(std::move(scores));
+  tflite::ModelMetadataT metadata;
+  metadata.subgraph_metadata.push_back(std::move(subgraph));
+
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::FinishModelMetadataBuffer(
+      builder, tflite::ModelMetadata::Pack(builder, &metadata));
+  return std::string(reinterpret_cast<const char*>(builder.GetBufferPointer()),
+                     builder.GetSize());
+}
+
+Detection* AddDetection(DetectionResult* result, int x, int y, int width,
+                        int height, int index, float score) {
+  auto* detection = result->add_detections();
+  auto* box = detection->mutable_bounding_box();
+  box->set_origin_x(x);
+  box->set_origin_y(y);
+  box->set_width(width);
+  box->set_height(height);
+  auto* detection_class = detection->add_classes();
+  detection_class->set_index(index);
+  detection_class->set_score(score);
+  return detection;
+}
+
+class DetectionPostprocessorTest : public tflite_shims::testing::Test {
+ protected:
+  // Builds the engine of a model with `num_boxes` boxes and `num_classes`
+  // classes, see BuildDetectionModel.
+  void BuildEngine(int num_boxes, int num_classes,
+                   tflite::TensorType type = tflite::TensorType_FLOAT32,
+                   const DetectionTensorQuantization& quantization = {}) {
+    BuildEngine({1, num_boxes, 4}, {1, num_boxes, num_classes}, type,
+                quantization);
+  }
+
+  void BuildEngine(const std::vector<int>& boxes_shape,
+                   const std::vector<int>& scores_shape,
+                   tflite::TensorType type = tflite::TensorType_FLOAT32,
+                   const DetectionTensorQuantization& quantization = {}) {
+    model_ = BuildDetectionModel(boxes_shape, scores_shape, type, quantization);
+    InitEngine();
+  }
+
+  // Same as above, with the provided metadata.
+  void BuildEngineWithMetadata(int num_boxes, int num_classes,
+                               const DetectionMetadata& metadata) {
+    const std::string model = BuildDetectionModel(
+        {1, num_boxes, 4}, {1, num_boxes, num_classes});
+    SUPPORT_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<ModelMetadataPopulator> populator,
+        ModelMetadataPopulator::CreateFromModelBuffer(model.data(),
+                                                      model.size()));
+    const std::string metadata_buffer = CreateMetadataBuffer(metadata);
+    populator->LoadMetadata(metadata_buffer.data(), metadata_buffer.size());
+    absl::flat_hash_map<std::string, std::string> associated_files;
+    if (!metadata.anchors_file.empty()) {
+      associated_files["anchors.txt"] = metadata.anchors_file;
+    }
+    if (!metadata.labels_file.empty()) {
+      associated_files["labels.txt"] = metadata.labels_file;
+    }
+    populator->LoadAssociatedFiles(associated_files);
+    SUPPORT_ASSERT_OK_AND_ASSIGN(model_, populator->Populate());
+    InitEngine();
+  }
+
+  StatusOr<std::unique_ptr<DetectionPostprocessor>> CreatePostprocessor(
+      const DetectionOptions& options) {
+    return DetectionPostprocessor::Create(
+        engine_.get(), {0, 1}, absl::make_unique<DetectionOptions>(options));
+  }
+
+  // Sets the contents of output tensor `index`: 0 for the boxes, 1 for the
+  // scores.
+  template <typename T>
+  void SetOutput(int index, const std::vector<T>& values) {
+    SUPPORT_ASSERT_OK(PopulateTensor(
+        values, TfLiteEngine::GetOutput(engine_->interpreter(), index)));
+  }
+
+  // The model buffer must outlive the engine.
+  std::string model_;
+  std::unique_ptr<TfLiteEngine> engine_;
+
+ private:
+  void InitEngine() {
+    engine_ = absl::make_unique<TfLiteEngine>();
+    SUPPORT_ASSERT_OK(
+        engine_->BuildModelFromFlatBuffer(model_.data(), model_.size()));
+    SUPPORT_ASSERT_OK(engine_->InitInterpreter());
+  }
+};
+
+TEST_F(DetectionPostprocessorTest, FailsWithInvalidMaxResults) {
+  ASSERT_NO_FATAL_FAILURE(BuildEngine(/*num_boxes=*/2, /*num_classes=*/2));
+  DetectionOptions options;
+  options.set_max_results(0);
+
+  StatusOr<std::unique_ptr<DetectionPostprocessor>> postprocessor =
+      CreatePostprocessor(options);
+
+  EXPECT_EQ(postprocessor.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(postprocessor.status().message(),
+              HasSubstr("Invalid `max_results` option"));
+  EXPECT_THAT(postprocessor.status().GetPayload(kTfLiteSupportPayload),
+              Optional(absl::Cord(
+                  absl::StrCat(TfLiteSupportStatus::kInvalidArgumentError))));
+}
+
+TEST_F(DetectionPostprocessorTest, FailsWithInvalidBoxDimensions) {
+  ASSERT_NO_FATAL_FAILURE(BuildEngine(/*boxes_shape=*/{1, 2, 5},
+                                      /*scores_shape=*/{1, 2, 2}));
+
+  StatusOr<std::unique_ptr<DetectionPostprocessor>> postprocessor =
+      CreatePostprocessor(DetectionOptions());
+
+  EXPECT_EQ(postprocessor.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(postprocessor.status().message(),
+              HasSubstr("Unexpected dimensions for output index 0"));
+  EXPECT_THAT(postprocessor.status().GetPayload(kTfLiteSupportPayload),
+              Optional(absl::Cord(absl::StrCat(
+                  TfLiteSupportStatus::kInvalidOutputTensorDimensionsError))));
+}
+
+TEST_F(DetectionPostprocessorTest, FailsWithMismatchedNumberOfRows) {
+  ASSERT_NO_FATAL_FAILURE(BuildEngine(/*boxes_shape=*/{1, 2, 4},
+                                      /*scores_shape=*/{1, 3, 2}));
+
+  StatusOr<std::unique_ptr<DetectionPostprocessor>> postprocessor =
+      CreatePostprocessor(DetectionOptions());
+
+  EXPECT_EQ(postprocessor.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(postprocessor.status().message(),
+              HasSubstr("Got 2 boxes for output index 0 but 3 rows"));
+  EXPECT_THAT(postprocessor.status().GetPayload(kTfLiteSupportPayload),
+              Optional(absl::Cord(absl::StrCat(
+                  TfLiteSupportStatus::kInvalidOutputTensorDimensionsError))));
+}
+
+TEST_F(DetectionPostprocessorTest, SucceedsWithCorners) {
+  ASSERT_NO_FATAL_FAILURE(BuildEngine(/*num_boxes=*/2, /*num_classes=*/2));
+  DetectionOptions options;
+  options.set_score_threshold(0.5f);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DetectionPostprocessor>
+                                   postprocessor,
+                               CreatePostprocessor(options));
+  ASSERT_NO_FATAL_FAILURE(SetOutput<float>(0, {0.1f, 0.2f, 0.5f, 0.6f,  //
+                                               0.5f, 0.5f, 1.0f, 1.0f}));
+  ASSERT_NO_FATAL_FAILURE(SetOutput<float>(1, {0.9f, 0.1f,  //
+                                               0.2f, 0.8f}));
+
+  DetectionResult result;
+  SUPPORT_ASSERT_OK(postprocessor->Postprocess(/*image_width=*/200,
+                                               /*image_height=*/100, &result));
+
+  DetectionResult expected;
+  AddDetection(&expected, 40, 10, 80, 40, /*index=*/0, /*score=*/0.9f);
+  AddDetection(&expected, 100, 50, 100, 50, /*index=*/1, /*score=*/0.8f);
+  EXPECT_THAT(result, EqualsProto(expected));
+}
+
+TEST_F(DetectionPostprocessorTest, SucceedsWithCenterSizeInPixels) {
+  ASSERT_NO_FATAL_FAILURE(BuildEngine(/*num_boxes=*/1, /*num_classes=*/1));
+  DetectionOptions options;
+  options.set_box_format(DetectionOptions::CENTER_SIZE);
+  options.set_normalized_coordinates(false);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DetectionPostprocessor>
+                                   postprocessor,
+                               CreatePostprocessor(options));
+  // [xcenter, ycenter, width, height] in pixels of the 16x8 model input, i.e.
+  // the center half of the image.
+  ASSERT_NO_FATAL_FAILURE(SetOutput<float>(0, {8.0f, 4.0f, 8.0f, 4.0f}));
+  ASSERT_NO_FATAL_FAILURE(SetOutput<float>(1, {0.7f}));
+
+  DetectionResult result;
+  SUPPORT_ASSERT_OK(postprocessor->Postprocess(/*image_width=*/100,
+                                               /*image_height=*/100, &result));
+
+  DetectionResult expected;
+  AddDetection(&expected, 25, 25, 50, 50, /*index=*/0, /*score=*/0.7f);
+  EXPECT_THAT(result, EqualsProto(expected));
+}
+
+// Encodings of two boxes, decoded with kAnchors and the default scales into
+// [ymin, xmin, ymax, xmax] = [0.42, 0.02, 0.62, 0.82] and
+// [0.2, 0.2, 0.3, 0.3].
+std::vector<float> GetBoxEncodings() {
+  return {1.0f, -2.0f, 0.0f, 5.0f * std::log(2.0f),  //
+          0.0f, 0.0f,  0.0f, 0.0f};
+}
+constexpr char kAnchors[] = R"(
+  anchors { ycenter: 0.5 xcenter: 0.5 height: 0.2 width: 0.4 }
+  anchors { ycenter: 0.25 xcenter: 0.25 height: 0.1 width: 0.1 }
+)";
+
+DetectionResult GetExpectedAnchorEncodedResult() {
+  DetectionResult expected;
+  AddDetection(&expected, 2, 42, 80, 20, /*index=*/0, /*score=*/0.9f);
+  AddDetection(&expected, 20, 20, 10, 10, /*index=*/0, /*score=*/0.6f);
+  return expected;
+}
+
+TEST_F(DetectionPostprocessorTest, SucceedsWithAnchorsFromOptions) {
+  ASSERT_NO_FATAL_FAILURE(BuildEngine(/*num_boxes=*/2, /*num_classes=*/1));
+  DetectionOptions options = ParseTextProtoOrDie<DetectionOptions>(kAnchors);
+  options.set_box_format(DetectionOptions::ANCHOR_ENCODED);
+  options.set_score_threshold(0.5f);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DetectionPostprocessor>
+                                   postprocessor,
+                               CreatePostprocessor(options));
+  ASSERT_NO_FATAL_FAILURE(SetOutput(0, GetBoxEncodings()));
+  ASSERT_NO_FATAL_FAILURE(SetOutput<float>(1, {0.9f, 0.6f}));
+
+  DetectionResult result;
+  SUPPORT_ASSERT_OK(postprocessor->Postprocess(/*image_width=*/100,
+                                               /*image_height=*/100, &result));
+
+  EXPECT_THAT(result, EqualsProto(GetExpectedAnchorEncodedResult()));
+}
+
+TEST_F(DetectionPostprocessorTest, SucceedsWithAnchorsFromMetadata) {
+  DetectionMetadata metadata;
+  // Blank lines and both separators are accepted.
+  metadata.anchors_file = "0.5 0.5 0.2 0.4\n\n0.25,0.25, 0.1,0.1\n";
+  ASSERT_NO_FATAL_FAILURE(BuildEngineWithMetadata(/*num_boxes=*/2,
+                                                  /*num_classes=*/1,
+                                                  metadata));
+  DetectionOptions options;
+  options.set_box_format(DetectionOptions::ANCHOR_ENCODED);
+  options.set_score_threshold(0.5f);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DetectionPostprocessor>
+                                   postprocessor,
+                               CreatePostprocessor(options));
+  ASSERT_NO_FATAL_FAILURE(SetOutput(0, GetBoxEncodings()));
+  ASSERT_NO_FATAL_FAILURE(SetOutput<float>(1, {0.9f, 0.6f}));
+
+  DetectionResult result;
+  SUPPORT_ASSERT_OK(postprocessor->Postprocess(/*image_width=*/100,
+                                               /*image_height=*/100, &result));
+
+  EXPECT_THAT(result, EqualsProto(GetExpectedAnchorEncodedResult()));
+}
+
+TEST_F(DetectionPostprocessorTest, FailsWithWrongNumberOfAnchors) {
+  DetectionMetadata metadata;
+  metadata.anchors_file = "0.5 0.5 0.2 0.4\n";
+  ASSERT_NO_FATAL_FAILURE(BuildEngineWithMetadata(/*num_boxes=*/2,
+                                                  /*num_classes=*/1,
+                                                  metadata));
+  DetectionOptions options;
+  options.set_box_format(DetectionOptions::ANCHOR_ENCODED);
+
+  StatusOr<std::unique_ptr<DetectionPostprocessor>> postprocessor =
+      CreatePostprocessor(options);
+
+  EXPECT_EQ(postprocessor.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(postprocessor.status().message(),
+              HasSubstr("Got 1 anchors, expected 2"));
+  EXPECT_THAT(postprocessor.status().GetPayload(kTfLiteSupportPayload),
+              Optional(absl::Cord(absl::StrCat(
+                  TfLiteSupportStatus::kMetadataInconsistencyError))));
+}
+
+TEST_F(DetectionPostprocessorTest, FailsWithInvalidAnchorsLine) {
+  DetectionMetadata metadata;
+  metadata.anchors_file = "0.5 0.5 0.2 0.4\n0.25 0.25 0.1\n";
+  ASSERT_NO_FATAL_FAILURE(BuildEngineWithMetadata(/*num_boxes=*/2,
+                                                  /*num_classes=*/1,
+                                                  metadata));
+  DetectionOptions options;
+  options.set_box_format(DetectionOptions::ANCHOR_ENCODED);
+
+  StatusOr<std::unique_ptr<DetectionPostprocessor>> postprocessor =
+      CreatePostprocessor(options);
+
+  EXPECT_EQ(postprocessor.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(postprocessor.status().message(),
+              HasSubstr("Invalid line in anchors file anchors.txt"));
+  EXPECT_THAT(postprocessor.status().GetPayload(kTfLiteSupportPayload),
+              Optional(absl::Cord(absl::StrCat(
+                  TfLiteSupportStatus::kMetadataInconsistencyError))));
+}
+
+TEST_F(DetectionPostprocessorTest, SucceedsWithQuantizedTensors) {
+  DetectionTensorQuantization quantization;
+  quantization.scale = 0.01f;
+  quantization.zero_point = 10;
+  ASSERT_NO_FATAL_FAILURE(BuildEngine(/*num_boxes=*/1, /*num_classes=*/2,
+                                      tflite::TensorType_UINT8,
+                                      quantization));
+  DetectionOptions options;
+  options.set_score_threshold(0.5f);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DetectionPostprocessor>
+                                   postprocessor,
+                               CreatePostprocessor(options));
+  // [0.1, 0.2, 0.5, 0.6] and scores [0.9, 0.2].
+  ASSERT_NO_FATAL_FAILURE(SetOutput<uint8_t>(0, {20, 30, 60, 70}));
+  ASSERT_NO_FATAL_FAILURE(SetOutput<uint8_t>(1, {100, 30}));
+
+  DetectionResult result;
+  SUPPORT_ASSERT_OK(postprocessor->Postprocess(/*image_width=*/200,
+                                               /*image_height=*/100, &result));
+
+  // The dequantized score may not be exactly 0.9.
+  ASSERT_EQ(result.detections_size(), 1);
+  EXPECT_THAT(result.detections(0).bounding_box(),
+              EqualsProto(ParseTextProtoOrDie<BoundingBox>(
+                  "origin_x: 40 origin_y: 10 width: 80 height: 40")));
+  ASSERT_EQ(result.detections(0).classes_size(), 1);
+  EXPECT_EQ(result.detections(0).classes(0).index(), 0);
+  EXPECT_NEAR(result.detections(0).classes(0).score(), 0.9f, 1e-5f);
+}
+
+TEST_F(DetectionPostprocessorTest, SucceedsWithBackgroundClass) {
+  ASSERT_NO_FATAL_FAILURE(BuildEngine(/*num_boxes=*/2, /*num_classes=*/3));
+  DetectionOptions options;
+  options.set_has_background_class(true);
+  options.set_score_threshold(0.5f);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DetectionPostprocessor>
+                                   postprocessor,
+                               CreatePostprocessor(options));
+  ASSERT_NO_FATAL_FAILURE(SetOutput<float>(0, {0.0f, 0.0f, 0.5f, 0.5f,  //
+                                               0.5f, 0.5f, 1.0f, 1.0f}));
+  // The background scores are ignored, even if above the threshold.
+  ASSERT_NO_FATAL_FAILURE(SetOutput<float>(1, {0.95f, 0.1f, 0.8f,  //
+                                               0.0f, 0.7f, 0.1f}));
+
+  DetectionResult result;
+  SUPPORT_ASSERT_OK(postprocessor->Postprocess(/*image_width=*/10,
+                                               /*image_height=*/10, &result));
+
+  // Class indices exclude the background class.
+  DetectionResult expected;
+  AddDetection(&expected, 0, 0, 5, 5, /*index=*/1, /*score=*/0.8f);
+  AddDetection(&expected, 5, 5, 5, 5, /*index=*/0, /*score=*/0.7f);
+  EXPECT_THAT(result, EqualsProto(expected));
+}
+
+TEST_F(DetectionPostprocessorTest, SucceedsWithLabelsAndThresholdFromMetadata) {
+  DetectionMetadata metadata;
+  // The label map does not list the background class.
+  metadata.labels_file = "cat\ndog\n";
+  metadata.score_threshold = 0.75f;
+  ASSERT_NO_FATAL_FAILURE(BuildEngineWithMetadata(/*num_boxes=*/2,
+                                                  /*num_classes=*/3,
+                                                  metadata));
+  DetectionOptions options;
+  options.set_has_background_class(true);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DetectionPostprocessor>
+                                   postprocessor,
+                               CreatePostprocessor(options));
+  ASSERT_NO_FATAL_FAILURE(SetOutput<float>(0, {0.0f, 0.0f, 0.5f, 0.5f,  //
+                                               0.5f, 0.5f, 1.0f, 1.0f}));
+  ASSERT_NO_FATAL_FAILURE(SetOutput<float>(1, {0.95f, 0.1f, 0.8f,  //
+                                               0.0f, 0.7f, 0.1f}));
+
+  DetectionResult result;
+  SUPPORT_ASSERT_OK(postprocessor->Postprocess(/*image_width=*/10,
+                                               /*image_height=*/10, &result));
+
+  // The second box is below the metadata threshold.
+  DetectionResult expected;
+  auto* detection_class =
+      AddDetection(&expected, 0, 0, 5, 5, /*index=*/1, /*score=*/0.8f)
+          ->mutable_classes(0);
+  detection_class->set_class_name("dog");
+  // No display names file.
+  detection_class->set_display_name("");
+  EXPECT_THAT(result, EqualsProto(expected));
+}
+
+TEST_F(DetectionPostprocessorTest, SucceedsWithBoxesOutsideOfImage) {
+  ASSERT_NO_FATAL_FAILURE(BuildEngine(/*num_boxes=*/2, /*num_classes=*/1));
+  DetectionOptions options;
+  options.set_score_threshold(0.5f);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DetectionPostprocessor>
+                                   postprocessor,
+                               CreatePostprocessor(options));
+  ASSERT_NO_FATAL_FAILURE(SetOutput<float>(0, {-0.1f, -0.2f, 0.5f, 1.2f,  //
+                                               1.1f, 1.1f, 1.5f, 1.5f}));
+  ASSERT_NO_FATAL_FAILURE(SetOutput<float>(1, {0.9f, 0.8f}));
+
+  DetectionResult result;
+  SUPPORT_ASSERT_OK(postprocessor->Postprocess(/*image_width=*/100,
+                                               /*image_height=*/100, &result));
+
+  // The first box is clamped to the image, the second one is dropped as it
+  // becomes empty once clamped.
+  DetectionResult expected;
+  AddDetection(&expected, 0, 0, 100, 50, /*index=*/0, /*score=*/0.9f);
+  EXPECT_THAT(result, EqualsProto(expected));
+}
+
+TEST_F(DetectionPostprocessorTest, KeepsAllCandidatesWithZeroMaxCandidates) {
+  ASSERT_NO_FATAL_FAILURE(BuildEngine(/*num_boxes=*/2, /*num_classes=*/1));
+  DetectionOptions options;
+  options.set_score_threshold(0.5f);
+  options.set_max_candidates(0);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DetectionPostprocessor>
+                                   postprocessor,
+                               CreatePostprocessor(options));
+  ASSERT_NO_FATAL_FAILURE(SetOutput<float>(0, {0.0f, 0.0f, 0.5f, 0.5f,  //
+                                               0.5f, 0.5f, 1.0f, 1.0f}));
+  ASSERT_NO_FATAL_FAILURE(SetOutput<float>(1, {0.9f, 0.8f}));
+
+  DetectionResult result;
+  SUPPORT_ASSERT_OK(postprocessor->Postprocess(/*image_width=*/10,
+                                               /*image_height=*/10, &result));
+
+  EXPECT_EQ(result.detections_size(), 2);
+}
+
+}  // namespace
+}  // namespace processor
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,79 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/test/task/processor/detection_test_utils.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/version.h"
+
+namespace tflite {
+namespace task {
+namespace processor {
+
+namespace {
+
+std::unique_ptr<tflite::TensorT> CreateTensor(
+    const std::string& name, const std::vector<int>& shape,
+    tflite::TensorType type,
+    const DetectionTensorQuantization& quantization) {
+  auto tensor = absl::make_unique<tflite::TensorT>();
+  tensor->name = name;
+  tensor->shape = shape;
+  tensor->type = type;
+  tensor->buffer = 0;
+  if (type != tflite::TensorType_FLOAT32) {
+    tensor->quantization = absl::make_unique<tflite::QuantizationParametersT>();
+    tensor->quantization->scale = {quantization.scale};
+    tensor->quantization->zero_point = {quantization.zero_point};
+  }
+  return tensor;
+}
+
+}  // namespace
+
+std::string BuildDetectionModel(
+    const std::vector<int>& boxes_shape, const std::vector<int>& scores_shape,
+    tflite::TensorType type, const DetectionTensorQuantization& quantization) {
+  auto subgraph = absl::make_unique<tflite::SubGraphT>();
+  subgraph->tensors.push_back(CreateTensor(
+      "image",
+      {1, kDetectionModelInputHeight, kDetectionModelInputWidth, 3},
+      tflite::TensorType_FLOAT32, quantization));
+  subgraph->tensors.push_back(
+      CreateTensor("boxes", boxes_shape, type, quantization));
+  subgraph->tensors.push_back(
+      CreateTensor("scores", scores_shape, type, quantization));
+  subgraph->inputs = {0, 1, 2};
+  subgraph->outputs = {1, 2};
+
+  tflite::ModelT model;
+  model.version = TFLITE_SCHEMA_VERSION;
+  model.subgraphs.push_back(std::move(subgraph));
+  // Buffer 0 is the empty sentinel buffer referenced by all tensors.
+  model.buffers.push_back(absl::make_unique<tflite::BufferT>());
+
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::FinishModelBuffer(builder, tflite::Model::Pack(builder, &model));
+  return std::string(reinterpret_cast<const char*>(builder.GetBufferPointer()),
+                     builder.GetSize());
+}
+
+}  // namespace processor
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,57 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TEST_TASK_PROCESSOR_DETECTION_TEST_UTILS_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TEST_TASK_PROCESSOR_DETECTION_TEST_UTILS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace task {
+namespace processor {
+
+// Dimensions of the image input of the models built by BuildDetectionModel.
+constexpr int kDetectionModelInputHeight = 8;
+constexpr int kDetectionModelInputWidth = 16;
+
+// Quantization parameters of the box and score tensors.
+struct DetectionTensorQuantization {
+  float scale = 0.0f;
+  int64_t zero_point = 0;
+};
+
+// Builds a TFLite model without any operator, for testing detection
+// postprocessing without running a detection model:
+// - input 0 is a [1 x kDetectionModelInputHeight x kDetectionModelInputWidth
+//   x 3] float32 image,
+// - inputs 1 and 2 are the box and score tensors of shapes `boxes_shape` and
+//   `scores_shape` and type `type`, quantized with `quantization` if `type` is
+//   not float32.
+// The box and score tensors are also the model outputs 0 and 1, so that their
+// contents can be set directly before postprocessing.
+std::string BuildDetectionModel(
+    const std::vector<int>& boxes_shape, const std::vector<int>& scores_shape,
+    tflite::TensorType type = tflite::TensorType_FLOAT32,
+    const DetectionTensorQuantization& quantization = {});
+
+}  // namespace processor
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TEST_TASK_PROCESSOR_DETECTION_TEST_UTILS_H_
@@ -0,0 +1,170 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/detection_cascade.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/port/status_matchers.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/image_classifier.h"
+#include "tensorflow_lite_support/cc/task/vision/object_detector.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/image_classifier_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/object_detector_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+#include "tensorflow_lite_support/cc/test/message_matchers.h"
+#include "tensorflow_lite_support/cc/test/test_utils.h"
+#include "tensorflow_lite_support/examples/task/vision/desktop/utils/image_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using ::testing::SizeIs;
+using ::tflite::support::EqualsProto;
+using ::tflite::support::StatusOr;
+using ::tflite::task::JoinPath;
+
+constexpr char kTestDataDirectory[] =
+    "/tensorflow_lite_support/cc/test/testdata/task/"
+    "vision/";
+constexpr char kMobileSsdWithMetadata[] =
+    "coco_ssd_mobilenet_v1_1.0_quant_2018_06_29.tflite";
+constexpr char kMobileNetQuantizedWithMetadata[] =
+    "mobilenet_v1_0.25_224_quant.tflite";
+
+StatusOr<ImageData> LoadImage(std::string image_name) {
+  return DecodeImageFromFile(JoinPath("./" /*test src dir*/,
+                                      kTestDataDirectory, image_name));
+}
+
+StatusOr<std::unique_ptr<DetectionCascade>> CreateCascade(
+    const DetectionCascade::Options& cascade_options) {
+  ObjectDetectorOptions detector_options;
+  detector_options.set_max_results(4);
+  detector_options.mutable_model_file_with_metadata()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileSsdWithMetadata));
+  ASSIGN_OR_RETURN(std::unique_ptr<ObjectDetector> detector,
+                   ObjectDetector::CreateFromOptions(detector_options));
+
+  ImageClassifierOptions classifier_options;
+  classifier_options.set_max_results(3);
+  classifier_options.mutable_model_file_with_metadata()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileNetQuantizedWithMetadata));
+  ASSIGN_OR_RETURN(std::unique_ptr<ImageClassifier> classifier,
+                   ImageClassifier::CreateFromOptions(classifier_options));
+
+  return DetectionCascade::Create(std::move(detector), std::move(classifier),
+                                  cascade_options);
+}
+
+TEST(DetectionCascadeTest, ProcessClassifiesEveryDetection) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image,
+                               LoadImage("cats_and_dogs.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DetectionCascade> cascade,
+                               CreateCascade({}));
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(DetectionCascade::Result result,
+                               cascade->Process(*frame_buffer));
+  ImageDataFree(&rgb_image);
+
+  EXPECT_THAT(result.detections.detections(), SizeIs(4));
+  EXPECT_THAT(result.classifications, SizeIs(4));
+  DetectionCascade::Latencies latencies = cascade->GetLatencies();
+  EXPECT_EQ(latencies.preprocessing.count, 1);
+  EXPECT_EQ(latencies.detection.count, 1);
+  EXPECT_EQ(latencies.classification.count, 1);
+  EXPECT_EQ(latencies.end_to_end.count, 1);
+  cascade->ResetLatencies();
+  EXPECT_EQ(cascade->GetLatencies().end_to_end.count, 0);
+}
+
+TEST(DetectionCascadeTest, ProcessLimitsClassifiedDetections) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image,
+                               LoadImage("cats_and_dogs.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+  DetectionCascade::Options options;
+  options.max_classified_detections = 2;
+  options.detection_min_dimension = 300;
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DetectionCascade> cascade,
+                               CreateCascade(options));
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(DetectionCascade::Result result,
+                               cascade->Process(*frame_buffer));
+
+  EXPECT_THAT(result.classifications, SizeIs(2));
+  // Boxes are mapped back from the downscaled detection input.
+  for (const Detection& detection : result.detections.detections()) {
+    const BoundingBox& box = detection.bounding_box();
+    EXPECT_LE(box.origin_x() + box.width(), rgb_image.width + 2);
+    EXPECT_LE(box.origin_y() + box.height(), rgb_image.height + 2);
+  }
+  ImageDataFree(&rgb_image);
+}
+
+TEST(DetectionCascadeTest, SubmitMatchesProcessInOrder) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image,
+                               LoadImage("cats_and_dogs.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DetectionCascade> cascade,
+                               CreateCascade({}));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(DetectionCascade::Result expected,
+                               cascade->Process(*frame_buffer));
+
+  constexpr int kNumFrames = 5;
+  absl::Mutex mutex;
+  std::vector<int> order;
+  std::vector<DetectionCascade::Result> results;
+  for (int i = 0; i < kNumFrames; ++i) {
+    SUPPORT_ASSERT_OK(cascade->Submit(
+        *frame_buffer, [&, i](StatusOr<DetectionCascade::Result> result) {
+          absl::MutexLock lock(&mutex);
+          order.push_back(i);
+          SUPPORT_ASSERT_OK(result);
+          results.push_back(std::move(result).value());
+        }));
+  }
+  cascade->Flush();
+  ImageDataFree(&rgb_image);
+
+  absl::MutexLock lock(&mutex);
+  EXPECT_THAT(order, testing::ElementsAre(0, 1, 2, 3, 4));
+  ASSERT_THAT(results, SizeIs(kNumFrames));
+  for (const DetectionCascade::Result& result : results) {
+    EXPECT_THAT(result.detections, EqualsProto(expected.detections));
+    ASSERT_THAT(result.classifications,
+                SizeIs(expected.classifications.size()));
+  }
+}
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
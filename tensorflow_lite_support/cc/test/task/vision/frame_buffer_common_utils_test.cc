@@ -0,0 +1,165 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/status_matchers.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Side of the test frames, made of 4 quadrants of kQuadrantSize x
+// kQuadrantSize pixels.
+constexpr int kQuadrantSize = 4;
+constexpr int kFrameSize = 2 * kQuadrantSize;
+// Luma of the top left, top right, bottom left and bottom right quadrants.
+constexpr uint8 kQuadrantLuma[] = {10, 60, 140, 250};
+
+uint8 QuadrantLuma(int x, int y) {
+  return kQuadrantLuma[(y / kQuadrantSize) * 2 + x / kQuadrantSize];
+}
+
+// Fills a `row_stride` x kFrameSize luma plane with the quadrant values, and
+// the padding at the end of each row with a value that must not be read.
+std::vector<uint8> CreateLumaPlane(int row_stride) {
+  std::vector<uint8> plane(row_stride * kFrameSize, 255);
+  for (int y = 0; y < kFrameSize; ++y) {
+    for (int x = 0; x < kFrameSize; ++x) {
+      plane[y * row_stride + x] = QuadrantLuma(x, y);
+    }
+  }
+  return plane;
+}
+
+TEST(ComputeLumaThumbnailTest, SucceedsWithRgb) {
+  // Gray RGB pixels, whose luma is their value.
+  std::vector<uint8> rgb(kFrameSize * kFrameSize * 3);
+  for (int y = 0; y < kFrameSize; ++y) {
+    for (int x = 0; x < kFrameSize; ++x) {
+      for (int c = 0; c < 3; ++c) {
+        rgb[(y * kFrameSize + x) * 3 + c] = QuadrantLuma(x, y);
+      }
+    }
+  }
+  std::unique_ptr<FrameBuffer> buffer =
+      CreateFromRgbRawBuffer(rgb.data(), {kFrameSize, kFrameSize});
+
+  std::vector<uint8> thumbnail;
+  SUPPORT_ASSERT_OK(ComputeLumaThumbnail(*buffer, 2, 2, &thumbnail));
+
+  EXPECT_THAT(thumbnail, ElementsAre(10, 60, 140, 250));
+}
+
+TEST(ComputeLumaThumbnailTest, SucceedsWithRgbaPrimaries) {
+  // Red, green, blue and white columns of 2 pixels.
+  constexpr uint8 kColors[][4] = {
+      {255, 0, 0, 255}, {0, 255, 0, 255}, {0, 0, 255, 255}, {255, 255, 255, 0}};
+  std::vector<uint8> rgba(kFrameSize * kFrameSize * 4);
+  for (int y = 0; y < kFrameSize; ++y) {
+    for (int x = 0; x < kFrameSize; ++x) {
+      for (int c = 0; c < 4; ++c) {
+        rgba[(y * kFrameSize + x) * 4 + c] = kColors[x / 2][c];
+      }
+    }
+  }
+  std::unique_ptr<FrameBuffer> buffer =
+      CreateFromRgbaRawBuffer(rgba.data(), {kFrameSize, kFrameSize});
+
+  std::vector<uint8> thumbnail;
+  SUPPORT_ASSERT_OK(ComputeLumaThumbnail(*buffer, 4, 1, &thumbnail));
+
+  // BT.601 weights, in 8-bit fixed point. The alpha channel is ignored.
+  EXPECT_THAT(thumbnail, ElementsAre(76, 149, 28, 255));
+}
+
+TEST(ComputeLumaThumbnailTest, SucceedsWithNv12AndNv21) {
+  constexpr int kRowStride = kFrameSize + 3;
+  const std::vector<uint8> y_plane = CreateLumaPlane(kRowStride);
+  // Interleaved chroma, which must not be read.
+  const std::vector<uint8> uv_plane(kRowStride * kFrameSize / 2, 200);
+
+  for (FrameBuffer::Format format :
+       {FrameBuffer::Format::kNV12, FrameBuffer::Format::kNV21}) {
+    SUPPORT_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<FrameBuffer> buffer,
+        CreateFromYuvRawBuffer(y_plane.data(), uv_plane.data(),
+                               uv_plane.data() + 1, format,
+                               {kFrameSize, kFrameSize}, kRowStride,
+                               kRowStride, /*pixel_stride_uv=*/2));
+
+    std::vector<uint8> thumbnail;
+    SUPPORT_ASSERT_OK(ComputeLumaThumbnail(*buffer, 2, 2, &thumbnail));
+
+    EXPECT_THAT(thumbnail, ElementsAre(10, 60, 140, 250));
+  }
+}
+
+TEST(ComputeLumaThumbnailTest, SucceedsWithYv12) {
+  constexpr int kRowStride = kFrameSize + 3;
+  const std::vector<uint8> y_plane = CreateLumaPlane(kRowStride);
+  // Planar chroma, which must not be read.
+  constexpr int kUvRowStride = kFrameSize / 2;
+  const std::vector<uint8> u_plane(kUvRowStride * kFrameSize / 2, 200);
+  const std::vector<uint8> v_plane(kUvRowStride * kFrameSize / 2, 100);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<FrameBuffer> buffer,
+      CreateFromYuvRawBuffer(y_plane.data(), u_plane.data(), v_plane.data(),
+                             FrameBuffer::Format::kYV12,
+                             {kFrameSize, kFrameSize}, kRowStride, kUvRowStride,
+                             /*pixel_stride_uv=*/1));
+
+  // A thumbnail wider than the frame repeats its columns.
+  constexpr int kThumbnailWidth = 2 * kFrameSize;
+  std::vector<uint8> thumbnail;
+  SUPPORT_ASSERT_OK(
+      ComputeLumaThumbnail(*buffer, kThumbnailWidth, 2, &thumbnail));
+
+  ASSERT_EQ(thumbnail.size(), 2 * kThumbnailWidth);
+  for (int y = 0; y < 2; ++y) {
+    for (int x = 0; x < kThumbnailWidth; ++x) {
+      EXPECT_EQ(thumbnail[y * kThumbnailWidth + x],
+                QuadrantLuma(x / 2, y * kQuadrantSize))
+          << x << ", " << y;
+    }
+  }
+}
+
+TEST(ComputeLumaThumbnailTest, FailsWithInvalidDimension) {
+  const std::vector<uint8> gray = CreateLumaPlane(kFrameSize);
+  std::unique_ptr<FrameBuffer> buffer =
+      CreateFromGrayRawBuffer(gray.data(), {kFrameSize, kFrameSize});
+
+  std::vector<uint8> thumbnail;
+  absl::Status status = ComputeLumaThumbnail(*buffer, 0, 2, &thumbnail);
+
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
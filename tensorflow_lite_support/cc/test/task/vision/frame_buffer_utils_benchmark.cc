@@ -0,0 +1,225 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Throughput of the libyuv backed format conversion, resize and rotation of
+// camera frames, at VGA, 720p and 1080p.
+//
+// The processed bytes are the bytes of the input frame, and the label gives
+// the formats involved. Use --benchmark_format=json (or --benchmark_out=<file>
+// --benchmark_out_format=json) for a machine readable output.
+
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/libyuv_frame_buffer_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+constexpr FrameBuffer::Dimension kResolutions[] = {
+    {640, 480}, {1280, 720}, {1920, 1080}};
+constexpr int kNumResolutions = sizeof(kResolutions) / sizeof(kResolutions[0]);
+
+// Indices of the benchmark arguments.
+constexpr int kResolutionArg = 0;
+constexpr int kFormatArg = 1;
+constexpr int kOutputArg = 2;
+
+int AsArg(FrameBuffer::Format format) { return static_cast<int>(format); }
+
+const char* FormatName(FrameBuffer::Format format) {
+  switch (format) {
+    case FrameBuffer::Format::kRGBA:
+      return "RGBA";
+    case FrameBuffer::Format::kRGB:
+      return "RGB";
+    case FrameBuffer::Format::kNV12:
+      return "NV12";
+    case FrameBuffer::Format::kNV21:
+      return "NV21";
+    case FrameBuffer::Format::kYV12:
+      return "YV12";
+    case FrameBuffer::Format::kYV21:
+      return "YV21";
+    case FrameBuffer::Format::kGRAY:
+      return "GRAY";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+// A frame buffer along with the pixels backing it.
+class TestFrame {
+ public:
+  // Creates a frame filled with a noisy ramp, closer to natural images than
+  // uniform or purely random data.
+  TestFrame(FrameBuffer::Dimension dimension, FrameBuffer::Format format)
+      : pixels_(GetFrameBufferByteSize(dimension, format)) {
+    std::mt19937 rng(/*seed=*/42);
+    for (size_t i = 0; i < pixels_.size(); ++i) {
+      pixels_[i] = static_cast<uint8>((i / 3 + (rng() & 31)) & 0xff);
+    }
+    frame_buffer_ =
+        CreateFromRawBuffer(pixels_.data(), dimension, format).value();
+  }
+
+  const FrameBuffer& frame_buffer() const { return *frame_buffer_; }
+  FrameBuffer* mutable_frame_buffer() { return frame_buffer_.get(); }
+  int64_t size_bytes() const { return pixels_.size(); }
+
+ private:
+  std::vector<uint8> pixels_;
+  std::unique_ptr<FrameBuffer> frame_buffer_;
+};
+
+// Runs `operation` on `input` into `output` in the benchmark loop.
+template <typename OperationFn>
+void RunFrameBufferBenchmark(const TestFrame& input, TestFrame& output,
+                             OperationFn operation, benchmark::State& state) {
+  for (auto _ : state) {
+    absl::Status status =
+        operation(input.frame_buffer(), output.mutable_frame_buffer());
+    if (!status.ok()) {
+      state.SkipWithError(std::string(status.message()).c_str());
+      break;
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * input.size_bytes());
+}
+
+// Adds the {resolution, format, output} argument sets for all resolutions.
+void AddArguments(benchmark::internal::Benchmark* benchmark,
+                  const char* output_name,
+                  const std::vector<std::pair<FrameBuffer::Format, int>>&
+                      format_and_outputs) {
+  benchmark->ArgNames({"resolution", "format", output_name});
+  for (int resolution = 0; resolution < kNumResolutions; ++resolution) {
+    for (const auto& format_and_output : format_and_outputs) {
+      benchmark->Args({resolution, AsArg(format_and_output.first),
+                       format_and_output.second});
+    }
+  }
+}
+
+void ConvertArguments(benchmark::internal::Benchmark* benchmark) {
+  // Camera formats to the RGB model input, and the other way around.
+  AddArguments(
+      benchmark, "output_format",
+      {{FrameBuffer::Format::kNV21, AsArg(FrameBuffer::Format::kRGB)},
+       {FrameBuffer::Format::kNV12, AsArg(FrameBuffer::Format::kRGB)},
+       {FrameBuffer::Format::kYV12, AsArg(FrameBuffer::Format::kRGB)},
+       {FrameBuffer::Format::kRGBA, AsArg(FrameBuffer::Format::kRGB)},
+       {FrameBuffer::Format::kRGB, AsArg(FrameBuffer::Format::kNV21)},
+       {FrameBuffer::Format::kRGB, AsArg(FrameBuffer::Format::kGRAY)}});
+}
+
+void ResizeArguments(benchmark::internal::Benchmark* benchmark) {
+  // Down to the typical input sizes of the classification and segmentation
+  // models.
+  AddArguments(benchmark, "output_side",
+               {{FrameBuffer::Format::kRGB, 224},
+                {FrameBuffer::Format::kRGB, 513},
+                {FrameBuffer::Format::kRGBA, 224},
+                {FrameBuffer::Format::kNV21, 224},
+                {FrameBuffer::Format::kYV12, 224}});
+}
+
+void RotateArguments(benchmark::internal::Benchmark* benchmark) {
+  AddArguments(benchmark, "angle",
+               {{FrameBuffer::Format::kRGB, 90},
+                {FrameBuffer::Format::kRGB, 180},
+                {FrameBuffer::Format::kRGBA, 90},
+                {FrameBuffer::Format::kNV21, 90},
+                {FrameBuffer::Format::kNV21, 180},
+                {FrameBuffer::Format::kYV12, 90}});
+}
+
+FrameBuffer::Dimension GetResolution(const benchmark::State& state) {
+  return kResolutions[state.range(kResolutionArg)];
+}
+
+FrameBuffer::Format GetFormat(const benchmark::State& state) {
+  return static_cast<FrameBuffer::Format>(state.range(kFormatArg));
+}
+
+void BM_Convert(benchmark::State& state) {
+  const auto output_format =
+      static_cast<FrameBuffer::Format>(state.range(kOutputArg));
+  const TestFrame input(GetResolution(state), GetFormat(state));
+  TestFrame output(GetResolution(state), output_format);
+  state.SetLabel(absl::StrCat(FormatName(GetFormat(state)), " to ",
+                              FormatName(output_format)));
+  LibyuvFrameBufferUtils utils;
+  RunFrameBufferBenchmark(
+      input, output,
+      [&utils](const FrameBuffer& buffer, FrameBuffer* output_buffer) {
+        return utils.Convert(buffer, output_buffer);
+      },
+      state);
+}
+BENCHMARK(BM_Convert)->Apply(ConvertArguments);
+
+void BM_Resize(benchmark::State& state) {
+  const int output_side = state.range(kOutputArg);
+  const TestFrame input(GetResolution(state), GetFormat(state));
+  TestFrame output({output_side, output_side}, GetFormat(state));
+  state.SetLabel(FormatName(GetFormat(state)));
+  LibyuvFrameBufferUtils utils;
+  RunFrameBufferBenchmark(
+      input, output,
+      [&utils](const FrameBuffer& buffer, FrameBuffer* output_buffer) {
+        return utils.Resize(buffer, output_buffer);
+      },
+      state);
+}
+BENCHMARK(BM_Resize)->Apply(ResizeArguments);
+
+void BM_Rotate(benchmark::State& state) {
+  const int angle_deg = state.range(kOutputArg);
+  FrameBuffer::Dimension dimension = GetResolution(state);
+  const TestFrame input(dimension, GetFormat(state));
+  if (angle_deg % 180 != 0) {
+    dimension.Swap();
+  }
+  TestFrame output(dimension, GetFormat(state));
+  state.SetLabel(FormatName(GetFormat(state)));
+  LibyuvFrameBufferUtils utils;
+  RunFrameBufferBenchmark(
+      input, output,
+      [&utils, angle_deg](const FrameBuffer& buffer,
+                          FrameBuffer* output_buffer) {
+        return utils.Rotate(buffer, angle_deg, output_buffer);
+      },
+      state);
+}
+BENCHMARK(BM_Rotate)->Apply(RotateArguments);
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
@@ -20,6 +20,9 @@ limitations under the License.
 #include "absl/flags/flag.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/strings/cord.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/synchronization/notification.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/shims/cc/shims_test_util.h"
 #include "tensorflow/lite/kernels/builtin_op_kernels.h"
@@ -27,9 +30,14 @@ limitations under the License.
 #include "tensorflow_lite_support/cc/common.h"
 #include "tensorflow_lite_support/cc/port/gmock.h"
 #include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/proto2.h"
 #include "tensorflow_lite_support/cc/port/status_macros.h"
 #include "tensorflow_lite_support/cc/port/status_matchers.h"
+#include "tensorflow_lite_support/cc/task/core/op_profiler.h"
+#include "tensorflow_lite_support/cc/task/core/raw_output_tensor.h"
+#include "tensorflow_lite_support/cc/task/core/shared_cpu_context.h"
 #include "tensorflow_lite_support/cc/task/core/task_api_factory.h"
+#include "tensorflow_lite_support/cc/task/core/task_stats.h"
 #include "tensorflow_lite_support/cc/task/core/task_utils.h"
 #include "tensorflow_lite_support/cc/task/core/tflite_engine.h"
 #include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
@@ -46,15 +54,20 @@ namespace task {
 namespace vision {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
 using ::testing::HasSubstr;
 using ::testing::Optional;
 using ::tflite::support::kTfLiteSupportPayload;
+using ::tflite::support::proto::Arena;
 using ::tflite::support::StatusOr;
 using ::tflite::support::TfLiteSupportStatus;
 using ::tflite::task::JoinPath;
 using ::tflite::task::ParseTextProtoOrDie;
+using ::tflite::task::core::CpuPlacementOptions;
 using ::tflite::task::core::PopulateTensor;
+using ::tflite::task::core::RawOutputTensor;
+using ::tflite::task::core::SharedCpuContext;
 using ::tflite::task::core::TaskAPIFactory;
 using ::tflite::task::core::TfLiteEngine;
 
@@ -306,6 +319,109 @@ TEST(ClassifyTest, SucceedsWithFloatModel) {
           )pb"));
 }
 
+TEST(ClassifyTest, SucceedsWithReusedResult) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("burger.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ImageClassifierOptions options;
+  options.set_max_results(1);
+  options.mutable_base_options()->mutable_model_file()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileNetFloatWithMetadata));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> image_classifier,
+                               ImageClassifier::CreateFromOptions(options));
+
+  // The previous contents of the result are replaced.
+  ClassificationResult result = ParseTextProtoOrDie<ClassificationResult>(
+      R"pb(classifications {
+             classes { index: 1 score: 0.5 class_name: "a long stale name" }
+             classes { index: 2 score: 0.25 display_name: "stale" }
+             head_index: 3
+           }
+           classifications { head_index: 4 }
+      )pb");
+  const ClassificationResult expected =
+      ParseTextProtoOrDie<ClassificationResult>(
+          R"pb(classifications {
+                 classes {
+                   index: 934
+                   score: 0.7399742
+                   class_name: "cheeseburger"
+                 }
+                 head_index: 0
+               }
+          )pb");
+  for (int i = 0; i < 2; ++i) {
+    SUPPORT_ASSERT_OK(image_classifier->Classify(*frame_buffer, &result));
+    ExpectApproximatelyEqual(result, expected);
+  }
+  ImageDataFree(&rgb_image);
+}
+
+TEST(ClassifyTest, SucceedsWithArenaAllocatedResult) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("burger.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ImageClassifierOptions options;
+  options.set_max_results(1);
+  options.mutable_base_options()->mutable_model_file()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileNetFloatWithMetadata));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> image_classifier,
+                               ImageClassifier::CreateFromOptions(options));
+
+  Arena arena;
+  ClassificationResult* result =
+      Arena::CreateMessage<ClassificationResult>(&arena);
+  SUPPORT_ASSERT_OK(image_classifier->Classify(*frame_buffer, result));
+  ImageDataFree(&rgb_image);
+
+  ExpectApproximatelyEqual(
+      *result, ParseTextProtoOrDie<ClassificationResult>(
+                   R"pb(classifications {
+                          classes {
+                            index: 934
+                            score: 0.7399742
+                            class_name: "cheeseburger"
+                          }
+                          head_index: 0
+                        }
+                   )pb"));
+  ASSERT_EQ(result->classifications_size(), 1);
+  EXPECT_EQ(result->classifications(0).GetArena(), &arena);
+}
+
+TEST(ClassifyTest, InferRawReturnsOutputTensorViews) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("burger.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ImageClassifierOptions options;
+  options.mutable_base_options()->mutable_model_file()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileNetFloatWithMetadata));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> image_classifier,
+                               ImageClassifier::CreateFromOptions(options));
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(absl::Span<const RawOutputTensor> outputs,
+                               image_classifier->InferRaw(*frame_buffer));
+  ImageDataFree(&rgb_image);
+
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_THAT(outputs[0].dims(), ElementsAre(1, 1001));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(absl::Span<const float> scores,
+                               outputs[0].data<float>());
+  ASSERT_EQ(scores.size(), 1001);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(int top_index, outputs[0].ArgMax());
+  EXPECT_EQ(top_index, 934);
+  EXPECT_NEAR(scores[top_index], 0.7399742, 1e-4);
+}
+
 TEST(ClassifyTest, SucceedsWithRegionOfInterest) {
   SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("multi_objects.jpg"));
   std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
@@ -346,6 +462,125 @@ TEST(ClassifyTest, SucceedsWithRegionOfInterest) {
                                        )pb"));
 }
 
+TEST(ClassifyTest, SucceedsWithMultipleRegionsOfInterest) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("multi_objects.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ImageClassifierOptions options;
+  options.set_max_results(1);
+  options.mutable_model_file_with_metadata()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileNetFloatWithMetadata));
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> image_classifier,
+                       ImageClassifier::CreateFromOptions(options));
+
+  std::vector<BoundingBox> rois(2);
+  // Crop around the soccer ball.
+  rois[0].set_origin_x(406);
+  rois[0].set_origin_y(110);
+  rois[0].set_width(148);
+  rois[0].set_height(153);
+  // Whole image.
+  rois[1].set_width(rgb_image.width);
+  rois[1].set_height(rgb_image.height);
+
+  StatusOr<std::vector<ClassificationResult>> results_or =
+      image_classifier->ClassifyRois(*frame_buffer, rois);
+  SUPPORT_ASSERT_OK(results_or);
+  ASSERT_EQ(results_or->size(), rois.size());
+  for (int i = 0; i < rois.size(); ++i) {
+    SUPPORT_ASSERT_OK_AND_ASSIGN(
+        ClassificationResult expected,
+        image_classifier->Classify(*frame_buffer, rois[i]));
+    ExpectApproximatelyEqual((*results_or)[i], expected);
+  }
+  ImageDataFree(&rgb_image);
+}
+
+TEST(ClassifyAsyncTest, SucceedsInOrder) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("burger.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ImageClassifierOptions options;
+  options.set_max_results(3);
+  options.mutable_model_file_with_metadata()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileNetQuantizedWithMetadata));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> image_classifier,
+                       ImageClassifier::CreateFromOptions(options));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(const ClassificationResult expected,
+                       image_classifier->Classify(*frame_buffer));
+
+  ImageClassifier::AsyncOptions async_options;
+  async_options.drop_frames_when_full = false;
+  image_classifier->SetAsyncOptions(async_options);
+  constexpr int kNumFrames = 4;
+  absl::Mutex mutex;
+  std::vector<int> order;
+  std::vector<ClassificationResult> results;
+  for (int i = 0; i < kNumFrames; ++i) {
+    SUPPORT_ASSERT_OK(image_classifier->ClassifyAsync(
+        *frame_buffer, [&, i](StatusOr<ClassificationResult> result) {
+          absl::MutexLock lock(&mutex);
+          order.push_back(i);
+          if (result.ok()) results.push_back(*result);
+        }));
+  }
+  // Frames are staged before the asynchronous call returns.
+  ImageDataFree(&rgb_image);
+  image_classifier->WaitForAsyncInferences();
+
+  absl::MutexLock lock(&mutex);
+  EXPECT_THAT(order, ElementsAreArray({0, 1, 2, 3}));
+  ASSERT_EQ(results.size(), kNumFrames);
+  for (const ClassificationResult& result : results) {
+    ExpectApproximatelyEqual(result, expected);
+  }
+  EXPECT_EQ(image_classifier->GetDroppedFrameCount(), 0);
+}
+
+TEST(ClassifyAsyncTest, DropsFramesWhenFull) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("burger.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ImageClassifierOptions options;
+  options.mutable_model_file_with_metadata()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileNetQuantizedWithMetadata));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> image_classifier,
+                       ImageClassifier::CreateFromOptions(options));
+  ImageClassifier::AsyncOptions async_options;
+  async_options.max_in_flight_frames = 1;
+  image_classifier->SetAsyncOptions(async_options);
+
+  // The first frame stays in flight until its callback is released.
+  absl::Notification release;
+  SUPPORT_ASSERT_OK(image_classifier->ClassifyAsync(
+      *frame_buffer, [&release](StatusOr<ClassificationResult> result) {
+        release.WaitForNotification();
+      }));
+  absl::Status status = image_classifier->ClassifyAsync(
+      *frame_buffer, [](StatusOr<ClassificationResult> result) {
+        ADD_FAILURE() << "Dropped frames must not be delivered.";
+      });
+  EXPECT_EQ(status.code(), absl::StatusCode::kUnavailable);
+  EXPECT_EQ(image_classifier->GetDroppedFrameCount(), 1);
+
+  release.Notify();
+  image_classifier->WaitForAsyncInferences();
+  SUPPORT_EXPECT_OK(image_classifier->ClassifyAsync(
+      *frame_buffer, [](StatusOr<ClassificationResult> result) {}));
+  image_classifier->WaitForAsyncInferences();
+  ImageDataFree(&rgb_image);
+}
+
 TEST(ClassifyTest, SucceedsWithQuantizedModel) {
   SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("burger.jpg"));
   std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
@@ -424,6 +659,265 @@ TEST(ClassifyTest, SucceedsWithBaseOptions) {
           )pb"));
 }
 
+TEST(ClassifyTest, RecordsStatsWhenEnabled) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("burger.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ImageClassifierOptions options;
+  options.mutable_base_options()->mutable_model_file()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileNetQuantizedWithMetadata));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> image_classifier,
+                       ImageClassifier::CreateFromOptions(options));
+
+  // Statistics are disabled by default.
+  SUPPORT_ASSERT_OK(image_classifier->Classify(*frame_buffer));
+  EXPECT_EQ(image_classifier->GetStats().invocations, 0);
+
+  image_classifier->SetStatsEnabled(true);
+  SUPPORT_ASSERT_OK(image_classifier->Classify(*frame_buffer));
+  SUPPORT_ASSERT_OK(image_classifier->Classify(*frame_buffer));
+  ImageDataFree(&rgb_image);
+
+  core::TaskStats stats = image_classifier->GetStats();
+  EXPECT_EQ(stats.invocations, 2);
+  EXPECT_EQ(stats.failed_invocations, 0);
+  EXPECT_EQ(stats.fallback_invocations, 0);
+  EXPECT_EQ(stats.preprocess.count, 2);
+  EXPECT_EQ(stats.invoke.count, 2);
+  EXPECT_EQ(stats.postprocess.count, 2);
+  EXPECT_EQ(stats.total.count, 2);
+  EXPECT_GE(stats.total.max, stats.invoke.max);
+  // Two uint8 224x224x3 inputs.
+  EXPECT_EQ(stats.input_bytes, 2 * 224 * 224 * 3);
+
+  image_classifier->ResetStats();
+  EXPECT_EQ(image_classifier->GetStats().invocations, 0);
+}
+
+TEST(ClassifyTest, ProfilesOperatorsWhenEnabled) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("burger.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ImageClassifierOptions options;
+  options.mutable_base_options()->mutable_model_file()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileNetQuantizedWithMetadata));
+  options.mutable_base_options()
+      ->mutable_profiling_options()
+      ->set_enable_op_profiling(true);
+  options.mutable_base_options()
+      ->mutable_profiling_options()
+      ->set_max_trace_invocations(1);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> image_classifier,
+                       ImageClassifier::CreateFromOptions(options));
+  ASSERT_NE(image_classifier->GetOpProfiler(), nullptr);
+
+  SUPPORT_ASSERT_OK(image_classifier->Classify(*frame_buffer));
+  SUPPORT_ASSERT_OK(image_classifier->Classify(*frame_buffer));
+  ImageDataFree(&rgb_image);
+
+  const core::OpProfiler* profiler = image_classifier->GetOpProfiler();
+  EXPECT_EQ(profiler->GetInvocationCount(), 2);
+  std::vector<core::OpStats> op_types = profiler->GetOpTypeStats();
+  ASSERT_FALSE(op_types.empty());
+  EXPECT_GE(op_types.front().total, op_types.back().total);
+  EXPECT_THAT(profiler->GetSummary(), HasSubstr("CONV_2D"));
+  // Each node is executed once per invocation.
+  for (const core::OpStats& node : profiler->GetNodeStats()) {
+    EXPECT_EQ(node.count, 2);
+  }
+  EXPECT_THAT(profiler->GetChromeTrace(),
+              HasSubstr("\"name\":\"DEPTHWISE_CONV_2D\""));
+}
+
+TEST(ClassifyTest, DoesNotProfileOperatorsByDefault) {
+  ImageClassifierOptions options;
+  options.mutable_base_options()->mutable_model_file()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileNetQuantizedWithMetadata));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> image_classifier,
+                       ImageClassifier::CreateFromOptions(options));
+
+  EXPECT_EQ(image_classifier->GetOpProfiler(), nullptr);
+}
+
+TEST(ClassifyTest, SucceedsWithWarmupAndPrefetch) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("burger.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ImageClassifierOptions options;
+  options.set_max_results(1);
+  core::BaseOptions* base_options = options.mutable_base_options();
+  base_options->mutable_model_file()->set_file_name(JoinPath(
+      "./" /*test src dir*/, kTestDataDirectory, kMobileNetFloatWithMetadata));
+  base_options->mutable_model_file()
+      ->mutable_memory_mapping_options()
+      ->set_prefetch_mode(core::MemoryMappingOptions::POPULATE);
+  base_options->mutable_warmup_options()->set_num_warmup_runs(2);
+  base_options->mutable_profiling_options()->set_enable_op_profiling(true);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> image_classifier,
+                       ImageClassifier::CreateFromOptions(options));
+  // Warm-up inferences are not profiled.
+  EXPECT_EQ(image_classifier->GetOpProfiler()->GetInvocationCount(), 0);
+
+  StatusOr<ClassificationResult> result_or =
+      image_classifier->Classify(*frame_buffer);
+  ImageDataFree(&rgb_image);
+  SUPPORT_ASSERT_OK(result_or);
+
+  // The warm-up inputs do not leak into the results.
+  ExpectApproximatelyEqual(
+      result_or.value(),
+      ParseTextProtoOrDie<ClassificationResult>(
+          R"pb(classifications {
+                 classes {
+                   index: 934
+                   score: 0.7399742
+                   class_name: "cheeseburger"
+                 }
+                 head_index: 0
+               }
+          )pb"));
+  EXPECT_EQ(image_classifier->GetOpProfiler()->GetInvocationCount(), 1);
+}
+
+TEST(ClassifyTest, SucceedsWithSharedCpuContext) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("burger.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ImageClassifierOptions options;
+  options.set_max_results(1);
+  options.mutable_base_options()->mutable_model_file()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileNetFloatWithMetadata));
+  options.mutable_base_options()
+      ->mutable_compute_settings()
+      ->mutable_tflite_settings()
+      ->mutable_cpu_settings()
+      ->set_num_threads(2);
+  // Any budget is accepted, whatever the budget of the process-wide context.
+  options.mutable_base_options()
+      ->mutable_shared_cpu_context_options()
+      ->set_thread_budget(0);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> first,
+                               ImageClassifier::CreateFromOptions(options));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> second,
+                               ImageClassifier::CreateFromOptions(options));
+
+  const ClassificationResult expected =
+      ParseTextProtoOrDie<ClassificationResult>(
+          R"pb(classifications {
+                 classes {
+                   index: 934
+                   score: 0.7399742
+                   class_name: "cheeseburger"
+                 }
+                 head_index: 0
+               }
+          )pb");
+  for (ImageClassifier* image_classifier : {first.get(), second.get()}) {
+    SUPPORT_ASSERT_OK_AND_ASSIGN(ClassificationResult result,
+                                 image_classifier->Classify(*frame_buffer));
+    ExpectApproximatelyEqual(result, expected);
+  }
+  // The leased contexts are uninstalled from the interpreters when the
+  // inferences complete: destroying a task doesn't affect the contexts used
+  // by the others.
+  first.reset();
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ClassificationResult result,
+                               second->Classify(*frame_buffer));
+  ExpectApproximatelyEqual(result, expected);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::shared_ptr<SharedCpuContext> cpu_context,
+                               SharedCpuContext::GetDefault(0));
+  EXPECT_EQ(cpu_context->available_threads(), cpu_context->thread_budget());
+  ImageDataFree(&rgb_image);
+}
+
+TEST(ClassifyTest, SucceedsWithCpuPlacement) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("burger.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ImageClassifierOptions options;
+  options.set_max_results(1);
+  options.mutable_base_options()->mutable_model_file()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileNetFloatWithMetadata));
+  options.mutable_base_options()
+      ->mutable_compute_settings()
+      ->mutable_tflite_settings()
+      ->mutable_cpu_settings()
+      ->set_num_threads(2);
+  // Node 0 exists on all machines, including those without NUMA support.
+  CpuPlacementOptions* placement_options =
+      options.mutable_base_options()->mutable_cpu_placement_options();
+  placement_options->set_numa_node(0);
+  placement_options->set_replicate_model_on_node(true);
+  options.mutable_base_options()->mutable_warmup_options()->set_num_warmup_runs(
+      1);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> first,
+                               ImageClassifier::CreateFromOptions(options));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> second,
+                               ImageClassifier::CreateFromOptions(options));
+
+  const ClassificationResult expected =
+      ParseTextProtoOrDie<ClassificationResult>(
+          R"pb(classifications {
+                 classes {
+                   index: 934
+                   score: 0.7399742
+                   class_name: "cheeseburger"
+                 }
+                 head_index: 0
+               }
+          )pb");
+  for (ImageClassifier* image_classifier : {first.get(), second.get()}) {
+    SUPPORT_ASSERT_OK_AND_ASSIGN(ClassificationResult result,
+                                 image_classifier->Classify(*frame_buffer));
+    ExpectApproximatelyEqual(result, expected);
+  }
+}
+
+TEST(CreateFromOptionsTest, FailsWithCpuPlacementAndSharedCpuContext) {
+  ImageClassifierOptions options;
+  options.mutable_base_options()->mutable_model_file()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileNetQuantizedWithMetadata));
+  options.mutable_base_options()->mutable_cpu_placement_options()->add_cpus(0);
+  options.mutable_base_options()->mutable_shared_cpu_context_options();
+
+  StatusOr<std::unique_ptr<ImageClassifier>> image_classifier_or =
+      ImageClassifier::CreateFromOptions(options);
+
+  EXPECT_EQ(image_classifier_or.status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(CreateFromOptionsTest, FailsWithNegativeWarmupRuns) {
+  ImageClassifierOptions options;
+  options.mutable_base_options()->mutable_model_file()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileNetQuantizedWithMetadata));
+  options.mutable_base_options()->mutable_warmup_options()->set_num_warmup_runs(
+      -1);
+
+  StatusOr<std::unique_ptr<ImageClassifier>> image_classifier_or =
+      ImageClassifier::CreateFromOptions(options);
+
+  EXPECT_EQ(image_classifier_or.status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
 TEST(ClassifyTest, GetInputCountSucceeds) {
   ImageClassifierOptions options;
   options.mutable_base_options()->mutable_model_file()->set_file_name(
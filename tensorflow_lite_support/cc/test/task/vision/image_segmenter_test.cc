@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow_lite_support/cc/common.h"
 #include "tensorflow_lite_support/cc/port/gmock.h"
 #include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/proto2.h"
 #include "tensorflow_lite_support/cc/port/status_macros.h"
 #include "tensorflow_lite_support/cc/port/status_matchers.h"
 #include "tensorflow_lite_support/cc/task/core/task_api_factory.h"
@@ -50,6 +51,7 @@ using ::testing::HasSubstr;
 using ::testing::Optional;
 using ::tflite::support::EqualsProto;
 using ::tflite::support::kTfLiteSupportPayload;
+using ::tflite::support::proto::Arena;
 using ::tflite::support::StatusOr;
 using ::tflite::support::TfLiteSupportStatus;
 using ::tflite::task::JoinPath;
@@ -299,6 +301,40 @@ TEST(SegmentTest, SucceedsWithCategoryMask) {
   ImageDataFree(&golden_mask);
 }
 
+TEST(SegmentTest, SucceedsWithReusedResult) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image,
+                               LoadImage("segmentation_input_rotation0.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ImageSegmenterOptions options;
+  options.mutable_base_options()->mutable_model_file()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory, kDeepLabV3));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageSegmenter> image_segmenter,
+                               ImageSegmenter::CreateFromOptions(options));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(const SegmentationResult expected,
+                               image_segmenter->Segment(*frame_buffer));
+
+  Arena arena;
+  SegmentationResult* result =
+      Arena::CreateMessage<SegmentationResult>(&arena);
+  for (int i = 0; i < 2; ++i) {
+    SUPPORT_ASSERT_OK(image_segmenter->Segment(*frame_buffer, result));
+    ASSERT_EQ(result->segmentation_size(), 1);
+    const Segmentation& segmentation = result->segmentation(0);
+    ExpectApproximatelyEqual(
+        segmentation,
+        ParseTextProtoOrDie<Segmentation>(kDeepLabV3PartialResult));
+    EXPECT_EQ(segmentation.colored_labels_size(),
+              expected.segmentation(0).colored_labels_size());
+    EXPECT_EQ(segmentation.category_mask(),
+              expected.segmentation(0).category_mask());
+  }
+  ImageDataFree(&rgb_image);
+  EXPECT_EQ(result->segmentation(0).GetArena(), &arena);
+}
+
 TEST(SegmentTest, SucceedsWithOrientation) {
   // Load input and build frame buffer with kRightBottom orientation.
   SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image,
@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow_lite_support/cc/task/vision/object_detector.h"
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "absl/flags/flag.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/strings/cord.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/shims/cc/shims_test_util.h"
 #include "tensorflow/lite/kernels/builtin_op_kernels.h"
@@ -27,6 +30,7 @@ limitations under the License.
 #include "tensorflow_lite_support/cc/common.h"
 #include "tensorflow_lite_support/cc/port/gmock.h"
 #include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/proto2.h"
 #include "tensorflow_lite_support/cc/port/status_macros.h"
 #include "tensorflow_lite_support/cc/port/status_matchers.h"
 #include "tensorflow_lite_support/cc/task/core/task_api_factory.h"
@@ -60,10 +64,12 @@ namespace task {
 namespace vision {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::Optional;
 using ::tflite::support::EqualsProto;
 using ::tflite::support::kTfLiteSupportPayload;
+using ::tflite::support::proto::Arena;
 using ::tflite::support::StatusOr;
 using ::tflite::support::TfLiteSupportStatus;
 using ::tflite::task::JoinPath;
@@ -358,6 +364,39 @@ TEST_F(DetectTest, SucceedswithBaseOptions) {
       result, ParseTextProtoOrDie<DetectionResult>(kExpectResults));
 }
 
+TEST_F(DetectTest, SucceedsWithReusedResult) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image,
+                               LoadImage("cats_and_dogs.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ObjectDetectorOptions options;
+  options.set_max_results(4);
+  options.mutable_base_options()->mutable_model_file()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileSsdWithMetadata));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectDetector> object_detector,
+                               ObjectDetector::CreateFromOptions(options));
+
+  // The previous contents of the result are replaced, both in an arena-backed
+  // and in a heap-allocated result.
+  Arena arena;
+  DetectionResult* arena_result =
+      Arena::CreateMessage<DetectionResult>(&arena);
+  DetectionResult heap_result;
+  for (DetectionResult* result : {arena_result, &heap_result}) {
+    for (int i = 0; i < 2; ++i) {
+      SUPPORT_ASSERT_OK(object_detector->Detect(*frame_buffer, result));
+      ExpectApproximatelyEqual(
+          *result, ParseTextProtoOrDie<DetectionResult>(kExpectResults));
+    }
+  }
+  ImageDataFree(&rgb_image);
+  ASSERT_GT(arena_result->detections_size(), 0);
+  EXPECT_EQ(arena_result->detections(0).GetArena(), &arena);
+}
+
 TEST_F(DetectTest, SucceedswithScoreCalibrations) {
   SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("cats_and_dogs.jpg"));
   std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
@@ -380,6 +419,91 @@ TEST_F(DetectTest, SucceedswithScoreCalibrations) {
       result, ParseTextProtoOrDie<DetectionResult>(kExpectResults));
 }
 
+TEST_F(DetectTest, SkipsUnchangedFramesInVideoMode) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image, LoadImage("cats_and_dogs.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ObjectDetectorOptions options;
+  options.set_max_results(4);
+  options.mutable_model_file_with_metadata()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileSsdWithMetadata));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectDetector> object_detector,
+                       ObjectDetector::CreateFromOptions(options));
+  ObjectDetector::VideoModeOptions video_mode_options;
+  video_mode_options.enabled = true;
+  video_mode_options.max_skipped_frames = 1;
+  object_detector->SetVideoModeOptions(video_mode_options);
+
+  // Inferred, then skipped, then inferred because of the staleness limit.
+  for (int i = 0; i < 3; ++i) {
+    SUPPORT_ASSERT_OK_AND_ASSIGN(const DetectionResult result,
+                         object_detector->Detect(*frame_buffer));
+    ExpectApproximatelyEqual(
+        result, ParseTextProtoOrDie<DetectionResult>(kExpectResults));
+  }
+  EXPECT_EQ(object_detector->GetVideoModeStats().executed_frames, 2);
+  EXPECT_EQ(object_detector->GetVideoModeStats().skipped_frames, 1);
+
+  // A different frame is always inferred.
+  std::fill(rgb_image.pixel_data,
+            rgb_image.pixel_data + rgb_image.width * rgb_image.height * 3, 0);
+  SUPPORT_ASSERT_OK(object_detector->Detect(*frame_buffer));
+  ImageDataFree(&rgb_image);
+  EXPECT_EQ(object_detector->GetVideoModeStats().executed_frames, 3);
+  EXPECT_EQ(object_detector->GetVideoModeStats().skipped_frames, 1);
+}
+
+TEST(DetectAsyncTest, SucceedsInOrder) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(ImageData rgb_image,
+                               LoadImage("cats_and_dogs.jpg"));
+  std::unique_ptr<FrameBuffer> frame_buffer = CreateFromRgbRawBuffer(
+      rgb_image.pixel_data,
+      FrameBuffer::Dimension{rgb_image.width, rgb_image.height});
+
+  ObjectDetectorOptions options;
+  options.set_max_results(4);
+  options.mutable_base_options()->mutable_model_file()->set_file_name(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory,
+               kMobileSsdWithMetadata));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectDetector> object_detector,
+                               ObjectDetector::CreateFromOptions(options));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(const DetectionResult expected,
+                               object_detector->Detect(*frame_buffer));
+
+  ObjectDetector::AsyncOptions async_options;
+  async_options.drop_frames_when_full = false;
+  object_detector->SetAsyncOptions(async_options);
+  constexpr int kNumFrames = 3;
+  absl::Mutex mutex;
+  std::vector<int> order;
+  std::vector<DetectionResult> results;
+  for (int i = 0; i < kNumFrames; ++i) {
+    SUPPORT_ASSERT_OK(object_detector->DetectAsync(
+        *frame_buffer, [&, i](StatusOr<DetectionResult> result) {
+          absl::MutexLock lock(&mutex);
+          order.push_back(i);
+          if (result.ok()) results.push_back(*result);
+        }));
+  }
+  // Frames are staged before the asynchronous call returns.
+  ImageDataFree(&rgb_image);
+  object_detector->WaitForAsyncInferences();
+
+  absl::MutexLock lock(&mutex);
+  EXPECT_THAT(order, ElementsAre(0, 1, 2));
+  ASSERT_EQ(results.size(), kNumFrames);
+  // The boxes are scaled to the original frame, whose pixels are no longer
+  // available at postprocessing time.
+  for (const DetectionResult& result : results) {
+    ExpectApproximatelyEqual(result, expected);
+    ExpectApproximatelyEqual(
+        result, ParseTextProtoOrDie<DetectionResult>(kExpectResults));
+  }
+}
+
 class PostprocessTest : public tflite_shims::testing::Test {
  public:
   class TestObjectDetector : public ObjectDetector {
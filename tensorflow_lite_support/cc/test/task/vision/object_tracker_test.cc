@@ -0,0 +1,117 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/object_tracker.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/detections_proto_inc.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using ::testing::SizeIs;
+
+struct Box {
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+DetectionResult MakeDetections(const std::vector<Box>& boxes) {
+  DetectionResult result;
+  for (const Box& box : boxes) {
+    BoundingBox* bounding_box =
+        result.add_detections()->mutable_bounding_box();
+    bounding_box->set_origin_x(box.x);
+    bounding_box->set_origin_y(box.y);
+    bounding_box->set_width(box.width);
+    bounding_box->set_height(box.height);
+  }
+  return result;
+}
+
+TEST(ObjectTrackerTest, KeepsTrackIdsOfMovingObjects) {
+  ObjectTracker tracker;
+  TrackingResult result =
+      tracker.Update(MakeDetections({{0, 0, 50, 50}, {200, 200, 40, 80}}));
+  ASSERT_THAT(result.objects, SizeIs(2));
+  const int64 first_id = result.objects[0].track_id;
+  const int64 second_id = result.objects[1].track_id;
+  EXPECT_NE(first_id, second_id);
+
+  for (int frame = 1; frame < 10; ++frame) {
+    // Listed in the reverse order to check association is not positional.
+    result = tracker.Update(MakeDetections(
+        {{200 - 3 * frame, 200, 40, 80}, {5 * frame, 2 * frame, 50, 50}}));
+    ASSERT_THAT(result.objects, SizeIs(2));
+    EXPECT_EQ(result.objects[0].track_id, first_id);
+    EXPECT_EQ(result.objects[1].track_id, second_id);
+    EXPECT_EQ(result.objects[0].frames_since_detection, 0);
+  }
+}
+
+TEST(ObjectTrackerTest, PredictsConstantVelocity) {
+  ObjectTracker tracker;
+  for (int frame = 0; frame < 20; ++frame) {
+    tracker.Update(MakeDetections({{10 * frame, 100, 60, 60}}));
+  }
+  // The object keeps moving by 10 pixels per frame.
+  TrackingResult result = tracker.Predict();
+  ASSERT_THAT(result.objects, SizeIs(1));
+  const BoundingBox& box = result.objects[0].detection.bounding_box();
+  EXPECT_LE(std::abs(box.origin_x() - 200), 2);
+  EXPECT_LE(std::abs(box.origin_y() - 100), 2);
+  EXPECT_LE(std::abs(box.width() - 60), 2);
+  EXPECT_LE(std::abs(box.height() - 60), 2);
+  EXPECT_EQ(result.objects[0].frames_since_detection, 1);
+}
+
+TEST(ObjectTrackerTest, DeletesTracksWithoutDetections) {
+  ObjectTracker::Options options;
+  options.max_frames_without_detection = 2;
+  ObjectTracker tracker(options);
+  TrackingResult result = tracker.Update(MakeDetections({{0, 0, 50, 50}}));
+  const int64 id = result.objects[0].track_id;
+
+  EXPECT_THAT(tracker.Predict().objects, SizeIs(1));
+  EXPECT_THAT(tracker.Update(MakeDetections({})).objects, SizeIs(0));
+  // A later detection at the same place starts a new track.
+  result = tracker.Update(MakeDetections({{0, 0, 50, 50}}));
+  ASSERT_THAT(result.objects, SizeIs(1));
+  EXPECT_NE(result.objects[0].track_id, id);
+}
+
+TEST(ObjectTrackerTest, ReportsTracksAfterMinDetections) {
+  ObjectTracker::Options options;
+  options.min_detections = 2;
+  ObjectTracker tracker(options);
+  EXPECT_THAT(tracker.Update(MakeDetections({{0, 0, 50, 50}})).objects,
+              SizeIs(0));
+  EXPECT_THAT(tracker.Update(MakeDetections({{2, 0, 50, 50}})).objects,
+              SizeIs(1));
+}
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
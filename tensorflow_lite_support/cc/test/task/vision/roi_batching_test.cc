@@ -0,0 +1,236 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Tests the batched inference on several regions of interest of
+// BaseVisionTaskApi::InferRois, through ImageClassifier::ClassifyRois and
+// ImageEmbedder::EmbedRois, on a model with a dynamic batch dimension.
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/core/shims/cc/shims_test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/version.h"
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/status_matchers.h"
+#include "tensorflow_lite_support/cc/task/core/task_stats.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/image_classifier.h"
+#include "tensorflow_lite_support/cc/task/vision/image_embedder.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/bounding_box_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/classifications_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/embeddings_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/image_classifier_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/image_embedder_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+#include "tensorflow_lite_support/cc/test/message_matchers.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using ::tflite::support::EqualsProto;
+
+// Side of the model input.
+constexpr int kInputSize = 4;
+// Side of the test image, made of 4 quadrants of kInputSize x kInputSize
+// pixels.
+constexpr int kImageSize = 2 * kInputSize;
+
+std::unique_ptr<tflite::TensorT> CreateTensor(
+    const std::string& name, const std::vector<int>& shape_signature) {
+  auto tensor = absl::make_unique<tflite::TensorT>();
+  tensor->name = name;
+  tensor->shape_signature = shape_signature;
+  tensor->shape = shape_signature;
+  // The batch size is 1 until resized.
+  tensor->shape[0] = 1;
+  tensor->type = tflite::TensorType_UINT8;
+  tensor->buffer = 0;
+  tensor->quantization = absl::make_unique<tflite::QuantizationParametersT>();
+  tensor->quantization->scale = {1.0f / 255};
+  tensor->quantization->zero_point = {0};
+  return tensor;
+}
+
+// Builds a uint8 model with a [-1 x kInputSize x kInputSize x 3] input, whose
+// [-1 x 1 x 1 x 3] output is the mean color of each input image. This is both
+// a classification model with 3 classes and an embedding model with 3
+// dimensions, whose outputs differ from one region to the other.
+std::string BuildDynamicBatchModel() {
+  auto subgraph = absl::make_unique<tflite::SubGraphT>();
+  subgraph->tensors.push_back(
+      CreateTensor("image", {-1, kInputSize, kInputSize, 3}));
+  subgraph->tensors.push_back(CreateTensor("mean_color", {-1, 1, 1, 3}));
+  subgraph->inputs = {0};
+  subgraph->outputs = {1};
+
+  tflite::Pool2DOptionsT pool_options;
+  pool_options.padding = tflite::Padding_VALID;
+  pool_options.stride_w = kInputSize;
+  pool_options.stride_h = kInputSize;
+  pool_options.filter_width = kInputSize;
+  pool_options.filter_height = kInputSize;
+  auto pool = absl::make_unique<tflite::OperatorT>();
+  pool->opcode_index = 0;
+  pool->inputs = {0};
+  pool->outputs = {1};
+  pool->builtin_options.Set(std::move(pool_options));
+  subgraph->operators.push_back(std::move(pool));
+
+  auto opcode = absl::make_unique<tflite::OperatorCodeT>();
+  opcode->builtin_code = tflite::BuiltinOperator_AVERAGE_POOL_2D;
+  opcode->deprecated_builtin_code =
+      static_cast<int8_t>(tflite::BuiltinOperator_AVERAGE_POOL_2D);
+  opcode->version = 1;
+
+  tflite::ModelT model;
+  model.version = TFLITE_SCHEMA_VERSION;
+  model.operator_codes.push_back(std::move(opcode));
+  model.subgraphs.push_back(std::move(subgraph));
+  // Buffer 0 is the empty sentinel buffer referenced by all tensors.
+  model.buffers.push_back(absl::make_unique<tflite::BufferT>());
+
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::FinishModelBuffer(builder, tflite::Model::Pack(builder, &model));
+  return std::string(reinterpret_cast<const char*>(builder.GetBufferPointer()),
+                     builder.GetSize());
+}
+
+BoundingBox CreateRoi(int x, int y, int width, int height) {
+  BoundingBox roi;
+  roi.set_origin_x(x);
+  roi.set_origin_y(y);
+  roi.set_width(width);
+  roi.set_height(height);
+  return roi;
+}
+
+class RoiBatchingTest : public tflite_shims::testing::Test {
+ protected:
+  void SetUp() override {
+    model_ = BuildDynamicBatchModel();
+    // Red, green, blue and gray quadrants.
+    const uint8 colors[4][3] = {
+        {255, 0, 0}, {0, 255, 0}, {0, 0, 255}, {128, 128, 128}};
+    pixels_.resize(kImageSize * kImageSize * 3);
+    for (int y = 0; y < kImageSize; ++y) {
+      for (int x = 0; x < kImageSize; ++x) {
+        const uint8* color = colors[2 * (y / kInputSize) + x / kInputSize];
+        std::copy(color, color + 3, &pixels_[3 * (y * kImageSize + x)]);
+      }
+    }
+    frame_buffer_ = CreateFromRgbRawBuffer(
+        pixels_.data(), FrameBuffer::Dimension{kImageSize, kImageSize});
+    // The quadrants, which are cropped, and the whole image, which is also
+    // resized.
+    rois_ = {CreateRoi(0, 0, kInputSize, kInputSize),
+             CreateRoi(kInputSize, 0, kInputSize, kInputSize),
+             CreateRoi(0, kInputSize, kInputSize, kInputSize),
+             CreateRoi(kInputSize, kInputSize, kInputSize, kInputSize),
+             CreateRoi(0, 0, kImageSize, kImageSize)};
+  }
+
+  std::string model_;
+  std::vector<uint8> pixels_;
+  std::unique_ptr<FrameBuffer> frame_buffer_;
+  std::vector<BoundingBox> rois_;
+};
+
+TEST_F(RoiBatchingTest, ClassifyRoisMatchesClassify) {
+  ImageClassifierOptions options;
+  options.mutable_model_file_with_metadata()->set_file_content(model_);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> classifier,
+                               ImageClassifier::CreateFromOptions(options));
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::vector<ClassificationResult> results,
+      classifier->ClassifyRois(*frame_buffer_, rois_));
+
+  ASSERT_EQ(results.size(), rois_.size());
+  for (size_t i = 0; i < rois_.size(); ++i) {
+    // Also checks that the input tensor is resized back to a batch of 1.
+    SUPPORT_ASSERT_OK_AND_ASSIGN(
+        ClassificationResult expected,
+        classifier->Classify(*frame_buffer_, rois_[i]));
+    EXPECT_THAT(results[i], EqualsProto(expected)) << "region " << i;
+  }
+  // Each region was read from its own batch slot: the top class of the red,
+  // green and blue quadrants is their color.
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_GT(results[i].classifications_size(), 0);
+    ASSERT_GT(results[i].classifications(0).classes_size(), 0);
+    EXPECT_EQ(results[i].classifications(0).classes(0).index(), i);
+  }
+}
+
+TEST_F(RoiBatchingTest, ClassifyRoisRecordsStatsOfTheBatch) {
+  ImageClassifierOptions options;
+  options.mutable_model_file_with_metadata()->set_file_content(model_);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageClassifier> classifier,
+                               ImageClassifier::CreateFromOptions(options));
+  classifier->SetStatsEnabled(true);
+
+  SUPPORT_ASSERT_OK(classifier->ClassifyRois(*frame_buffer_, rois_));
+
+  // The batch is recorded as a single inference on all the regions.
+  core::TaskStats stats = classifier->GetStats();
+  EXPECT_EQ(stats.invocations, 1);
+  EXPECT_EQ(stats.preprocess.count, 1);
+  EXPECT_EQ(stats.invoke.count, 1);
+  EXPECT_EQ(stats.postprocess.count, 1);
+  EXPECT_EQ(stats.total.count, 1);
+  EXPECT_GE(stats.total.max, stats.invoke.max);
+  const int num_rois = rois_.size();
+  EXPECT_EQ(stats.input_bytes, num_rois * kInputSize * kInputSize * 3);
+}
+
+TEST_F(RoiBatchingTest, EmbedRoisMatchesEmbed) {
+  ImageEmbedderOptions options;
+  options.mutable_model_file_with_metadata()->set_file_content(model_);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ImageEmbedder> embedder,
+                               ImageEmbedder::CreateFromOptions(options));
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::vector<EmbeddingResult> results,
+                               embedder->EmbedRois(*frame_buffer_, rois_));
+
+  ASSERT_EQ(results.size(), rois_.size());
+  for (size_t i = 0; i < rois_.size(); ++i) {
+    SUPPORT_ASSERT_OK_AND_ASSIGN(EmbeddingResult expected,
+                                 embedder->Embed(*frame_buffer_, rois_[i]));
+    EXPECT_THAT(results[i], EqualsProto(expected)) << "region " << i;
+  }
+  // The embedding of the red quadrant is its mean color.
+  ASSERT_EQ(results[0].embeddings_size(), 1);
+  const FeatureVector& red = results[0].embeddings(0).feature_vector();
+  ASSERT_EQ(red.value_float_size(), 3);
+  EXPECT_FLOAT_EQ(red.value_float(0), 1.0f);
+  EXPECT_FLOAT_EQ(red.value_float(1), 0.0f);
+  EXPECT_FLOAT_EQ(red.value_float(2), 0.0f);
+}
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
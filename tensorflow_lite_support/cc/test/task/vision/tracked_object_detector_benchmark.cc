@@ -0,0 +1,162 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Throughput and box quality of TrackedObjectDetector for several detection
+// intervals, on a sequence simulating a camera panning over a still image.
+//
+// The `mean_iou` counter is the average, over all the frames and all the
+// objects detected when running the detector on every frame, of the best IoU
+// with a tracked box. It is computed outside of the timed loop.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/object_detector.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/object_detector_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/tracked_object_detector.h"
+#include "tensorflow_lite_support/cc/test/test_utils.h"
+#include "tensorflow_lite_support/examples/task/vision/desktop/utils/image_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using ::tflite::task::JoinPath;
+
+constexpr char kTestDataDirectory[] =
+    "/tensorflow_lite_support/cc/test/testdata/task/"
+    "vision/";
+constexpr char kMobileSsdWithMetadata[] =
+    "coco_ssd_mobilenet_v1_1.0_quant_2018_06_29.tflite";
+constexpr char kImage[] = "cats_and_dogs.jpg";
+
+// Number of frames of the sequence, and the horizontal motion in pixels of
+// the camera between two frames.
+constexpr int kNumFrames = 60;
+constexpr int kPanPixelsPerFrame = 2;
+
+// Frames cropped out of a still image by a window moving left to right.
+class PanningSequence {
+ public:
+  PanningSequence() {
+    image_ = DecodeImageFromFile(JoinPath("./" /*test src dir*/,
+                                          kTestDataDirectory, kImage))
+                 .value();
+    frame_width_ = image_.width - kNumFrames * kPanPixelsPerFrame;
+    for (int i = 0; i < kNumFrames; ++i) {
+      FrameBuffer::Plane plane = {
+          /*buffer=*/image_.pixel_data + i * kPanPixelsPerFrame * 3,
+          /*stride=*/{image_.width * 3, 3}};
+      frames_.push_back(FrameBuffer::Create(
+          {plane}, {frame_width_, image_.height}, FrameBuffer::Format::kRGB,
+          FrameBuffer::Orientation::kTopLeft));
+    }
+  }
+  ~PanningSequence() { ImageDataFree(&image_); }
+
+  const FrameBuffer& frame(int i) const { return *frames_[i]; }
+
+ private:
+  ImageData image_;
+  int frame_width_;
+  std::vector<std::unique_ptr<FrameBuffer>> frames_;
+};
+
+std::unique_ptr<ObjectDetector> CreateDetector() {
+  ObjectDetectorOptions options;
+  options.set_max_results(4);
+  options.mutable_model_file_with_metadata()->set_file_name(JoinPath(
+      "./" /*test src dir*/, kTestDataDirectory, kMobileSsdWithMetadata));
+  return ObjectDetector::CreateFromOptions(options).value();
+}
+
+float IntersectionOverUnion(const BoundingBox& a, const BoundingBox& b) {
+  const int width =
+      std::min(a.origin_x() + a.width(), b.origin_x() + b.width()) -
+      std::max(a.origin_x(), b.origin_x());
+  const int height =
+      std::min(a.origin_y() + a.height(), b.origin_y() + b.height()) -
+      std::max(a.origin_y(), b.origin_y());
+  if (width <= 0 || height <= 0) return 0.0f;
+  const float intersection = static_cast<float>(width) * height;
+  return intersection / (a.width() * a.height() + b.width() * b.height() -
+                         intersection);
+}
+
+void BM_TrackedObjectDetector(benchmark::State& state) {
+  const int detection_interval = state.range(0);
+  PanningSequence sequence;
+
+  // Reference: detection on every frame.
+  std::unique_ptr<ObjectDetector> reference_detector = CreateDetector();
+  std::vector<DetectionResult> reference(kNumFrames);
+  for (int i = 0; i < kNumFrames; ++i) {
+    reference[i] = reference_detector->Detect(sequence.frame(i)).value();
+  }
+
+  TrackedObjectDetector::Options options;
+  options.detection_interval = detection_interval;
+  options.tracker_options.max_frames_without_detection =
+      std::max(5, detection_interval);
+  std::unique_ptr<TrackedObjectDetector> tracked_detector =
+      TrackedObjectDetector::Create(CreateDetector(), options).value();
+
+  // The tracked objects of the last iteration, which are the same for all
+  // iterations since the tracker is reset.
+  std::vector<TrackingResult> results(kNumFrames);
+  for (auto _ : state) {
+    tracked_detector->Reset();
+    for (int i = 0; i < kNumFrames; ++i) {
+      results[i] = tracked_detector->Track(sequence.frame(i)).value();
+    }
+  }
+
+  double total_iou = 0;
+  int64 num_references = 0;
+  for (int i = 0; i < kNumFrames; ++i) {
+    for (const Detection& expected : reference[i].detections()) {
+      float best_iou = 0;
+      for (const TrackedObject& object : results[i].objects) {
+        best_iou = std::max(
+            best_iou, IntersectionOverUnion(expected.bounding_box(),
+                                            object.detection.bounding_box()));
+      }
+      total_iou += best_iou;
+      ++num_references;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumFrames);
+  state.counters["frames_per_second"] = benchmark::Counter(
+      state.iterations() * kNumFrames, benchmark::Counter::kIsRate);
+  state.counters["mean_iou"] =
+      num_references > 0 ? total_iou / num_references : 0;
+}
+BENCHMARK(BM_TrackedObjectDetector)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(3)
+    ->Arg(5)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
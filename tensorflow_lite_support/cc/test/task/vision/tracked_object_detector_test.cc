@@ -0,0 +1,214 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/task/vision/tracked_object_detector.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "tensorflow/lite/core/shims/cc/shims_test_util.h"
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/status_matchers.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/object_detector.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/object_detector_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+#include "tensorflow_lite_support/cc/test/test_utils.h"
+#include "tensorflow_lite_support/examples/task/vision/desktop/utils/image_utils.h"
+
+namespace tflite {
+namespace task {
+namespace vision {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::Not;
+using ::tflite::support::StatusOr;
+using ::tflite::task::JoinPath;
+
+constexpr char kTestDataDirectory[] =
+    "/tensorflow_lite_support/cc/test/testdata/task/"
+    "vision/";
+constexpr char kMobileSsdWithMetadata[] =
+    "coco_ssd_mobilenet_v1_1.0_quant_2018_06_29.tflite";
+
+std::unique_ptr<ObjectDetector> CreateDetector() {
+  ObjectDetectorOptions options;
+  options.set_max_results(4);
+  options.mutable_model_file_with_metadata()->set_file_name(JoinPath(
+      "./" /*test src dir*/, kTestDataDirectory, kMobileSsdWithMetadata));
+  StatusOr<std::unique_ptr<ObjectDetector>> detector =
+      ObjectDetector::CreateFromOptions(options);
+  EXPECT_TRUE(detector.ok()) << detector.status();
+  return detector.ok() ? std::move(detector).value() : nullptr;
+}
+
+std::vector<int64> GetTrackIds(const TrackingResult& result) {
+  std::vector<int64> ids;
+  for (const TrackedObject& object : result.objects) {
+    ids.push_back(object.track_id);
+  }
+  return ids;
+}
+
+class TrackedObjectDetectorTest : public tflite_shims::testing::Test {
+ protected:
+  void SetUp() override {
+    SUPPORT_ASSERT_OK_AND_ASSIGN(
+        image_, DecodeImageFromFile(JoinPath(
+                    "./" /*test src dir*/, kTestDataDirectory,
+                    "cats_and_dogs.jpg")));
+    frame_buffer_ = CreateFromRgbRawBuffer(
+        image_.pixel_data, FrameBuffer::Dimension{image_.width, image_.height});
+    // A frame of the same size without any pixel data, which can only be
+    // passed to `Track` on the frames where detection does not run.
+    unread_frame_buffer_ = FrameBuffer::Create(
+        std::vector<FrameBuffer::Plane>(), frame_buffer_->dimension(),
+        FrameBuffer::Format::kRGB, FrameBuffer::Orientation::kTopLeft);
+  }
+
+  void TearDown() override { ImageDataFree(&image_); }
+
+  ImageData image_ = {};
+  std::unique_ptr<FrameBuffer> frame_buffer_;
+  std::unique_ptr<FrameBuffer> unread_frame_buffer_;
+};
+
+TEST_F(TrackedObjectDetectorTest, FailsWithNullDetector) {
+  StatusOr<std::unique_ptr<TrackedObjectDetector>> tracked_detector =
+      TrackedObjectDetector::Create(nullptr, TrackedObjectDetector::Options());
+
+  EXPECT_EQ(tracked_detector.status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(TrackedObjectDetectorTest, FailsWithInvalidDetectionInterval) {
+  TrackedObjectDetector::Options options;
+  options.detection_interval = 0;
+
+  StatusOr<std::unique_ptr<TrackedObjectDetector>> tracked_detector =
+      TrackedObjectDetector::Create(CreateDetector(), options);
+
+  EXPECT_EQ(tracked_detector.status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(TrackedObjectDetectorTest, FailsWithTracksDeletedBeforeDetection) {
+  TrackedObjectDetector::Options options;
+  options.detection_interval = 4;
+  options.tracker_options.max_frames_without_detection = 3;
+
+  StatusOr<std::unique_ptr<TrackedObjectDetector>> tracked_detector =
+      TrackedObjectDetector::Create(CreateDetector(), options);
+
+  EXPECT_EQ(tracked_detector.status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(TrackedObjectDetectorTest, DetectsEveryIntervalAndKeepsTracks) {
+  TrackedObjectDetector::Options options;
+  options.detection_interval = 3;
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TrackedObjectDetector> tracked_detector,
+      TrackedObjectDetector::Create(CreateDetector(), options));
+
+  // Detection runs on the first frame.
+  SUPPORT_ASSERT_OK_AND_ASSIGN(TrackingResult detected,
+                               tracked_detector->Track(*frame_buffer_));
+  ASSERT_THAT(detected.objects, Not(IsEmpty()));
+  const std::vector<int64> track_ids = GetTrackIds(detected);
+  for (const TrackedObject& object : detected.objects) {
+    EXPECT_EQ(object.frames_since_detection, 0);
+  }
+
+  // The next two frames are not read, and the tracks are kept with their
+  // predicted boxes.
+  for (int i = 1; i < 3; ++i) {
+    SUPPORT_ASSERT_OK_AND_ASSIGN(
+        TrackingResult predicted,
+        tracked_detector->Track(*unread_frame_buffer_));
+    EXPECT_EQ(GetTrackIds(predicted), track_ids);
+    for (const TrackedObject& object : predicted.objects) {
+      EXPECT_EQ(object.frames_since_detection, i);
+    }
+  }
+  EXPECT_EQ(tracked_detector->GetFrameCount(), 3);
+  EXPECT_EQ(tracked_detector->GetDetectedFrameCount(), 1);
+
+  // Detection runs again on the fourth frame, whose detections are associated
+  // with the existing tracks since the image is still.
+  SUPPORT_ASSERT_OK_AND_ASSIGN(detected,
+                               tracked_detector->Track(*frame_buffer_));
+  EXPECT_EQ(GetTrackIds(detected), track_ids);
+  for (const TrackedObject& object : detected.objects) {
+    EXPECT_EQ(object.frames_since_detection, 0);
+  }
+  EXPECT_EQ(tracked_detector->GetFrameCount(), 4);
+  EXPECT_EQ(tracked_detector->GetDetectedFrameCount(), 2);
+}
+
+TEST_F(TrackedObjectDetectorTest, DetectsEveryFrameWithIntervalOfOne) {
+  TrackedObjectDetector::Options options;
+  options.detection_interval = 1;
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TrackedObjectDetector> tracked_detector,
+      TrackedObjectDetector::Create(CreateDetector(), options));
+
+  for (int i = 0; i < 3; ++i) {
+    SUPPORT_ASSERT_OK(tracked_detector->Track(*frame_buffer_));
+  }
+
+  EXPECT_EQ(tracked_detector->GetFrameCount(), 3);
+  EXPECT_EQ(tracked_detector->GetDetectedFrameCount(), 3);
+}
+
+TEST_F(TrackedObjectDetectorTest, DetectsAndCreatesNewTracksAfterReset) {
+  TrackedObjectDetector::Options options;
+  options.detection_interval = 3;
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TrackedObjectDetector> tracked_detector,
+      TrackedObjectDetector::Create(CreateDetector(), options));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(TrackingResult before_reset,
+                               tracked_detector->Track(*frame_buffer_));
+  ASSERT_THAT(before_reset.objects, Not(IsEmpty()));
+  int64 max_track_id = 0;
+  for (const TrackedObject& object : before_reset.objects) {
+    max_track_id = std::max(max_track_id, object.track_id);
+  }
+
+  tracked_detector->Reset();
+  // Detection runs on the frame following the reset even though it is within
+  // the detection interval.
+  SUPPORT_ASSERT_OK_AND_ASSIGN(TrackingResult after_reset,
+                               tracked_detector->Track(*frame_buffer_));
+
+  EXPECT_EQ(tracked_detector->GetDetectedFrameCount(), 2);
+  ASSERT_EQ(after_reset.objects.size(), before_reset.objects.size());
+  // The previous tracks were deleted, and track ids keep increasing.
+  for (const TrackedObject& object : after_reset.objects) {
+    EXPECT_GT(object.track_id, max_track_id);
+    EXPECT_EQ(object.frames_since_detection, 0);
+  }
+}
+
+}  // namespace
+}  // namespace vision
+}  // namespace task
+}  // namespace tflite
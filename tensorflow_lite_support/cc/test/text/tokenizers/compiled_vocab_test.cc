@@ -0,0 +1,165 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/text/tokenizers/compiled_vocab.h"
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/cord.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/status_matchers.h"
+
+namespace tflite {
+namespace support {
+namespace text {
+namespace tokenizer {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Optional;
+
+TEST(CompiledVocabTest, LooksUpDenseVocab) {
+  std::vector<std::string> vocab;
+  for (int i = 0; i < 1000; ++i) {
+    vocab.push_back(absl::StrCat("word", i));
+  }
+  std::string buffer = BuildCompiledVocab(vocab);
+  ASSERT_TRUE(CompiledVocab::IsCompiledVocab(buffer));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledVocab> compiled,
+                               CompiledVocab::CreateFromBuffer(buffer));
+
+  const int vocab_size = vocab.size();
+  EXPECT_EQ(compiled->VocabularySize(), vocab_size);
+  for (int i = 0; i < vocab_size; ++i) {
+    int id;
+    ASSERT_TRUE(compiled->LookupId(vocab[i], &id));
+    EXPECT_EQ(id, i);
+    absl::string_view word;
+    ASSERT_TRUE(compiled->LookupWord(i, &word));
+    EXPECT_EQ(word, vocab[i]);
+  }
+  int id;
+  EXPECT_FALSE(compiled->LookupId("word1000", &id));
+  EXPECT_FALSE(compiled->LookupId("", &id));
+  absl::string_view word;
+  EXPECT_FALSE(compiled->LookupWord(-1, &word));
+  EXPECT_FALSE(compiled->LookupWord(1000, &word));
+}
+
+TEST(CompiledVocabTest, LooksUpSparseVocab) {
+  std::string buffer =
+      BuildCompiledVocab({"<PAD>", "<START>", "<UNKNOWN>", "hello", "world"},
+                         {0, 1, 2, 42, 7});
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledVocab> compiled,
+                               CompiledVocab::CreateFromBuffer(buffer));
+
+  int id;
+  ASSERT_TRUE(compiled->LookupId("hello", &id));
+  EXPECT_EQ(id, 42);
+  ASSERT_TRUE(compiled->LookupId("world", &id));
+  EXPECT_EQ(id, 7);
+  absl::string_view word;
+  ASSERT_TRUE(compiled->LookupWord(42, &word));
+  EXPECT_EQ(word, "hello");
+  ASSERT_TRUE(compiled->LookupWord(2, &word));
+  EXPECT_EQ(word, "<UNKNOWN>");
+  EXPECT_FALSE(compiled->LookupWord(3, &word));
+}
+
+TEST(CompiledVocabTest, LastDuplicateWins) {
+  std::string buffer = BuildCompiledVocab({"a", "b", "a"});
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledVocab> compiled,
+                               CompiledVocab::CreateFromBuffer(buffer));
+
+  int id;
+  ASSERT_TRUE(compiled->LookupId("a", &id));
+  EXPECT_EQ(id, 2);
+  absl::string_view word;
+  ASSERT_TRUE(compiled->LookupWord(0, &word));
+  EXPECT_EQ(word, "a");
+}
+
+TEST(CompiledVocabTest, WorksOnUnalignedBuffer) {
+  std::string buffer = absl::StrCat("x", BuildCompiledVocab({"a", "b", "c"}));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CompiledVocab> compiled,
+      CompiledVocab::CreateFromBuffer(absl::string_view(buffer).substr(1)));
+
+  int id;
+  ASSERT_TRUE(compiled->LookupId("c", &id));
+  EXPECT_EQ(id, 2);
+}
+
+TEST(CompiledVocabTest, BuildsFromTextVocab) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CompiledVocab> compiled,
+      CompiledVocab::CreateFromBuffer(BuildCompiledVocabFromText(
+          "[PAD]\n[UNK]\nhello\n", /*with_ids=*/false)));
+
+  EXPECT_EQ(compiled->VocabularySize(), 3);
+  int id;
+  ASSERT_TRUE(compiled->LookupId("hello", &id));
+  EXPECT_EQ(id, 2);
+  absl::string_view word;
+  ASSERT_TRUE(compiled->LookupWord(1, &word));
+  EXPECT_EQ(word, "[UNK]");
+}
+
+TEST(CompiledVocabTest, BuildsFromTextVocabWithIds) {
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CompiledVocab> compiled,
+      CompiledVocab::CreateFromBuffer(BuildCompiledVocabFromText(
+          "<PAD> 0\n<UNKNOWN> 2\nhello 42\n", /*with_ids=*/true)));
+
+  EXPECT_EQ(compiled->VocabularySize(), 3);
+  int id;
+  ASSERT_TRUE(compiled->LookupId("hello", &id));
+  EXPECT_EQ(id, 42);
+  absl::string_view word;
+  ASSERT_TRUE(compiled->LookupWord(2, &word));
+  EXPECT_EQ(word, "<UNKNOWN>");
+  EXPECT_FALSE(compiled->LookupWord(1, &word));
+}
+
+TEST(CompiledVocabTest, FailsWithTextVocab) {
+  std::string buffer = "[PAD]\n[UNK]\nhello\n";
+  EXPECT_FALSE(CompiledVocab::IsCompiledVocab(buffer));
+  auto compiled_or = CompiledVocab::CreateFromBuffer(buffer);
+
+  EXPECT_EQ(compiled_or.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(compiled_or.status().message(),
+              HasSubstr("not a compiled vocabulary"));
+  EXPECT_THAT(compiled_or.status().GetPayload(kTfLiteSupportPayload),
+              Optional(absl::Cord(absl::StrCat(
+                  TfLiteSupportStatus::kMetadataInvalidTokenizerError))));
+}
+
+TEST(CompiledVocabTest, FailsWithTruncatedBuffer) {
+  std::string buffer = BuildCompiledVocab({"a", "b", "c"});
+  buffer.pop_back();
+  auto compiled_or = CompiledVocab::CreateFromBuffer(buffer);
+
+  EXPECT_EQ(compiled_or.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(compiled_or.status().message(),
+              HasSubstr("Corrupted compiled vocabulary header"));
+}
+
+}  // namespace
+}  // namespace tokenizer
+}  // namespace text
+}  // namespace support
+}  // namespace tflite
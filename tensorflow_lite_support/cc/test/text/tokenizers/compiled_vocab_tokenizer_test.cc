@@ -0,0 +1,214 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Checks that the tokenizers built on top of a compiled vocabulary give the
+// same results as the ones parsing the text vocabulary, including when the
+// compiled vocabulary is read from the model metadata.
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/port/status_matchers.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/core/task_utils.h"
+#include "tensorflow_lite_support/cc/test/test_utils.h"
+#include "tensorflow_lite_support/cc/text/tokenizers/bert_tokenizer.h"
+#include "tensorflow_lite_support/cc/text/tokenizers/compiled_vocab.h"
+#include "tensorflow_lite_support/cc/text/tokenizers/regex_tokenizer.h"
+#include "tensorflow_lite_support/cc/text/tokenizers/tokenizer_utils.h"
+#include "tensorflow_lite_support/metadata/cc/metadata_extractor.h"
+#include "tensorflow_lite_support/metadata/cc/metadata_populator.h"
+#include "tensorflow_lite_support/metadata/metadata_schema_generated.h"
+
+namespace tflite {
+namespace support {
+namespace text {
+namespace tokenizer {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::Not;
+using ::tflite::metadata::ModelMetadataExtractor;
+using ::tflite::metadata::ModelMetadataPopulator;
+using ::tflite::task::JoinPath;
+using ::tflite::task::core::LoadBinaryContent;
+
+constexpr char kTestDataDirectory[] =
+    "/tensorflow_lite_support/cc/test/testdata/task/text/";
+constexpr char kMobileBertVocab[] = "mobilebert_vocab.txt";
+constexpr char kRegexVocab[] = "vocab_for_regex_tokenizer.txt";
+// Pattern of the regex tokenizer of the model below.
+constexpr char kRegexPattern[] = R"([^\w\']+)";
+// A model whose input process unit is a regex tokenizer, with the "vocab.txt"
+// and "labels.txt" associated files.
+constexpr char kModelWithRegexTokenizer[] =
+    "test_model_nl_classifier_with_regex_tokenizer.tflite";
+
+constexpr const char* kSentences[] = {
+    "The quick brown fox jumps over the lazy dog.",
+    "Tokenization throughput matters for on-device question answering.",
+    "She didn't expect the movie's ending to be so unremarkable!",
+    "The café on the corner serves crème brûlée and espresso.",
+    "Unbelievably, the antidisestablishmentarianism debate resurfaced.",
+    "",
+};
+
+std::string LoadTestData(const std::string& name) {
+  return LoadBinaryContent(
+      JoinPath("./" /*test src dir*/, kTestDataDirectory, name).c_str());
+}
+
+// Creates the tokenizer described by the regex tokenizer process unit of the
+// input tensor of the model.
+StatusOr<std::unique_ptr<Tokenizer>> CreateRegexTokenizer(
+    const ModelMetadataExtractor& extractor) {
+  ASSIGN_OR_RETURN(const tflite::ProcessUnit* process_unit,
+                   extractor.FindFirstProcessUnit(
+                       *extractor.GetInputTensorMetadata(0),
+                       tflite::ProcessUnitOptions_RegexTokenizerOptions));
+  return CreateTokenizerFromProcessUnit(process_unit, &extractor);
+}
+
+// Checks that `actual` gives the same tokens as `expected` on the test
+// sentences, and the same ids for these tokens.
+void ExpectSameTokenization(Tokenizer* expected, Tokenizer* actual) {
+  for (const char* sentence : kSentences) {
+    const TokenizerResult expected_result = expected->Tokenize(sentence);
+    const TokenizerResult result = actual->Tokenize(sentence);
+    EXPECT_EQ(result.subwords, expected_result.subwords) << sentence;
+    for (const std::string& subword : result.subwords) {
+      int expected_id = -1;
+      int id = -1;
+      EXPECT_EQ(actual->LookupId(subword, &id),
+                expected->LookupId(subword, &expected_id))
+          << subword;
+      EXPECT_EQ(id, expected_id) << subword;
+    }
+  }
+}
+
+TEST(CompiledVocabTokenizerTest, BertTokenizerMatchesTextVocab) {
+  const std::string text_vocab = LoadTestData(kMobileBertVocab);
+  ASSERT_THAT(text_vocab, Not(IsEmpty()));
+  const std::string compiled_vocab =
+      BuildCompiledVocabFromText(text_vocab, /*with_ids=*/false);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledVocab> vocab,
+                               CompiledVocab::CreateFromBuffer(compiled_vocab));
+  BertTokenizer text_tokenizer(text_vocab.data(), text_vocab.size());
+  BertTokenizer compiled_tokenizer(std::move(vocab));
+
+  ExpectSameTokenization(&text_tokenizer, &compiled_tokenizer);
+  for (const char* sentence : kSentences) {
+    const WordpieceTokenizerResult expected =
+        text_tokenizer.TokenizeWordpiece(sentence);
+    const WordpieceTokenizerResult result =
+        compiled_tokenizer.TokenizeWordpiece(sentence);
+    EXPECT_EQ(result.wp_begin_offset, expected.wp_begin_offset) << sentence;
+    EXPECT_EQ(result.wp_end_offset, expected.wp_end_offset) << sentence;
+    EXPECT_EQ(result.row_lengths, expected.row_lengths) << sentence;
+  }
+  absl::string_view word;
+  ASSERT_TRUE(compiled_tokenizer.LookupWord(100, &word));
+  absl::string_view expected_word;
+  ASSERT_TRUE(text_tokenizer.LookupWord(100, &expected_word));
+  EXPECT_EQ(word, expected_word);
+}
+
+TEST(CompiledVocabTokenizerTest, RegexTokenizerMatchesTextVocab) {
+  const std::string text_vocab = LoadTestData(kRegexVocab);
+  ASSERT_THAT(text_vocab, Not(IsEmpty()));
+  const std::string compiled_vocab =
+      BuildCompiledVocabFromText(text_vocab, /*with_ids=*/true);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledVocab> vocab,
+                               CompiledVocab::CreateFromBuffer(compiled_vocab));
+  RegexTokenizer text_tokenizer(kRegexPattern, text_vocab.data(),
+                                text_vocab.size());
+  RegexTokenizer compiled_tokenizer(kRegexPattern, std::move(vocab));
+
+  ExpectSameTokenization(&text_tokenizer, &compiled_tokenizer);
+  int unknown_token = -1;
+  ASSERT_TRUE(compiled_tokenizer.GetUnknownToken(&unknown_token));
+  int expected_unknown_token = -1;
+  ASSERT_TRUE(text_tokenizer.GetUnknownToken(&expected_unknown_token));
+  EXPECT_EQ(unknown_token, expected_unknown_token);
+}
+
+TEST(CompiledVocabTokenizerTest, CreatesRegexTokenizerFromModelMetadata) {
+  const std::string model = LoadTestData(kModelWithRegexTokenizer);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ModelMetadataExtractor> extractor,
+      ModelMetadataExtractor::CreateFromModelBuffer(model.data(),
+                                                    model.size()));
+  ASSERT_NE(extractor->GetModelMetadata(), nullptr);
+
+  // Replaces the text vocabulary of the model with its compiled version,
+  // stored uncompressed.
+  SUPPORT_ASSERT_OK_AND_ASSIGN(absl::string_view text_vocab,
+                               extractor->GetAssociatedFile("vocab.txt"));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(absl::string_view labels,
+                               extractor->GetAssociatedFile("labels.txt"));
+  absl::flat_hash_map<std::string, std::string> associated_files;
+  associated_files["vocab.txt"] =
+      BuildCompiledVocabFromText(text_vocab, /*with_ids=*/true);
+  associated_files["labels.txt"] = std::string(labels);
+  std::unique_ptr<tflite::ModelMetadataT> metadata(
+      extractor->GetModelMetadata()->UnPack());
+  flatbuffers::FlatBufferBuilder builder;
+  tflite::FinishModelMetadataBuffer(
+      builder, tflite::ModelMetadata::Pack(builder, metadata.get()));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ModelMetadataPopulator> populator,
+      ModelMetadataPopulator::CreateFromModelBuffer(model.data(),
+                                                    model.size()));
+  populator->LoadMetadata(
+      reinterpret_cast<const char*>(builder.GetBufferPointer()),
+      builder.GetSize());
+  populator->LoadAssociatedFiles(associated_files);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::string compiled_model,
+                               populator->Populate());
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ModelMetadataExtractor> compiled_extractor,
+      ModelMetadataExtractor::CreateFromModelBuffer(compiled_model.data(),
+                                                    compiled_model.size()));
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Tokenizer> text_tokenizer,
+                               CreateRegexTokenizer(*extractor));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Tokenizer> compiled_tokenizer,
+                               CreateRegexTokenizer(*compiled_extractor));
+
+  // The compiled vocabulary is used in place in the model buffer.
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      absl::string_view compiled_vocab,
+      compiled_extractor->GetAssociatedFile("vocab.txt"));
+  EXPECT_TRUE(CompiledVocab::IsCompiledVocab(compiled_vocab));
+  EXPECT_GE(compiled_vocab.data(), compiled_model.data());
+  EXPECT_LE(compiled_vocab.data() + compiled_vocab.size(),
+            compiled_model.data() + compiled_model.size());
+  ExpectSameTokenization(text_tokenizer.get(), compiled_tokenizer.get());
+}
+
+}  // namespace
+}  // namespace tokenizer
+}  // namespace text
+}  // namespace support
+}  // namespace tflite
@@ -0,0 +1,149 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Throughput of the BERT wordpiece and regex tokenizers on documents of
+// several sizes, with the vocabularies of the MobileBERT and NLClassifier test
+// models.
+//
+// Besides bytes per second, the `tokens_per_second` counter gives the number
+// of produced tokens (subwords for BERT) per second. Use
+// --benchmark_format=json (or --benchmark_out=<file>
+// --benchmark_out_format=json) for a machine readable output.
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/test/test_utils.h"
+#include "tensorflow_lite_support/cc/text/tokenizers/bert_tokenizer.h"
+#include "tensorflow_lite_support/cc/text/tokenizers/compiled_vocab.h"
+#include "tensorflow_lite_support/cc/text/tokenizers/regex_tokenizer.h"
+#include "tensorflow_lite_support/cc/utils/common_utils.h"
+
+namespace tflite {
+namespace support {
+namespace text {
+namespace tokenizer {
+namespace {
+
+using ::tflite::task::JoinPath;
+
+constexpr char kTestDataDirectory[] =
+    "/tensorflow_lite_support/cc/test/testdata/task/text/";
+constexpr char kMobileBertVocab[] = "mobilebert_vocab.txt";
+constexpr char kRegexVocab[] = "vocab_for_regex_tokenizer.txt";
+// Pattern of the regex tokenizer of the NLClassifier test model.
+constexpr char kRegexPattern[] = R"([^\w\']+)";
+
+// Sentences mixing frequent words, rare words split into several wordpieces,
+// numbers, punctuation and a few non-ASCII characters, sampled to build the
+// documents.
+constexpr const char* kSentences[] = {
+    "The quick brown fox jumps over the lazy dog.",
+    "Tokenization throughput matters for on-device question answering.",
+    "In 2019, researchers released a compact BERT variant for mobile phones.",
+    "She didn't expect the movie's ending to be so unremarkable!",
+    "Photosynthesis converts light energy into chemical energy.",
+    "Call me at 555-0142 or e-mail support@example.com (weekdays only).",
+    "The café on the corner serves crème brûlée and espresso.",
+    "Hyperparameter optimization is computationally expensive, isn't it?",
+    "東京 is the capital of Japan; 北京 is the capital of China.",
+    "Results: precision=0.92, recall=0.87, F1=0.89 on the held-out set.",
+    "Once upon a time, in a faraway kingdom, lived an extraordinary knight.",
+    "Unbelievably, the antidisestablishmentarianism debate resurfaced.",
+};
+constexpr int kNumSentences = sizeof(kSentences) / sizeof(kSentences[0]);
+
+// Returns a document of at least `num_bytes` bytes made of random sentences.
+std::string MakeDocument(int num_bytes) {
+  std::mt19937 rng(/*seed=*/42);
+  std::string document;
+  while (document.size() < static_cast<size_t>(num_bytes)) {
+    document.append(kSentences[rng() % kNumSentences]);
+    document.push_back(' ');
+  }
+  return document;
+}
+
+std::string GetTestDataPath(const char* file_name) {
+  return JoinPath("./" /*test src dir*/, kTestDataDirectory, file_name);
+}
+
+// Runs `tokenize`, which tokenizes `document` and returns the number of
+// tokens, in the benchmark loop.
+template <typename TokenizeFn>
+void RunTokenizerBenchmark(const std::string& document, TokenizeFn tokenize,
+                           benchmark::State& state) {
+  const auto num_tokens = tokenize();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tokenize());
+  }
+  state.SetBytesProcessed(state.iterations() * document.size());
+  state.counters["tokens_per_second"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * num_tokens,
+      benchmark::Counter::kIsRate);
+}
+
+void BM_BertTokenizeWordpiece(benchmark::State& state) {
+  const std::string document = MakeDocument(state.range(0));
+  const std::vector<std::string> vocab =
+      utils::LoadVocabFromFile(GetTestDataPath(kMobileBertVocab));
+  const BertTokenizer tokenizer(vocab);
+  RunTokenizerBenchmark(
+      document,
+      [&] { return tokenizer.TokenizeWordpiece(document).subwords.size(); },
+      state);
+}
+BENCHMARK(BM_BertTokenizeWordpiece)
+    ->ArgName("bytes")
+    ->Arg(128)
+    ->Arg(2048)
+    ->Arg(32768);
+
+// Same as above, with the wordpieces looked up in a compiled vocabulary rather
+// than in a hash map.
+void BM_BertTokenizeWordpieceCompiledVocab(benchmark::State& state) {
+  const std::string document = MakeDocument(state.range(0));
+  const std::string compiled_vocab = BuildCompiledVocab(
+      utils::LoadVocabFromFile(GetTestDataPath(kMobileBertVocab)));
+  const BertTokenizer tokenizer(
+      CompiledVocab::CreateFromBuffer(compiled_vocab).value());
+  RunTokenizerBenchmark(
+      document,
+      [&] { return tokenizer.TokenizeWordpiece(document).subwords.size(); },
+      state);
+}
+BENCHMARK(BM_BertTokenizeWordpieceCompiledVocab)
+    ->ArgName("bytes")
+    ->Arg(128)
+    ->Arg(2048)
+    ->Arg(32768);
+
+void BM_RegexTokenize(benchmark::State& state) {
+  const std::string document = MakeDocument(state.range(0));
+  RegexTokenizer tokenizer(kRegexPattern, GetTestDataPath(kRegexVocab));
+  RunTokenizerBenchmark(
+      document, [&] { return tokenizer.Tokenize(document).subwords.size(); },
+      state);
+}
+BENCHMARK(BM_RegexTokenize)->ArgName("bytes")->Arg(128)->Arg(2048)->Arg(32768);
+
+}  // namespace
+}  // namespace tokenizer
+}  // namespace text
+}  // namespace support
+}  // namespace tflite
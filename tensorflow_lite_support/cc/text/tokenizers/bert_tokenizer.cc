@@ -55,6 +55,13 @@ bool FlatHashMapBackedWordpiece::LookupWord(int vocab_id,
   return true;
 }
 
+tensorflow::text::LookupStatus CompiledVocabBackedWordpiece::Contains(
+    absl::string_view key, bool* value) const {
+  int unused_id;
+  *value = vocab_->LookupId(key, &unused_id);
+  return tensorflow::text::LookupStatus();
+}
+
 TokenizerResult BertTokenizer::Tokenize(const std::string& input) {
   return TokenizeWordpiece(input);
 }
@@ -80,7 +87,7 @@ WordpieceTokenizerResult BertTokenizer::TokenizeWordpiece(
     tensorflow::text::LookupStatus status = WordpieceTokenize(
         token, options_.max_bytes_per_token, options_.max_chars_per_subtoken,
         options_.suffix_indicator, options_.use_unknown_token,
-        options_.unknown_token, options_.split_unknown_chars, &vocab_,
+        options_.unknown_token, options_.split_unknown_chars, vocab_.get(),
         &subwords, &wp_absolute_begin_offset, &wp_absolute_end_offset,
         &num_word_pieces);
 
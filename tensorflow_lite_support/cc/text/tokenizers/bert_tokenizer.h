@@ -17,11 +17,14 @@ limitations under the License.
 #define TENSORFLOW_LITE_SUPPORT_CC_TEXT_TOKENIZERS_BERT_TOKENIZER_H_
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/memory/memory.h"  // from @com_google_absl
 #include "re2/re2.h"
+#include "tensorflow_lite_support/cc/text/tokenizers/compiled_vocab.h"
 #include "tensorflow_lite_support/cc/text/tokenizers/tokenizer.h"
 #include "tensorflow_lite_support/cc/utils/common_utils.h"
 #include "tensorflow_text/core/kernels/regex_split.h"
@@ -67,17 +70,25 @@ struct BertTokenizerOptions {
   std::string include_delim_str = kDefaultIncludeDelimRe;
 };
 
-// A flat-hash-map based implementation of WordpieceVocab, used in
-// BertTokenizer to invoke tensorflow::text::WordpieceTokenize within.
-class FlatHashMapBackedWordpiece : public tensorflow::text::WordpieceVocab {
+// A WordpieceVocab that also supports id lookups, used in BertTokenizer to
+// invoke tensorflow::text::WordpieceTokenize within.
+class IndexedWordpieceVocab : public tensorflow::text::WordpieceVocab {
+ public:
+  virtual bool LookupId(absl::string_view key, int* result) const = 0;
+  virtual bool LookupWord(int vocab_id, absl::string_view* result) const = 0;
+  virtual int VocabularySize() const = 0;
+};
+
+// A flat-hash-map based implementation of IndexedWordpieceVocab.
+class FlatHashMapBackedWordpiece : public IndexedWordpieceVocab {
  public:
   explicit FlatHashMapBackedWordpiece(const std::vector<std::string>& vocab);
 
   tensorflow::text::LookupStatus Contains(absl::string_view key,
                                           bool* value) const override;
-  bool LookupId(absl::string_view key, int* result) const;
-  bool LookupWord(int vocab_id, absl::string_view* result) const;
-  int VocabularySize() const { return vocab_.size(); }
+  bool LookupId(absl::string_view key, int* result) const override;
+  bool LookupWord(int vocab_id, absl::string_view* result) const override;
+  int VocabularySize() const override { return vocab_.size(); }
 
  private:
   // All words indexed position in vocabulary file.
@@ -85,13 +96,34 @@ class FlatHashMapBackedWordpiece : public tensorflow::text::WordpieceVocab {
   absl::flat_hash_map<absl::string_view, int> index_map_;
 };
 
+// An implementation of IndexedWordpieceVocab on top of a CompiledVocab, which
+// requires no parsing nor copies at construction time.
+class CompiledVocabBackedWordpiece : public IndexedWordpieceVocab {
+ public:
+  explicit CompiledVocabBackedWordpiece(std::unique_ptr<CompiledVocab> vocab)
+      : vocab_(std::move(vocab)) {}
+
+  tensorflow::text::LookupStatus Contains(absl::string_view key,
+                                          bool* value) const override;
+  bool LookupId(absl::string_view key, int* result) const override {
+    return vocab_->LookupId(key, result);
+  }
+  bool LookupWord(int vocab_id, absl::string_view* result) const override {
+    return vocab_->LookupWord(vocab_id, result);
+  }
+  int VocabularySize() const override { return vocab_->VocabularySize(); }
+
+ private:
+  std::unique_ptr<CompiledVocab> vocab_;
+};
+
 // Wordpiece tokenizer for bert models. Initialized with a vocab file or vector.
 class BertTokenizer : public tflite::support::text::tokenizer::Tokenizer {
  public:
   // Initialize the tokenizer from vocab vector and tokenizer configs.
   explicit BertTokenizer(const std::vector<std::string>& vocab,
                          const BertTokenizerOptions& options = {})
-      : vocab_{FlatHashMapBackedWordpiece(vocab)},
+      : vocab_{absl::make_unique<FlatHashMapBackedWordpiece>(vocab)},
         options_{options},
         delim_re_{options.delim_str},
         include_delim_re_{options.include_delim_str} {}
@@ -109,6 +141,17 @@ class BertTokenizer : public tflite::support::text::tokenizer::Tokenizer {
             utils::LoadVocabFromBuffer(vocab_buffer_data, vocab_buffer_size),
             options) {}
 
+  // Initialize the tokenizer from a compiled vocabulary (see
+  // BuildCompiledVocab) and tokenizer configs. The buffer backing `vocab` must
+  // outlive the tokenizer.
+  explicit BertTokenizer(std::unique_ptr<CompiledVocab> vocab,
+                         const BertTokenizerOptions& options = {})
+      : vocab_{absl::make_unique<CompiledVocabBackedWordpiece>(
+            std::move(vocab))},
+        options_{options},
+        delim_re_{options.delim_str},
+        include_delim_re_{options.include_delim_str} {}
+
   // Perform tokenization, return tokenized results containing the subwords.
   TokenizerResult Tokenize(const std::string& input) override;
 
@@ -119,23 +162,23 @@ class BertTokenizer : public tflite::support::text::tokenizer::Tokenizer {
   // Check if a certain key is included in the vocab.
   tensorflow::text::LookupStatus Contains(const absl::string_view key,
                                           bool* value) const {
-    return vocab_.Contains(key, value);
+    return vocab_->Contains(key, value);
   }
 
   // Find the id of a wordpiece.
   bool LookupId(absl::string_view key, int* result) const override {
-    return vocab_.LookupId(key, result);
+    return vocab_->LookupId(key, result);
   }
 
   // Find the wordpiece from an id.
   bool LookupWord(int vocab_id, absl::string_view* result) const override {
-    return vocab_.LookupWord(vocab_id, result);
+    return vocab_->LookupWord(vocab_id, result);
   }
 
-  int VocabularySize() const { return vocab_.VocabularySize(); }
+  int VocabularySize() const { return vocab_->VocabularySize(); }
 
  private:
-  tflite::support::text::tokenizer::FlatHashMapBackedWordpiece vocab_;
+  std::unique_ptr<IndexedWordpieceVocab> vocab_;
   BertTokenizerOptions options_;
   RE2 delim_re_;
   RE2 include_delim_re_;
@@ -0,0 +1,274 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/cc/text/tokenizers/compiled_vocab.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/common.h"
+#include "tensorflow_lite_support/cc/utils/common_utils.h"
+
+namespace tflite {
+namespace support {
+namespace text {
+namespace tokenizer {
+
+using ::tflite::support::CreateStatusWithPayload;
+using ::tflite::support::StatusOr;
+using ::tflite::support::TfLiteSupportStatus;
+
+namespace {
+
+// "TFCV" when read as bytes.
+constexpr uint32_t kMagic = 0x56434654;
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kHeaderWords = 6;
+// Set when the ids are exactly 0..num_words-1, i.e. the id is the position.
+constexpr uint32_t kDenseIdsFlag = 0x1;
+
+// Reads a little-endian uint32 from a possibly unaligned address. Compilers
+// turn this into a single load on little-endian targets.
+uint32_t Load32(const char* p) {
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(p);
+  return static_cast<uint32_t>(bytes[0]) |
+         (static_cast<uint32_t>(bytes[1]) << 8) |
+         (static_cast<uint32_t>(bytes[2]) << 16) |
+         (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+void Append32(uint32_t value, std::string* output) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    output->push_back(static_cast<char>((value >> shift) & 0xff));
+  }
+}
+
+// 32-bit FNV-1a. The hash is part of the format and must not change.
+uint32_t Hash(absl::string_view key) {
+  uint32_t hash = 2166136261u;
+  for (unsigned char c : key) {
+    hash ^= c;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+}  // namespace
+
+bool CompiledVocab::IsCompiledVocab(absl::string_view buffer) {
+  return buffer.size() >= sizeof(uint32_t) && Load32(buffer.data()) == kMagic;
+}
+
+StatusOr<std::unique_ptr<CompiledVocab>> CompiledVocab::CreateFromBuffer(
+    absl::string_view buffer) {
+  if (buffer.size() < kHeaderWords * sizeof(uint32_t) ||
+      !IsCompiledVocab(buffer)) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "Buffer is not a compiled vocabulary.",
+        TfLiteSupportStatus::kMetadataInvalidTokenizerError);
+  }
+  const char* header = buffer.data();
+  const uint32_t version = Load32(header + 4);
+  if (version != kVersion) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        absl::StrFormat("Unsupported compiled vocabulary version: %d.",
+                        version),
+        TfLiteSupportStatus::kMetadataInvalidTokenizerError);
+  }
+  const uint64_t num_words = Load32(header + 8);
+  const uint64_t num_slots = Load32(header + 12);
+  const uint32_t flags = Load32(header + 16);
+  const uint64_t string_data_size = Load32(header + 20);
+  // All sizes are 32-bit, so the sum below cannot overflow 64 bits.
+  const uint64_t expected_size =
+      (kHeaderWords + num_words + (num_words + 1) + num_slots) *
+          sizeof(uint32_t) +
+      string_data_size;
+  if (num_slots == 0 || (num_slots & (num_slots - 1)) != 0 ||
+      num_slots < num_words || expected_size != buffer.size()) {
+    return CreateStatusWithPayload(
+        absl::StatusCode::kInvalidArgument,
+        "Corrupted compiled vocabulary header.",
+        TfLiteSupportStatus::kMetadataInvalidTokenizerError);
+  }
+
+  auto vocab = absl::WrapUnique(new CompiledVocab());
+  vocab->num_words_ = num_words;
+  vocab->slot_mask_ = num_slots - 1;
+  vocab->string_data_size_ = string_data_size;
+  vocab->dense_ids_ = (flags & kDenseIdsFlag) != 0;
+  vocab->ids_ = header + kHeaderWords * sizeof(uint32_t);
+  vocab->offsets_ = vocab->ids_ + num_words * sizeof(uint32_t);
+  vocab->slots_ = vocab->offsets_ + (num_words + 1) * sizeof(uint32_t);
+  vocab->string_data_ = vocab->slots_ + num_slots * sizeof(uint32_t);
+  return vocab;
+}
+
+bool CompiledVocab::WordAt(uint32_t position,
+                           absl::string_view* result) const {
+  const uint32_t begin = Load32(offsets_ + position * sizeof(uint32_t));
+  const uint32_t end = Load32(offsets_ + (position + 1) * sizeof(uint32_t));
+  if (begin > end || end > string_data_size_) {
+    return false;
+  }
+  *result = absl::string_view(string_data_ + begin, end - begin);
+  return true;
+}
+
+bool CompiledVocab::LookupId(absl::string_view key, int* result) const {
+  // Linear probing; the builder keeps the load factor at or below 1/2, so
+  // probe sequences are short and always reach an empty slot.
+  uint32_t slot = Hash(key) & slot_mask_;
+  for (uint32_t probes = 0; probes <= slot_mask_; ++probes) {
+    const uint32_t entry = Load32(slots_ + slot * sizeof(uint32_t));
+    if (entry == 0 || entry > num_words_) {
+      return false;
+    }
+    absl::string_view word;
+    if (WordAt(entry - 1, &word) && word == key) {
+      *result =
+          static_cast<int>(Load32(ids_ + (entry - 1) * sizeof(uint32_t)));
+      return true;
+    }
+    slot = (slot + 1) & slot_mask_;
+  }
+  return false;
+}
+
+bool CompiledVocab::LookupWord(int vocab_id, absl::string_view* result) const {
+  if (dense_ids_) {
+    if (vocab_id < 0 || static_cast<uint32_t>(vocab_id) >= num_words_) {
+      return false;
+    }
+    return WordAt(vocab_id, result);
+  }
+  // Binary search in the sorted ids.
+  uint32_t low = 0;
+  uint32_t high = num_words_;
+  while (low < high) {
+    const uint32_t mid = low + (high - low) / 2;
+    if (static_cast<int>(Load32(ids_ + mid * sizeof(uint32_t))) < vocab_id) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low == num_words_ ||
+      static_cast<int>(Load32(ids_ + low * sizeof(uint32_t))) != vocab_id) {
+    return false;
+  }
+  return WordAt(low, result);
+}
+
+std::string BuildCompiledVocab(const std::vector<std::string>& vocab) {
+  std::vector<int> ids(vocab.size());
+  std::iota(ids.begin(), ids.end(), 0);
+  return BuildCompiledVocab(vocab, ids);
+}
+
+std::string BuildCompiledVocab(const std::vector<std::string>& words,
+                               const std::vector<int>& ids) {
+  const uint32_t num_words = std::min(words.size(), ids.size());
+
+  // Words are stored in id order, so that LookupWord is an index (dense ids)
+  // or a binary search (sparse ids). The sort is stable so that the relative
+  // order of duplicated words is kept.
+  std::vector<uint32_t> order(num_words);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&ids](uint32_t a, uint32_t b) { return ids[a] < ids[b]; });
+  bool dense_ids = true;
+  for (uint32_t position = 0; position < num_words; ++position) {
+    dense_ids &= ids[order[position]] == static_cast<int>(position);
+  }
+
+  uint32_t num_slots = 1;
+  while (num_slots < 2 * num_words) {
+    num_slots <<= 1;
+  }
+  const uint32_t slot_mask = num_slots - 1;
+  std::vector<uint32_t> slots(num_slots, 0);
+  // Insert in input order so that later duplicates overwrite earlier ones,
+  // matching the behavior of the hash-map based vocabularies.
+  std::vector<uint32_t> position_of(num_words);
+  for (uint32_t position = 0; position < num_words; ++position) {
+    position_of[order[position]] = position;
+  }
+  for (uint32_t index = 0; index < num_words; ++index) {
+    const std::string& word = words[index];
+    uint32_t slot = Hash(word) & slot_mask;
+    while (slots[slot] != 0 && words[order[slots[slot] - 1]] != word) {
+      slot = (slot + 1) & slot_mask;
+    }
+    slots[slot] = position_of[index] + 1;
+  }
+
+  std::string string_data;
+  std::vector<uint32_t> offsets;
+  offsets.reserve(num_words + 1);
+  for (uint32_t position = 0; position < num_words; ++position) {
+    offsets.push_back(string_data.size());
+    string_data.append(words[order[position]]);
+  }
+  offsets.push_back(string_data.size());
+
+  std::string output;
+  output.reserve((kHeaderWords + 2 * num_words + 1 + num_slots) *
+                     sizeof(uint32_t) +
+                 string_data.size());
+  Append32(kMagic, &output);
+  Append32(kVersion, &output);
+  Append32(num_words, &output);
+  Append32(num_slots, &output);
+  Append32(dense_ids ? kDenseIdsFlag : 0, &output);
+  Append32(string_data.size(), &output);
+  for (uint32_t position = 0; position < num_words; ++position) {
+    Append32(static_cast<uint32_t>(ids[order[position]]), &output);
+  }
+  for (uint32_t offset : offsets) {
+    Append32(offset, &output);
+  }
+  for (uint32_t slot : slots) {
+    Append32(slot, &output);
+  }
+  output.append(string_data);
+  return output;
+}
+
+std::string BuildCompiledVocabFromText(absl::string_view text_vocab,
+                                       bool with_ids) {
+  if (!with_ids) {
+    return BuildCompiledVocab(
+        utils::LoadVocabFromBuffer(text_vocab.data(), text_vocab.size()));
+  }
+  std::vector<std::string> words;
+  std::vector<int> ids;
+  for (const auto& entry : utils::LoadVocabAndIndexFromBuffer(
+           text_vocab.data(), text_vocab.size())) {
+    words.push_back(entry.first);
+    ids.push_back(entry.second);
+  }
+  return BuildCompiledVocab(words, ids);
+}
+
+}  // namespace tokenizer
+}  // namespace text
+}  // namespace support
+}  // namespace tflite
@@ -0,0 +1,113 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CC_TEXT_TOKENIZERS_COMPILED_VOCAB_H_
+#define TENSORFLOW_LITE_SUPPORT_CC_TEXT_TOKENIZERS_COMPILED_VOCAB_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/statusor.h"
+
+namespace tflite {
+namespace support {
+namespace text {
+namespace tokenizer {
+
+// A prebuilt vocabulary, which is looked up in place in its buffer.
+//
+// The buffer is a sequence of little-endian uint32 words, followed by the raw
+// bytes of all the words:
+//
+//   header:  magic, version, num_words, num_slots, flags, string_data_size
+//   ids:     num_words ids, sorted in ascending order
+//   offsets: num_words + 1 offsets of each word in the string data
+//   slots:   num_slots open-addressing hash slots; each holds the position of
+//            a word plus one, or 0 if the slot is empty
+//   string data
+//
+// Creating a CompiledVocab only validates the header and keeps a view on the
+// buffer, so that tokenizers are constructed in constant time, without parsing
+// nor copying the words. Offsets and slots are bounds-checked on lookup
+// instead. Several CompiledVocab objects may view the same buffer, e.g. a
+// mmapped file, but the buffer itself is owned by the caller: a vocabulary
+// stored as a model associated file is read in place from the model buffer if
+// the file is stored uncompressed, and from the copy decompressed by each
+// ModelMetadataExtractor otherwise.
+//
+// Text vocabulary files can be compiled with BuildCompiledVocabFromText, or
+// with the `compile_vocab` tool in examples/task/text/desktop.
+class CompiledVocab {
+ public:
+  // Returns whether `buffer` starts with the compiled vocabulary magic number.
+  static bool IsCompiledVocab(absl::string_view buffer);
+
+  // Creates a vocabulary view on top of `buffer`, which is not copied and must
+  // outlive the returned object. There are no alignment requirements.
+  static tflite::support::StatusOr<std::unique_ptr<CompiledVocab>>
+  CreateFromBuffer(absl::string_view buffer);
+
+  // Finds the id of a word.
+  bool LookupId(absl::string_view key, int* result) const;
+
+  // Finds the word from an id.
+  bool LookupWord(int vocab_id, absl::string_view* result) const;
+
+  // Returns the number of words in the vocabulary.
+  int VocabularySize() const { return num_words_; }
+
+ private:
+  CompiledVocab() = default;
+
+  // Returns the word stored at `position`, or false if the offsets are
+  // corrupted.
+  bool WordAt(uint32_t position, absl::string_view* result) const;
+
+  const char* ids_ = nullptr;
+  const char* offsets_ = nullptr;
+  const char* slots_ = nullptr;
+  const char* string_data_ = nullptr;
+  uint32_t num_words_ = 0;
+  uint32_t slot_mask_ = 0;
+  uint32_t string_data_size_ = 0;
+  bool dense_ids_ = false;
+};
+
+// Builds a compiled vocabulary where the id of each word is its index in
+// `vocab`, e.g. from the result of utils::LoadVocabFromBuffer.
+std::string BuildCompiledVocab(const std::vector<std::string>& vocab);
+
+// Builds a compiled vocabulary from parallel vectors of words and ids, e.g.
+// from the result of utils::LoadVocabAndIndexFromBuffer. If a word occurs more
+// than once, the last occurrence determines its id.
+std::string BuildCompiledVocab(const std::vector<std::string>& words,
+                               const std::vector<int>& ids);
+
+// Builds a compiled vocabulary from the contents of a text vocabulary file. If
+// `with_ids` is false, the file has one word per line, whose id is its line
+// number, as read by BertTokenizer. Otherwise, each line holds a word and its
+// id separated by a space, as read by RegexTokenizer.
+std::string BuildCompiledVocabFromText(absl::string_view text_vocab,
+                                       bool with_ids);
+
+}  // namespace tokenizer
+}  // namespace text
+}  // namespace support
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CC_TEXT_TOKENIZERS_COMPILED_VOCAB_H_
@@ -60,6 +60,11 @@ RegexTokenizer::RegexTokenizer(const std::string& regex_pattern,
   buildIndexTokenMap(token_index_map_, &index_token_map_);
 }
 
+RegexTokenizer::RegexTokenizer(const std::string& regex_pattern,
+                               std::unique_ptr<CompiledVocab> vocab)
+    : delim_re_{absl::Substitute("($0)", regex_pattern)},
+      compiled_vocab_{std::move(vocab)} {}
+
 TokenizerResult RegexTokenizer::Tokenize(const std::string& input) {
   absl::string_view leftover(input.data());
   absl::string_view last_end = leftover;
@@ -90,6 +95,9 @@ TokenizerResult RegexTokenizer::Tokenize(const std::string& input) {
 }
 
 bool RegexTokenizer::LookupId(absl::string_view key, int* result) const {
+  if (compiled_vocab_ != nullptr) {
+    return compiled_vocab_->LookupId(key, result);
+  }
   auto it = token_index_map_.find(key);
   if (it == token_index_map_.end()) {
     return false;
@@ -99,6 +107,9 @@ bool RegexTokenizer::LookupId(absl::string_view key, int* result) const {
 }
 
 bool RegexTokenizer::LookupWord(int vocab_id, absl::string_view* result) const {
+  if (compiled_vocab_ != nullptr) {
+    return compiled_vocab_->LookupWord(vocab_id, result);
+  }
   auto it = index_token_map_.find(vocab_id);
   if (it == index_token_map_.end()) {
     return false;
@@ -16,8 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_SUPPORT_CC_TEXT_TOKENIZERS_REGEX_TOKENIZER_H_
 #define TENSORFLOW_LITE_SUPPORT_CC_TEXT_TOKENIZERS_REGEX_TOKENIZER_H_
 
+#include <memory>
+
 #include "absl/container/node_hash_map.h"  // from @com_google_absl
 #include "re2/re2.h"
+#include "tensorflow_lite_support/cc/text/tokenizers/compiled_vocab.h"
 #include "tensorflow_lite_support/cc/text/tokenizers/tokenizer.h"
 
 namespace tflite {
@@ -35,6 +38,11 @@ class RegexTokenizer : public Tokenizer {
                           const char* vocab_buffer_data,
                           size_t vocab_buffer_size);
 
+  // Creates the tokenizer from a compiled vocabulary (see BuildCompiledVocab).
+  // The buffer backing `vocab` must outlive the tokenizer.
+  explicit RegexTokenizer(const std::string& regex_pattern,
+                          std::unique_ptr<CompiledVocab> vocab);
+
   TokenizerResult Tokenize(const std::string& input) override;
 
   bool LookupId(absl::string_view key, int* result) const override;
@@ -49,6 +57,8 @@ class RegexTokenizer : public Tokenizer {
   RE2 delim_re_;
   absl::node_hash_map<std::string, int> token_index_map_;
   absl::node_hash_map<int, absl::string_view> index_token_map_;
+  // If set, used for lookups instead of the maps above, which are left empty.
+  std::unique_ptr<CompiledVocab> compiled_vocab_;
 };
 
 }  // namespace tokenizer
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow_lite_support/cc/common.h"
 #include "tensorflow_lite_support/cc/port/status_macros.h"
 #include "tensorflow_lite_support/cc/text/tokenizers/bert_tokenizer.h"
+#include "tensorflow_lite_support/cc/text/tokenizers/compiled_vocab.h"
 #include "tensorflow_lite_support/cc/text/tokenizers/regex_tokenizer.h"
 #include "tensorflow_lite_support/cc/text/tokenizers/sentencepiece_tokenizer.h"
 #include "tensorflow_lite_support/metadata/metadata_schema_generated.h"
@@ -70,6 +71,11 @@ StatusOr<std::unique_ptr<Tokenizer>> CreateTokenizerFromProcessUnit(
       ASSIGN_OR_RETURN(absl::string_view vocab_buffer,
                        CheckAndLoadFirstAssociatedFile(options->vocab_file(),
                                                        metadata_extractor));
+      if (CompiledVocab::IsCompiledVocab(vocab_buffer)) {
+        ASSIGN_OR_RETURN(std::unique_ptr<CompiledVocab> vocab,
+                         CompiledVocab::CreateFromBuffer(vocab_buffer));
+        return absl::make_unique<BertTokenizer>(std::move(vocab));
+      }
       return absl::make_unique<BertTokenizer>(vocab_buffer.data(),
                                               vocab_buffer.size());
     }
@@ -96,10 +102,17 @@ StatusOr<std::unique_ptr<Tokenizer>> CreateTokenizerFromProcessUnit(
             TfLiteSupportStatus::kMetadataInvalidTokenizerError);
       }
 
-      std::unique_ptr<RegexTokenizer> regex_tokenizer =
-          absl::make_unique<RegexTokenizer>(
-              options->delim_regex_pattern()->str(), vocab_buffer.data(),
-              vocab_buffer.size());
+      std::unique_ptr<RegexTokenizer> regex_tokenizer;
+      if (CompiledVocab::IsCompiledVocab(vocab_buffer)) {
+        ASSIGN_OR_RETURN(std::unique_ptr<CompiledVocab> vocab,
+                         CompiledVocab::CreateFromBuffer(vocab_buffer));
+        regex_tokenizer = absl::make_unique<RegexTokenizer>(
+            options->delim_regex_pattern()->str(), std::move(vocab));
+      } else {
+        regex_tokenizer = absl::make_unique<RegexTokenizer>(
+            options->delim_regex_pattern()->str(), vocab_buffer.data(),
+            vocab_buffer.size());
+      }
 
       int unknown_token_id = 0;
       if (!regex_tokenizer->GetUnknownToken(&unknown_token_id)) {
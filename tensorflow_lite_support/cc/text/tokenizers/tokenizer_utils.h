@@ -28,6 +28,10 @@ namespace tokenizer {
 
 
 // Create a Tokenizer from model metadata by extracting
+//
+// Vocabulary files that were compiled with BuildCompiledVocab are looked up in
+// place in the buffer returned by `metadata_extractor`, so the returned
+// tokenizer must not outlive it.
 tflite::support::StatusOr<std::unique_ptr<Tokenizer>>
 CreateTokenizerFromProcessUnit(
     const tflite::ProcessUnit* tokenizer_process_unit,
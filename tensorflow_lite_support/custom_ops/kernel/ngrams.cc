@@ -15,10 +15,14 @@ limitations under the License.
 
 #include "tensorflow_lite_support/custom_ops/kernel/ngrams.h"
 
+#include <cstdint>
+#include <cstring>
+
 #include "flatbuffers/flexbuffers.h"  // from @flatbuffers
 #include "tensorflow/lite/context.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/string_util.h"
+#include "tensorflow_lite_support/custom_ops/kernel/string_tensor_writer.h"
 
 namespace tflite {
 namespace ops {
@@ -86,6 +90,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   TF_LITE_ENSURE(context, attributes.reduction_type == kStringJoin);
   TF_LITE_ENSURE(context, attributes.axis == -1);
+  TF_LITE_ENSURE(context, attributes.width > 0);
 
   TfLiteTensor* output_values = GetOutput(context, node, kValues);
   if (OutputIsTensor(node)) {
@@ -118,81 +123,140 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   return kTfLiteOk;
 }
 
+// Returns the token length of an input string.
+inline int64_t TokenLength(const TfLiteTensor* input_values, int64_t index) {
+  return GetString(input_values, index).len;
+}
+
+// Joins the n-grams of each row of `input_values` into `output_values`. Row
+// `i` spans the tokens [row_start(i), row_start(i + 1)). If
+// `output_row_splits` is not null, the n-gram row_splits are written to it.
+// The output gets the shape `output_dims`, or is a vector if it is null.
+//
+// The input string tensor already stores the offsets of all tokens, so the
+// sliding window is just the range [j - width + 1, j] of token indices: it
+// needs no storage of its own and shifts in constant time. A first pass sizes
+// the output with a running sum of the window's token lengths, and a second
+// pass copies every n-gram into its final place in the output tensor.
+template <typename RowStartFn>
+TfLiteStatus WriteNgrams(TfLiteContext* context,
+                         const NgramsAttributes& attributes,
+                         const TfLiteTensor* input_values, int64_t num_rows,
+                         RowStartFn row_start, int64_t* output_row_splits,
+                         TfLiteTensor* output_values,
+                         const TfLiteIntArray* output_dims) {
+  const int width = attributes.width;
+  const char* separator = attributes.string_separator.data();
+  const int separator_length = attributes.string_separator.length();
+  const int64_t separators_length =
+      static_cast<int64_t>(separator_length) * (width - 1);
+
+  int64_t num_ngrams = 0;
+  int64_t data_size = 0;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    if (output_row_splits != nullptr) {
+      output_row_splits[i] = num_ngrams;
+    }
+    const int64_t begin = row_start(i);
+    const int64_t end = row_start(i + 1);
+    int64_t window_length = 0;
+    for (int64_t j = begin; j < end; ++j) {
+      window_length += TokenLength(input_values, j);
+      if (j - begin >= width) {
+        window_length -= TokenLength(input_values, j - width);
+      }
+      if (j - begin + 1 >= width) {
+        ++num_ngrams;
+        data_size += window_length + separators_length;
+      }
+    }
+  }
+  if (output_row_splits != nullptr) {
+    output_row_splits[num_rows] = num_ngrams;
+  }
+  TF_LITE_ENSURE(context, StringTensorSizeFits(num_ngrams, data_size));
+
+  StringTensorWriter writer(num_ngrams, data_size);
+  TF_LITE_ENSURE(context, writer.ok());
+  for (int64_t i = 0; i < num_rows; ++i) {
+    const int64_t begin = row_start(i);
+    const int64_t end = row_start(i + 1);
+    int64_t window_length = 0;
+    for (int64_t j = begin; j < end; ++j) {
+      window_length += TokenLength(input_values, j);
+      if (j - begin >= width) {
+        window_length -= TokenLength(input_values, j - width);
+      }
+      if (j - begin + 1 < width) continue;
+
+      char* data =
+          writer.AddUninitializedString(window_length + separators_length);
+      for (int64_t k = j - width + 1; k <= j; ++k) {
+        if (k != j - width + 1) {
+          memcpy(data, separator, separator_length);
+          data += separator_length;
+        }
+        const StringRef token = GetString(input_values, k);
+        memcpy(data, token.str, token.len);
+        data += token.len;
+      }
+    }
+  }
+
+  TfLiteIntArray* output_shape;
+  if (output_dims != nullptr) {
+    output_shape = TfLiteIntArrayCopy(output_dims);
+  } else {
+    output_shape = TfLiteIntArrayCreate(1);
+    output_shape->data[0] = num_ngrams;
+  }
+  writer.WriteToTensor(output_values, output_shape);
+  return kTfLiteOk;
+}
+
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const auto& attributes =
       *reinterpret_cast<NgramsAttributes*>(node->user_data);
 
-  // Storage for the dummy input and output row_splits used in the tensor case.
-  std::vector<int64_t> tensor_input_row_splits;
-  std::vector<int64_t> tensor_output_row_splits;
-
-  const int64_t* input_row_splits;
-  int64_t* output_row_splits;
-  int n_row_splits = 0;
-
   const TfLiteTensor* input_values = GetInput(context, node, kValues);
+  TfLiteTensor* output_values = GetOutput(context, node, kValues);
 
   if (OutputIsTensor(node)) {
-    // Generate mock input and output innermost row_splits.
-    int64_t total_tokens = NumElements(input_values);
-    int64_t tokens_per_element =
+    // Every row of the innermost dimension has the same number of tokens, and
+    // the output keeps the shape computed in Prepare.
+    const int64_t tokens_per_row =
         SizeOfDimension(input_values, NumDimensions(input_values) - 1);
-    tensor_input_row_splits.reserve(total_tokens / tokens_per_element + 1);
-    tensor_output_row_splits.resize(total_tokens / tokens_per_element + 1);
-    for (int64_t i = 0; i <= total_tokens; i += tokens_per_element) {
-      tensor_input_row_splits.push_back(i);
-    }
-    input_row_splits = tensor_input_row_splits.data();
-    output_row_splits = tensor_output_row_splits.data();
-    n_row_splits = tensor_input_row_splits.size();
-  } else {
-    int index = 0;
-    while (index < NumRowSplits(node) - 1) {
-      const TfLiteTensor* input_tensor_row_splits =
-          GetInput(context, node, kRowSplitsStart + index);
-      TfLiteTensor* output_tensor_row_splits =
-          GetOutput(context, node, kRowSplitsStart + index);
-      memcpy(output_tensor_row_splits->data.raw,
-             input_tensor_row_splits->data.raw, input_tensor_row_splits->bytes);
-      ++index;
-    }
+    const int64_t num_rows =
+        tokens_per_row == 0 ? 0 : NumElements(input_values) / tokens_per_row;
+    return WriteNgrams(
+        context, attributes, input_values, num_rows,
+        [tokens_per_row](int64_t i) { return i * tokens_per_row; },
+        /*output_row_splits=*/nullptr, output_values, output_values->dims);
+  }
 
+  int index = 0;
+  while (index < NumRowSplits(node) - 1) {
     const TfLiteTensor* input_tensor_row_splits =
         GetInput(context, node, kRowSplitsStart + index);
     TfLiteTensor* output_tensor_row_splits =
         GetOutput(context, node, kRowSplitsStart + index);
-    input_row_splits = input_tensor_row_splits->data.i64;
-    output_row_splits = output_tensor_row_splits->data.i64;
-    n_row_splits = SizeOfDimension(input_tensor_row_splits, 0);
+    memcpy(output_tensor_row_splits->data.raw,
+           input_tensor_row_splits->data.raw, input_tensor_row_splits->bytes);
+    ++index;
   }
 
-  DynamicBuffer buffer;
-  StringRef separator;
-  separator.str = attributes.string_separator.c_str();
-  separator.len = attributes.string_separator.length();
-  int buffer_index = 0;
-  for (int i = 0; i < n_row_splits - 1; ++i) {
-    output_row_splits[i] = buffer_index;
-    std::vector<StringRef> tokens;
-    for (int j = input_row_splits[i]; j < input_row_splits[i + 1]; ++j) {
-      tokens.emplace_back(GetString(input_values, j));
-      if (tokens.size() < attributes.width) continue;
-      tokens.erase(tokens.begin(),
-                   tokens.begin() + tokens.size() - attributes.width);
-      buffer.AddJoinedString(tokens, separator);
-      ++buffer_index;
-    }
-  }
-  output_row_splits[n_row_splits - 1] = buffer_index;
-
-  TfLiteTensor* output_values = GetOutput(context, node, kValues);
-  if (OutputIsTensor(node)) {
-    buffer.WriteToTensor(output_values, /*new_shape=*/nullptr);
-  } else {
-    buffer.WriteToTensorAsVector(output_values);
-  }
-
-  return kTfLiteOk;
+  const TfLiteTensor* input_tensor_row_splits =
+      GetInput(context, node, kRowSplitsStart + index);
+  TfLiteTensor* output_tensor_row_splits =
+      GetOutput(context, node, kRowSplitsStart + index);
+  TF_LITE_ENSURE(context, SizeOfDimension(input_tensor_row_splits, 0) > 0);
+  const int64_t* input_row_splits = input_tensor_row_splits->data.i64;
+  return WriteNgrams(
+      context, attributes, input_values,
+      SizeOfDimension(input_tensor_row_splits, 0) - 1,
+      [input_row_splits](int64_t i) { return input_row_splits[i]; },
+      output_tensor_row_splits->data.i64, output_values,
+      /*output_dims=*/nullptr);
 }
 
 }  // namespace ngrams
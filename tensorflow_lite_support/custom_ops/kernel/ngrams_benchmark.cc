@@ -0,0 +1,100 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Throughput benchmarks of the tftext:Ngrams op on large batches, for ngram
+// widths 2 to 5.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/string_util.h"
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/custom_ops/kernel/ngrams.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace ngrams {
+namespace {
+
+constexpr const char* kWords[] = {"the",   "quick", "brown", "fox",
+                                  "jumps", "over",  "a",     "lazy",
+                                  "dog",   "while", "it",    "sleeps"};
+
+class NgramsBenchmarkModel : public SingleOpModel {
+ public:
+  // Builds the op over a ragged batch of `num_rows` rows of `row_length`
+  // tokens each.
+  NgramsBenchmarkModel(int width, int num_rows, int row_length) {
+    input_values_ = AddInput(TensorType_STRING);
+    const int input_row_splits = AddInput(TensorType_INT64);
+    output_values_ = AddOutput(TensorType_STRING);
+    AddOutput(TensorType_INT64);
+
+    flexbuffers::Builder fbb;
+    size_t start_map = fbb.StartMap();
+    fbb.Int("width", width);
+    fbb.String("string_separator", " ");
+    fbb.Int("axis", -1);
+    fbb.String("reduction_type", "STRING_JOIN");
+    fbb.EndMap(start_map);
+    fbb.Finish();
+    SetCustomOp("tftext:Ngrams", fbb.GetBuffer(), Register_tftext_Ngrams);
+
+    BuildInterpreter({{num_rows * row_length}, {num_rows + 1}});
+
+    std::mt19937 rng(/*seed=*/42);
+    std::vector<std::string> tokens(num_rows * row_length);
+    for (std::string& token : tokens) {
+      token = kWords[rng() % (sizeof(kWords) / sizeof(kWords[0]))];
+    }
+    PopulateStringTensor(input_values_, tokens);
+    std::vector<int64_t> row_splits(num_rows + 1);
+    for (int i = 0; i <= num_rows; ++i) {
+      row_splits[i] = static_cast<int64_t>(i) * row_length;
+    }
+    PopulateTensor(input_row_splits, row_splits);
+  }
+
+  int64_t output_bytes() {
+    return interpreter_->tensor(output_values_)->bytes;
+  }
+
+ private:
+  int input_values_;
+  int output_values_;
+};
+
+void BM_Ngrams(benchmark::State& state) {
+  const int width = state.range(0);
+  const int row_length = state.range(1);
+  const int num_rows = (1 << 16) / row_length;
+  NgramsBenchmarkModel model(width, num_rows, row_length);
+  for (auto _ : state) {
+    model.Invoke();
+  }
+  state.SetItemsProcessed(state.iterations() * num_rows * row_length);
+  state.SetBytesProcessed(state.iterations() * model.output_bytes());
+}
+BENCHMARK(BM_Ngrams)->ArgsProduct({{2, 3, 4, 5}, {8, 64, 512}});
+
+}  // namespace
+}  // namespace ngrams
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
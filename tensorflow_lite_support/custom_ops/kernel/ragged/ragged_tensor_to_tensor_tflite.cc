@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 
 #include "flatbuffers/flexbuffers.h"  // from @flatbuffers
@@ -46,6 +48,12 @@ struct ConversionAttributes {
   std::vector<tensorflow::RowPartitionType> partition_types;
   int ragged_rank = 0;
 
+  // Scratch buffers for Eval. They live as long as the node, so that their
+  // capacity is reused instead of being reallocated on every invocation.
+  std::vector<int> multiplier;
+  std::vector<int> output_index;
+  std::vector<int> new_output_index;
+
   tensorflow::RowPartitionType GetRowPartitionTypeByDimension(
       int dimension) const {
     if (partition_types.front() ==
@@ -274,6 +282,18 @@ RuntimeShape CalculateOutputSize(
   return result_shape;
 }
 
+bool ShapeEquals(const TfLiteIntArray* dims, const RuntimeShape& shape) {
+  if (dims == nullptr || dims->size != shape.DimensionsCount()) {
+    return false;
+  }
+  for (int i = 0; i < dims->size; ++i) {
+    if (dims->data[i] != shape.Dims(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 TfLiteIntArray* IntArrayFromShape(const RuntimeShape& shape) {
   TfLiteIntArray* result = TfLiteIntArrayCreate(shape.DimensionsCount());
   for (int i = 0; i < shape.DimensionsCount(); ++i) {
@@ -545,6 +565,102 @@ void SetOutput(TfLiteContext* context, int ragged_rank,
   }
 }
 
+// Fast path for ragged_rank = 1 with ROW_SPLITS partitioning: each output row
+// is the (possibly truncated) slice values[row_splits[i]:row_splits[i + 1]]
+// followed by padding, so rows are copied directly without computing a
+// per-value output index.
+template <typename VALUE_TYPE, typename INDEX_TYPE>
+TfLiteStatus SetOutputFromRowSplitsT(TfLiteContext* context,
+                                     const TfLiteTensor& row_splits_tensor,
+                                     const TfLiteTensor& values_tensor,
+                                     const TfLiteTensor& default_value_tensor,
+                                     TfLiteTensor* output_tensor) {
+  const INDEX_TYPE* row_splits = GetTensorData<INDEX_TYPE>(&row_splits_tensor);
+  const int num_splits = NumElements(&row_splits_tensor);
+  const VALUE_TYPE* values_base = GetTensorData<VALUE_TYPE>(&values_tensor);
+  const int64_t num_values = values_tensor.dims->data[0];
+  VALUE_TYPE* output_base = GetTensorData<VALUE_TYPE>(output_tensor);
+  const VALUE_TYPE default_value =
+      *GetTensorData<VALUE_TYPE>(&default_value_tensor);
+
+  const RuntimeShape output_shape = GetTensorShape(output_tensor);
+  const int num_rows = output_shape.Dims(0);
+  const int width = output_shape.Dims(1);
+  const int value_element_size =
+      RuntimeShape(output_shape.DimensionsCount() - 2,
+                   output_shape.DimsData() + 2)
+          .FlatSize();
+  const int output_row_size = width * value_element_size;
+
+  for (int row = 0; row < num_rows; ++row) {
+    VALUE_TYPE* dst = output_base + row * output_row_size;
+    int copied = 0;
+    if (row + 1 < num_splits) {
+      const int64_t begin = row_splits[row];
+      const int64_t row_length = row_splits[row + 1] - begin;
+      const int64_t real_length =
+          std::max<int64_t>(0, std::min<int64_t>(width, row_length));
+      if (begin < 0 || begin + real_length > num_values) {
+        context->ReportError(context, "Row splits are out of range");
+        return kTfLiteError;
+      }
+      copied = real_length * value_element_size;
+      std::memcpy(dst, values_base + begin * value_element_size,
+                  copied * sizeof(VALUE_TYPE));
+    }
+    std::fill(dst + copied, dst + output_row_size, default_value);
+  }
+  return kTfLiteOk;
+}
+
+template <typename VALUE_TYPE>
+TfLiteStatus SetOutputFromRowSplits(TfLiteContext* context,
+                                    const TfLiteTensor& row_splits_tensor,
+                                    const TfLiteTensor& values_tensor,
+                                    const TfLiteTensor& default_value_tensor,
+                                    TfLiteTensor* output_tensor) {
+  switch (row_splits_tensor.type) {
+    case kTfLiteInt32:
+      return SetOutputFromRowSplitsT<VALUE_TYPE, int32_t>(
+          context, row_splits_tensor, values_tensor, default_value_tensor,
+          output_tensor);
+    case kTfLiteInt64:
+      return SetOutputFromRowSplitsT<VALUE_TYPE, int64_t>(
+          context, row_splits_tensor, values_tensor, default_value_tensor,
+          output_tensor);
+    default:
+      context->ReportError(context,
+                           "Not supported row partitioning tensor type");
+      return kTfLiteError;
+  }
+}
+
+TfLiteStatus SetOutputFromRowSplits(TfLiteContext* context,
+                                    const TfLiteTensor& row_splits_tensor,
+                                    const TfLiteTensor& values_tensor,
+                                    const TfLiteTensor& default_value_tensor,
+                                    TfLiteTensor* output_tensor) {
+  switch (output_tensor->type) {
+    case kTfLiteInt32:
+      return SetOutputFromRowSplits<int32_t>(context, row_splits_tensor,
+                                             values_tensor,
+                                             default_value_tensor,
+                                             output_tensor);
+    case kTfLiteInt64:
+      return SetOutputFromRowSplits<int64_t>(context, row_splits_tensor,
+                                             values_tensor,
+                                             default_value_tensor,
+                                             output_tensor);
+    case kTfLiteFloat32:
+      return SetOutputFromRowSplits<float>(context, row_splits_tensor,
+                                           values_tensor, default_value_tensor,
+                                           output_tensor);
+    default:
+      context->ReportError(context, "Not supported values type");
+      return kTfLiteError;
+  }
+}
+
 }  // namespace
 
 void* Initialize(TfLiteContext* context, const char* buffer, size_t length) {
@@ -605,7 +721,7 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 }
 
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
-  const ConversionAttributes* attributes =
+  ConversionAttributes* attributes =
       reinterpret_cast<ConversionAttributes*>(node->user_data);
   TfLiteTensor& input_shape = context->tensors[node->inputs->data[kShapeInput]];
   TfLiteTensor& input_values =
@@ -634,25 +750,42 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     return kTfLiteError;
   }
 
-  std::vector<int> multiplier;
+  std::vector<int>& multiplier = attributes->multiplier;
   multiplier.resize(attributes->ragged_rank + 1);
   multiplier.back() = 1;
   for (int i = multiplier.size() - 2; i >= 0; --i) {
     multiplier[i] = multiplier[i + 1] * output_shape.Dims(i + 1);
   }
 
-  // Allocate output tensor.
+  // Allocate output tensor. A dynamic tensor keeps its buffer between
+  // invocations, so it only needs to be resized when the shape changes.
   TfLiteTensor& output_tensor =
       context->tensors[node->outputs->data[kOutputTensor]];
-
-  TF_LITE_ENSURE_OK(context,
-                    context->ResizeTensor(context, &output_tensor,
-                                          IntArrayFromShape(output_shape)));
+  if (output_tensor.data.raw == nullptr ||
+      !ShapeEquals(output_tensor.dims, output_shape)) {
+    TF_LITE_ENSURE_OK(context,
+                      context->ResizeTensor(context, &output_tensor,
+                                            IntArrayFromShape(output_shape)));
+  }
 
   // Copy data.
   const int full_size = multiplier.front() * output_shape.Dims(0);
   if (full_size > 0) {
-    std::vector<int> output_index, new_output_index;
+    if (attributes->ragged_rank == 1 &&
+        attributes->GetRowPartitionTypeByDimension(0) ==
+            tensorflow::RowPartitionType::ROW_SPLITS) {
+      const TfLiteTensor* row_splits =
+          GetRowPartitionTensor(*attributes, context, node, 0);
+      if (NumElements(row_splits) == first_dimension + 1) {
+        return SetOutputFromRowSplits(context, *row_splits, input_values,
+                                      default_value, &output_tensor);
+      }
+    }
+
+    std::vector<int>& output_index = attributes->output_index;
+    std::vector<int>& new_output_index = attributes->new_output_index;
+    output_index.clear();
+    new_output_index.clear();
     int nvals = input_values.dims->data[0];
     output_index.reserve(nvals);
     new_output_index.reserve(nvals);
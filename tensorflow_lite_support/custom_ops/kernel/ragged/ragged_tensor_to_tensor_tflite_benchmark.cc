@@ -0,0 +1,105 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Throughput benchmarks of the RaggedTensorToTensor op densifying batches of
+// token ids, as done after tokenization, for several batch sizes and maximum
+// row lengths.
+//
+// The rows have random lengths up to the maximum length, and the processed
+// bytes are the bytes of the dense output.
+
+#include <random>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+TfLiteRegistration* Register_RAGGED_TENSOR_TO_TENSOR();
+}  // namespace custom
+}  // namespace ops
+
+namespace {
+
+class RaggedTensorToTensorBenchmarkModel : public SingleOpModel {
+ public:
+  // Builds the op over `num_rows` rows of int32 ids, partitioned by row
+  // splits, into a [num_rows, max_length] tensor.
+  RaggedTensorToTensorBenchmarkModel(int num_rows, int max_length) {
+    std::mt19937 rng(/*seed=*/42);
+    std::vector<int> row_splits(num_rows + 1);
+    for (int i = 0; i < num_rows; ++i) {
+      row_splits[i + 1] = row_splits[i] + 1 + rng() % max_length;
+    }
+    num_values_ = row_splits.back();
+
+    const int input_shape = AddInput(TensorType_INT32);
+    const int input_values = AddInput(TensorType_INT32);
+    const int input_default_value = AddInput(TensorType_INT32);
+    const int input_row_splits = AddInput(TensorType_INT32);
+    output_ = AddOutput(TensorType_INT32);
+
+    flexbuffers::Builder fbb;
+    size_t start = fbb.StartMap();
+    {
+      size_t start = fbb.StartVector("row_partition_types");
+      fbb.String("ROW_SPLITS");
+      fbb.EndVector(start, /*typed=*/true, /*fixed=*/false);
+    }
+    fbb.Int("num_row_partition_tensors", 1);
+    fbb.EndMap(start);
+    fbb.Finish();
+    SetCustomOp("RaggedTensorToTensor", fbb.GetBuffer(),
+                ops::custom::Register_RAGGED_TENSOR_TO_TENSOR);
+    BuildInterpreter({{2}, {num_values_}, {1}, {num_rows + 1}});
+
+    std::vector<int> values(num_values_);
+    for (int& value : values) {
+      value = rng() % 30522;
+    }
+    PopulateTensor(input_shape, {num_rows, max_length});
+    PopulateTensor(input_values, values);
+    PopulateTensor(input_default_value, {0});
+    PopulateTensor(input_row_splits, row_splits);
+  }
+
+  int num_values() const { return num_values_; }
+
+  int64_t output_bytes() { return interpreter_->tensor(output_)->bytes; }
+
+ private:
+  int num_values_;
+  int output_;
+};
+
+void BM_RaggedTensorToTensor(benchmark::State& state) {
+  const int num_rows = state.range(0);
+  const int max_length = state.range(1);
+  RaggedTensorToTensorBenchmarkModel model(num_rows, max_length);
+  for (auto _ : state) {
+    model.Invoke();
+  }
+  state.SetItemsProcessed(state.iterations() * model.num_values());
+  state.SetBytesProcessed(state.iterations() * model.output_bytes());
+}
+BENCHMARK(BM_RaggedTensorToTensor)
+    ->ArgNames({"rows", "max_length"})
+    ->ArgsProduct({{1, 64, 1024}, {16, 128, 512}});
+
+}  // namespace
+}  // namespace tflite
@@ -151,6 +151,46 @@ TEST(RaggedTensorToTensorTest, RaggedTensorToTensorRowSplits) {
                                          .4, .5, .6, .7, .8, .9, 1.5, 1.5}));
 }
 
+TEST(RaggedTensorToTensorTest, RaggedTensorToTensorRowSplitsRepeatedInvoke) {
+  RaggedTensorToTensorOpModel model(2,      // output_shape_dims
+                                    {9},    // values_shape
+                                    {{5}},  // partition_tensors_shapes
+                                    std::vector<std::string>({"ROW_SPLITS"}));
+  // params = [[.1, .2, .3], [], [.4, .5, .6, .7], [.8, .9]], truncated.
+  model.InvokeFloat(
+      {4, 2},                                // shape
+      {.1, .2, .3, .4, .5, .6, .7, .8, .9},  // values
+      1.5,                                   // default_value
+      std::vector<std::vector<int>>({std::vector<int>({0, 3, 3, 7, 9})}));
+  EXPECT_THAT(model.GetOutputShape(), testing::ElementsAreArray({4, 2}));
+  EXPECT_THAT(model.GetOutputFloat(),
+              testing::ElementsAreArray({.1, .2, 1.5, 1.5, .4, .5, .8, .9}));
+
+  // Same output shape, different rows: stale values must be overwritten.
+  // params = [[], [.1], [.2, .3, .4, .5, .6], [.7, .8, .9]]
+  model.InvokeFloat(
+      {4, 2},                                // shape
+      {.1, .2, .3, .4, .5, .6, .7, .8, .9},  // values
+      0.,                                    // default_value
+      std::vector<std::vector<int>>({std::vector<int>({0, 0, 1, 6, 9})}));
+  EXPECT_THAT(model.GetOutputShape(), testing::ElementsAreArray({4, 2}));
+  EXPECT_THAT(model.GetOutputFloat(),
+              testing::ElementsAreArray({0., 0., .1, 0., .2, .3, .7, .8}));
+
+  // Inferred width, which changes the output shape.
+  model.InvokeFloat(
+      {-1, -1},                              // shape
+      {.1, .2, .3, .4, .5, .6, .7, .8, .9},  // values
+      0.,                                    // default_value
+      std::vector<std::vector<int>>({std::vector<int>({0, 0, 1, 6, 9})}));
+  EXPECT_THAT(model.GetOutputShape(), testing::ElementsAreArray({4, 5}));
+  EXPECT_THAT(model.GetOutputFloat(),
+              testing::ElementsAreArray({0., 0., 0., 0., 0.,    //
+                                         .1, 0., 0., 0., 0.,    //
+                                         .2, .3, .4, .5, .6,    //
+                                         .7, .8, .9, 0., 0.}));
+}
+
 TEST(RaggedTensorToTensorTest, RaggedTensorToTensor_3DParams) {
   // params = [
   //           [[]],
@@ -49,15 +49,31 @@ class DoubleArrayTrie {
     }
   };
 
-  // nodes and nodes_length specify the array of the nodes of the trie.
+  // nodes specify the array of the nodes of the trie.
   explicit DoubleArrayTrie(const flatbuffers::Vector<uint32_t>* nodes)
-      : nodes_(nodes) {}
+      : DoubleArrayTrie(nodes->data(), nodes->size()) {}
+
+  // nodes and nodes_length specify the array of the nodes of the trie. Like
+  // flatbuffers, the nodes are expected in little-endian byte order.
+  DoubleArrayTrie(const uint32_t* nodes, uint32_t nodes_length)
+      : nodes_(nodes), nodes_length_(nodes_length) {}
 
   // Finds matches that are prefixes of a string.
   template <typename callback>
   void IteratePrefixMatches(const utils::string_view& input,
                             callback update_fn) const;
 
+  // Finds the matches that are prefixes of every suffix of a string, in
+  // order of start position. This is equivalent to calling
+  // IteratePrefixMatches on each suffix, but the trie is set up once for the
+  // whole string. For each start position `i`, `start_fn(i)` is called first
+  // and the matches at `i` are only searched if it returns true; each match is
+  // then passed to `update_fn(i, match)`.
+  template <typename start_callback, typename callback>
+  void IteratePrefixMatchesAtEachPosition(const utils::string_view& input,
+                                          start_callback start_fn,
+                                          callback update_fn) const;
+
   // Finds the longest prefix match of a string.
   Match LongestPrefixMatch(const utils::string_view& input) const {
     Match match;
@@ -66,48 +82,102 @@ class DoubleArrayTrie {
   }
 
  private:
+  // The accessors below decode a node that has already been loaded, so that
+  // each node is read once per input byte.
+
   // Returns whether a node as a leaf as a child.
-  bool has_leaf(uint32_t i) const { return ((*nodes_)[i]) & 0x100; }
+  static bool has_leaf(uint32_t node) { return node & 0x100; }
 
   // Returns a value associated with a node. Available when a node is a leaf.
-  int value(uint32_t i) const {
-    return static_cast<int>(((*nodes_)[i]) & 0x7fffffff);
+  static int value(uint32_t node) {
+    return static_cast<int>(node & 0x7fffffff);
   }
 
   // Returns a label associated with a node.
   // A leaf node will have the MSB set and thus return an invalid label.
-  int32_t label(uint32_t i) const { return ((*nodes_)[i]) & 0x800000ff; }
+  static int32_t label(uint32_t node) { return node & 0x800000ff; }
 
   // Returns offset to children.
-  int32_t offset(uint32_t i) const {
-    const uint32_t node = (*nodes_)[i];
+  static int32_t offset(uint32_t node) {
     return (node >> 10) << ((node & 0x200) >> 6);
   }
 
-  const flatbuffers::Vector<uint32_t>* nodes_;
+  // Finds the matches of the trie made of `nodes_length` `nodes`, whose root
+  // children are at `root_offset`, that are prefixes of the `length` bytes at
+  // `data`.
+  template <typename callback>
+  static void IteratePrefixMatches(const uint32_t* nodes,
+                                   uint32_t nodes_length, uint32_t root_offset,
+                                   const char* data, int length,
+                                   callback update_fn);
+
+  const uint32_t* nodes_;
+  uint32_t nodes_length_;
 };
 
 template <typename callback>
 void DoubleArrayTrie::IteratePrefixMatches(const utils::string_view& input,
                                            callback update_fn) const {
-  if (nodes_->size() == 0) {
+  if (nodes_length_ == 0) {
+    return;
+  }
+  IteratePrefixMatches(nodes_, nodes_length_, offset(nodes_[0]), input.data(),
+                       input.length(), update_fn);
+}
+
+template <typename start_callback, typename callback>
+void DoubleArrayTrie::IteratePrefixMatchesAtEachPosition(
+    const utils::string_view& input, start_callback start_fn,
+    callback update_fn) const {
+  const char* const data = input.data();
+  const int length = input.length();
+  if (nodes_length_ == 0) {
+    for (int i = 0; i < length; ++i) {
+      start_fn(i);
+    }
     return;
   }
-  uint32_t pos = offset(0);
-  for (int i = 0; i < input.length(); ++i) {
-    pos ^= static_cast<unsigned char>(input.at(i));
-    if (pos < 0 || pos >= nodes_->size() || label(pos) != input.at(i)) {
+  const uint32_t* const nodes = nodes_;
+  const uint32_t nodes_length = nodes_length_;
+  const uint32_t root_offset = offset(nodes[0]);
+  for (int i = 0; i < length; ++i) {
+    if (!start_fn(i)) {
+      continue;
+    }
+    IteratePrefixMatches(
+        nodes, nodes_length, root_offset, data + i, length - i,
+        [&update_fn, i](const Match& match) { update_fn(i, match); });
+  }
+}
+
+template <typename callback>
+void DoubleArrayTrie::IteratePrefixMatches(const uint32_t* nodes,
+                                           uint32_t nodes_length,
+                                           uint32_t root_offset,
+                                           const char* data, int length,
+                                           callback update_fn) {
+  // Positions are bounds-checked once per transition against the cached
+  // length, and nodes are then read through the raw pointer.
+  uint32_t pos = root_offset;
+  for (int i = 0; i < length; ++i) {
+    const unsigned char c = static_cast<unsigned char>(data[i]);
+    pos ^= c;
+    if (pos >= nodes_length) {
+      // No match, exit.
+      return;
+    }
+    const uint32_t node = nodes[pos];
+    if (label(node) != c) {
       // No match, exit.
       return;
     }
-    const bool node_has_leaf = has_leaf(pos);
-    pos ^= offset(pos);
-    if (pos < 0 || pos >= nodes_->size()) {
+    pos ^= offset(node);
+    if (pos >= nodes_length) {
       // We can get here only if the structure is corrupted.
       return;
     }
-    if (node_has_leaf) {
-      update_fn(Match(value(pos), i + 1));
+    if (has_leaf(node)) {
+      update_fn(Match(value(nodes[pos]), i + 1));
     }
   }
 }
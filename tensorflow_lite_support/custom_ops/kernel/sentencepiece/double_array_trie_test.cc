@@ -72,6 +72,110 @@ TEST(DoubleArrayTrieTest, ComplexMatch) {
   EXPECT_THAT(matches, testing::ElementsAre(DoubleArrayTrie::Match(15, 8)));
 }
 
+TEST(DoubleArrayTrieTest, RawNodesMatchFlatbufferNodes) {
+  flatbuffers::FlatBufferBuilder builder(1024);
+  const std::vector<std::string> test_strings = {"\xe2\x96\x81the", ",", "s",
+                                                 "\xe2\x96\x81Hello", "A",
+                                                 "AAX", "AA", "B"};
+  const std::vector<uint32_t> nodes = BuildTrie(test_strings);
+  const auto trie_vector = builder.CreateVector(nodes);
+  TrieBuilder trie_builder(builder);
+  trie_builder.add_nodes(trie_vector);
+  const auto pieces = trie_builder.Finish();
+  EncoderConfigBuilder ecb(builder);
+  ecb.add_pieces(pieces);
+  FinishEncoderConfigBuffer(builder, ecb.Finish());
+  const EncoderConfig* config = GetEncoderConfig(builder.GetBufferPointer());
+  DoubleArrayTrie flatbuffer_dat(config->pieces()->nodes());
+  DoubleArrayTrie raw_dat(nodes.data(), nodes.size());
+
+  for (const std::string& input :
+       {std::string("AAXL"), std::string("\xe2\x96\x81Hello"),
+        std::string("\xe2\x96\x81th"), std::string("s,"), std::string("")}) {
+    std::vector<DoubleArrayTrie::Match> flatbuffer_matches;
+    flatbuffer_dat.IteratePrefixMatches(
+        utils::string_view(input),
+        [&flatbuffer_matches](const DoubleArrayTrie::Match& m) {
+          flatbuffer_matches.push_back(m);
+        });
+    std::vector<DoubleArrayTrie::Match> raw_matches;
+    raw_dat.IteratePrefixMatches(
+        utils::string_view(input),
+        [&raw_matches](const DoubleArrayTrie::Match& m) {
+          raw_matches.push_back(m);
+        });
+    EXPECT_EQ(raw_matches, flatbuffer_matches);
+  }
+  EXPECT_EQ(raw_dat.LongestPrefixMatch(utils::string_view("AAXL")),
+            DoubleArrayTrie::Match(5, 3));
+}
+
+TEST(DoubleArrayTrieTest, EachPositionMatchesEverySuffix) {
+  const std::vector<std::string> test_strings = {"\xe2\x96\x81the", ",", "s",
+                                                 "\xe2\x96\x81Hello", "A",
+                                                 "AAX", "AA", "B"};
+  const std::vector<uint32_t> nodes = BuildTrie(test_strings);
+  DoubleArrayTrie dat(nodes.data(), nodes.size());
+  const std::string input = "BAAXs,\xe2\x96\x81theAA";
+
+  const int length = input.size();
+  std::vector<std::pair<int, DoubleArrayTrie::Match>> expected;
+  for (int i = 0; i < length; ++i) {
+    dat.IteratePrefixMatches(
+        utils::string_view(input.data() + i, length - i),
+        [&expected, i](const DoubleArrayTrie::Match& m) {
+          expected.emplace_back(i, m);
+        });
+  }
+  std::vector<int> starts;
+  std::vector<std::pair<int, DoubleArrayTrie::Match>> matches;
+  dat.IteratePrefixMatchesAtEachPosition(
+      utils::string_view(input),
+      [&starts](int i) {
+        starts.push_back(i);
+        return true;
+      },
+      [&matches](int i, const DoubleArrayTrie::Match& m) {
+        matches.emplace_back(i, m);
+      });
+
+  EXPECT_EQ(starts.size(), input.size());
+  EXPECT_EQ(matches, expected);
+}
+
+TEST(DoubleArrayTrieTest, EachPositionSkipsRejectedStarts) {
+  const std::vector<uint32_t> nodes = BuildTrie({"A", "AA", "B"});
+  DoubleArrayTrie dat(nodes.data(), nodes.size());
+
+  std::vector<std::pair<int, DoubleArrayTrie::Match>> matches;
+  dat.IteratePrefixMatchesAtEachPosition(
+      utils::string_view("AAB"), [](int i) { return i != 1; },
+      [&matches](int i, const DoubleArrayTrie::Match& m) {
+        matches.emplace_back(i, m);
+      });
+
+  EXPECT_THAT(matches,
+              testing::ElementsAre(
+                  std::make_pair(0, DoubleArrayTrie::Match(0, 1)),
+                  std::make_pair(0, DoubleArrayTrie::Match(1, 2)),
+                  std::make_pair(2, DoubleArrayTrie::Match(2, 1))));
+}
+
+TEST(DoubleArrayTrieTest, EmptyTrieHasNoMatch) {
+  DoubleArrayTrie dat(nullptr, 0);
+  EXPECT_TRUE(dat.LongestPrefixMatch(utils::string_view("A")).empty());
+
+  int num_starts = 0;
+  dat.IteratePrefixMatchesAtEachPosition(
+      utils::string_view("AB"),
+      [&num_starts](int i) {
+        ++num_starts;
+        return true;
+      },
+      [](int i, const DoubleArrayTrie::Match& m) { FAIL(); });
+  EXPECT_EQ(num_starts, 2);
+}
+
 }  // namespace sentencepiece
 }  // namespace custom
 }  // namespace ops
@@ -0,0 +1,108 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Throughput benchmarks of the sentencepiece decoder, on the encodings of a
+// batch of 1024 strings of several lengths.
+//
+// The processed bytes are the bytes of the original strings, and the
+// `tokens_per_second` counter gives the number of decoded pieces per second.
+
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/test/test_utils.h"
+#include "tensorflow_lite_support/custom_ops/kernel/sentencepiece/model_converter.h"
+#include "tensorflow_lite_support/custom_ops/kernel/sentencepiece/optimized_decoder.h"
+#include "tensorflow_lite_support/custom_ops/kernel/sentencepiece/optimized_encoder.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace sentencepiece {
+namespace {
+
+using ::tflite::task::JoinPath;
+
+constexpr char kConfigFilePath[] =
+    "/tensorflow_lite_support/custom_ops/kernel/"
+    "sentencepiece/testdata/sentencepiece.model";
+
+constexpr const char* kWords[] = {
+    "the",   "quick", "brown", "fox",       "jumps",    "over",  "lazy", "dog",
+    "Hello", "world", "model", "tokenizer", "sentence", "piece", "naïve"};
+
+std::string ReadModel() {
+  std::ifstream infile(JoinPath("./" /*test src dir*/, kConfigFilePath));
+  return std::string((std::istreambuf_iterator<char>(infile)),
+                     (std::istreambuf_iterator<char>()));
+}
+
+// A batch of 1024 strings of about `length` bytes each, and their encodings.
+class EncodedBatch {
+ public:
+  EncodedBatch(const std::string& model, int length) {
+    const std::string encoder_config = ConvertSentencepieceModel(model);
+    std::mt19937 rng(/*seed=*/42);
+    for (int i = 0; i < 1024; ++i) {
+      std::string text;
+      while (text.size() < static_cast<size_t>(length)) {
+        text.append(kWords[rng() % (sizeof(kWords) / sizeof(kWords[0]))]);
+        text.push_back(' ');
+      }
+      encoded_.push_back(EncodeString(text, encoder_config.data(),
+                                      /*add_bos=*/false, /*add_eos=*/false,
+                                      /*reverse=*/false)
+                             .codes);
+      num_bytes_ += text.size();
+      num_tokens_ += encoded_.back().size();
+    }
+  }
+
+  const std::vector<std::vector<int>>& encoded() const { return encoded_; }
+  int64_t num_bytes() const { return num_bytes_; }
+  int64_t num_tokens() const { return num_tokens_; }
+
+ private:
+  std::vector<std::vector<int>> encoded_;
+  int64_t num_bytes_ = 0;
+  int64_t num_tokens_ = 0;
+};
+
+void BM_DecodeString(benchmark::State& state) {
+  static const std::string* model = new std::string(ReadModel());
+  static const std::string* decoder_config =
+      new std::string(ConvertSentencepieceModelForDecoder(*model));
+  const EncodedBatch batch(*model, state.range(0));
+  for (auto _ : state) {
+    for (const std::vector<int>& encoded : batch.encoded()) {
+      benchmark::DoNotOptimize(DecodeString(encoded, decoder_config->data()));
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * batch.num_bytes());
+  state.SetItemsProcessed(state.iterations() * batch.encoded().size());
+  state.counters["tokens_per_second"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * batch.num_tokens(),
+      benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_DecodeString)->Arg(16)->Arg(128)->Arg(1024)->ThreadRange(1, 8);
+
+}  // namespace
+}  // namespace sentencepiece
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
@@ -16,7 +16,10 @@ limitations under the License.
 #include "tensorflow_lite_support/custom_ops/kernel/sentencepiece/optimized_encoder.h"
 
 #include <algorithm>
+#include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #include "tensorflow_lite_support/custom_ops/kernel/sentencepiece/double_array_trie.h"
 #include "tensorflow_lite_support/custom_ops/kernel/sentencepiece/encoder_config_generated.h"
@@ -28,143 +31,161 @@ namespace sentencepiece {
 namespace {
 
 const char kSpaceSymbol[] = "\xe2\x96\x81";
-
-template <typename processing_callback>
-std::tuple<std::string, std::vector<int>> process_string(
-    const std::string& input, const std::vector<int>& offsets,
-    const processing_callback& pc) {
-  std::string result_string;
-  result_string.reserve(input.size());
-  std::vector<int> result_offsets;
-  result_offsets.reserve(offsets.size());
-  for (int i = 0, j = 0; i < input.size();) {
-    auto result = pc(input.data() + i, input.size() - i);
-    auto consumed = std::get<0>(result);
-    auto new_string = std::get<1>(result);
-    if (consumed == 0) {
-      // Skip the current byte and move forward.
-      result_string.push_back(input[i]);
-      result_offsets.push_back(offsets[j]);
-      i++;
-      j++;
-      continue;
-    }
-    result_string.append(new_string.data(), new_string.length());
-    for (int i = 0; i < new_string.length(); ++i) {
-      result_offsets.push_back(offsets[j]);
-    }
-    j += consumed;
-    i += consumed;
-  }
-  return std::make_tuple(result_string, result_offsets);
-}
+constexpr int kSpaceSymbolLength = sizeof(kSpaceSymbol) - 1;
 
 inline char is_whitespace(char c) {
   return c == ' ' || c == '\t' || c == '\r' || c == '\n';
 }
 
-std::tuple<int, utils::string_view> remove_extra_whitespaces(const char* data,
-                                                             int len) {
-  if (len == 0 || !is_whitespace(*data)) {
-    return std::make_tuple(0, utils::string_view(nullptr, 0));
+// Receives the bytes produced by the prefix replacement step together with
+// their input offsets, and applies the whitespace removal and escaping steps
+// on the fly, so that the normalization needs no intermediate strings.
+class NormalizedStringWriter {
+ public:
+  NormalizedStringWriter(const EncoderConfig& config, std::string* output,
+                         std::vector<int>* offsets)
+      : remove_extra_whitespaces_(config.remove_extra_whitespaces()),
+        escape_whitespaces_(config.escape_whitespaces()),
+        output_(output),
+        offsets_(offsets) {}
+
+  void Append(char c, int offset) {
+    if (remove_extra_whitespaces_) {
+      // Runs of whitespaces are held back until their length is known.
+      if (is_whitespace(c)) {
+        if (num_pending_whitespaces_++ == 0) {
+          pending_whitespace_ = c;
+          pending_whitespace_offset_ = offset;
+        }
+        return;
+      }
+      FlushWhitespaces();
+    }
+    Emit(c, offset);
   }
-  int num_consumed = 1;
-  for (; num_consumed < len && is_whitespace(data[num_consumed]);
-       ++num_consumed) {
+
+  // Trailing whitespaces are dropped when removing extra whitespaces, which
+  // is the same as not flushing the pending ones.
+  void Finish() { num_pending_whitespaces_ = 0; }
+
+ private:
+  // A single whitespace is kept as is, longer runs are collapsed into a space.
+  void FlushWhitespaces() {
+    if (num_pending_whitespaces_ > 0) {
+      Emit(num_pending_whitespaces_ == 1 ? pending_whitespace_ : ' ',
+           pending_whitespace_offset_);
+      num_pending_whitespaces_ = 0;
+    }
   }
-  return num_consumed > 1
-             ? std::make_tuple(num_consumed, utils::string_view(" ", 1))
-             : std::make_tuple(0, utils::string_view(nullptr, 0));
-}
 
-std::tuple<int, utils::string_view> find_replacement(
-    const char* data, int len, const DoubleArrayTrie& dat,
-    const flatbuffers::Vector<int8_t>& replacements) {
-  const auto max_match = dat.LongestPrefixMatch(utils::string_view(data, len));
-  if (!max_match.empty()) {
-    // Because flatbuffer byte is signed char which is not the same as char,
-    // there is the reinterpret_cast here.
-    const char* replaced_string_ptr =
-        reinterpret_cast<const char*>(replacements.data() + max_match.id);
-    return std::make_tuple(max_match.match_length,
-                           utils::string_view(replaced_string_ptr));
+  void Emit(char c, int offset) {
+    if (escape_whitespaces_ && is_whitespace(c)) {
+      output_->append(kSpaceSymbol, kSpaceSymbolLength);
+      offsets_->insert(offsets_->end(), kSpaceSymbolLength, offset);
+    } else {
+      output_->push_back(c);
+      offsets_->push_back(offset);
+    }
   }
-  return std::make_tuple(0, utils::string_view(nullptr, 0));
-}
+
+  const bool remove_extra_whitespaces_;
+  const bool escape_whitespaces_;
+  std::string* output_;
+  std::vector<int>* offsets_;
+  int num_pending_whitespaces_ = 0;
+  char pending_whitespace_ = ' ';
+  int pending_whitespace_offset_ = 0;
+};
+
 }  // namespace
 
-std::tuple<std::string, std::vector<int>> NormalizeString(
-    const std::string& in_string, const EncoderConfig& config) {
-  std::vector<int> output_offsets;
-  std::string result = in_string;
-  output_offsets.reserve(in_string.length());
-  for (int i = 0; i < in_string.length(); ++i) {
-    output_offsets.push_back(i);
-  }
+void NormalizeString(utils::string_view in_string, const EncoderConfig& config,
+                     EncoderScratch* scratch) {
+  std::string& result = scratch->normalized;
+  std::vector<int>& output_offsets = scratch->offsets;
+  result.clear();
+  output_offsets.clear();
   if (in_string.empty()) {
-    return std::make_tuple(result, output_offsets);
+    return;
   }
+  const char* data = in_string.data();
+  int length = in_string.length();
+  // The dummy prefix is attributed to the first byte of the input.
+  int prefix_length = 0;
   if (config.add_dummy_prefix()) {
-    result.insert(result.begin(), ' ');
-    output_offsets.insert(output_offsets.begin(), 0);
+    scratch->prefixed_input.assign(1, ' ');
+    scratch->prefixed_input.append(data, length);
+    data = scratch->prefixed_input.data();
+    length = scratch->prefixed_input.length();
+    prefix_length = 1;
   }
+  // Escaping is the only step that grows the string.
+  const int max_length = config.escape_whitespaces()
+                             ? length * kSpaceSymbolLength
+                             : length;
+  result.reserve(max_length);
+  output_offsets.reserve(max_length);
+
+  NormalizedStringWriter writer(config, &result, &output_offsets);
   // Greedely replace normalized_prefixes with normalized_replacements
   if (config.normalized_prefixes() != nullptr &&
       config.normalized_replacements() != nullptr) {
     const DoubleArrayTrie normalized_prefixes_matcher(
         config.normalized_prefixes()->nodes());
-    const auto norm_replace = [&config, &normalized_prefixes_matcher](
-                                  const char* data, int len) {
-      return find_replacement(data, len, normalized_prefixes_matcher,
-                              *config.normalized_replacements());
-    };
-    std::tie(result, output_offsets) =
-        process_string(result, output_offsets, norm_replace);
-  }
-  if (config.remove_extra_whitespaces()) {
-    std::tie(result, output_offsets) =
-        process_string(result, output_offsets, remove_extra_whitespaces);
-    if (!result.empty() && is_whitespace(result.back())) {
-      result.pop_back();
-      output_offsets.pop_back();
-    }
-  }
-  if (config.escape_whitespaces()) {
-    const auto replace_whitespaces = [](const char* data, int len) {
-      if (len > 0 && is_whitespace(*data)) {
-        return std::make_tuple(1, utils::string_view(kSpaceSymbol));
+    // Because flatbuffer byte is signed char which is not the same as char,
+    // there is the reinterpret_cast here.
+    const char* replacements = reinterpret_cast<const char*>(
+        config.normalized_replacements()->data());
+    for (int i = 0; i < length;) {
+      const int offset = std::max(i - prefix_length, 0);
+      const auto max_match = normalized_prefixes_matcher.LongestPrefixMatch(
+          utils::string_view(data + i, length - i));
+      if (max_match.empty()) {
+        writer.Append(data[i], offset);
+        ++i;
+        continue;
       }
-      return std::make_tuple(0, utils::string_view(nullptr, 0));
-    };
-    std::tie(result, output_offsets) =
-        process_string(result, output_offsets, replace_whitespaces);
+      for (const char* c = replacements + max_match.id; *c != '\0'; ++c) {
+        writer.Append(*c, offset);
+      }
+      i += max_match.match_length;
+    }
+  } else {
+    for (int i = 0; i < length; ++i) {
+      writer.Append(data[i], std::max(i - prefix_length, 0));
+    }
   }
+  writer.Finish();
+}
 
-  return std::make_tuple(result, output_offsets);
+std::tuple<std::string, std::vector<int>> NormalizeString(
+    const std::string& in_string, const EncoderConfig& config) {
+  EncoderScratch scratch;
+  NormalizeString(utils::string_view(in_string), config, &scratch);
+  return std::make_tuple(std::move(scratch.normalized),
+                         std::move(scratch.offsets));
 }
 
-EncoderResult EncodeNormalizedString(const std::string& str,
-                                     const std::vector<int>& offsets,
-                                     const EncoderConfig& config, bool add_bos,
-                                     bool add_eos, bool reverse) {
+namespace {
+
+void EncodeNormalizedString(const EncoderConfig& config, bool add_bos,
+                            bool add_eos, bool reverse,
+                            EncoderScratch* scratch, std::vector<int>* codes,
+                            std::vector<int>* output_offsets) {
+  using LatticeElement = EncoderScratch::LatticeElement;
+  const std::string& str = scratch->normalized;
+  const std::vector<int>& offsets = scratch->offsets;
   const DoubleArrayTrie piece_matcher(config.pieces()->nodes());
-  const flatbuffers::Vector<float>* piece_scores = config.pieces_scores();
+  const float* piece_scores = config.pieces_scores()->data();
   const int unknown_code = config.unknown_code();
   const float unknown_penalty = config.unknown_penalty();
-  struct LatticeElement {
-    float score = 0;
-    int code = -1;
-    int prev_position = -1;
-    LatticeElement(float score_, int code_, int prev_position_)
-        : score(score_), code(code_), prev_position(prev_position_) {}
-    LatticeElement() {}
-  };
   const int length = str.length();
-  std::vector<LatticeElement> lattice(length + 1);
-  for (int i = 0; i < length; ++i) {
+  std::vector<LatticeElement>& lattice = scratch->lattice;
+  lattice.assign(length + 1, LatticeElement());
+  auto lattice_start = [&lattice, unknown_code, unknown_penalty](int i) {
     if (i > 0 && lattice[i].prev_position < 0) {
       // This state is unreachable.
-      continue;
+      return false;
     }
     if (unknown_code >= 0) {
       // Put unknown code.
@@ -180,22 +201,29 @@ EncoderResult EncodeNormalizedString(const std::string& str,
             lattice[i].code == unknown_code ? lattice[i].prev_position : i);
       }
     }
-    auto lattice_update = [&lattice, i,
-                           piece_scores](const DoubleArrayTrie::Match& m) {
-      LatticeElement& target_element = lattice[i + m.match_length];
-      const float score = lattice[i].score + (*piece_scores)[m.id];
-      if (target_element.prev_position < 0 || target_element.score < score) {
-        target_element = LatticeElement(score, m.id, i);
-      }
-    };
-    piece_matcher.IteratePrefixMatches(
-        utils::string_view(str.data() + i, length - i), lattice_update);
-  }
+    return true;
+  };
+  auto lattice_update = [&lattice, piece_scores](
+                            int i, const DoubleArrayTrie::Match& m) {
+    LatticeElement& target_element = lattice[i + m.match_length];
+    const float score = lattice[i].score + piece_scores[m.id];
+    if (target_element.prev_position < 0 || target_element.score < score) {
+      target_element = LatticeElement(score, m.id, i);
+    }
+  };
+  piece_matcher.IteratePrefixMatchesAtEachPosition(
+      utils::string_view(str), lattice_start, lattice_update);
 
-  EncoderResult result;
+  // Codes are produced from the end of the string and reversed afterwards
+  // unless `reverse` is set.
+  const size_t codes_begin = codes->size();
+  const size_t offsets_begin =
+      output_offsets != nullptr ? output_offsets->size() : 0;
   if (add_eos) {
-    result.codes.push_back(config.end_code());
-    result.offsets.push_back(length);
+    codes->push_back(config.end_code());
+    if (output_offsets != nullptr) {
+      output_offsets->push_back(length);
+    }
   }
   if (lattice[length].prev_position >= 0) {
     for (int pos = length; pos > 0;) {
@@ -203,36 +231,52 @@ EncoderResult EncodeNormalizedString(const std::string& str,
       if (code != config.unknown_code()) {
         code += config.encoding_offset();
       }
-      result.codes.push_back(code);
+      codes->push_back(code);
       pos = lattice[pos].prev_position;
-      result.offsets.push_back(offsets[pos]);
+      if (output_offsets != nullptr) {
+        output_offsets->push_back(offsets[pos]);
+      }
     }
   }
   if (add_bos) {
-    result.codes.push_back(config.start_code());
-    result.offsets.push_back(0);
+    codes->push_back(config.start_code());
+    if (output_offsets != nullptr) {
+      output_offsets->push_back(0);
+    }
   }
   if (!reverse) {
-    std::reverse(result.codes.begin(), result.codes.end());
-    std::reverse(result.offsets.begin(), result.offsets.end());
+    std::reverse(codes->begin() + codes_begin, codes->end());
+    if (output_offsets != nullptr) {
+      std::reverse(output_offsets->begin() + offsets_begin,
+                   output_offsets->end());
+    }
   }
-  return result;
+}
+
+}  // namespace
+
+void EncodeString(utils::string_view string, const EncoderConfig& config,
+                  bool add_bos, bool add_eos, bool reverse,
+                  EncoderScratch* scratch, std::vector<int>* codes,
+                  std::vector<int>* offsets) {
+  NormalizeString(string, config, scratch);
+  EncodeNormalizedString(config, add_bos, add_eos, reverse, scratch, codes,
+                         offsets);
 }
 
 EncoderResult EncodeString(const std::string& string, const void* config_buffer,
                            bool add_bos, bool add_eos, bool reverse) {
   // Get the config from the buffer.
   const EncoderConfig* config = GetEncoderConfig(config_buffer);
+  EncoderResult result;
   if (config->version() != EncoderVersion::EncoderVersion_SENTENCE_PIECE) {
-    EncoderResult result;
     result.type = EncoderResultType::WRONG_CONFIG;
     return result;
   }
-  std::string normalized_string;
-  std::vector<int> offsets;
-  std::tie(normalized_string, offsets) = NormalizeString(string, *config);
-  return EncodeNormalizedString(normalized_string, offsets, *config, add_bos,
-                                add_eos, reverse);
+  EncoderScratch scratch;
+  EncodeString(utils::string_view(string), *config, add_bos, add_eos, reverse,
+               &scratch, &result.codes, &result.offsets);
+  return result;
 }
 
 }  // namespace sentencepiece
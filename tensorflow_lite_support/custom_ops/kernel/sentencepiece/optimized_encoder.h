@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow_lite_support/custom_ops/kernel/sentencepiece/encoder_config_generated.h"
+#include "tensorflow_lite_support/custom_ops/kernel/sentencepiece/utils.h"
 
 namespace tflite {
 namespace ops {
@@ -36,14 +37,49 @@ struct EncoderResult {
   std::vector<int> codes;
   std::vector<int> offsets;
 };
+
+// Buffers reused across calls to EncodeString, so that encoding a batch of
+// strings stops allocating once they have grown to the longest string.
+// Not thread-safe: use one instance per thread.
+struct EncoderScratch {
+  struct LatticeElement {
+    float score = 0;
+    int code = -1;
+    int prev_position = -1;
+    LatticeElement(float score_, int code_, int prev_position_)
+        : score(score_), code(code_), prev_position(prev_position_) {}
+    LatticeElement() {}
+  };
+  // The input with the dummy prefix prepended, if the config requires one.
+  std::string prefixed_input;
+  // The normalized string and, for each of its bytes, the offset of the input
+  // byte it originates from.
+  std::string normalized;
+  std::vector<int> offsets;
+  std::vector<LatticeElement> lattice;
+};
+
 std::tuple<std::string, std::vector<int>> NormalizeString(
     const std::string& in_string, const EncoderConfig& config);
 
+// Normalizes `in_string` into `scratch->normalized` and `scratch->offsets` in
+// a single pass over the input.
+void NormalizeString(utils::string_view in_string, const EncoderConfig& config,
+                     EncoderScratch* scratch);
+
 // Encodes one string and returns ids and offsets. Takes the configuration as a
 // type-erased buffer.
 EncoderResult EncodeString(const std::string& string, const void* config_buffer,
                            bool add_bos, bool add_eos, bool reverse);
 
+// Encodes one string and appends its ids to `codes` and, if not null, their
+// offsets to `offsets`. The config version must have been checked to be
+// EncoderVersion_SENTENCE_PIECE.
+void EncodeString(utils::string_view string, const EncoderConfig& config,
+                  bool add_bos, bool add_eos, bool reverse,
+                  EncoderScratch* scratch, std::vector<int>* codes,
+                  std::vector<int>* offsets);
+
 }  // namespace sentencepiece
 }  // namespace custom
 }  // namespace ops
@@ -0,0 +1,139 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Throughput benchmarks of the sentencepiece encoder, comparing the
+// allocating EncodeString API with the scratch-reusing one.
+//
+// Besides bytes per second, the `tokens_per_second` counter gives the number
+// of produced pieces per second.
+
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/cc/test/test_utils.h"
+#include "tensorflow_lite_support/custom_ops/kernel/sentencepiece/encoder_config_generated.h"
+#include "tensorflow_lite_support/custom_ops/kernel/sentencepiece/model_converter.h"
+#include "tensorflow_lite_support/custom_ops/kernel/sentencepiece/optimized_encoder.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace sentencepiece {
+namespace {
+
+using ::tflite::task::JoinPath;
+
+constexpr char kConfigFilePath[] =
+    "/tensorflow_lite_support/custom_ops/kernel/"
+    "sentencepiece/testdata/sentencepiece.model";
+
+constexpr const char* kWords[] = {
+    "the",   "quick", "brown", "fox",       "jumps",    "over",  "lazy", "dog",
+    "Hello", "world", "model", "tokenizer", "sentence", "piece", "  ",   "\t"};
+
+const std::string& GetConvertedModel() {
+  static const std::string* converted_model = [] {
+    std::ifstream infile(JoinPath("./" /*test src dir*/, kConfigFilePath));
+    std::string config((std::istreambuf_iterator<char>(infile)),
+                       (std::istreambuf_iterator<char>()));
+    return new std::string(ConvertSentencepieceModel(config));
+  }();
+  return *converted_model;
+}
+
+// Returns a batch of 1024 strings of about `length` bytes each.
+std::vector<std::string> MakeBatch(int length) {
+  std::mt19937 rng(/*seed=*/42);
+  std::vector<std::string> batch(1024);
+  for (std::string& text : batch) {
+    while (text.size() < static_cast<size_t>(length)) {
+      text.append(kWords[rng() % (sizeof(kWords) / sizeof(kWords[0]))]);
+      text.push_back(' ');
+    }
+  }
+  return batch;
+}
+
+int64_t TotalBytes(const std::vector<std::string>& batch) {
+  int64_t bytes = 0;
+  for (const std::string& text : batch) {
+    bytes += text.size();
+  }
+  return bytes;
+}
+
+int64_t TotalTokens(const std::vector<std::string>& batch) {
+  int64_t tokens = 0;
+  for (const std::string& text : batch) {
+    tokens += EncodeString(text, GetConvertedModel().data(), /*add_bos=*/false,
+                           /*add_eos=*/false, /*reverse=*/false)
+                  .codes.size();
+  }
+  return tokens;
+}
+
+void SetProcessed(const std::vector<std::string>& batch,
+                  benchmark::State& state) {
+  state.SetBytesProcessed(state.iterations() * TotalBytes(batch));
+  state.SetItemsProcessed(state.iterations() * batch.size());
+  state.counters["tokens_per_second"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * TotalTokens(batch),
+      benchmark::Counter::kIsRate);
+}
+
+void BM_EncodeString(benchmark::State& state) {
+  const std::string& model = GetConvertedModel();
+  const std::vector<std::string> batch = MakeBatch(state.range(0));
+  for (auto _ : state) {
+    for (const std::string& text : batch) {
+      benchmark::DoNotOptimize(
+          EncodeString(text, model.data(), /*add_bos=*/false,
+                       /*add_eos=*/false, /*reverse=*/false));
+    }
+  }
+  SetProcessed(batch, state);
+}
+BENCHMARK(BM_EncodeString)->Arg(16)->Arg(128)->Arg(1024)->ThreadRange(1, 8);
+
+void BM_EncodeStringWithScratch(benchmark::State& state) {
+  const EncoderConfig* config = GetEncoderConfig(GetConvertedModel().data());
+  const std::vector<std::string> batch = MakeBatch(state.range(0));
+  EncoderScratch scratch;
+  std::vector<int> codes;
+  for (auto _ : state) {
+    for (const std::string& text : batch) {
+      codes.clear();
+      EncodeString(utils::string_view(text), *config, /*add_bos=*/false,
+                   /*add_eos=*/false, /*reverse=*/false, &scratch, &codes,
+                   /*offsets=*/nullptr);
+      benchmark::DoNotOptimize(codes.data());
+    }
+  }
+  SetProcessed(batch, state);
+}
+BENCHMARK(BM_EncodeStringWithScratch)
+    ->Arg(16)
+    ->Arg(128)
+    ->Arg(1024)
+    ->ThreadRange(1, 8);
+
+}  // namespace
+}  // namespace sentencepiece
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
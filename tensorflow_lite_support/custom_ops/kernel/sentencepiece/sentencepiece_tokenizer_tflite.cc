@@ -16,11 +16,16 @@ limitations under the License.
 /**
  * Sentencepiece tflite tokenizer implementation.
  */
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow_lite_support/custom_ops/kernel/sentencepiece/optimized_encoder.h"
 #include "tensorflow_lite_support/custom_ops/kernel/sentencepiece/sentencepiece_tokenizer.h"
 #include "flatbuffers/flexbuffers.h"  // from @flatbuffers
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/context.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/model.h"
@@ -35,6 +40,10 @@ namespace tokenizer {
 constexpr int kOutputValuesInd = 0;
 constexpr int kOutputSplitsInd = 1;
 
+// Batches are only split across threads when each thread gets at least this
+// many strings, as smaller batches don't amortize the dispatch.
+constexpr int kMinStringsPerTask = 16;
+
 namespace {
 TfLiteIntArray* CreateSizeArray(const std::initializer_list<int>& sizes) {
   TfLiteIntArray* array_size = TfLiteIntArrayCreate(sizes.size());
@@ -44,14 +53,66 @@ TfLiteIntArray* CreateSizeArray(const std::initializer_list<int>& sizes) {
   }
   return array_size;
 }
+
+// Encoding state of a contiguous range of the input strings. Kept in the
+// node's user data so that its buffers are reused across invocations.
+struct EncodeTaskState {
+  EncoderScratch scratch;
+  std::vector<int> encoded;
+  // Cumulative number of codes after each string of the range.
+  std::vector<int> splits;
+};
+
+struct TokenizerOpData {
+  std::vector<EncodeTaskState> task_states;
+};
+
+class EncodeTask : public cpu_backend_threadpool::Task {
+ public:
+  EncodeTask(const TfLiteTensor* input_text, int begin, int end,
+             const EncoderConfig* config, bool add_bos, bool add_eos,
+             bool reverse, EncodeTaskState* state)
+      : input_text_(input_text),
+        begin_(begin),
+        end_(end),
+        config_(config),
+        add_bos_(add_bos),
+        add_eos_(add_eos),
+        reverse_(reverse),
+        state_(state) {}
+
+  void Run() override {
+    state_->encoded.clear();
+    state_->splits.clear();
+    for (int i = begin_; i < end_; ++i) {
+      const auto strref = tflite::GetString(input_text_, i);
+      EncodeString(utils::string_view(strref.str, strref.len), *config_,
+                   add_bos_, add_eos_, reverse_, &state_->scratch,
+                   &state_->encoded, /*offsets=*/nullptr);
+      state_->splits.push_back(state_->encoded.size());
+    }
+  }
+
+ private:
+  const TfLiteTensor* input_text_;
+  const int begin_;
+  const int end_;
+  const EncoderConfig* config_;
+  const bool add_bos_;
+  const bool add_eos_;
+  const bool reverse_;
+  EncodeTaskState* state_;
+};
 }  // namespace
 
 // Initializes text encoder object from serialized parameters.
 void* Initialize(TfLiteContext* /*context*/, const char* /*buffer*/,
                  size_t /*length*/) {
-  return nullptr;
+  return new TokenizerOpData();
+}
+void Free(TfLiteContext* /*context*/, void* buffer) {
+  delete reinterpret_cast<TokenizerOpData*>(buffer);
 }
-void Free(TfLiteContext* /*context*/, void* /*buffer*/) {}
 
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // TODO(mgubin): Add checks for input and output tensors.
@@ -66,6 +127,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 }
 
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  TokenizerOpData* op_data =
+      reinterpret_cast<TokenizerOpData*>(node->user_data);
   const TfLiteTensor& model_tensor =
       context->tensors[node->inputs->data[tensorflow::ops::kSPModelIndex]];
   const auto model_buffer_data = model_tensor.data.data;
@@ -82,36 +145,64 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       context->tensors[node->inputs->data[tensorflow::ops::kReverseInput]];
   const bool reverse = reverse_tensor.data.b[0];
 
-  std::vector<int32> encoded;
-  std::vector<int32> splits;
+  const EncoderConfig* config = GetEncoderConfig(model_buffer_data);
+  TF_LITE_ENSURE_MSG(
+      context,
+      config->version() == EncoderVersion::EncoderVersion_SENTENCE_PIECE,
+      "Sentencepiece conversion failed");
+
+  // Split the batch into contiguous ranges of strings, one per task, so that
+  // the outputs can be concatenated in order.
   const int num_strings = tflite::GetStringCount(&input_text);
-  for (int i = 0; i < num_strings; ++i) {
-    const auto strref = tflite::GetString(&input_text, i);
-    const auto res = EncodeString(std::string(strref.str, strref.len),
-                                  model_buffer_data, add_bos, add_eos, reverse);
-    TF_LITE_ENSURE_MSG(context, res.type == EncoderResultType::SUCCESS,
-                       "Sentencepiece conversion failed");
-    std::copy(res.codes.begin(), res.codes.end(), std::back_inserter(encoded));
-    splits.emplace_back(encoded.size());
+  CpuBackendContext* cpu_backend_context =
+      CpuBackendContext::GetFromContext(context);
+  const int num_tasks =
+      std::max(1, std::min(cpu_backend_context->max_num_threads(),
+                           num_strings / kMinStringsPerTask));
+  if (op_data->task_states.size() < static_cast<size_t>(num_tasks)) {
+    op_data->task_states.resize(num_tasks);
+  }
+  std::vector<EncodeTask> tasks;
+  tasks.reserve(num_tasks);
+  for (int i = 0; i < num_tasks; ++i) {
+    tasks.emplace_back(&input_text, num_strings * i / num_tasks,
+                       num_strings * (i + 1) / num_tasks, config, add_bos,
+                       add_eos, reverse, &op_data->task_states[i]);
+  }
+  if (num_tasks == 1) {
+    tasks[0].Run();
+  } else {
+    cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                    cpu_backend_context);
   }
 
+  int num_encoded = 0;
+  for (int i = 0; i < num_tasks; ++i) {
+    num_encoded += op_data->task_states[i].encoded.size();
+  }
   TfLiteTensor& output_values =
       context->tensors[node->outputs->data[kOutputValuesInd]];
   TF_LITE_ENSURE_OK(context,
-                    context->ResizeTensor(
-                        context, &output_values,
-                        CreateSizeArray({static_cast<int>(encoded.size())})));
-  int32_t* output_values_flat = output_values.data.i32;
-  std::copy(encoded.begin(), encoded.end(), output_values_flat);
+                    context->ResizeTensor(context, &output_values,
+                                          CreateSizeArray({num_encoded})));
   TfLiteTensor& output_splits =
       context->tensors[node->outputs->data[kOutputSplitsInd]];
-  TF_LITE_ENSURE_OK(
-      context, context->ResizeTensor(
-                   context, &output_splits,
-                   CreateSizeArray({static_cast<int>(splits.size() + 1)})));
+  TF_LITE_ENSURE_OK(context, context->ResizeTensor(
+                                 context, &output_splits,
+                                 CreateSizeArray({num_strings + 1})));
+  int32_t* output_values_flat = output_values.data.i32;
   int32_t* output_splits_flat = output_splits.data.i32;
-  *output_splits_flat = 0;
-  std::copy(splits.begin(), splits.end(), output_splits_flat + 1);
+  *output_splits_flat++ = 0;
+  int values_offset = 0;
+  for (int i = 0; i < num_tasks; ++i) {
+    const EncodeTaskState& state = op_data->task_states[i];
+    std::copy(state.encoded.begin(), state.encoded.end(),
+              output_values_flat + values_offset);
+    for (const int split : state.splits) {
+      *output_splits_flat++ = values_offset + split;
+    }
+    values_offset += state.encoded.size();
+  }
   return kTfLiteOk;
 }
 }  // namespace tokenizer
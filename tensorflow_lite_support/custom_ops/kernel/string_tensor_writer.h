@@ -0,0 +1,110 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_CUSTOM_OPS_KERNEL_STRING_TENSOR_WRITER_H_
+#define TENSORFLOW_LITE_SUPPORT_CUSTOM_OPS_KERNEL_STRING_TENSOR_WRITER_H_
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include "tensorflow/lite/context.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+
+// Returns whether a string tensor with `num_strings` strings of `data_size`
+// bytes in total can be addressed with the int32 offsets of its header.
+inline bool StringTensorSizeFits(int64_t num_strings, int64_t data_size) {
+  return num_strings >= 0 && data_size >= 0 &&
+         static_cast<int64_t>(sizeof(int32_t)) * (num_strings + 2) +
+                 data_size <=
+             std::numeric_limits<int32_t>::max();
+}
+
+// Writes strings straight into the buffer of a dynamic string tensor, using
+// the same layout as DynamicBuffer: the number of strings, the offset of each
+// string from the start of the buffer plus the end offset, then the string
+// data. Unlike DynamicBuffer, the number of strings and their total size must
+// be known up front (see StringTensorSizeFits), so that the tensor buffer is
+// allocated once and every byte is copied once.
+class StringTensorWriter {
+ public:
+  StringTensorWriter(int num_strings, int data_size)
+      : num_strings_(num_strings),
+        header_size_(sizeof(int32_t) * (num_strings + 2)),
+        size_(header_size_ + data_size),
+        buffer_(static_cast<char*>(malloc(size_))),
+        data_offset_(header_size_) {
+    if (buffer_ != nullptr) {
+      WriteInt32(0, num_strings_);
+    }
+  }
+
+  ~StringTensorWriter() { free(buffer_); }
+
+  StringTensorWriter(const StringTensorWriter&) = delete;
+  StringTensorWriter& operator=(const StringTensorWriter&) = delete;
+
+  // Returns false if the buffer could not be allocated.
+  bool ok() const { return buffer_ != nullptr; }
+
+  void AddString(const char* str, int len) {
+    if (len > 0) {
+      memcpy(AddUninitializedString(len), str, len);
+    } else {
+      AddUninitializedString(0);
+    }
+  }
+
+  // Adds a string of `len` bytes and returns where its contents must be
+  // written, so that callers can assemble it from several pieces in place.
+  char* AddUninitializedString(int len) {
+    WriteInt32(sizeof(int32_t) * (1 + index_++), data_offset_);
+    char* data = buffer_ + data_offset_;
+    data_offset_ += len;
+    return data;
+  }
+
+  // Hands the buffer over to `tensor`, which takes ownership of `new_shape`.
+  // All the strings must have been added.
+  void WriteToTensor(TfLiteTensor* tensor, TfLiteIntArray* new_shape) {
+    WriteInt32(sizeof(int32_t) * (1 + num_strings_), data_offset_);
+    TfLiteTensorReset(tensor->type, tensor->name, new_shape, tensor->params,
+                      buffer_, size_, kTfLiteDynamic, tensor->allocation,
+                      tensor->is_variable, tensor);
+    buffer_ = nullptr;
+  }
+
+ private:
+  void WriteInt32(size_t position, int32_t value) {
+    memcpy(buffer_ + position, &value, sizeof(int32_t));
+  }
+
+  const int32_t num_strings_;
+  const int32_t header_size_;
+  const int32_t size_;
+  char* buffer_;
+  int32_t index_ = 0;
+  int32_t data_offset_;
+};
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_CUSTOM_OPS_KERNEL_STRING_TENSOR_WRITER_H_
@@ -16,12 +16,18 @@ limitations under the License.
 #include "tensorflow_lite_support/custom_ops/kernel/whitespace_tokenizer.h"
 
 #include <algorithm>
-#include <utility>
-#include <vector>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #include "tensorflow/lite/context.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/string_util.h"
+#include "tensorflow_lite_support/custom_ops/kernel/string_tensor_writer.h"
 #include "libutf/utf.h"
 
 constexpr int kInput = 0;
@@ -57,95 +63,195 @@ inline int charntorune(Rune* r, const char* s, int n) {
   return bytes_read;
 }
 
-std::vector<std::pair<const char*, int>> Tokenize(StringRef str) {
-  const char* p = str.str;
-  int n = str.len;
+// Whether each ASCII byte is whitespace, according to isspacerune. Built from
+// libutf itself so that the fast path can never disagree with the slow one.
+class AsciiWhitespaceTable {
+ public:
+  AsciiWhitespaceTable() {
+    for (int c = 0; c < 128; ++c) {
+      is_space_[c] = isspacerune(c);
+    }
+  }
+
+  bool IsSpace(unsigned char c) const { return is_space_[c]; }
+
+ private:
+  bool is_space_[128];
+};
+
+const AsciiWhitespaceTable& GetAsciiWhitespaceTable() {
+  static const AsciiWhitespaceTable* table = new AsciiWhitespaceTable();
+  return *table;
+}
+
+// Returns whether `c` is printable ASCII (0x21-0x7f). These bytes are never
+// whitespace and never part of a multi-byte rune, so they can extend a token
+// without being decoded.
+inline bool IsPlainAscii(unsigned char c) { return c > 0x20 && c < 0x80; }
+
+// Returns the length of the longest prefix of [p, p + n) made of plain ASCII
+// bytes, looking at 16 bytes at a time where SIMD is available.
+inline int PlainAsciiPrefixLength(const char* p, int n) {
+  int i = 0;
+#if defined(__SSE2__)
+  const __m128i space = _mm_set1_epi8(0x20);
+  for (; i + 16 <= n; i += 16) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    // The comparison is signed, so bytes with the high bit set fail it too.
+    const int plain = _mm_movemask_epi8(_mm_cmpgt_epi8(bytes, space));
+    if (plain != 0xffff) {
+      return i + __builtin_ctz(~plain);
+    }
+  }
+#elif defined(__ARM_NEON) && defined(__GNUC__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  const int8x16_t space = vdupq_n_s8(0x20);
+  for (; i + 16 <= n; i += 16) {
+    const int8x16_t bytes = vld1q_s8(reinterpret_cast<const int8_t*>(p + i));
+    // The comparison is signed, so bytes with the high bit set fail it too.
+    const uint8x16_t plain = vcgtq_s8(bytes, space);
+    // Narrow the 0x00/0xff byte mask to one nibble per byte.
+    const uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(plain), 4)), 0);
+    if (mask != ~uint64_t{0}) {
+      return i + (__builtin_ctzll(~mask) >> 2);
+    }
+  }
+#endif
+  while (i < n && IsPlainAscii(p[i])) {
+    ++i;
+  }
+  return i;
+}
 
-  std::vector<std::pair<const char*, int>> tokens;
+// Calls `on_token(const char* start, int length)` for each whitespace
+// separated token of `str`. Runs of plain ASCII are skipped in bulk, ASCII
+// whitespace and control bytes are looked up in a table, and only bytes with
+// the high bit set are decoded as runes. As before, tokenization stops at the
+// first invalid UTF-8 sequence.
+template <typename TokenFn>
+void ForEachToken(StringRef str, TokenFn on_token) {
+  const AsciiWhitespaceTable& ascii_whitespace = GetAsciiWhitespaceTable();
+  const char* p = str.str;
+  const char* const end = str.str + str.len;
   const char* start = nullptr;
-  while (n > 0) {
-    Rune r;
-    int c = charntorune(&r, p, n);
-    if (r == Runeerror) break;
+  while (p < end) {
+    if (start != nullptr) {
+      p += PlainAsciiPrefixLength(p, end - p);
+      if (p == end) break;
+    }
 
-    if (isspacerune(r)) {
+    const unsigned char c = *p;
+    bool is_space;
+    int c_len;
+    if (c < 0x80) {
+      is_space = ascii_whitespace.IsSpace(c);
+      c_len = 1;
+    } else {
+      Rune r;
+      c_len = charntorune(&r, p, end - p);
+      if (r == Runeerror) break;
+      is_space = isspacerune(r);
+    }
+
+    if (is_space) {
       if (start != nullptr) {
-        tokens.push_back({start, p - start});
+        on_token(start, p - start);
       }
       start = nullptr;
-    } else {
-      if (start == nullptr) {
-        start = p;
-      }
+    } else if (start == nullptr) {
+      start = p;
     }
-
-    p += c;
-    n -= c;
+    p += c_len;
   }
   if (start != nullptr) {
-    tokens.push_back({start, p - start});
+    on_token(start, p - start);
   }
-
-  return tokens;
 }
 
-TfLiteStatus WritePaddedOutput(
-    const std::vector<std::vector<std::pair<const char*, int>>>& list_of_tokens,
-    const TfLiteTensor* input, TfLiteTensor* output_values) {
-  TfLiteIntArray* output_shape = TfLiteIntArrayCreate(NumDimensions(input) + 1);
-  for (int i = 0; i < NumDimensions(input); ++i) {
-    output_shape->data[i] = SizeOfDimension(input, i);
-  }
+// Both writers tokenize the input twice: once to size the outputs, and once
+// to fill them, so that no per-token state has to be kept in between.
 
-  size_t max_tokens = 0;
-  for (const auto& tokens : list_of_tokens) {
-    max_tokens = std::max(max_tokens, tokens.size());
+TfLiteStatus WritePaddedOutput(TfLiteContext* context,
+                               const TfLiteTensor* input, int input_size,
+                               TfLiteTensor* output_values) {
+  int max_tokens = 0;
+  int64_t data_size = 0;
+  for (int i = 0; i < input_size; ++i) {
+    int num_tokens = 0;
+    ForEachToken(GetString(input, i), [&](const char*, int len) {
+      ++num_tokens;
+      data_size += len;
+    });
+    max_tokens = std::max(max_tokens, num_tokens);
   }
+  const int64_t num_strings = static_cast<int64_t>(input_size) * max_tokens;
+  TF_LITE_ENSURE(context, StringTensorSizeFits(num_strings, data_size));
 
-  output_shape->data[NumDimensions(input)] = max_tokens;
-  DynamicBuffer buffer;
-  for (const auto& tokens : list_of_tokens) {
-    for (const auto& token : tokens) {
-      buffer.AddString(token.first, token.second);
-    }
-    for (int i = tokens.size(); i < max_tokens; ++i) {
-      buffer.AddString(nullptr, 0);
+  StringTensorWriter writer(num_strings, data_size);
+  TF_LITE_ENSURE(context, writer.ok());
+  for (int i = 0; i < input_size; ++i) {
+    int num_tokens = 0;
+    ForEachToken(GetString(input, i), [&](const char* start, int len) {
+      writer.AddString(start, len);
+      ++num_tokens;
+    });
+    for (; num_tokens < max_tokens; ++num_tokens) {
+      writer.AddString(nullptr, 0);
     }
   }
-  buffer.WriteToTensor(output_values, output_shape);
+
+  TfLiteIntArray* output_shape = TfLiteIntArrayCreate(NumDimensions(input) + 1);
+  for (int i = 0; i < NumDimensions(input); ++i) {
+    output_shape->data[i] = SizeOfDimension(input, i);
+  }
+  output_shape->data[NumDimensions(input)] = max_tokens;
+  writer.WriteToTensor(output_values, output_shape);
   return kTfLiteOk;
 }
 
-TfLiteStatus WriteRaggedOutput(
-    const std::vector<std::vector<std::pair<const char*, int>>>& list_of_tokens,
-    const TfLiteTensor* input, TfLiteTensor* output_values,
-    std::vector<TfLiteTensor*> nested_row_splits) {
+TfLiteStatus WriteRaggedOutput(TfLiteContext* context, TfLiteNode* node,
+                               const TfLiteTensor* input, int input_size,
+                               TfLiteTensor* output_values) {
   // The outer dimensions of the ragged tensor are all non-ragged.
-  for (int i = 0; i < nested_row_splits.size() - 1; ++i) {
+  const int num_row_splits = NumDimensions(input);
+  for (int i = 0; i < num_row_splits - 1; ++i) {
     int row_splits_step = SizeOfDimension(input, i + 1);
-    TfLiteTensor* row_splits = nested_row_splits[i];
+    TfLiteTensor* row_splits =
+        GetOutput(context, node, kOutputRowSplitsStart + i);
     for (int j = 0; j < SizeOfDimension(row_splits, 0); ++j) {
       row_splits->data.i64[j] = j * row_splits_step;
     }
   }
 
-  // Generate the innermost row_splits and values tensors.
-  TfLiteTensor* row_splits = nested_row_splits.back();
-  TfLiteIntArray* output_shape = TfLiteIntArrayCreate(1);
-  DynamicBuffer buffer;
-  int token_index = 0;
-  int row_splits_index = 0;
-  for (const auto& tokens : list_of_tokens) {
-    row_splits->data.i64[row_splits_index] = token_index;
-    for (const auto& token : tokens) {
-      buffer.AddString(token.first, token.second);
-      ++token_index;
-    }
-    ++row_splits_index;
+  // The first pass writes the innermost row_splits, the second the values.
+  TfLiteTensor* row_splits =
+      GetOutput(context, node, kOutputRowSplitsStart + num_row_splits - 1);
+  int64_t* splits = row_splits->data.i64;
+  int64_t num_tokens = 0;
+  int64_t data_size = 0;
+  splits[0] = 0;
+  for (int i = 0; i < input_size; ++i) {
+    ForEachToken(GetString(input, i), [&](const char*, int len) {
+      ++num_tokens;
+      data_size += len;
+    });
+    splits[i + 1] = num_tokens;
+  }
+  TF_LITE_ENSURE(context, StringTensorSizeFits(num_tokens, data_size));
+
+  StringTensorWriter writer(num_tokens, data_size);
+  TF_LITE_ENSURE(context, writer.ok());
+  for (int i = 0; i < input_size; ++i) {
+    ForEachToken(GetString(input, i), [&](const char* start, int len) {
+      writer.AddString(start, len);
+    });
   }
-  row_splits->data.i64[row_splits_index] = token_index;
-  output_shape->data[0] = token_index;
-  buffer.WriteToTensor(output_values, output_shape);
+
+  TfLiteIntArray* output_shape = TfLiteIntArrayCreate(1);
+  output_shape->data[0] = num_tokens;
+  writer.WriteToTensor(output_values, output_shape);
   return kTfLiteOk;
 }
 
@@ -186,28 +292,13 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     input_size *= SizeOfDimension(input, i);
   }
 
-  std::vector<std::vector<std::pair<const char*, int>>> list_of_tokens;
-  list_of_tokens.reserve(input_size);
-  for (int i = 0; i < input_size; ++i) {
-    list_of_tokens.emplace_back(Tokenize(GetString(input, i)));
-  }
-
   TfLiteTensor* output_values = GetOutput(context, node, kOutputValues);
   TF_LITE_ENSURE(context, IsDynamicTensor(output_values));
 
   if (OutputIsPaddedTensor(node)) {
-    return WritePaddedOutput(list_of_tokens, input, output_values);
-  }
-
-  std::vector<TfLiteTensor*> nested_row_splits;
-  nested_row_splits.reserve(NumDimensions(input));
-  for (int i = 0; i < NumDimensions(input); ++i) {
-    TfLiteTensor* output_row_splits =
-        GetOutput(context, node, kOutputRowSplitsStart + i);
-    nested_row_splits.push_back(output_row_splits);
+    return WritePaddedOutput(context, input, input_size, output_values);
   }
-  return WriteRaggedOutput(list_of_tokens, input, output_values,
-                           nested_row_splits);
+  return WriteRaggedOutput(context, node, input, input_size, output_values);
 }
 
 }  // namespace whitespace_tokenizer
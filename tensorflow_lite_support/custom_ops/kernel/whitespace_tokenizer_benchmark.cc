@@ -0,0 +1,103 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Throughput benchmarks of the WhitespaceTokenizer op on batches of sentences
+// of several lengths, with ragged and padded outputs.
+//
+// Besides bytes per second, the `tokens_per_second` counter gives the number
+// of produced tokens per second.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow_lite_support/cc/port/benchmark.h"
+#include "tensorflow_lite_support/custom_ops/kernel/whitespace_tokenizer.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace whitespace_tokenizer {
+namespace {
+
+constexpr int kBatchSize = 256;
+
+// Words and separators, including multi-byte whitespace (U+3000) and
+// non-ASCII words to exercise the UTF-8 decoding.
+constexpr const char* kWords[] = {
+    "the", "quick", "brown", "fox",   "jumps", "over", "a",     "lazy",
+    "dog", "naïve", "café",  "東京", "while", "it",   "sleeps"};
+constexpr int kNumWords = sizeof(kWords) / sizeof(kWords[0]);
+constexpr const char* kSeparators[] = {" ",  " ",  " ", "  ",
+                                       "\t", "\n", "\xe3\x80\x80"};
+constexpr int kNumSeparators = sizeof(kSeparators) / sizeof(kSeparators[0]);
+
+class WhitespaceTokenizerBenchmarkModel : public SingleOpModel {
+ public:
+  // Builds the op over a batch of `kBatchSize` strings of `num_words` words
+  // each.
+  WhitespaceTokenizerBenchmarkModel(bool ragged, int num_words) {
+    input_ = AddInput(TensorType_STRING);
+    AddOutput(TensorType_STRING);
+    if (ragged) {
+      AddOutput(TensorType_INT64);
+    }
+    SetCustomOp("WhitespaceTokenizer", {}, Register_tftext_WhitespaceTokenizer);
+    BuildInterpreter({{kBatchSize}});
+
+    std::mt19937 rng(/*seed=*/42);
+    std::vector<std::string> batch(kBatchSize);
+    for (std::string& text : batch) {
+      for (int i = 0; i < num_words; ++i) {
+        if (i > 0) {
+          text.append(kSeparators[rng() % kNumSeparators]);
+        }
+        text.append(kWords[rng() % kNumWords]);
+      }
+      input_bytes_ += text.size();
+    }
+    PopulateStringTensor(input_, batch);
+  }
+
+  int64_t input_bytes() const { return input_bytes_; }
+
+ private:
+  int input_;
+  int64_t input_bytes_ = 0;
+};
+
+void BM_WhitespaceTokenizer(benchmark::State& state) {
+  const bool ragged = state.range(0) != 0;
+  const int num_words = state.range(1);
+  WhitespaceTokenizerBenchmarkModel model(ragged, num_words);
+  for (auto _ : state) {
+    model.Invoke();
+  }
+  state.SetItemsProcessed(state.iterations() * kBatchSize);
+  state.SetBytesProcessed(state.iterations() * model.input_bytes());
+  state.counters["tokens_per_second"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * kBatchSize * num_words,
+      benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_WhitespaceTokenizer)
+    ->ArgNames({"ragged", "words"})
+    ->ArgsProduct({{0, 1}, {8, 64, 512}});
+
+}  // namespace
+}  // namespace whitespace_tokenizer
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
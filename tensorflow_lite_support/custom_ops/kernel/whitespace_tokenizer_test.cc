@@ -182,6 +182,20 @@ TEST(WhitespaceTokenizerTest, MatrixRAGGEDOutput) {
                           "n", "o", "p", "q", "r"));
 }
 
+TEST(WhitespaceTokenizerTest, MixedWhitespaceAndUnicodeRaggedOutput) {
+  WhitespaceTokenizerModel m(
+      RAGGED,
+      {"  h\xc3\xa9llo \t\n w\xc3\xb6rld  ",
+       "a_token_that_is_longer_than_sixteen_bytes\tand\xe4\xb8\xad", "",
+       " \t "},
+      {4});
+  m.CheckRowSplits({2, 2, 0, 0});
+  EXPECT_THAT(m.ExtractValuesTensorVector(),
+              ElementsAre("h\xc3\xa9llo", "w\xc3\xb6rld",
+                          "a_token_that_is_longer_than_sixteen_bytes",
+                          "and\xe4\xb8\xad"));
+}
+
 }  // namespace test
 }  // namespace whitespace_tokenizer
 }  // namespace custom
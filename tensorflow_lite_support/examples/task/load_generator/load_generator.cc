@@ -0,0 +1,421 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Drives a Task API from several client threads and reports the throughput,
+// latency percentiles, CPU utilization and peak memory.
+//
+// Example usage:
+// bazel run -c opt \
+//  tensorflow_lite_support/examples/task/load_generator:load_generator \
+//  -- \
+//  --task=image_classifier \
+//  --model_path=/path/to/model.tflite \
+//  --inputs=/path/to/image1.jpg,/path/to/image2.jpg \
+//  --num_threads=8 \
+//  --arrival=poisson \
+//  --qps=200
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"  // from @com_google_absl
+#include "absl/flags/parse.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "absl/strings/str_split.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/integral_types.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/cc/task/core/proto/base_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/text/bert_nl_classifier.h"
+#include "tensorflow_lite_support/cc/task/text/bert_question_answerer.h"
+#include "tensorflow_lite_support/cc/task/text/nlclassifier/nl_classifier.h"
+#include "tensorflow_lite_support/cc/task/text/proto/bert_nl_classifier_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/text/proto/bert_question_answerer_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/text/proto/nl_classifier_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/core/frame_buffer.h"
+#include "tensorflow_lite_support/cc/task/vision/image_classifier.h"
+#include "tensorflow_lite_support/cc/task/vision/image_embedder.h"
+#include "tensorflow_lite_support/cc/task/vision/image_segmenter.h"
+#include "tensorflow_lite_support/cc/task/vision/object_detector.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/image_classifier_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/image_embedder_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/image_segmenter_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/proto/object_detector_options_proto_inc.h"
+#include "tensorflow_lite_support/cc/task/vision/utils/frame_buffer_common_utils.h"
+#include "tensorflow_lite_support/examples/task/load_generator/load_generator_lib.h"
+#include "tensorflow_lite_support/examples/task/vision/desktop/utils/image_utils.h"
+
+ABSL_FLAG(std::string, task, "",
+          "Task to run, one of: image_classifier, object_detector, "
+          "image_segmenter, image_embedder, nl_classifier, bert_nl_classifier, "
+          "bert_question_answerer.");
+ABSL_FLAG(std::string, model_path, "",
+          "Absolute path to the '.tflite' model, with metadata.");
+ABSL_FLAG(std::vector<std::string>, inputs, {},
+          "Comma-separated list of input files. For the vision tasks, RGB or "
+          "RGBA images. For the text tasks, text files with one input per "
+          "line; for bert_question_answerer, each line is a question and its "
+          "context separated by a tab.");
+ABSL_FLAG(int32, num_threads, 1, "Number of client threads.");
+ABSL_FLAG(std::string, arrival, "closed",
+          "How the clients issue requests: 'closed' (back to back), 'fixed' "
+          "(evenly spaced at --qps) or 'poisson' (open loop at --qps on "
+          "average).");
+ABSL_FLAG(double, qps, 0,
+          "Total number of requests per second, for the 'fixed' and "
+          "'poisson' arrivals.");
+ABSL_FLAG(std::string, instances, "per_thread",
+          "'per_thread' for one task instance per client thread, or 'shared' "
+          "for a pool of --pool_size instances shared by all the clients.");
+ABSL_FLAG(int32, pool_size, 1, "Number of instances of the shared pool.");
+ABSL_FLAG(double, duration_s, 10, "Duration of the measurement, in seconds.");
+ABSL_FLAG(int32, warmup_runs, 1,
+          "Number of untimed inferences per instance before the measurement.");
+ABSL_FLAG(int32, interpreter_threads, 1,
+          "Number of CPU threads used by each task instance.");
+ABSL_FLAG(int32, shared_cpu_budget, -1,
+          "If >= 0, the task instances draw their CPU threads from a "
+          "process-wide context with this many threads in total (0 for the "
+          "number of cores), instead of having their own thread pools. Not "
+          "supported by image_embedder.");
+ABSL_FLAG(int32, numa_node, -1,
+          "If >= 0, the interpreter threads of the task instances run on the "
+          "CPU cores of this NUMA node, with their memory allocated there. "
+          "Not supported by image_embedder.");
+ABSL_FLAG(bool, replicate_model_on_node, false,
+          "Whether the model is copied into memory local to `--numa_node`.");
+
+namespace tflite {
+namespace task {
+namespace load_generator {
+
+namespace {
+
+using ::tflite::support::StatusOr;
+using ::tflite::task::text::BertNLClassifier;
+using ::tflite::task::text::BertNLClassifierOptions;
+using ::tflite::task::text::BertQuestionAnswerer;
+using ::tflite::task::text::BertQuestionAnswererOptions;
+using ::tflite::task::text::NLClassifierOptions;
+using ::tflite::task::text::nlclassifier::NLClassifier;
+using ::tflite::task::vision::FrameBuffer;
+using ::tflite::task::vision::ImageClassifier;
+using ::tflite::task::vision::ImageClassifierOptions;
+using ::tflite::task::vision::ImageData;
+using ::tflite::task::vision::ImageEmbedder;
+using ::tflite::task::vision::ImageEmbedderOptions;
+using ::tflite::task::vision::ImageSegmenter;
+using ::tflite::task::vision::ImageSegmenterOptions;
+using ::tflite::task::vision::ObjectDetector;
+using ::tflite::task::vision::ObjectDetectorOptions;
+
+// Decoded images, shared read-only by all the task instances.
+class ImageCorpus {
+ public:
+  static StatusOr<std::unique_ptr<ImageCorpus>> Create(
+      const std::vector<std::string>& paths) {
+    std::unique_ptr<ImageCorpus> corpus(new ImageCorpus());
+    for (const std::string& path : paths) {
+      ASSIGN_OR_RETURN(ImageData image, vision::DecodeImageFromFile(path));
+      corpus->images_.push_back(image);
+      if (image.channels == 3) {
+        corpus->frame_buffers_.push_back(vision::CreateFromRgbRawBuffer(
+            image.pixel_data, {image.width, image.height}));
+      } else if (image.channels == 4) {
+        corpus->frame_buffers_.push_back(vision::CreateFromRgbaRawBuffer(
+            image.pixel_data, {image.width, image.height}));
+      } else {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Expected image with 3 (RGB) or 4 (RGBA) channels, found %d in %s",
+            image.channels, path));
+      }
+    }
+    return corpus;
+  }
+
+  ~ImageCorpus() {
+    for (ImageData& image : images_) {
+      vision::ImageDataFree(&image);
+    }
+  }
+
+  const FrameBuffer& Get(int index) const { return *frame_buffers_[index]; }
+  int size() const { return frame_buffers_.size(); }
+
+ private:
+  ImageCorpus() = default;
+
+  std::vector<ImageData> images_;
+  std::vector<std::unique_ptr<FrameBuffer>> frame_buffers_;
+};
+
+// Returns the non-empty lines of the files at `paths`.
+StatusOr<std::vector<std::string>> ReadLines(
+    const std::vector<std::string>& paths) {
+  std::vector<std::string> lines;
+  for (const std::string& path : paths) {
+    std::ifstream file(path);
+    if (!file) {
+      return absl::NotFoundError(absl::StrFormat("Unable to open %s", path));
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+      if (!line.empty()) {
+        lines.push_back(line);
+      }
+    }
+  }
+  if (lines.empty()) {
+    return absl::InvalidArgumentError("The input files are empty.");
+  }
+  return lines;
+}
+
+// Task instance owning a task and running `run` on it.
+template <typename TaskT>
+class TaskInstance : public TaskRunner {
+ public:
+  using RunFn = std::function<absl::Status(TaskT&, int)>;
+
+  TaskInstance(std::unique_ptr<TaskT> task, RunFn run)
+      : task_(std::move(task)), run_(std::move(run)) {}
+
+  absl::Status Run(int input_index) override {
+    return run_(*task_, input_index);
+  }
+
+ private:
+  std::unique_ptr<TaskT> task_;
+  RunFn run_;
+};
+
+// Returns a factory creating instances of TaskT from `options`, running `run`
+// for each request.
+template <typename TaskT, typename OptionsT>
+TaskRunnerFactory CreateFactory(const OptionsT& options,
+                                typename TaskInstance<TaskT>::RunFn run) {
+  return [options, run]() -> StatusOr<std::unique_ptr<TaskRunner>> {
+    ASSIGN_OR_RETURN(std::unique_ptr<TaskT> task,
+                     TaskT::CreateFromOptions(options));
+    return std::unique_ptr<TaskRunner>(
+        new TaskInstance<TaskT>(std::move(task), run));
+  };
+}
+
+template <typename OptionsT>
+OptionsT BuildOptions() {
+  OptionsT options;
+  options.mutable_base_options()->mutable_model_file()->set_file_name(
+      absl::GetFlag(FLAGS_model_path));
+  options.mutable_base_options()
+      ->mutable_compute_settings()
+      ->mutable_tflite_settings()
+      ->mutable_cpu_settings()
+      ->set_num_threads(absl::GetFlag(FLAGS_interpreter_threads));
+  if (absl::GetFlag(FLAGS_shared_cpu_budget) >= 0) {
+    options.mutable_base_options()
+        ->mutable_shared_cpu_context_options()
+        ->set_thread_budget(absl::GetFlag(FLAGS_shared_cpu_budget));
+  }
+  if (absl::GetFlag(FLAGS_numa_node) >= 0) {
+    tflite::task::core::CpuPlacementOptions* placement_options =
+        options.mutable_base_options()->mutable_cpu_placement_options();
+    placement_options->set_numa_node(absl::GetFlag(FLAGS_numa_node));
+    placement_options->set_replicate_model_on_node(
+        absl::GetFlag(FLAGS_replicate_model_on_node));
+  }
+  return options;
+}
+
+// Owns the inputs of the corpus, which must outlive the factory.
+struct Workload {
+  std::unique_ptr<ImageCorpus> images;
+  std::vector<std::string> texts;
+  std::vector<std::pair<std::string, std::string>> questions_and_contexts;
+  int num_inputs = 0;
+  TaskRunnerFactory factory;
+};
+
+absl::Status CreateVisionWorkload(const std::string& task,
+                                  Workload* workload) {
+  ASSIGN_OR_RETURN(workload->images,
+                   ImageCorpus::Create(absl::GetFlag(FLAGS_inputs)));
+  workload->num_inputs = workload->images->size();
+  const ImageCorpus* images = workload->images.get();
+  if (task == "image_classifier") {
+    workload->factory = CreateFactory<ImageClassifier>(
+        BuildOptions<ImageClassifierOptions>(),
+        [images](ImageClassifier& classifier, int index) {
+          return classifier.Classify(images->Get(index)).status();
+        });
+  } else if (task == "object_detector") {
+    workload->factory = CreateFactory<ObjectDetector>(
+        BuildOptions<ObjectDetectorOptions>(),
+        [images](ObjectDetector& detector, int index) {
+          return detector.Detect(images->Get(index)).status();
+        });
+  } else if (task == "image_segmenter") {
+    workload->factory = CreateFactory<ImageSegmenter>(
+        BuildOptions<ImageSegmenterOptions>(),
+        [images](ImageSegmenter& segmenter, int index) {
+          return segmenter.Segment(images->Get(index)).status();
+        });
+  } else {
+    // ImageEmbedderOptions has no `base_options` yet.
+    ImageEmbedderOptions options;
+    options.mutable_model_file_with_metadata()->set_file_name(
+        absl::GetFlag(FLAGS_model_path));
+    options.set_num_threads(absl::GetFlag(FLAGS_interpreter_threads));
+    workload->factory = CreateFactory<ImageEmbedder>(
+        options, [images](ImageEmbedder& embedder, int index) {
+          return embedder.Embed(images->Get(index)).status();
+        });
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CreateTextWorkload(const std::string& task, Workload* workload) {
+  ASSIGN_OR_RETURN(std::vector<std::string> lines,
+                   ReadLines(absl::GetFlag(FLAGS_inputs)));
+  workload->num_inputs = lines.size();
+  if (task == "bert_question_answerer") {
+    for (const std::string& line : lines) {
+      std::vector<std::string> fields = absl::StrSplit(line, '\t');
+      if (fields.size() != 2) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Expected a question and a context separated by a tab, got: %s",
+            line));
+      }
+      workload->questions_and_contexts.emplace_back(fields[0], fields[1]);
+    }
+    const auto* inputs = &workload->questions_and_contexts;
+    workload->factory = CreateFactory<BertQuestionAnswerer>(
+        BuildOptions<BertQuestionAnswererOptions>(),
+        [inputs](BertQuestionAnswerer& answerer, int index) {
+          const auto& question_and_context = (*inputs)[index];
+          answerer.Answer(question_and_context.second,
+                          question_and_context.first);
+          return absl::OkStatus();
+        });
+    return absl::OkStatus();
+  }
+  workload->texts = std::move(lines);
+  const std::vector<std::string>* texts = &workload->texts;
+  if (task == "nl_classifier") {
+    workload->factory = CreateFactory<NLClassifier>(
+        BuildOptions<NLClassifierOptions>(),
+        [texts](NLClassifier& classifier, int index) {
+          classifier.Classify((*texts)[index]);
+          return absl::OkStatus();
+        });
+  } else {
+    workload->factory = CreateFactory<BertNLClassifier>(
+        BuildOptions<BertNLClassifierOptions>(),
+        [texts](BertNLClassifier& classifier, int index) {
+          classifier.Classify((*texts)[index]);
+          return absl::OkStatus();
+        });
+  }
+  return absl::OkStatus();
+}
+
+StatusOr<LoadOptions> BuildLoadOptions(int num_inputs) {
+  LoadOptions options;
+  options.num_threads = absl::GetFlag(FLAGS_num_threads);
+  const std::string arrival = absl::GetFlag(FLAGS_arrival);
+  if (arrival == "closed") {
+    options.arrival_process = ArrivalProcess::kClosedLoop;
+  } else if (arrival == "fixed") {
+    options.arrival_process = ArrivalProcess::kFixedRate;
+  } else if (arrival == "poisson") {
+    options.arrival_process = ArrivalProcess::kPoisson;
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unknown arrival '%s'.", arrival));
+  }
+  options.target_qps = absl::GetFlag(FLAGS_qps);
+  const std::string instances = absl::GetFlag(FLAGS_instances);
+  if (instances == "per_thread") {
+    options.instance_mode = InstanceMode::kPerThread;
+  } else if (instances == "shared") {
+    options.instance_mode = InstanceMode::kSharedPool;
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unknown instances '%s'.", instances));
+  }
+  options.pool_size = absl::GetFlag(FLAGS_pool_size);
+  options.duration = absl::Seconds(absl::GetFlag(FLAGS_duration_s));
+  options.warmup_runs = absl::GetFlag(FLAGS_warmup_runs);
+  options.num_inputs = num_inputs;
+  return options;
+}
+
+}  // namespace
+
+absl::Status Run() {
+  const std::string task = absl::GetFlag(FLAGS_task);
+  Workload workload;
+  if (task == "image_classifier" || task == "object_detector" ||
+      task == "image_segmenter" || task == "image_embedder") {
+    RETURN_IF_ERROR(CreateVisionWorkload(task, &workload));
+  } else if (task == "nl_classifier" || task == "bert_nl_classifier" ||
+             task == "bert_question_answerer") {
+    RETURN_IF_ERROR(CreateTextWorkload(task, &workload));
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unknown task '%s'.", task));
+  }
+  ASSIGN_OR_RETURN(LoadOptions options, BuildLoadOptions(workload.num_inputs));
+
+  std::cout << absl::StrFormat(
+      "Running %s with %d client thread(s) for %.1f s...\n", task,
+      options.num_threads, absl::ToDoubleSeconds(options.duration));
+  ASSIGN_OR_RETURN(LoadReport report, RunLoad(options, workload.factory));
+  std::cout << FormatReport(report);
+  return absl::OkStatus();
+}
+
+}  // namespace load_generator
+}  // namespace task
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  // Parse command line arguments and perform sanity checks.
+  absl::ParseCommandLine(argc, argv);
+  if (absl::GetFlag(FLAGS_model_path).empty()) {
+    std::cerr << "Missing mandatory 'model_path' argument.\n";
+    return 1;
+  }
+  if (absl::GetFlag(FLAGS_inputs).empty()) {
+    std::cerr << "Missing mandatory 'inputs' argument.\n";
+    return 1;
+  }
+
+  // Run the load.
+  absl::Status status = tflite::task::load_generator::Run();
+  if (status.ok()) {
+    return 0;
+  } else {
+    std::cerr << "Load generation failed: " << status.message() << "\n";
+    return 1;
+  }
+}
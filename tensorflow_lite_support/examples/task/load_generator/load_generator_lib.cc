@@ -0,0 +1,339 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/examples/task/load_generator/load_generator_lib.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+
+namespace tflite {
+namespace task {
+namespace load_generator {
+
+namespace internal {
+
+LatencySummary Summarize(std::vector<int64_t>* latencies_ns) {
+  LatencySummary summary;
+  if (latencies_ns->empty()) {
+    return summary;
+  }
+  std::sort(latencies_ns->begin(), latencies_ns->end());
+  const size_t count = latencies_ns->size();
+  auto percentile = [&](double fraction) {
+    size_t index = static_cast<size_t>(std::ceil(fraction * count));
+    index = std::min(std::max(index, size_t{1}), count) - 1;
+    return absl::Nanoseconds((*latencies_ns)[index]);
+  };
+  double sum_ns = 0;
+  for (int64_t latency_ns : *latencies_ns) {
+    sum_ns += latency_ns;
+  }
+  summary.mean = absl::Nanoseconds(sum_ns / count);
+  summary.p50 = percentile(0.5);
+  summary.p90 = percentile(0.9);
+  summary.p99 = percentile(0.99);
+  summary.p999 = percentile(0.999);
+  summary.max = absl::Nanoseconds(latencies_ns->back());
+  return summary;
+}
+
+absl::Status ValidateOptions(const LoadOptions& options) {
+  if (options.num_threads < 1) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Expected at least 1 client thread, got %d.", options.num_threads));
+  }
+  if (options.arrival_process != ArrivalProcess::kClosedLoop &&
+      options.target_qps <= 0) {
+    return absl::InvalidArgumentError(
+        "A positive target QPS is required for open-loop arrivals.");
+  }
+  if (options.instance_mode == InstanceMode::kSharedPool &&
+      options.pool_size < 1) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Expected a pool of at least 1 instance, got %d.", options.pool_size));
+  }
+  if (options.duration <= absl::ZeroDuration()) {
+    return absl::InvalidArgumentError("Expected a positive duration.");
+  }
+  if (options.num_inputs < 1) {
+    return absl::InvalidArgumentError("Expected a non-empty input corpus.");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace internal
+
+namespace {
+
+using ::tflite::support::StatusOr;
+using ::tflite::task::load_generator::internal::Summarize;
+using ::tflite::task::load_generator::internal::ValidateOptions;
+
+// Pool of task instances borrowed by the client threads for each request.
+class InstancePool {
+ public:
+  explicit InstancePool(
+      const std::vector<std::unique_ptr<TaskRunner>>& runners) {
+    for (const auto& runner : runners) {
+      free_.push_back(runner.get());
+    }
+  }
+
+  // Blocks until an instance is available and returns it.
+  TaskRunner* Acquire() {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(this, &InstancePool::HasFreeInstance));
+    TaskRunner* runner = free_.back();
+    free_.pop_back();
+    return runner;
+  }
+
+  void Release(TaskRunner* runner) {
+    absl::MutexLock lock(&mutex_);
+    free_.push_back(runner);
+  }
+
+ private:
+  bool HasFreeInstance() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !free_.empty();
+  }
+
+  absl::Mutex mutex_;
+  std::vector<TaskRunner*> free_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Measurements of a client thread.
+struct ClientResult {
+  std::vector<int64_t> latencies_ns;
+  std::vector<int64_t> service_times_ns;
+  int64_t num_errors = 0;
+  absl::Status first_error;
+  int64_t num_dropped = 0;
+};
+
+// CPU time (user and system) consumed by the process so far.
+absl::Duration GetProcessCpuTime() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return absl::DurationFromTimeval(usage.ru_utime) +
+         absl::DurationFromTimeval(usage.ru_stime);
+}
+
+int64_t GetPeakRssBytes() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  // Reported in kilobytes on Linux.
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+}
+
+// Issues requests from `start` until `end`, running them on the instances
+// returned by `acquire`, which are then given back to `release`. For open-loop
+// arrivals, the requests still due when `end` is reached are dropped, so that
+// a client which fell behind the schedule does not overrun the measurement.
+template <typename AcquireFn, typename ReleaseFn>
+void RunClient(const LoadOptions& options, int client_index, absl::Time start,
+               absl::Time end, AcquireFn acquire, ReleaseFn release,
+               ClientResult* result) {
+  const bool open_loop =
+      options.arrival_process != ArrivalProcess::kClosedLoop;
+  const double client_qps = options.target_qps / options.num_threads;
+  const absl::Duration interval =
+      open_loop ? absl::Seconds(1 / client_qps) : absl::ZeroDuration();
+  std::mt19937_64 rng(/*seed=*/client_index + 1);
+  std::exponential_distribution<double> exponential(open_loop ? client_qps
+                                                              : 1.0);
+  auto next_interval = [&]() {
+    return options.arrival_process == ArrivalProcess::kPoisson
+               ? absl::Seconds(exponential(rng))
+               : interval;
+  };
+
+  // Spread the first requests and inputs of the clients.
+  absl::Time scheduled =
+      options.arrival_process == ArrivalProcess::kFixedRate
+          ? start + interval * client_index / options.num_threads
+          : start + (open_loop ? next_interval() : absl::ZeroDuration());
+  int input_index =
+      static_cast<int>(static_cast<int64_t>(client_index) *
+                       options.num_inputs / options.num_threads);
+  while (true) {
+    absl::Time now = absl::Now();
+    if (open_loop) {
+      if (scheduled >= end) {
+        break;
+      }
+      if (now >= end) {
+        for (; scheduled < end; scheduled += next_interval()) {
+          ++result->num_dropped;
+        }
+        break;
+      }
+      if (scheduled > now) {
+        absl::SleepFor(scheduled - now);
+      }
+    } else {
+      if (now >= end) {
+        break;
+      }
+      scheduled = now;
+    }
+    TaskRunner* runner = acquire();
+    const absl::Time run_start = absl::Now();
+    absl::Status status = runner->Run(input_index);
+    const absl::Time run_end = absl::Now();
+    release(runner);
+
+    if (status.ok()) {
+      result->latencies_ns.push_back(
+          absl::ToInt64Nanoseconds(run_end - scheduled));
+      result->service_times_ns.push_back(
+          absl::ToInt64Nanoseconds(run_end - run_start));
+    } else {
+      if (result->num_errors == 0) {
+        result->first_error = status;
+      }
+      ++result->num_errors;
+    }
+    input_index = (input_index + 1) % options.num_inputs;
+    scheduled += next_interval();
+  }
+}
+
+}  // namespace
+
+StatusOr<LoadReport> RunLoad(const LoadOptions& options,
+                             const TaskRunnerFactory& factory) {
+  RETURN_IF_ERROR(ValidateOptions(options));
+
+  // Create and warm up the instances.
+  const int num_instances = options.instance_mode == InstanceMode::kPerThread
+                                ? options.num_threads
+                                : options.pool_size;
+  std::vector<std::unique_ptr<TaskRunner>> runners;
+  runners.reserve(num_instances);
+  for (int i = 0; i < num_instances; ++i) {
+    ASSIGN_OR_RETURN(std::unique_ptr<TaskRunner> runner, factory());
+    for (int run = 0; run < options.warmup_runs; ++run) {
+      RETURN_IF_ERROR(runner->Run(run % options.num_inputs));
+    }
+    runners.push_back(std::move(runner));
+  }
+  InstancePool pool(runners);
+
+  // Run the client threads.
+  std::vector<ClientResult> results(options.num_threads);
+  const absl::Duration start_cpu_time = GetProcessCpuTime();
+  const absl::Time start = absl::Now();
+  const absl::Time end = start + options.duration;
+  std::vector<std::thread> clients;
+  clients.reserve(options.num_threads);
+  for (int i = 0; i < options.num_threads; ++i) {
+    if (options.instance_mode == InstanceMode::kPerThread) {
+      TaskRunner* runner = runners[i].get();
+      clients.emplace_back([&options, &results, i, start, end, runner] {
+        RunClient(
+            options, i, start, end, [runner] { return runner; },
+            [](TaskRunner*) {}, &results[i]);
+      });
+    } else {
+      clients.emplace_back([&options, &results, &pool, i, start, end] {
+        RunClient(
+            options, i, start, end, [&pool] { return pool.Acquire(); },
+            [&pool](TaskRunner* runner) { pool.Release(runner); },
+            &results[i]);
+      });
+    }
+  }
+  for (std::thread& client : clients) {
+    client.join();
+  }
+
+  LoadReport report;
+  report.elapsed = absl::Now() - start;
+  const absl::Duration cpu_time = GetProcessCpuTime() - start_cpu_time;
+  report.cpu_cores_used = absl::FDivDuration(cpu_time, report.elapsed);
+  report.cpu_utilization =
+      report.cpu_cores_used /
+      std::max(1u, std::thread::hardware_concurrency());
+  report.peak_rss_bytes = GetPeakRssBytes();
+
+  std::vector<int64_t> latencies_ns;
+  std::vector<int64_t> service_times_ns;
+  for (ClientResult& result : results) {
+    latencies_ns.insert(latencies_ns.end(), result.latencies_ns.begin(),
+                        result.latencies_ns.end());
+    service_times_ns.insert(service_times_ns.end(),
+                            result.service_times_ns.begin(),
+                            result.service_times_ns.end());
+    if (report.num_errors == 0 && result.num_errors > 0) {
+      report.first_error = result.first_error;
+    }
+    report.num_errors += result.num_errors;
+    report.num_dropped += result.num_dropped;
+  }
+  report.num_requests = latencies_ns.size();
+  report.throughput_qps =
+      report.num_requests / absl::ToDoubleSeconds(report.elapsed);
+  report.latency = Summarize(&latencies_ns);
+  report.service_time = Summarize(&service_times_ns);
+  return report;
+}
+
+std::string FormatReport(const LoadReport& report) {
+  auto format_latency = [](const LatencySummary& summary) {
+    return absl::StrFormat(
+        "mean %.3f  p50 %.3f  p90 %.3f  p99 %.3f  p99.9 %.3f  max %.3f",
+        absl::ToDoubleMilliseconds(summary.mean),
+        absl::ToDoubleMilliseconds(summary.p50),
+        absl::ToDoubleMilliseconds(summary.p90),
+        absl::ToDoubleMilliseconds(summary.p99),
+        absl::ToDoubleMilliseconds(summary.p999),
+        absl::ToDoubleMilliseconds(summary.max));
+  };
+  std::string formatted = absl::StrFormat(
+      "Requests          : %d completed, %d failed, %d dropped\n"
+      "Elapsed           : %.2f s\n"
+      "Throughput        : %.1f QPS\n"
+      "Latency (ms)      : %s\n"
+      "Service time (ms) : %s\n"
+      "CPU               : %.2f cores (%.1f%% of the machine)\n"
+      "Peak RSS          : %.1f MiB\n",
+      report.num_requests, report.num_errors, report.num_dropped,
+      absl::ToDoubleSeconds(report.elapsed), report.throughput_qps,
+      format_latency(report.latency), format_latency(report.service_time),
+      report.cpu_cores_used, 100 * report.cpu_utilization,
+      report.peak_rss_bytes / (1024.0 * 1024.0));
+  if (!report.first_error.ok()) {
+    absl::StrAppendFormat(&formatted, "First error       : %s\n",
+                          report.first_error.ToString());
+  }
+  return formatted;
+}
+
+}  // namespace load_generator
+}  // namespace task
+}  // namespace tflite
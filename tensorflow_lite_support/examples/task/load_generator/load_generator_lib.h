@@ -0,0 +1,158 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_EXAMPLES_TASK_LOAD_GENERATOR_LOAD_GENERATOR_LIB_H_
+#define TENSORFLOW_LITE_SUPPORT_EXAMPLES_TASK_LOAD_GENERATOR_LOAD_GENERATOR_LIB_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/statusor.h"
+
+namespace tflite {
+namespace task {
+namespace load_generator {
+
+// A task instance running inferences on the inputs of a corpus. Instances do
+// not need to be thread-safe: each one is used by a single thread at a time.
+class TaskRunner {
+ public:
+  virtual ~TaskRunner() = default;
+
+  // Runs one inference on the input at `input_index` in the corpus.
+  virtual absl::Status Run(int input_index) = 0;
+};
+
+// Creates a new task instance. Called once per instance before the load
+// starts.
+using TaskRunnerFactory = std::function<
+    tflite::support::StatusOr<std::unique_ptr<TaskRunner>>()>;
+
+// How the client threads issue their requests.
+enum class ArrivalProcess {
+  // Each client issues its next request as soon as the previous one completes.
+  kClosedLoop,
+  // Requests are scheduled at evenly spaced times, at the target rate.
+  kFixedRate,
+  // Requests are scheduled at exponentially distributed intervals, at the
+  // target rate on average.
+  kPoisson,
+};
+
+// How the task instances are shared between the client threads.
+enum class InstanceMode {
+  // Each client thread owns its task instance.
+  kPerThread,
+  // The client threads borrow instances from a shared pool for each request,
+  // waiting for one to be available if needed.
+  kSharedPool,
+};
+
+struct LoadOptions {
+  // Number of client threads.
+  int num_threads = 1;
+
+  ArrivalProcess arrival_process = ArrivalProcess::kClosedLoop;
+
+  // Total number of requests per second over all the client threads. Required
+  // for kFixedRate and kPoisson, ignored for kClosedLoop.
+  double target_qps = 0;
+
+  InstanceMode instance_mode = InstanceMode::kPerThread;
+
+  // Number of task instances of the pool, for kSharedPool.
+  int pool_size = 1;
+
+  // Duration of the measurement.
+  absl::Duration duration = absl::Seconds(10);
+
+  // Number of untimed inferences run by each instance before the measurement,
+  // so that lazy initializations are excluded.
+  int warmup_runs = 1;
+
+  // Number of inputs in the corpus. The inputs are used in a round-robin
+  // fashion by each client thread, starting at different offsets.
+  int num_inputs = 1;
+};
+
+struct LatencySummary {
+  absl::Duration mean;
+  absl::Duration p50;
+  absl::Duration p90;
+  absl::Duration p99;
+  absl::Duration p999;
+  absl::Duration max;
+};
+
+struct LoadReport {
+  // Number of completed and failed requests during the measurement.
+  int64_t num_requests = 0;
+  int64_t num_errors = 0;
+  // Number of requests scheduled during the measurement which were never
+  // issued, because their client was still late on the schedule at its end.
+  // Always 0 for kClosedLoop.
+  int64_t num_dropped = 0;
+  // Status of the first failed request, if any.
+  absl::Status first_error;
+
+  absl::Duration elapsed;
+  // Completed requests per second.
+  double throughput_qps = 0;
+
+  // Latency as seen by the clients: for kFixedRate and kPoisson, from the
+  // scheduled time of each request, so that the queueing delays caused by
+  // an overloaded server are accounted for.
+  LatencySummary latency;
+  // Time spent running the inference only, excluding the wait for a pooled
+  // instance and the scheduling delays.
+  LatencySummary service_time;
+
+  // Average number of CPU cores used by the process during the measurement,
+  // and the same value as a fraction of the available cores.
+  double cpu_cores_used = 0;
+  double cpu_utilization = 0;
+  // Peak resident set size of the process, in bytes.
+  int64_t peak_rss_bytes = 0;
+};
+
+// Creates the task instances with `factory`, drives them from the client
+// threads as configured by `options` and reports the measurements.
+tflite::support::StatusOr<LoadReport> RunLoad(const LoadOptions& options,
+                                              const TaskRunnerFactory& factory);
+
+// Returns a human readable multi-line description of `report`.
+std::string FormatReport(const LoadReport& report);
+
+namespace internal {
+
+// Returns an InvalidArgumentError if `options` cannot be run.
+absl::Status ValidateOptions(const LoadOptions& options);
+
+// Sorts `latencies_ns` and returns their mean, nearest-rank percentiles and
+// maximum, or zero durations if there are none.
+LatencySummary Summarize(std::vector<int64_t>* latencies_ns);
+
+}  // namespace internal
+
+}  // namespace load_generator
+}  // namespace task
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_EXAMPLES_TASK_LOAD_GENERATOR_LOAD_GENERATOR_LIB_H_
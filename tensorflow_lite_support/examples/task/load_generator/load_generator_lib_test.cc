@@ -0,0 +1,232 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/examples/task/load_generator/load_generator_lib.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/time/clock.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/status_matchers.h"
+#include "tensorflow_lite_support/cc/port/statusor.h"
+
+namespace tflite {
+namespace task {
+namespace load_generator {
+namespace {
+
+using ::tflite::support::StatusOr;
+using ::tflite::task::load_generator::internal::Summarize;
+using ::tflite::task::load_generator::internal::ValidateOptions;
+
+// Counters shared by the fake task instances.
+struct FakeTaskCounters {
+  std::atomic<int> num_instances{0};
+  std::atomic<int64_t> num_runs{0};
+  // Number of inferences currently running, and its maximum.
+  std::atomic<int> num_running{0};
+  std::atomic<int> max_running{0};
+};
+
+// Task whose inferences sleep for a fixed time.
+class FakeTaskRunner : public TaskRunner {
+ public:
+  FakeTaskRunner(absl::Duration run_time, FakeTaskCounters* counters)
+      : run_time_(run_time), counters_(counters) {}
+
+  absl::Status Run(int input_index) override {
+    const int num_running = ++counters_->num_running;
+    int max_running = counters_->max_running.load();
+    while (num_running > max_running &&
+           !counters_->max_running.compare_exchange_weak(max_running,
+                                                         num_running)) {
+    }
+    absl::SleepFor(run_time_);
+    --counters_->num_running;
+    ++counters_->num_runs;
+    return absl::OkStatus();
+  }
+
+ private:
+  const absl::Duration run_time_;
+  FakeTaskCounters* counters_;
+};
+
+TaskRunnerFactory CreateFakeTaskFactory(absl::Duration run_time,
+                                        FakeTaskCounters* counters) {
+  return [run_time, counters]() -> StatusOr<std::unique_ptr<TaskRunner>> {
+    ++counters->num_instances;
+    return absl::make_unique<FakeTaskRunner>(run_time, counters);
+  };
+}
+
+TEST(SummarizeTest, ComputesNearestRankPercentiles) {
+  std::vector<int64_t> latencies_ns;
+  for (int i = 1; i <= 1000; ++i) {
+    latencies_ns.push_back(i);
+  }
+  std::shuffle(latencies_ns.begin(), latencies_ns.end(),
+               std::mt19937(/*seed=*/42));
+
+  const LatencySummary summary = Summarize(&latencies_ns);
+
+  EXPECT_EQ(summary.mean, absl::Nanoseconds(500.5));
+  EXPECT_EQ(summary.p50, absl::Nanoseconds(500));
+  EXPECT_EQ(summary.p90, absl::Nanoseconds(900));
+  EXPECT_EQ(summary.p99, absl::Nanoseconds(990));
+  EXPECT_EQ(summary.p999, absl::Nanoseconds(999));
+  EXPECT_EQ(summary.max, absl::Nanoseconds(1000));
+}
+
+TEST(SummarizeTest, SucceedsWithFewLatencies) {
+  std::vector<int64_t> latencies_ns = {30, 10};
+
+  const LatencySummary summary = Summarize(&latencies_ns);
+
+  EXPECT_EQ(summary.mean, absl::Nanoseconds(20));
+  EXPECT_EQ(summary.p50, absl::Nanoseconds(10));
+  EXPECT_EQ(summary.p90, absl::Nanoseconds(30));
+  EXPECT_EQ(summary.p999, absl::Nanoseconds(30));
+  EXPECT_EQ(summary.max, absl::Nanoseconds(30));
+}
+
+TEST(SummarizeTest, SucceedsWithNoLatencies) {
+  std::vector<int64_t> latencies_ns;
+
+  const LatencySummary summary = Summarize(&latencies_ns);
+
+  EXPECT_EQ(summary.mean, absl::ZeroDuration());
+  EXPECT_EQ(summary.p50, absl::ZeroDuration());
+  EXPECT_EQ(summary.max, absl::ZeroDuration());
+}
+
+TEST(ValidateOptionsTest, SucceedsWithDefaultOptions) {
+  SUPPORT_EXPECT_OK(ValidateOptions(LoadOptions()));
+}
+
+TEST(ValidateOptionsTest, FailsWithInvalidOptions) {
+  LoadOptions no_threads;
+  no_threads.num_threads = 0;
+  LoadOptions open_loop_without_qps;
+  open_loop_without_qps.arrival_process = ArrivalProcess::kPoisson;
+  LoadOptions empty_pool;
+  empty_pool.instance_mode = InstanceMode::kSharedPool;
+  empty_pool.pool_size = 0;
+  LoadOptions no_duration;
+  no_duration.duration = absl::ZeroDuration();
+  LoadOptions no_inputs;
+  no_inputs.num_inputs = 0;
+
+  for (const LoadOptions& options :
+       {no_threads, open_loop_without_qps, empty_pool, no_duration,
+        no_inputs}) {
+    EXPECT_EQ(ValidateOptions(options).code(),
+              absl::StatusCode::kInvalidArgument);
+  }
+}
+
+TEST(RunLoadTest, FailsWithInvalidOptions) {
+  FakeTaskCounters counters;
+  LoadOptions options;
+  options.num_threads = 0;
+
+  StatusOr<LoadReport> report = RunLoad(
+      options, CreateFakeTaskFactory(absl::Milliseconds(1), &counters));
+
+  EXPECT_EQ(report.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(counters.num_instances, 0);
+}
+
+TEST(RunLoadTest, CountsClosedLoopRequests) {
+  FakeTaskCounters counters;
+  LoadOptions options;
+  options.num_threads = 2;
+  options.duration = absl::Milliseconds(100);
+  options.warmup_runs = 3;
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      LoadReport report,
+      RunLoad(options,
+              CreateFakeTaskFactory(absl::Milliseconds(1), &counters)));
+
+  EXPECT_EQ(counters.num_instances, 2);
+  // All the runs but the warm-up ones are measured.
+  EXPECT_GT(report.num_requests, 0);
+  EXPECT_EQ(report.num_requests + 2 * options.warmup_runs, counters.num_runs);
+  EXPECT_EQ(report.num_errors, 0);
+  EXPECT_EQ(report.num_dropped, 0);
+  EXPECT_GE(report.service_time.p50, absl::Milliseconds(1));
+  EXPECT_GE(report.latency.max, report.service_time.max);
+  EXPECT_GE(report.elapsed, options.duration);
+}
+
+TEST(RunLoadTest, SharedPoolLendsAtMostPoolSizeInstances) {
+  FakeTaskCounters counters;
+  LoadOptions options;
+  options.num_threads = 6;
+  options.instance_mode = InstanceMode::kSharedPool;
+  options.pool_size = 2;
+  options.duration = absl::Milliseconds(100);
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      LoadReport report,
+      RunLoad(options,
+              CreateFakeTaskFactory(absl::Milliseconds(2), &counters)));
+
+  EXPECT_EQ(counters.num_instances, 2);
+  EXPECT_GT(report.num_requests, 0);
+  EXPECT_LE(counters.max_running, 2);
+}
+
+TEST(RunLoadTest, OpenLoopEndsNearTheDurationWhenLate) {
+  for (ArrivalProcess arrival_process :
+       {ArrivalProcess::kFixedRate, ArrivalProcess::kPoisson}) {
+    FakeTaskCounters counters;
+    LoadOptions options;
+    options.num_threads = 2;
+    options.arrival_process = arrival_process;
+    // 2.5 times more requests than the clients can run.
+    options.target_qps = 1000;
+    options.duration = absl::Milliseconds(200);
+
+    SUPPORT_ASSERT_OK_AND_ASSIGN(
+        LoadReport report,
+        RunLoad(options,
+                CreateFakeTaskFactory(absl::Milliseconds(5), &counters)));
+
+    // Without dropping the late requests, the run would take 500 ms.
+    EXPECT_LT(report.elapsed, options.duration + absl::Milliseconds(100));
+    EXPECT_GT(report.num_requests, 0);
+    EXPECT_GT(report.num_dropped, 0);
+    if (arrival_process == ArrivalProcess::kFixedRate) {
+      // Each client has 100 requests scheduled during the measurement.
+      EXPECT_NEAR(report.num_requests + report.num_dropped, 200, 2);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace load_generator
+}  // namespace task
+}  // namespace tflite
@@ -0,0 +1,95 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Compiles a text vocabulary file into the format read by CompiledVocab,
+// which can then replace the vocabulary associated file of a BertTokenizer or
+// RegexTokenizer in the model metadata.
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "absl/flags/flag.h"  // from @com_google_absl
+#include "absl/flags/parse.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "tensorflow_lite_support/cc/text/tokenizers/compiled_vocab.h"
+
+ABSL_FLAG(std::string, vocab_path, "",
+          "Absolute path to the text vocabulary file to compile.");
+ABSL_FLAG(std::string, output_path, "",
+          "Absolute path to the compiled vocabulary file to write.");
+ABSL_FLAG(bool, with_ids, false,
+          "If true, each line of the vocabulary holds a word and its id "
+          "separated by a space, as for RegexTokenizer. Otherwise, each line "
+          "holds a word whose id is its line number, as for BertTokenizer.");
+
+namespace tflite {
+namespace support {
+namespace text {
+namespace tokenizer {
+
+absl::Status CompileVocab() {
+  std::ifstream input(absl::GetFlag(FLAGS_vocab_path), std::ios::binary);
+  if (!input) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Unable to read vocabulary: %s", absl::GetFlag(FLAGS_vocab_path)));
+  }
+  std::stringstream text_vocab;
+  text_vocab << input.rdbuf();
+
+  const std::string compiled_vocab = BuildCompiledVocabFromText(
+      text_vocab.str(), absl::GetFlag(FLAGS_with_ids));
+
+  std::ofstream output(absl::GetFlag(FLAGS_output_path),
+                       std::ios::binary | std::ios::trunc);
+  output.write(compiled_vocab.data(), compiled_vocab.size());
+  output.close();
+  if (!output) {
+    return absl::UnknownError(absl::StrFormat(
+        "Unable to write compiled vocabulary: %s",
+        absl::GetFlag(FLAGS_output_path)));
+  }
+  std::cout << absl::StrFormat("Wrote %d bytes to %s\n", compiled_vocab.size(),
+                               absl::GetFlag(FLAGS_output_path));
+  return absl::OkStatus();
+}
+
+}  // namespace tokenizer
+}  // namespace text
+}  // namespace support
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  // Parse command line arguments and perform sanity checks.
+  absl::ParseCommandLine(argc, argv);
+  if (absl::GetFlag(FLAGS_vocab_path).empty()) {
+    std::cerr << "Missing mandatory 'vocab_path' argument.\n";
+    return 1;
+  }
+  if (absl::GetFlag(FLAGS_output_path).empty()) {
+    std::cerr << "Missing mandatory 'output_path' argument.\n";
+    return 1;
+  }
+
+  absl::Status status = tflite::support::text::tokenizer::CompileVocab();
+  if (status.ok()) {
+    return 0;
+  } else {
+    std::cerr << "Compilation failed: " << status.message() << "\n";
+    return 1;
+  }
+}
@@ -83,6 +83,17 @@ ModelMetadataExtractor::CreateFromModelBuffer(const char* buffer_data,
   return extractor;
 }
 
+/* static */
+tflite::support::StatusOr<std::unique_ptr<ModelMetadataExtractor>>
+ModelMetadataExtractor::CreateFromVerifiedModelBuffer(const char* buffer_data,
+                                                      size_t buffer_size) {
+  std::unique_ptr<ModelMetadataExtractor> extractor =
+      absl::WrapUnique(new ModelMetadataExtractor());
+  RETURN_IF_ERROR(extractor->InitFromModelBuffer(buffer_data, buffer_size,
+                                                 /*verify=*/false));
+  return extractor;
+}
+
 /* static */
 tflite::support::StatusOr<const tflite::ProcessUnit*>
 ModelMetadataExtractor::FindFirstProcessUnit(
@@ -128,17 +139,19 @@ std::string ModelMetadataExtractor::FindFirstAssociatedFileName(
 }
 
 absl::Status ModelMetadataExtractor::InitFromModelBuffer(
-    const char* buffer_data, size_t buffer_size) {
+    const char* buffer_data, size_t buffer_size, bool verify) {
   // Rely on the simplest, base flatbuffers verifier. Here is not the place to
   // e.g. use an OpResolver: we just want to make sure the buffer is valid to
   // access the metadata.
-  flatbuffers::Verifier verifier = flatbuffers::Verifier(
-      reinterpret_cast<const uint8_t*>(buffer_data), buffer_size);
-  if (!tflite::VerifyModelBuffer(verifier)) {
-    return CreateStatusWithPayload(
-        StatusCode::kInvalidArgument,
-        "The model is not a valid FlatBuffer buffer.",
-        TfLiteSupportStatus::kInvalidFlatBufferError);
+  if (verify) {
+    flatbuffers::Verifier verifier = flatbuffers::Verifier(
+        reinterpret_cast<const uint8_t*>(buffer_data), buffer_size);
+    if (!tflite::VerifyModelBuffer(verifier)) {
+      return CreateStatusWithPayload(
+          StatusCode::kInvalidArgument,
+          "The model is not a valid FlatBuffer buffer.",
+          TfLiteSupportStatus::kInvalidFlatBufferError);
+    }
   }
   model_ = tflite::GetModel(buffer_data);
   if (model_->metadata() == nullptr) {
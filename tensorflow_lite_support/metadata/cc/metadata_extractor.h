@@ -49,6 +49,13 @@ class ModelMetadataExtractor {
   static tflite::support::StatusOr<std::unique_ptr<ModelMetadataExtractor>>
   CreateFromModelBuffer(const char* buffer_data, size_t buffer_size);
 
+  // Same as CreateFromModelBuffer, but skips the verification of the Model
+  // FlatBuffer. Use only when the buffer has already been verified, e.g. by
+  // tflite::Verify when building the interpreter model from the same bytes,
+  // to avoid walking the whole FlatBuffer a second time.
+  static tflite::support::StatusOr<std::unique_ptr<ModelMetadataExtractor>>
+  CreateFromVerifiedModelBuffer(const char* buffer_data, size_t buffer_size);
+
   // Returns the pointer to the *first* ProcessUnit with the provided type, or
   // nullptr if none can be found. An error is returned if multiple
   // ProcessUnit-s with the provided type are found.
@@ -135,8 +142,10 @@ class ModelMetadataExtractor {
   static constexpr int kDefaultSubgraphIndex = 0;
   // Private default constructor, called from CreateFromModel().
   ModelMetadataExtractor() = default;
-  // Initializes the ModelMetadataExtractor from the provided Model FlatBuffer.
-  absl::Status InitFromModelBuffer(const char* buffer_data, size_t buffer_size);
+  // Initializes the ModelMetadataExtractor from the provided Model FlatBuffer,
+  // verifying it first unless `verify` is false.
+  absl::Status InitFromModelBuffer(const char* buffer_data, size_t buffer_size,
+                                   bool verify = true);
   // Extracts and stores in associated_files_ the associated files (if present)
   // packed into the model FlatBuffer data.
   absl::Status ExtractAssociatedFiles(const char* buffer_data,
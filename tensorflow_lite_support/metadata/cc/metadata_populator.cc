@@ -15,9 +15,16 @@ limitations under the License.
 
 #include "tensorflow_lite_support/metadata/cc/metadata_populator.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <functional>
+#include <limits>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"  // from @com_google_absl
 
 #include "flatbuffers/flatbuffers.h"  // from @flatbuffers
 #include "contrib/minizip/ioapi.h"
@@ -26,6 +33,7 @@ limitations under the License.
 #include "tensorflow_lite_support/cc/common.h"
 #include "tensorflow_lite_support/cc/port/status_macros.h"
 #include "tensorflow_lite_support/cc/port/statusor.h"
+#include "tensorflow_lite_support/metadata/cc/utils/zip_fd_file.h"
 #include "tensorflow_lite_support/metadata/cc/utils/zip_mem_file.h"
 #include "tensorflow_lite_support/metadata/metadata_schema_generated.h"
 
@@ -39,6 +47,51 @@ using ::absl::StatusCode;
 using ::tflite::support::CreateStatusWithPayload;
 using ::tflite::support::TfLiteSupportStatus;
 
+// An associated file compressed with raw deflate, as stored in zip archives.
+struct DeflatedFile {
+  absl::Status status;
+  std::string data;
+  uLong crc = 0;
+};
+
+DeflatedFile Deflate(const std::string& contents) {
+  DeflatedFile file;
+  // zlib takes 32-bit sizes, and the archive is not zip64 anyway.
+  if (contents.size() > std::numeric_limits<uInt>::max() / 2) {
+    file.status = CreateStatusWithPayload(
+        StatusCode::kInvalidArgument, "Associated file is too large to zip",
+        TfLiteSupportStatus::kMetadataAssociatedFileZipError);
+    return file;
+  }
+  file.crc = crc32(0, reinterpret_cast<const Bytef*>(contents.data()),
+                   contents.size());
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS,
+                   /*memLevel=*/8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    file.status = CreateStatusWithPayload(
+        StatusCode::kUnknown, "Unable to initialize deflate",
+        TfLiteSupportStatus::kMetadataAssociatedFileZipError);
+    return file;
+  }
+  file.data.resize(deflateBound(&stream, contents.size()));
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(contents.data()));
+  stream.avail_in = contents.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&file.data[0]);
+  stream.avail_out = file.data.size();
+  const int result = deflate(&stream, Z_FINISH);
+  file.data.resize(stream.total_out);
+  deflateEnd(&stream);
+  if (result != Z_STREAM_END) {
+    file.status = CreateStatusWithPayload(
+        StatusCode::kUnknown, "Unable to deflate associated file",
+        TfLiteSupportStatus::kMetadataAssociatedFileZipError);
+  }
+  return file;
+}
+
 }  // namespace
 
 ModelMetadataPopulator::ModelMetadataPopulator(const tflite::Model& model) {
@@ -94,6 +147,89 @@ void ModelMetadataPopulator::LoadAssociatedFiles(
   associated_files_ = associated_files;
 }
 
+void ModelMetadataPopulator::LoadAssociatedFiles(
+    absl::flat_hash_map<std::string, std::string>&& associated_files) {
+  associated_files_ = std::move(associated_files);
+}
+
+absl::Status ModelMetadataPopulator::WriteAssociatedFiles(
+    void* zip_file, AssociatedFileCompression compression, int num_threads) {
+  zipFile zf = static_cast<zipFile>(zip_file);
+  std::vector<const std::pair<const std::string, std::string>*> files;
+  files.reserve(associated_files_.size());
+  for (const auto& file : associated_files_) {
+    files.push_back(&file);
+  }
+  std::sort(files.begin(), files.end(),
+            [](const auto* a, const auto* b) { return a->first < b->first; });
+
+  const bool deflate = compression == AssociatedFileCompression::kDeflate;
+  const size_t batch_size = deflate ? std::max(num_threads, 1) : 1;
+  std::vector<DeflatedFile> deflated(batch_size);
+  for (size_t batch_start = 0; batch_start < files.size();
+       batch_start += batch_size) {
+    const size_t batch_end = std::min(files.size(), batch_start + batch_size);
+    if (deflate) {
+      // Compress the files of the batch in parallel: they are independent.
+      std::vector<std::thread> threads;
+      for (size_t i = batch_start + 1; i < batch_end; ++i) {
+        threads.emplace_back([&files, &deflated, i, batch_start] {
+          deflated[i - batch_start] = Deflate(files[i]->second);
+        });
+      }
+      deflated[0] = Deflate(files[batch_start]->second);
+      for (std::thread& thread : threads) {
+        thread.join();
+      }
+    }
+
+    // Then write them sequentially, in order.
+    for (size_t i = batch_start; i < batch_end; ++i) {
+      const std::string& name = files[i]->first;
+      const std::string& contents = files[i]->second;
+      bool ok;
+      if (deflate) {
+        DeflatedFile& file = deflated[i - batch_start];
+        RETURN_IF_ERROR(file.status);
+        ok = zipOpenNewFileInZip2(zf, name.c_str(),
+                                  /*zipfi=*/nullptr,
+                                  /*extrafield_local=*/nullptr,
+                                  /*size_extrafield_local=*/0,
+                                  /*extrafield_global=*/nullptr,
+                                  /*size_extrafield_global=*/0,
+                                  /*comment=*/nullptr,
+                                  /*method=*/Z_DEFLATED,
+                                  /*level=*/Z_DEFAULT_COMPRESSION,
+                                  /*raw=*/1) == ZIP_OK &&
+             zipWriteInFileInZip(zf, file.data.data(), file.data.length()) ==
+                 ZIP_OK &&
+             zipCloseFileInZipRaw(zf, contents.length(), file.crc) == ZIP_OK;
+        // Release the compressed data as soon as it is written.
+        file = DeflatedFile();
+      } else {
+        ok = zipOpenNewFileInZip(zf, name.c_str(),
+                                 /*zipfi=*/nullptr,
+                                 /*extrafield_local=*/nullptr,
+                                 /*size_extrafield_local=*/0,
+                                 /*extrafield_global=*/nullptr,
+                                 /*size_extrafield_global=*/0,
+                                 /*comment=*/nullptr,
+                                 /*method=*/0,
+                                 /*level=*/Z_DEFAULT_COMPRESSION) == ZIP_OK &&
+             zipWriteInFileInZip(zf, contents.data(), contents.length()) ==
+                 ZIP_OK &&
+             zipCloseFileInZip(zf) == ZIP_OK;
+      }
+      if (!ok) {
+        return CreateStatusWithPayload(
+            StatusCode::kUnknown, "Unable to write file to zip archive",
+            TfLiteSupportStatus::kMetadataAssociatedFileZipError);
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
 tflite::support::StatusOr<std::string>
 ModelMetadataPopulator::AppendAssociatedFiles(const char* model_buffer_data,
                                               size_t model_buffer_size) {
@@ -108,30 +244,15 @@ ModelMetadataPopulator::AppendAssociatedFiles(const char* model_buffer_data,
         TfLiteSupportStatus::kMetadataAssociatedFileZipError);
   }
   // Write associated files.
-  for (const auto& [name, contents] : associated_files_) {
-    if ((zipOpenNewFileInZip(zf, name.c_str(),
-                             /*zipfi=*/nullptr,
-                             /*extrafield_local=*/nullptr,
-                             /*size_extrafield_local=*/0,
-                             /*extrafield_global=*/nullptr,
-                             /*size_extrafield_global=*/0,
-                             /*comment=*/nullptr,
-                             /*method=*/0,
-                             /*level=*/Z_DEFAULT_COMPRESSION) != ZIP_OK) ||
-        (zipWriteInFileInZip(zf, contents.data(), contents.length()) !=
-         ZIP_OK) ||
-        (zipCloseFileInZip(zf) != ZIP_OK)) {
-      return CreateStatusWithPayload(
-          StatusCode::kUnknown, "Unable to write file to zip archive",
-          TfLiteSupportStatus::kMetadataAssociatedFileZipError);
-    }
-  }
+  absl::Status status = WriteAssociatedFiles(
+      zf, AssociatedFileCompression::kStore, /*num_threads=*/1);
   // Close zip.
-  if (zipClose(zf, /*global_comment=*/nullptr) != ZIP_OK) {
+  if (zipClose(zf, /*global_comment=*/nullptr) != ZIP_OK && status.ok()) {
     return CreateStatusWithPayload(
         StatusCode::kUnknown, "Unable to close zip archive",
         TfLiteSupportStatus::kMetadataAssociatedFileZipError);
   }
+  RETURN_IF_ERROR(status);
   // Return as a string.
   return std::string(mem_file.GetFileContent());
 }
@@ -146,5 +267,46 @@ tflite::support::StatusOr<std::string> ModelMetadataPopulator::Populate() {
       model_fbb.GetSize());
 }
 
+absl::Status ModelMetadataPopulator::PopulateToFileDescriptor(
+    int file_descriptor, AssociatedFileCompression compression,
+    int num_threads) {
+  ZipFdFile fd_file(file_descriptor);
+  {
+    // Build and write the model, and free the builder before zipping.
+    flatbuffers::FlatBufferBuilder model_fbb;
+    model_fbb.Finish(tflite::Model::Pack(model_fbb, &model_t_),
+                     tflite::ModelIdentifier());
+    if (!fd_file.Write(model_fbb.GetBufferPointer(), model_fbb.GetSize())) {
+      return CreateStatusWithPayload(
+          StatusCode::kUnknown,
+          absl::StrFormat("Unable to write model: %s",
+                          std::strerror(fd_file.error())),
+          TfLiteSupportStatus::kError);
+    }
+  }
+  // Open zip, appended to the model.
+  zipFile zf = zipOpen2(/*pathname=*/nullptr, APPEND_STATUS_CREATEAFTER,
+                        /*globalcomment=*/nullptr, &fd_file.GetFileFuncDef());
+  if (zf == nullptr) {
+    return CreateStatusWithPayload(
+        StatusCode::kUnknown, "Unable to open zip archive",
+        TfLiteSupportStatus::kMetadataAssociatedFileZipError);
+  }
+  absl::Status status = WriteAssociatedFiles(zf, compression, num_threads);
+  if (zipClose(zf, /*global_comment=*/nullptr) != ZIP_OK && status.ok()) {
+    status = CreateStatusWithPayload(
+        StatusCode::kUnknown, "Unable to close zip archive",
+        TfLiteSupportStatus::kMetadataAssociatedFileZipError);
+  }
+  if (fd_file.error() != 0) {
+    return CreateStatusWithPayload(
+        StatusCode::kUnknown,
+        absl::StrFormat("Unable to write zip archive: %s",
+                        std::strerror(fd_file.error())),
+        TfLiteSupportStatus::kMetadataAssociatedFileZipError);
+  }
+  return status;
+}
+
 }  // namespace metadata
 }  // namespace tflite
@@ -34,6 +34,18 @@ namespace metadata {
 // [1]: https://www.tensorflow.org/lite/convert/metadata
 class ModelMetadataPopulator {
  public:
+  // How associated files are stored in the zip archive appended to the model.
+  enum class AssociatedFileCompression {
+    // Stored as is. Best for files that are already compressed, and what
+    // `Populate()` uses.
+    kStore,
+    // Compressed with deflate. The C++ and Python metadata extractors can
+    // read such files, but the Java metadata extractor (used on Android)
+    // only supports stored files: use kStore for models meant to be read
+    // with it.
+    kDeflate,
+  };
+
   // Creates a ModelMetadataPopulator from the provided TFLite Model FlatBuffer
   // and returns a pointer to the new object. Ownership is transferred to the
   // caller. Returns an error if the creation failed, which may happen e.g. if
@@ -66,11 +78,27 @@ class ModelMetadataPopulator {
   // previous calls, so this method should usually be called only once.
   void LoadAssociatedFiles(
       const absl::flat_hash_map<std::string, std::string>& associated_files);
+  // Same as above, but takes ownership of the files to avoid copying them.
+  void LoadAssociatedFiles(
+      absl::flat_hash_map<std::string, std::string>&& associated_files);
 
   // Finalizes metadata population. Returns the TFLite FlatBuffer model with
   // metadata and associated files as a string buffer.
   tflite::support::StatusOr<std::string> Populate();
 
+  // Finalizes metadata population like `Populate()`, but streams the TFLite
+  // FlatBuffer model with metadata and associated files to
+  // `file_descriptor`, starting at its current offset, instead of returning a
+  // copy of the whole model. The file descriptor must be seekable and is not
+  // closed.
+  //
+  // With kDeflate, up to `num_threads` associated files are compressed in
+  // parallel, and only their compressed contents are held in memory.
+  absl::Status PopulateToFileDescriptor(
+      int file_descriptor,
+      AssociatedFileCompression compression = AssociatedFileCompression::kStore,
+      int num_threads = 1);
+
  private:
   // Private constructor.
   explicit ModelMetadataPopulator(const tflite::Model& model);
@@ -78,6 +106,10 @@ class ModelMetadataPopulator {
   // internally by `Populate()`.
   tflite::support::StatusOr<std::string> AppendAssociatedFiles(
       const char* model_buffer_data, size_t model_buffer_size);
+  // Writes the associated files, sorted by name, to an open minizip archive.
+  absl::Status WriteAssociatedFiles(void* zip_file,
+                                    AssociatedFileCompression compression,
+                                    int num_threads);
 
   // The unpacked model FlatBuffer.
   tflite::ModelT model_t_;
@@ -0,0 +1,210 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/metadata/cc/metadata_populator.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow_lite_support/cc/port/gmock.h"
+#include "tensorflow_lite_support/cc/port/gtest.h"
+#include "tensorflow_lite_support/cc/port/status_macros.h"
+#include "tensorflow_lite_support/cc/port/status_matchers.h"
+#include "tensorflow_lite_support/cc/test/test_utils.h"
+#include "tensorflow_lite_support/metadata/cc/metadata_extractor.h"
+#include "tensorflow_lite_support/metadata/metadata_schema_generated.h"
+
+namespace tflite {
+namespace metadata {
+namespace {
+
+using ::tflite::task::JoinPath;
+using Compression = ModelMetadataPopulator::AssociatedFileCompression;
+
+constexpr char kTestDataDirectory[] =
+    "/tensorflow_lite_support/cc/test/testdata/task/vision/";
+// A model without metadata nor associated files.
+constexpr char kModelWithoutMetadata[] =
+    "mobilenet_v1_0.25_224_1_default_1.tflite";
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+std::string CreateMetadataBuffer() {
+  ModelMetadataT metadata;
+  metadata.name = "populator test";
+  flatbuffers::FlatBufferBuilder builder;
+  FinishModelMetadataBuffer(builder, ModelMetadata::Pack(builder, &metadata));
+  return std::string(reinterpret_cast<const char*>(builder.GetBufferPointer()),
+                     builder.GetSize());
+}
+
+// Compressible files, more than the number of compression threads used below
+// so that they are compressed in several batches.
+absl::flat_hash_map<std::string, std::string> CreateAssociatedFiles() {
+  absl::flat_hash_map<std::string, std::string> files;
+  for (int i = 0; i < 5; ++i) {
+    std::string contents;
+    for (int line = 0; line < 1000; ++line) {
+      absl::StrAppend(&contents, "label_", i, "_", line % 10, "\n");
+    }
+    files[absl::StrCat("labels_", i, ".txt")] = contents;
+  }
+  files["empty.txt"] = "";
+  return files;
+}
+
+class PopulateToFileDescriptorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    model_ = ReadFile(JoinPath("./" /*test src dir*/, kTestDataDirectory,
+                               kModelWithoutMetadata));
+    ASSERT_FALSE(model_.empty());
+    metadata_ = CreateMetadataBuffer();
+    associated_files_ = CreateAssociatedFiles();
+  }
+
+  std::unique_ptr<ModelMetadataPopulator> CreatePopulator() {
+    tflite::support::StatusOr<std::unique_ptr<ModelMetadataPopulator>>
+        populator = ModelMetadataPopulator::CreateFromModelBuffer(
+            model_.data(), model_.size());
+    EXPECT_TRUE(populator.ok()) << populator.status();
+    (*populator)->LoadMetadata(metadata_.data(), metadata_.size());
+    (*populator)->LoadAssociatedFiles(associated_files_);
+    return std::move(populator).value();
+  }
+
+  // Populates to a new temporary file after writing `prefix` to it, and
+  // returns the contents written after the prefix.
+  tflite::support::StatusOr<std::string> PopulateToFile(
+      ModelMetadataPopulator* populator, const std::string& name,
+      Compression compression, int num_threads,
+      const std::string& prefix = "") {
+    const std::string path = JoinPath(::testing::TempDir(), name);
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    EXPECT_GE(fd, 0);
+    EXPECT_EQ(write(fd, prefix.data(), prefix.size()),
+              static_cast<ssize_t>(prefix.size()));
+    absl::Status status =
+        populator->PopulateToFileDescriptor(fd, compression, num_threads);
+    close(fd);
+    RETURN_IF_ERROR(status);
+    return ReadFile(path).substr(prefix.size());
+  }
+
+  void ExpectAssociatedFiles(const std::string& populated_model) {
+    SUPPORT_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<ModelMetadataExtractor> extractor,
+        ModelMetadataExtractor::CreateFromModelBuffer(populated_model.data(),
+                                                      populated_model.size()));
+    ASSERT_NE(extractor->GetModelMetadata(), nullptr);
+    EXPECT_EQ(extractor->GetModelMetadata()->name()->str(), "populator test");
+    for (const auto& file : associated_files_) {
+      SUPPORT_ASSERT_OK_AND_ASSIGN(absl::string_view contents,
+                                   extractor->GetAssociatedFile(file.first));
+      EXPECT_EQ(contents, file.second) << file.first;
+    }
+  }
+
+  std::string model_;
+  std::string metadata_;
+  absl::flat_hash_map<std::string, std::string> associated_files_;
+};
+
+TEST_F(PopulateToFileDescriptorTest, SucceedsWithStoredFiles) {
+  std::unique_ptr<ModelMetadataPopulator> populator = CreatePopulator();
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::string populated_model,
+      PopulateToFile(populator.get(), "stored.tflite", Compression::kStore,
+                     /*num_threads=*/1));
+
+  ExpectAssociatedFiles(populated_model);
+  // Streaming produces the same bytes as populating in memory.
+  SUPPORT_ASSERT_OK_AND_ASSIGN(std::string in_memory_model,
+                               populator->Populate());
+  EXPECT_EQ(populated_model, in_memory_model);
+}
+
+TEST_F(PopulateToFileDescriptorTest, SucceedsWithDeflatedFiles) {
+  std::unique_ptr<ModelMetadataPopulator> populator = CreatePopulator();
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::string deflated_model,
+      PopulateToFile(populator.get(), "deflated.tflite", Compression::kDeflate,
+                     /*num_threads=*/2));
+
+  ExpectAssociatedFiles(deflated_model);
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::string stored_model,
+      PopulateToFile(populator.get(), "stored.tflite", Compression::kStore,
+                     /*num_threads=*/1));
+  EXPECT_LT(deflated_model.size(), stored_model.size());
+}
+
+TEST_F(PopulateToFileDescriptorTest, IsDeterministic) {
+  std::unique_ptr<ModelMetadataPopulator> populator = CreatePopulator();
+
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::string first,
+      PopulateToFile(populator.get(), "first.tflite", Compression::kDeflate,
+                     /*num_threads=*/1));
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::string second,
+      PopulateToFile(populator.get(), "second.tflite", Compression::kDeflate,
+                     /*num_threads=*/4));
+
+  EXPECT_EQ(first, second);
+}
+
+TEST_F(PopulateToFileDescriptorTest, SucceedsAtNonZeroOffset) {
+  std::unique_ptr<ModelMetadataPopulator> populator = CreatePopulator();
+
+  // The zip offsets are relative to the start of the model, not of the file.
+  SUPPORT_ASSERT_OK_AND_ASSIGN(
+      std::string populated_model,
+      PopulateToFile(populator.get(), "offset.tflite", Compression::kDeflate,
+                     /*num_threads=*/2, /*prefix=*/"some header"));
+
+  ExpectAssociatedFiles(populated_model);
+}
+
+TEST_F(PopulateToFileDescriptorTest, FailsWithInvalidFileDescriptor) {
+  std::unique_ptr<ModelMetadataPopulator> populator = CreatePopulator();
+
+  absl::Status status = populator->PopulateToFileDescriptor(
+      /*file_descriptor=*/-1, Compression::kStore, /*num_threads=*/1);
+
+  EXPECT_EQ(status.code(), absl::StatusCode::kUnknown);
+}
+
+}  // namespace
+}  // namespace metadata
+}  // namespace tflite
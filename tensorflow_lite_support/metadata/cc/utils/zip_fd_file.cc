@@ -0,0 +1,144 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow_lite_support/metadata/cc/utils/zip_fd_file.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#include "contrib/minizip/ioapi.h"
+
+namespace tflite {
+namespace metadata {
+
+ZipFdFile::ZipFdFile(int file_descriptor)
+    : file_descriptor_(file_descriptor),
+      base_offset_(lseek(file_descriptor, 0, SEEK_CUR)),
+      offset_(0),
+      size_(0),
+      error_(base_offset_ < 0 ? errno : 0) {
+  zlib_filefunc_def_.zopen_file = OpenFile;
+  zlib_filefunc_def_.zread_file = ReadFile;
+  zlib_filefunc_def_.zwrite_file = WriteFile;
+  zlib_filefunc_def_.ztell_file = TellFile;
+  zlib_filefunc_def_.zseek_file = SeekFile;
+  zlib_filefunc_def_.zclose_file = CloseFile;
+  zlib_filefunc_def_.zerror_file = ErrorFile;
+  zlib_filefunc_def_.opaque = this;
+}
+
+zlib_filefunc_def& ZipFdFile::GetFileFuncDef() { return zlib_filefunc_def_; }
+
+bool ZipFdFile::Write(const void* buf, size_t size) {
+  if (error_ != 0) {
+    return false;
+  }
+  const char* data = static_cast<const char*>(buf);
+  while (size > 0) {
+    const ssize_t written =
+        pwrite(file_descriptor_, data, size, base_offset_ + offset_);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      error_ = errno;
+      return false;
+    }
+    data += written;
+    size -= written;
+    offset_ += written;
+    size_ = std::max(size_, offset_);
+  }
+  return true;
+}
+
+/* static */
+voidpf ZipFdFile::OpenFile(voidpf opaque, const char* filename, int mode) {
+  // Result is never used, but needs to be non-null for `zipOpen2` not to fail.
+  return opaque;
+}
+
+/* static */
+size_t ZipFdFile::ReadFile(voidpf opaque, voidpf stream, void* buf,
+                           size_t size) {
+  auto* fd_file = static_cast<ZipFdFile*>(opaque);
+  if (fd_file->offset_ >= fd_file->size_) {
+    return 0;
+  }
+  size = std::min(size, fd_file->size_ - fd_file->offset_);
+  const ssize_t read = pread(fd_file->file_descriptor_, buf, size,
+                             fd_file->base_offset_ + fd_file->offset_);
+  if (read < 0) {
+    fd_file->error_ = errno;
+    return 0;
+  }
+  fd_file->offset_ += read;
+  return read;
+}
+
+/* static */
+size_t ZipFdFile::WriteFile(voidpf opaque, voidpf stream, const void* buf,
+                            size_t size) {
+  auto* fd_file = static_cast<ZipFdFile*>(opaque);
+  const size_t offset = fd_file->offset_;
+  fd_file->Write(buf, size);
+  return fd_file->offset_ - offset;
+}
+
+/* static */
+ptrdiff_t ZipFdFile::TellFile(voidpf opaque, voidpf stream) {
+  return static_cast<ZipFdFile*>(opaque)->offset_;
+}
+
+/* static */
+ptrdiff_t ZipFdFile::SeekFile(voidpf opaque, voidpf stream, size_t offset,
+                              int origin) {
+  auto* fd_file = static_cast<ZipFdFile*>(opaque);
+  // Relative offsets are passed as size_t, so negative ones wrap around.
+  switch (origin) {
+    case SEEK_SET:
+      fd_file->offset_ = offset;
+      return 0;
+    case SEEK_CUR:
+      if (fd_file->offset_ + offset > fd_file->size_) {
+        return -1;
+      }
+      fd_file->offset_ += offset;
+      return 0;
+    case SEEK_END:
+      if (fd_file->size_ + offset > fd_file->size_) {
+        return -1;
+      }
+      fd_file->offset_ = fd_file->size_ + offset;
+      return 0;
+    default:
+      return -1;
+  }
+}
+
+/* static */
+int ZipFdFile::CloseFile(voidpf opaque, voidpf stream) {
+  // The file descriptor is not owned.
+  return 0;
+}
+
+/* static */
+int ZipFdFile::ErrorFile(voidpf opaque, voidpf stream) {
+  return static_cast<ZipFdFile*>(opaque)->error_;
+}
+
+}  // namespace metadata
+}  // namespace tflite
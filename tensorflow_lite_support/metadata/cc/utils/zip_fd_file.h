@@ -0,0 +1,75 @@
+/* Copyright 2021 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_SUPPORT_METADATA_CC_UTILS_ZIP_FD_FILE_H_
+#define TENSORFLOW_LITE_SUPPORT_METADATA_CC_UTILS_ZIP_FD_FILE_H_
+
+#include <sys/types.h>
+
+#include <cstdlib>
+
+#include "contrib/minizip/ioapi.h"
+
+namespace tflite {
+namespace metadata {
+
+// Zip file implementation writing straight to a file descriptor, so that a zip
+// archive can be appended to data without holding either of them in memory.
+//
+// Offsets are relative to the position of the file descriptor at construction
+// time, which must be seekable (e.g. a regular file, not a pipe). The file
+// descriptor is not owned and is never closed.
+class ZipFdFile {
+ public:
+  explicit ZipFdFile(int file_descriptor);
+  // Provides access to the `zlib_filefunc_def` implementation for the file.
+  zlib_filefunc_def& GetFileFuncDef();
+  // Writes `size` bytes at the current offset. Can be used before opening the
+  // file with `zipOpen2` and APPEND_STATUS_CREATEAFTER, to write the data the
+  // archive is appended to.
+  bool Write(const void* buf, size_t size);
+  // Returns the errno of the first failed operation, or 0 if none failed.
+  int error() const { return error_; }
+
+ private:
+  // The file descriptor written to.
+  const int file_descriptor_;
+  // The position of the file descriptor at construction time.
+  off_t base_offset_;
+  // The current offset in the file.
+  size_t offset_;
+  // The size of the data written so far.
+  size_t size_;
+  // The errno of the first failed operation, if any.
+  int error_;
+  // The `zlib_filefunc_def` implementation for this zip file.
+  zlib_filefunc_def zlib_filefunc_def_;
+
+  // The file function implementations used in the `zlib_filefunc_def`.
+  static voidpf OpenFile(voidpf opaque, const char* filename, int mode);
+  static size_t ReadFile(voidpf opaque, voidpf stream, void* buf, size_t size);
+  static size_t WriteFile(voidpf opaque, voidpf stream, const void* buf,
+                          size_t size);
+  static ptrdiff_t TellFile(voidpf opaque, voidpf stream);
+  static ptrdiff_t SeekFile(voidpf opaque, voidpf stream, size_t offset,
+                            int origin);
+  static int CloseFile(voidpf opaque, voidpf stream);
+  static int ErrorFile(voidpf opaque, voidpf stream);
+};
+
+}  // namespace metadata
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_SUPPORT_METADATA_CC_UTILS_ZIP_FD_FILE_H_